@@ -21,6 +21,14 @@ crow::response deleteApplicationInstance(PersistentStore& store, const crow::req
 crow::response getApplicationInstanceLogs(PersistentStore& store, 
                                           const crow::request& req, 
                                           const std::string& instanceID);
+///Stream logs for an instance of an application as plain text, sending each 
+///line as soon as it is available, prefixed with the pod and container from 
+///which it came. If the follow parameter is given, the stream continues until 
+///the client disconnects or all of the containers stop.
+///\param instanceID the instance for which to get logs
+crow::response streamApplicationInstanceLogs(PersistentStore& store, 
+                                             const crow::request& req, 
+                                             const std::string& instanceID);
 ///Get the current number of replicas in an instance
 crow::response getApplicationInstanceScale(PersistentStore& store, const crow::request& req, const std::string& instanceID);
 ///Scale a given instance to N replicas
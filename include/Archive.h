@@ -22,6 +22,20 @@ void gzipDecompress(std::istream& src, std::ostream& dest);
 ///compress gzipped data from one stream to another
 void gzipCompress(std::istream& src, std::ostream& dest);
 
+///compress a buffer of data in memory, producing gzip formatted output
+///\param data the data to compress
+///\param level the zlib compression level to use, from 1 (fastest) to 9 
+///             (smallest output)
+///\return the compressed data
+///\throws std::runtime_error if compression fails
+std::string gzipCompress(const std::string& data, int level);
+
+///decompress a buffer of gzip formatted data in memory
+///\param data the compressed data
+///\return the decompressed data
+///\throws std::runtime_error if the data is not valid gzip data
+std::string gzipDecompress(const std::string& data);
+
 //A simple interface for reading a tarball
 //files are read in on demand, and can be dropped from memory when no longer needed
 //Once dropped, a file cannot be retrieved again
@@ -0,0 +1,350 @@
+#ifndef SLATE_CACHE_MANAGER_H
+#define SLATE_CACHE_MANAGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libcuckoo/cuckoohash_map.hh>
+
+#include <concurrent_multimap.h>
+#include <Entities.h>
+
+///A cuckoohash_map holding cache records, which notes when each record is
+///read so that CacheManager can prefer to evict records which are not in use,
+///and counts how many reads find a record which has not expired.
+///The record type must have a mutable boolean member named referenced, and a
+///member function expired().
+template<typename Key, typename Record,
+         typename Hash=std::hash<Key>, typename KeyEqual=std::equal_to<Key>>
+class cache_map : public cuckoohash_map<Key,Record,Hash,KeyEqual>{
+public:
+	///Search for a key, copying the associated record if it is found
+	///\return whether the key was found
+	template<typename K>
+	bool find(const K& key, Record& val) const{
+		bool found=this->find_fn(key,[&val](const Record& record){
+			record.referenced=true;
+			val=record;
+		});
+		lookupCount.fetch_add(1,std::memory_order_relaxed);
+		if(found && !val.expired())
+			hitCount.fetch_add(1,std::memory_order_relaxed);
+		return found;
+	}
+
+	///Search for a key
+	///\return the associated record
+	///\throws std::out_of_range if the key is not found
+	template<typename K>
+	Record find(const K& key) const{
+		Record val;
+		if(!find(key,val))
+			throw std::out_of_range("key not found in table");
+		return val;
+	}
+
+	///\return the number of searches performed
+	unsigned long long lookups() const{ return lookupCount.load(std::memory_order_relaxed); }
+	///\return the number of searches which found an unexpired record
+	unsigned long long hits() const{ return hitCount.load(std::memory_order_relaxed); }
+
+private:
+	mutable std::atomic<unsigned long long> lookupCount{0};
+	mutable std::atomic<unsigned long long> hitCount{0};
+};
+
+//Estimates of the heap memory owned by cached data, beyond the size of the
+//objects themselves
+std::size_t dynamicSize(const std::string& s);
+std::size_t dynamicSize(const User& user);
+std::size_t dynamicSize(const Group& group);
+std::size_t dynamicSize(const Cluster& cluster);
+std::size_t dynamicSize(const GeoLocation& location);
+std::size_t dynamicSize(const Application& application);
+std::size_t dynamicSize(const ApplicationInstance& instance);
+std::size_t dynamicSize(const Secret& secret);
+inline std::size_t dynamicSize(bool){ return 0; }
+
+template<typename T>
+std::size_t dynamicSize(const std::vector<T>& items){
+	std::size_t size=items.capacity()*sizeof(T);
+	for(const auto& item : items)
+		size+=dynamicSize(item);
+	return size;
+}
+
+template<typename T>
+std::size_t dynamicSize(const std::set<T>& items){
+	//each item is held in a tree node with three pointers and a color
+	const std::size_t nodeOverhead=4*sizeof(void*);
+	std::size_t size=items.size()*(sizeof(T)+nodeOverhead);
+	for(const auto& item : items)
+		size+=dynamicSize(item);
+	return size;
+}
+
+///Enforces size limits on a collection of caches, and removes expired records
+///from them.
+///Caches are examined periodically by a background thread. Each examination
+///removes all expired records, and then, if the cache is over its entry or
+///memory budget, evicts records using the CLOCK algorithm: records are
+///considered in a circular order, and a record which has been read since it
+///was last considered has its reference mark cleared and is passed over,
+///while one which has not is evicted.
+///Each cache is locked in its entirety while it is examined. To keep this 
+///short, memory use is estimated from the sizes of a bounded sample of 
+///entries rather than by sizing every entry.
+class CacheManager{
+public:
+	///Limits on the size of a cache. A limit of zero means no limit.
+	struct Budget{
+		std::size_t maxEntries;
+		///The limit on the estimated memory used by the cache, in bytes
+		std::size_t maxBytes;
+	};
+
+	CacheManager();
+	///Stops the background sweeping thread, if running
+	~CacheManager();
+
+	///Register a cache of individual records.
+	///\param name the name by which the cache is identified in statistics and
+	///            configuration
+	///\param cache the cache, which must outlive this object, or at least
+	///             any background sweeping
+	///\param budget the limits on the cache's size
+	///\param onRemoval a function to call, while the cache is still locked,
+	///                 whenever any records are removed from it. This can be
+	///                 used to invalidate knowledge that the cache is complete.
+	template<typename Key, typename Record, typename Hash, typename KeyEqual>
+	void manage(const std::string& name, cache_map<Key,Record,Hash,KeyEqual>& cache,
+	            Budget budget, std::function<void()> onRemoval=nullptr){
+		using Mapped=Record;
+		manageTable(name,budget,
+			[&cache]{ return cache.size(); },
+			[&cache]{ return HitCounts{cache.lookups(),cache.hits()}; },
+			[&cache,onRemoval](Budget budget, std::size_t& hand){
+				auto table=cache.lock_table();
+				return sweepTable(table,budget,hand,onRemoval,
+					[](Mapped& record, std::chrono::steady_clock::time_point now){
+						return now>record.expirationTime;
+					},
+					[](const Key& key, const Mapped& record){
+						return sizeof(Key)+dynamicSize(key)+sizeof(Mapped)+dynamicSize(record.record);
+					});
+			});
+	}
+
+	///Register a cache of categories of records.
+	///Within a category which has expired (and so is not known to be
+	///complete), expired records are removed, and the category is removed when
+	///no records remain. Eviction removes whole categories.
+	///Parameters are as for the other overload.
+	template<typename Key, typename Record, typename KeyHash, typename KeyEqual,
+	         typename ValueHash, typename ValueEqual>
+	void manage(const std::string& name,
+	            concurrent_multimap<Key,Record,KeyHash,KeyEqual,ValueHash,ValueEqual>& cache,
+	            Budget budget, std::function<void()> onRemoval=nullptr){
+		using Multimap=concurrent_multimap<Key,Record,KeyHash,KeyEqual,ValueHash,ValueEqual>;
+		using Mapped=typename Multimap::category_type;
+		manageTable(name,budget,
+			[&cache]{ return cache.size(); },
+			[&cache]{ return HitCounts{cache.lookups(),cache.hits()}; },
+			[&cache,onRemoval](Budget budget, std::size_t& hand){
+				auto table=cache.lock_table();
+				return sweepTable(table,budget,hand,onRemoval,
+					[](Mapped& category, std::chrono::steady_clock::time_point now){
+						if(category.expiration>=now)
+							return false;
+						auto stale=[now](const Record& record){ return now>record.expirationTime; };
+						const auto& records=category.items();
+						if(std::none_of(records.begin(),records.end(),stale))
+							return false;
+						//the table is locked, so this is safe
+						auto& modifiable=Multimap::mutableItems(category);
+						for(auto it=modifiable.begin(); it!=modifiable.end();){
+							if(stale(*it))
+								it=modifiable.erase(it);
+							else
+								++it;
+						}
+						return modifiable.empty();
+					},
+					[](const Key& key, const Mapped& category){
+						//each record is held in a hash table node with a next
+						//pointer, and a cached hash
+						const std::size_t nodeOverhead=2*sizeof(void*);
+						std::size_t size=sizeof(Key)+dynamicSize(key)+sizeof(Mapped)
+						                 +sizeof(typename Multimap::set_type)
+						                 +category.items().bucket_count()*sizeof(void*);
+						for(const auto& record : category.items())
+							size+=sizeof(Record)+nodeOverhead+dynamicSize(record.record);
+						return size;
+					});
+			});
+	}
+
+	///Change the budget of a registered cache
+	///\return whether a cache with the given name was found
+	bool setBudget(const std::string& name, Budget budget);
+
+	///Check whether a cache's budget could hold a given number of entries of
+	///the average size seen when it was last examined. Listings of all 
+	///records of a kind which cannot fit should not be cached, since they 
+	///would only be evicted, and so marked incomplete, by the next sweep.
+	///\param name the name of the cache
+	///\param entries the number of entries
+	///\return whether the entries would fit; false if the cache is unknown
+	bool canHold(const std::string& name, std::size_t entries) const;
+
+	///Examine every cache once
+	void sweep();
+
+	///Begin examining caches periodically in a background thread
+	///\param interval the time to wait between rounds of examinations
+	void startSweeping(std::chrono::milliseconds interval);
+
+	///Stop the background sweeping thread, if running
+	void stopSweeping();
+
+	///\return human-readable statistics on the entries, estimated memory use,
+	///        hit ratio, expirations, and evictions for each cache
+	std::string getStatistics() const;
+
+	///Write the same statistics as getStatistics in the Prometheus text format
+	void writeMetrics(std::ostream& os) const;
+
+private:
+	///The outcome of examining a cache
+	struct SweepResult{
+		std::size_t entries;
+		std::size_t bytes;
+		std::size_t expired;
+		std::size_t evicted;
+	};
+
+	///The number of searches of a cache, and how many of them found fresh data
+	struct HitCounts{
+		unsigned long long lookups;
+		unsigned long long hits;
+	};
+
+	struct ManagedCache{
+		std::string name;
+		Budget budget;
+		///Get the current number of entries in the cache
+		std::function<std::size_t()> size;
+		///Get the number of searches of the cache
+		std::function<HitCounts()> hitCounts;
+		///Examine the cache with the given budget and CLOCK hand position
+		std::function<SweepResult(Budget,std::size_t&)> sweep;
+		///The position at which the next eviction scan should begin
+		std::size_t hand;
+
+		std::atomic<std::size_t> bytes;
+		///The estimated size of an entry as of the last sweep
+		std::atomic<std::size_t> meanEntryBytes;
+		std::atomic<unsigned long long> expired;
+		std::atomic<unsigned long long> evicted;
+	};
+
+	void manageTable(const std::string& name, Budget budget,
+	                 std::function<std::size_t()> size,
+	                 std::function<HitCounts()> hitCounts,
+	                 std::function<SweepResult(Budget,std::size_t&)> sweep);
+
+	///Remove expired entries from a locked table and evict entries as
+	///necessary to fit its budget
+	///\param table the table
+	///\param budget the limits the table must fit within
+	///\param hand the CLOCK hand, the index of the entry to consider first
+	///            for eviction
+	///\param onRemoval called if any entry is removed
+	///\param expire a function which removes any expired data from a mapped
+	///              value and returns whether the whole entry should be removed
+	///\param entrySize a function which estimates the memory used by an entry
+	template<typename LockedTable, typename ExpireFunc, typename SizeFunc>
+	static SweepResult sweepTable(LockedTable& table, Budget budget, std::size_t& hand,
+	                              const std::function<void()>& onRemoval,
+	                              ExpireFunc expire, SizeFunc entrySize){
+		const auto now=std::chrono::steady_clock::now();
+		SweepResult result{0,0,0,0};
+		std::size_t sampled=0, sampledBytes=0;
+		for(auto it=table.begin(); it!=table.end();){
+			if(expire(it->second,now)){
+				it=table.erase(it);
+				result.expired++;
+			}
+			else{
+				if(sampled<sizeSampleLimit){
+					sampledBytes+=entrySize(it->first,it->second);
+					sampled++;
+				}
+				++it;
+			}
+		}
+		result.entries=table.size();
+		const std::size_t meanEntryBytes=(sampled ? sampledBytes/sampled : 0);
+		result.bytes=meanEntryBytes*result.entries;
+
+		auto overBudget=[&]{
+			return (budget.maxEntries && result.entries>budget.maxEntries)
+			    || (budget.maxBytes && result.bytes>budget.maxBytes);
+		};
+		if(overBudget()){
+			//advance to the hand's position
+			if(hand>=result.entries)
+				hand=0;
+			auto it=table.begin();
+			for(std::size_t i=0; i<hand; i++)
+				++it;
+			//each entry needs to be passed over at most once to clear its
+			//reference mark, so two full revolutions suffice
+			for(std::size_t steps=2*result.entries; steps && overBudget(); steps--){
+				if(it==table.end()){
+					it=table.begin();
+					hand=0;
+				}
+				if(it->second.referenced){
+					it->second.referenced=false;
+					++it;
+					hand++;
+				}
+				else{
+					result.bytes-=std::min(result.bytes,meanEntryBytes);
+					it=table.erase(it);
+					result.entries--;
+					result.evicted++;
+				}
+			}
+		}
+
+		if((result.expired || result.evicted) && onRemoval)
+			onRemoval();
+		return result;
+	}
+
+	///The most entries of a cache to size when estimating its memory use
+	static const std::size_t sizeSampleLimit=64;
+
+	///Protects caches and the budgets of its members
+	mutable std::mutex cachesMutex;
+	std::vector<std::unique_ptr<ManagedCache>> caches;
+
+	std::thread sweeper;
+	std::mutex sweeperMutex;
+	std::condition_variable sweeperCondition;
+	bool stopRequested;
+};
+
+#endif //SLATE_CACHE_MANAGER_H
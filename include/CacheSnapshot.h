@@ -0,0 +1,77 @@
+#ifndef SLATE_CACHE_SNAPSHOT_H
+#define SLATE_CACHE_SNAPSHOT_H
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+#include <Entities.h>
+
+///Encodes cached records in a compact binary form, so that the contents of
+///the caches can be saved by one server instance and loaded by the next.
+///Integers are written as variable length (LEB128) values and strings are
+///prefixed with their lengths, so most records take only a few bytes more
+///than the text they contain.
+class SnapshotWriter{
+public:
+	void writeInteger(std::uint64_t value);
+	void writeString(const std::string& s);
+	void write(const User& user);
+	void write(const Group& group);
+	void write(const Cluster& cluster);
+	void write(const ApplicationInstance& instance);
+	void write(const Application& application);
+	void write(const std::set<std::string>& items);
+
+	///Begin a section of the snapshot. Sections are prefixed with their
+	///lengths, so that a reader can skip any which it does not understand.
+	///\param kind a number identifying the contents of the section
+	void beginSection(std::uint64_t kind);
+	///Complete the section most recently begun
+	void endSection();
+
+	///\return the encoded data
+	const std::string& data() const{ return buffer; }
+private:
+	std::string buffer;
+	///The kind of the section in progress and the position at which its
+	///contents began
+	std::uint64_t sectionKind;
+	std::size_t sectionStart;
+};
+
+///Decodes data written by SnapshotWriter. All read functions throw
+///std::runtime_error if the data ends too soon.
+class SnapshotReader{
+public:
+	///\param data the encoded data, which must remain valid for the lifetime
+	///            of the reader
+	///\param size the length of the encoded data
+	SnapshotReader(const char* data, std::size_t size);
+
+	std::uint64_t readInteger();
+	std::string readString();
+	void read(User& user);
+	void read(Group& group);
+	void read(Cluster& cluster);
+	void read(ApplicationInstance& instance);
+	void read(Application& application);
+	void read(std::set<std::string>& items);
+
+	///\return whether all data has been read
+	bool atEnd() const{ return position==size; }
+
+	///Begin reading a section
+	///\param length will be set to the length of the section's contents
+	///\return the kind of the section
+	std::uint64_t readSectionHeader(std::size_t& length);
+	///Skip over data, such as the contents of a section which is not
+	///understood
+	void skip(std::size_t length);
+private:
+	const char* data;
+	std::size_t size;
+	std::size_t position;
+};
+
+#endif //SLATE_CACHE_SNAPSHOT_H
@@ -0,0 +1,134 @@
+#ifndef SLATE_CHANGE_FEED_H
+#define SLATE_CHANGE_FEED_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/core/client/ClientConfiguration.h>
+#include <aws/dynamodb/model/AttributeValue.h>
+#include <aws/dynamodbstreams/DynamoDBStreamsClient.h>
+
+#include <LatencyHistogram.h>
+
+///Follows the DynamoDB Streams of a set of tables, reporting every change made
+///to their items, so that cached copies of those items can be kept up to date
+///when they are modified by other clients of the database.
+///Each stream is divided into shards, each of which covers a range of time;
+///DynamoDB closes shards and opens new ones periodically. Changes within a
+///shard are delivered in order, and a shard is only read once its parent has
+///been read completely, so changes to the same item are always delivered in
+///the order in which they were made.
+///Streams are only read from the point at which following begins; it is
+///assumed that anything cached before that point was read from the database
+///after any earlier changes.
+class ChangeFeed{
+public:
+	using Item=Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>;
+
+	///A change to a single item
+	struct Change{
+		enum Kind{Insert,Modify,Remove};
+		Kind kind;
+		///The name of the table containing the item
+		std::string table;
+		///The item's key attributes
+		Item keys;
+		///The item before the change, if the stream records old images and
+		///the item previously existed
+		Item oldImage;
+		///The item after the change, if the stream records new images and
+		///the item still exists
+		Item newImage;
+	};
+
+	///\param credentials the AWS credentials used for authentication
+	///\param clientConfig specification of the DynamoDB Streams endpoint
+	///\param onChange the function to call with each change. It is called
+	///                from the feed's background thread.
+	///\param onGap the function to call with a table's name when changes to
+	///             it may have been missed, because the position in its stream
+	///             was lost. All cached data from the table should then be
+	///             discarded.
+	ChangeFeed(const Aws::Auth::AWSCredentials& credentials,
+	           const Aws::Client::ClientConfiguration& clientConfig,
+	           std::function<void(const Change&)> onChange,
+	           std::function<void(const std::string&)> onGap);
+
+	///Stops following changes, if running
+	~ChangeFeed();
+
+	///Add a table to follow. Must be called before start().
+	///\param table the name of the table
+	///\param streamArn the ARN of the table's stream
+	void follow(const std::string& table, const std::string& streamArn);
+
+	///Begin following changes in a background thread
+	void start();
+
+	///Stop following changes
+	void stop();
+
+	///\return human-readable statistics on the number of changes received and
+	///        the delay between changes being made and being received
+	std::string getStatistics() const;
+
+private:
+	///The state of reading a single table's stream
+	struct Stream{
+		std::string table;
+		std::string arn;
+		///Iterators for the shards currently being read, indexed by shard ID
+		std::map<std::string,std::string> iterators;
+		///Shards which have been read completely, or which were already closed
+		///when following began
+		std::set<std::string> finished;
+		///Whether the stream's shards have been listed at least once
+		bool described;
+		///The time at which the shards should next be listed to find any new
+		///ones
+		std::chrono::steady_clock::time_point nextDescribe;
+	};
+
+	Aws::DynamoDBStreams::DynamoDBStreamsClient client;
+	std::function<void(const Change&)> onChange;
+	std::function<void(const std::string&)> onGap;
+	std::vector<Stream> streams;
+
+	std::thread worker;
+	std::mutex workerMutex;
+	std::condition_variable workerCondition;
+	bool stopRequested;
+
+	std::atomic<unsigned long long> changesReceived;
+	std::atomic<unsigned long long> gaps;
+	///The time from changes being made to their being received. DynamoDB only
+	///reports the times at which changes were made to the nearest second.
+	LatencyHistogram delays;
+
+	///Repeatedly poll all streams until stopped
+	void run();
+	///List a stream's shards, and begin reading any which are new and whose
+	///parents have been completely read
+	void describe(Stream& stream);
+	///Read available records from all of a stream's open shards
+	///\return the number of changes read
+	std::size_t poll(Stream& stream);
+	///Obtain an iterator for a shard
+	///\param latest whether to start from the newest position in the shard,
+	///              rather than the oldest
+	///\return the iterator, or an empty string on failure
+	std::string shardIterator(const Stream& stream, const std::string& shardID, bool latest);
+	///Convert a stream record to a Change and pass it to onChange
+	void deliver(const Stream& stream, const Aws::DynamoDBStreams::Model::Record& record);
+};
+
+#endif //SLATE_CHANGE_FEED_H
@@ -79,6 +79,11 @@ namespace internal{
 	///\return a string describing the error which has occured, or an empty 
 	///        string indicating success
 	std::string deleteCluster(PersistentStore& store, const Cluster& cluster, bool force);
+	
+	///Attempt to contact a cluster with kubectl
+	///\param cluster the cluster to contact
+	///\return whether the cluster responded as expected
+	bool pingCluster(PersistentStore& store, const Cluster& cluster);
 }
 
 #endif //SLATE_CLUSTER_COMMANDS_H
@@ -0,0 +1,114 @@
+#ifndef SLATE_CLUSTER_PROBER_H
+#define SLATE_CLUSTER_PROBER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Entities.h"
+#include "LatencyHistogram.h"
+
+class PersistentStore;
+
+///Checks whether clusters can be contacted, from a background thread, so that
+///the store's record of each cluster's reachability is kept current and
+///requests need not wait for a cluster to respond (or to time out).
+///Each cluster is probed on its own schedule: reachable clusters at a fixed
+///interval, and unreachable ones at an interval which doubles with each
+///consecutive failure, up to a limit. A cluster is probed promptly when it is
+///first seen, when its configuration changes, when it becomes reachable or
+///unreachable, or when probeSoon() is called for it.
+class ClusterProber{
+public:
+	struct Schedule{
+		///The time between probes of a reachable cluster
+		std::chrono::seconds interval;
+		///The longest time between probes of an unreachable cluster
+		std::chrono::seconds maxBackoff;
+		///The time to wait before probing a cluster which has changed
+		std::chrono::seconds afterChange;
+		///The maximum number of probes to run at once
+		unsigned int maxConcurrent;
+	};
+
+	///\param store the store from which to list clusters and in which to
+	///             record their reachability. It must outlive this object.
+	///\param probe the function which attempts to contact a cluster, and
+	///             returns whether it succeeded
+	///\param schedule the timing of probes
+	ClusterProber(PersistentStore& store, std::function<bool(const Cluster&)> probe,
+	              Schedule schedule);
+
+	///Stops probing, if running
+	~ClusterProber();
+
+	///Begin probing clusters in a background thread
+	void start();
+
+	///Stop probing, waiting for any probes in progress to finish
+	void stop();
+
+	///Request that a cluster be probed shortly, for example because it has
+	///just been registered or its configuration has been updated
+	///\param cID the ID of the cluster
+	void probeSoon(const std::string& cID);
+
+	///\return human-readable statistics on the state of each cluster and the
+	///        time taken to probe it
+	std::string getStatistics() const;
+
+	///\return the timing of probes
+	const Schedule& getSchedule() const{ return schedule; }
+
+private:
+	///What is known about a single cluster
+	struct ClusterState{
+		std::string name;
+		///A hash of the cluster's configuration when it was last listed, to
+		///notice changes
+		std::size_t configHash;
+		std::chrono::steady_clock::time_point nextProbe;
+		///Whether the cluster has been probed at least once
+		bool probed;
+		///The result of the most recent probe
+		bool reachable;
+		///The number of consecutive failed probes
+		unsigned int failures;
+		///Whether a probe of this cluster is currently running
+		bool inProgress;
+		///The durations of all probes of this cluster
+		std::unique_ptr<LatencyHistogram> latency;
+	};
+
+	PersistentStore& store;
+	std::function<bool(const Cluster&)> probe;
+	const Schedule schedule;
+
+	///Protects clusters, pending, and stopRequested
+	mutable std::mutex stateMutex;
+	std::map<std::string,ClusterState> clusters;
+	///Probes which have been started and may not have finished
+	std::vector<std::future<void>> pending;
+
+	std::thread worker;
+	std::condition_variable workerCondition;
+	bool stopRequested;
+
+	///Repeatedly start probes as they come due, until stopped
+	void run();
+	///Bring the set of tracked clusters up to date with the store, and start
+	///probes of those which are due
+	void startDueProbes();
+	///Probe one cluster and record the result
+	void probeCluster(Cluster cluster);
+};
+
+#endif //SLATE_CLUSTER_PROBER_H
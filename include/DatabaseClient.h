@@ -0,0 +1,124 @@
+#ifndef SLATE_DATABASE_CLIENT_H
+#define SLATE_DATABASE_CLIENT_H
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/core/client/ClientConfiguration.h>
+#include <aws/core/client/RetryStrategy.h>
+#include <aws/dynamodb/DynamoDBClient.h>
+
+#include <LatencyHistogram.h>
+#include <Tracing.h>
+
+///A retry strategy which backs off exponentially, choosing each delay
+///uniformly at random between zero and the exponential limit ('full jitter').
+///The SDK's default strategy uses the same delays for every client, so
+///requests which are throttled together tend to be retried together and
+///throttled again.
+class JitteredRetryStrategy : public Aws::Client::RetryStrategy{
+public:
+	///\param maxRetries the maximum number of times to retry a request
+	///\param baseDelay the upper limit for the delay before the first retry,
+	///                 in milliseconds
+	///\param maxDelay the maximum delay before any retry, in milliseconds
+	JitteredRetryStrategy(long maxRetries, long baseDelay, long maxDelay);
+
+	bool ShouldRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+	                 long attemptedRetries) const override;
+
+	long CalculateDelayBeforeNextRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+	                                   long attemptedRetries) const override;
+
+	///\return the number of retries which have been made
+	unsigned long long retries() const{ return retryCount.load(); }
+
+private:
+	const long maxRetries;
+	const long baseDelay;
+	const long maxDelay;
+	mutable std::atomic<unsigned long long> retryCount;
+};
+
+///A DynamoDB client which records the latency of every operation performed
+///through it. It exposes the subset of the SDK client's interface which is
+///used by PersistentStore, with the same signatures.
+class DatabaseClient{
+public:
+	///The operations for which latencies are recorded
+	enum class Operation{
+		BatchWriteItem,
+		CreateTable,
+		DeleteItem,
+		DeleteTable,
+		DescribeTable,
+		DescribeTimeToLive,
+		GetItem,
+		PutItem,
+		Query,
+		Scan,
+		UpdateItem,
+		UpdateTable,
+		UpdateTimeToLive,
+		Count ///<not an operation; the number of operations
+	};
+
+	DatabaseClient(const Aws::Auth::AWSCredentials& credentials,
+	               const Aws::Client::ClientConfiguration& clientConfig);
+
+	Aws::DynamoDB::Model::BatchWriteItemOutcome BatchWriteItem(const Aws::DynamoDB::Model::BatchWriteItemRequest& request) const;
+	Aws::DynamoDB::Model::CreateTableOutcome CreateTable(const Aws::DynamoDB::Model::CreateTableRequest& request) const;
+	Aws::DynamoDB::Model::DeleteItemOutcome DeleteItem(const Aws::DynamoDB::Model::DeleteItemRequest& request) const;
+	Aws::DynamoDB::Model::DeleteTableOutcome DeleteTable(const Aws::DynamoDB::Model::DeleteTableRequest& request) const;
+	Aws::DynamoDB::Model::DescribeTableOutcome DescribeTable(const Aws::DynamoDB::Model::DescribeTableRequest& request) const;
+	Aws::DynamoDB::Model::DescribeTimeToLiveOutcome DescribeTimeToLive(const Aws::DynamoDB::Model::DescribeTimeToLiveRequest& request) const;
+	Aws::DynamoDB::Model::GetItemOutcome GetItem(const Aws::DynamoDB::Model::GetItemRequest& request) const;
+	Aws::DynamoDB::Model::PutItemOutcome PutItem(const Aws::DynamoDB::Model::PutItemRequest& request) const;
+	Aws::DynamoDB::Model::QueryOutcome Query(const Aws::DynamoDB::Model::QueryRequest& request) const;
+	Aws::DynamoDB::Model::ScanOutcome Scan(const Aws::DynamoDB::Model::ScanRequest& request) const;
+	Aws::DynamoDB::Model::UpdateItemOutcome UpdateItem(const Aws::DynamoDB::Model::UpdateItemRequest& request) const;
+	Aws::DynamoDB::Model::UpdateTableOutcome UpdateTable(const Aws::DynamoDB::Model::UpdateTableRequest& request) const;
+	Aws::DynamoDB::Model::UpdateTimeToLiveOutcome UpdateTimeToLive(const Aws::DynamoDB::Model::UpdateTimeToLiveRequest& request) const;
+
+	//Asynchronous versions. The latency recorded is the time until the
+	//outcome is available, not until it is retrieved from the future.
+	std::future<Aws::DynamoDB::Model::GetItemOutcome> GetItemCallable(const Aws::DynamoDB::Model::GetItemRequest& request) const;
+	std::future<Aws::DynamoDB::Model::QueryOutcome> QueryCallable(const Aws::DynamoDB::Model::QueryRequest& request) const;
+
+	///\return the latencies recorded for an operation
+	const LatencyHistogram& latency(Operation op) const{ return latencies[(std::size_t)op]; }
+	///\return the name of an operation
+	static const char* operationName(Operation op);
+
+	///\return human-readable latency statistics for all operations which
+	///        have been performed, and the number of retries made
+	std::string getStatistics() const;
+
+	///Write the latencies of all operations and the number of retries made
+	///in the Prometheus text format
+	void writeMetrics(std::ostream& os) const;
+
+private:
+	Aws::DynamoDB::DynamoDBClient client;
+	///The client's retry strategy, if it is one which counts its retries
+	std::shared_ptr<const JitteredRetryStrategy> retryStrategy;
+	mutable std::array<LatencyHistogram,(std::size_t)Operation::Count> latencies;
+
+	///Perform a synchronous operation, recording how long it takes
+	template<typename Request, typename Outcome>
+	Outcome timed(Operation op, Outcome (Aws::DynamoDB::DynamoDBClient::*call)(const Request&) const,
+	              const Request& request) const{
+		tracing::Span span("dynamodb",operationName(op));
+		auto start=std::chrono::steady_clock::now();
+		Outcome outcome=(client.*call)(request);
+		latencies[(std::size_t)op].record(std::chrono::steady_clock::now()-start);
+		return outcome;
+	}
+};
+
+#endif //SLATE_DATABASE_CLIENT_H
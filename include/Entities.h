@@ -241,6 +241,39 @@ struct hash<Secret>{
 };
 }
 
+///A long-running operation which is performed in the background, and whose 
+///progress can be queried
+struct Job{
+	Job():valid(false),resultCode(0){}
+	
+	bool valid;
+	std::string id;
+	///The kind of operation being performed, e.g. 'install'
+	std::string kind;
+	///The ID of the user on whose behalf the operation is performed
+	std::string owner;
+	///The ID of the cluster on which the operation acts, if there is exactly one
+	std::string cluster;
+	///One of 'pending', 'running', 'succeeded', or 'failed'
+	std::string status;
+	///A description of the step the operation has reached
+	std::string progress;
+	///Once finished, the HTTP status code with which the operation would have 
+	///been answered, had it been performed synchronously
+	unsigned int resultCode;
+	///Once finished, the body of the response which would have been sent
+	std::string result;
+	std::string ctime;
+	///The time at which the job was last updated
+	std::string mtime;
+	
+	explicit operator bool() const{ return valid; }
+	///\return whether the job has finished, successfully or not
+	bool finished() const{ return status=="succeeded" || status=="failed"; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Job& j);
+
 static class IDGenerator{
 public:
 	///Creates a random ID for a new user
@@ -263,6 +296,10 @@ public:
 	std::string generateSecretID(){
 		return secretIDPrefix+generateRawID();
 	}
+	///Creates a random ID for a new job
+	std::string generateJobID(){
+		return jobIDPrefix+generateRawID();
+	}
 	///Creates a random access token for a user
 	///At the moment there is no apparent reason that a user's access token
 	///should have any particular structure or meaning. Definite requirements:
@@ -281,6 +318,7 @@ public:
 	const static std::string groupIDPrefix;
 	const static std::string instanceIDPrefix;
 	const static std::string secretIDPrefix;
+	const static std::string jobIDPrefix;
 	
 private:
 	std::mutex mut;
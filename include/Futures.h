@@ -0,0 +1,43 @@
+#ifndef SLATE_FUTURES_H
+#define SLATE_FUTURES_H
+
+#include <future>
+#include <utility>
+#include <vector>
+
+///Construct a future whose value is already available
+///\param value the value with which the future should be satisfied
+template<typename T>
+std::future<T> makeReadyFuture(T value){
+	std::promise<T> promise;
+	promise.set_value(std::move(value));
+	return promise.get_future();
+}
+
+///Attach a continuation to a future.
+///The continuation runs in the thread which first waits on the resulting
+///future, once the original future's value is available, so no additional
+///thread is used.
+///\param future the future whose result should be transformed
+///\param fn the function to apply to the result
+///\return a deferred future for the result of applying fn
+template<typename T, typename F>
+auto then(std::future<T>&& future, F fn) -> std::future<decltype(fn(std::declval<T>()))>{
+	return std::async(std::launch::deferred,
+	                  [fn](std::future<T> future){ return fn(future.get()); },
+	                  std::move(future));
+}
+
+///Wait for all of a collection of futures
+///\param futures the futures to wait for, which will all have been consumed
+///\return the results of the futures, in the same order
+template<typename T>
+std::vector<T> getAll(std::vector<std::future<T>>& futures){
+	std::vector<T> results;
+	results.reserve(futures.size());
+	for(auto& future : futures)
+		results.push_back(future.get());
+	return results;
+}
+
+#endif //SLATE_FUTURES_H
@@ -1,6 +1,9 @@
 #ifndef SLATE_HTTPREQUESTS_H
 #define SLATE_HTTPREQUESTS_H
 
+#include <functional>
+#include <string>
+
 #include <curl/curlver.h>
 
 #ifdef CURL_AT_LEAST_VERSION
@@ -13,13 +16,27 @@
 namespace httpRequests{
 
 struct Options{
-	Options():contentType("application/octet-stream"){}
+	Options():contentType("application/octet-stream"),acceptCompression(true){}
 	///value to use for the HTTP ContentType header.
 	///Only meaningful for POST and PUT operations
 	std::string contentType;
 	///If non-empty, the value to set as curl's CURLOPT_CAINFO for SSL 
 	///certificate verification. 
 	std::string caBundlePath;
+	///Whether to advertise support for compressed (e.g. gzipped) responses, 
+	///which are decompressed before being returned. 
+	bool acceptCompression;
+	///If non-empty, the value to send as the If-None-Match header, so that 
+	///the server may respond with 304 Not Modified if the data is unchanged. 
+	///Only meaningful for GET operations
+	std::string ifNoneMatch;
+	///If set, the body of a successful (2xx) response is passed to this 
+	///function piece by piece as it arrives, instead of being collected in 
+	///Response::body, so that a long or unending response can be consumed 
+	///as it is received. The function may return false to abandon the 
+	///request, in which case an exception is thrown. 
+	///Only meaningful for GET operations
+	std::function<bool(const char* data, std::size_t size)> outputSink;
 };
 	
 ///The result of an HTTP(S) request
@@ -28,6 +45,9 @@ struct Response{
 	unsigned int status;
 	///The data received as the body of the response
 	std::string body;
+	///The value of the ETag header of the response, if any.
+	///Only collected for GET operations
+	std::string etag;
 };
 	
 ///Make an HTTP(S) GET request
@@ -0,0 +1,29 @@
+#ifndef SLATE_JOB_COMMANDS_H
+#define SLATE_JOB_COMMANDS_H
+
+#include <functional>
+
+#include "crow.h"
+#include "Entities.h"
+#include "JobEngine.h"
+#include "PersistentStore.h"
+
+///Handle a request either directly, or, if the client has asked for this with
+///the 'async' query parameter, by running the handler as a background job and
+///immediately replying with 202 Accepted and the job's ID.
+///\param kind a short description of the operation, e.g. 'install'
+///\param findCluster a function which determines the ID of the cluster on 
+///                   which the operation acts, or returns the empty string if 
+///                   it does not act on exactly one. It is only called if the
+///                   request is run as a job.
+///\param handler the function which handles the request. It may be called
+///               after this function has returned, with a copy of the request.
+crow::response runAsJob(PersistentStore& store, JobEngine& jobs, const crow::request& req,
+                        const std::string& kind, const std::function<std::string()>& findCluster,
+                        std::function<crow::response(const crow::request&)> handler);
+
+///Fetch the state of a job, including its result if it has finished
+crow::response getJob(PersistentStore& store, const crow::request& req,
+                      const std::string& jobID);
+
+#endif //SLATE_JOB_COMMANDS_H
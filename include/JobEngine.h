@@ -0,0 +1,143 @@
+#ifndef SLATE_JOB_ENGINE_H
+#define SLATE_JOB_ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "crow.h"
+#include "Entities.h"
+#include "LatencyHistogram.h"
+
+class PersistentStore;
+
+///Runs long operations, such as installing applications or deleting clusters,
+///on background threads, so that the requests which start them can be
+///answered immediately. The state of each operation is recorded in the store
+///as a Job, so that it can be queried through any replica of the service.
+///Jobs wait in a bounded queue and are started in the order they were
+///submitted, except that a job is passed over while its cluster already has
+///the maximum number of jobs running, so that one slow cluster cannot occupy
+///every worker.
+///Jobs are not resumed if the service restarts. Instead, each engine
+///periodically refreshes the records of the jobs it has not yet finished, and
+///marks as failed any unfinished job whose record has gone unrefreshed for
+///several intervals, since the replica responsible for it must have stopped.
+class JobEngine{
+public:
+	struct Limits{
+		///The maximum number of jobs to run at once
+		unsigned int maxConcurrent;
+		///The maximum number of jobs to run at once which act on any single
+		///cluster
+		unsigned int maxPerCluster;
+		///The maximum number of jobs which may wait to be started
+		unsigned int maxQueued;
+	};
+
+	///The work done by a job, which produces the response which would have
+	///been sent had the operation been performed synchronously
+	using Operation=std::function<crow::response()>;
+
+	///\param store the store in which to record jobs. It must outlive this
+	///             object.
+	///\param limits the bounds on the number of jobs running and waiting
+	///\param heartbeatInterval how often to refresh the records of unfinished
+	///                         jobs and check for jobs which other replicas
+	///                         have abandoned
+	JobEngine(PersistentStore& store, Limits limits,
+	          std::chrono::seconds heartbeatInterval=std::chrono::seconds(60));
+
+	///Waits for running jobs to finish, and marks any which have not started
+	///as failed
+	~JobEngine();
+
+	///Queue an operation to be run as a job
+	///\param kind a short description of the operation, e.g. 'install'
+	///\param owner the user on whose behalf the operation is performed
+	///\param cluster the ID of the cluster on which the operation acts, or
+	///               the empty string if it does not act on exactly one
+	///\param operation the work to perform
+	///\return the record of the new job, which will be invalid if the queue
+	///        is full or the job could not be recorded
+	Job submit(const std::string& kind, const User& owner, const std::string& cluster,
+	           Operation operation);
+
+	///Record a description of the step which the job running on the calling
+	///thread has reached. This has no effect if called outside of a job, so
+	///operations need not know whether they are being run as jobs.
+	static void reportProgress(const std::string& progress);
+
+	///\return human-readable statistics on the numbers of jobs run and the
+	///        time they spent waiting and running
+	std::string getStatistics() const;
+
+	///Write the numbers of jobs and their wait and run times in the 
+	///Prometheus text format
+	void writeMetrics(std::ostream& os) const;
+
+private:
+	///A job which has been submitted but not yet started
+	struct Task{
+		Job job;
+		Operation operation;
+		std::chrono::steady_clock::time_point submitted;
+	};
+
+	PersistentStore& store;
+	const Limits limits;
+	const std::chrono::seconds heartbeatInterval;
+
+	///Protects queue, runningByCluster, activeJobs, and stopRequested
+	mutable std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	std::deque<Task> queue;
+	///The number of jobs currently running on each cluster
+	std::map<std::string,unsigned int> runningByCluster;
+	///The IDs of all jobs which are queued or running
+	std::set<std::string> activeJobs;
+	bool stopRequested;
+	std::vector<std::thread> workers;
+	///Used to wake the monitor thread when stopping
+	std::condition_variable monitorCondition;
+	std::thread monitor;
+
+	std::atomic<unsigned long long> jobsSubmitted;
+	std::atomic<unsigned long long> jobsRejected;
+	std::atomic<unsigned long long> jobsSucceeded;
+	std::atomic<unsigned long long> jobsFailed;
+	std::atomic<unsigned int> jobsRunning;
+	///The number of jobs left unfinished by other replicas which this engine
+	///has marked as failed
+	std::atomic<unsigned long long> jobsAbandoned;
+	///The time from jobs being submitted to their being started
+	LatencyHistogram waitTimes;
+	///The time taken to run jobs
+	LatencyHistogram runTimes;
+
+	///Repeatedly take jobs from the queue and run them, until stopped
+	void work();
+	///Run one job and record its outcome
+	void run(Task& task);
+	///Refresh the records of active jobs and fail abandoned ones, until
+	///stopped
+	void monitorJobs();
+	///Mark as failed all unfinished jobs whose records have not been
+	///refreshed for several heartbeat intervals
+	void failAbandonedJobs();
+	///\pre queueMutex is held
+	///\return the first queued task whose cluster is not already running the
+	///        maximum number of jobs, or queue.end() if there is none
+	std::deque<Task>::iterator nextRunnable();
+};
+
+#endif //SLATE_JOB_ENGINE_H
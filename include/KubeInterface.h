@@ -14,6 +14,9 @@ namespace kubernetes{
 	                   const std::string& tillerNamespace,
 	                   const std::vector<std::string>& arguments);
 
+	///Ensure that a group's namespace exists on a cluster. Namespaces known to 
+	///exist are remembered, so that repeated calls for the same group do not
+	///contact the cluster.
 	///\param clusterConfig path to the kubernetes config file corresponding to 
 	///                     the target cluster
 	///\param group the Group whose namespace should be created
@@ -23,6 +26,12 @@ namespace kubernetes{
 	///                     the target cluster
 	///\param group the Group whose namespace should be removed
 	void kubectl_delete_namespace(const std::string& clusterConfig, const Group& group);
+	
+	///Discard all remembered namespaces for a cluster, e.g. because it is being
+	///removed
+	///\param clusterConfig path to the kubernetes config file corresponding to 
+	///                     the target cluster
+	void forgetNamespaces(const std::string& clusterConfig);
 
 	///Collect the types and names of all objects matching a selector
 	///
@@ -0,0 +1,54 @@
+#ifndef SLATE_LATENCY_HISTOGRAM_H
+#define SLATE_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+///A fixed-bucket histogram of operation durations, which can be updated
+///concurrently from any number of threads without locking.
+class LatencyHistogram{
+public:
+	///The number of buckets with finite upper bounds
+	static const std::size_t nBounds=14;
+	///The upper bounds of the buckets, in microseconds. An additional bucket
+	///collects all longer durations.
+	static const std::array<unsigned long long,nBounds> bucketBounds;
+
+	LatencyHistogram();
+
+	///Record one duration
+	template<typename Duration>
+	void record(Duration duration){
+		recordMicroseconds(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+	}
+
+	///Record one duration given in microseconds
+	void recordMicroseconds(long long duration);
+
+	///\return the number of durations recorded
+	unsigned long long count() const{ return total.load(); }
+	///\return the sum of all durations recorded, in microseconds
+	unsigned long long sum() const{ return totalMicroseconds.load(); }
+	///\param bucket the index of the bucket, which may be nBounds for the
+	///              bucket of durations longer than all bounds
+	///\return the number of durations recorded in the bucket
+	unsigned long long bucketCount(std::size_t bucket) const{ return buckets[bucket].load(); }
+
+	///Estimate a quantile of the recorded durations
+	///\param q the quantile, between 0 and 1
+	///\return the upper bound of the bucket containing the quantile, in
+	///        microseconds, or 0 if no durations have been recorded
+	unsigned long long quantile(double q) const;
+
+	///\return a one line, human-readable summary of the recorded durations
+	std::string summary() const;
+
+private:
+	std::array<std::atomic<unsigned long long>,nBounds+1> buckets;
+	std::atomic<unsigned long long> total;
+	std::atomic<unsigned long long> totalMicroseconds;
+};
+
+#endif //SLATE_LATENCY_HISTOGRAM_H
@@ -1,65 +1,99 @@
 #ifndef SLATE_LOGGING_H
 #define SLATE_LOGGING_H
 
+#include <atomic>
 #include <iostream>
-#include <sstream>
 #include <mutex>
+#include <sstream>
+#include <string>
 #include <thread>
 
 #include "Utilities.h"
 #include "ServerUtilities.h"
 
-struct logTarget{
-	std::ostream& stream;
-	std::mutex mutex;
-	
-	void write(const std::string& msg){
-		std::lock_guard<std::mutex> guard(mutex);
-		stream << msg;
-		stream.flush();
+///Log messages are not written by the threads which produce them. Each thread
+///places its formatted messages in its own bounded queue, without locking, and
+///a single background thread collects them and writes them out in batches.
+///If a thread's queue is full, or the background thread is not running,
+///messages are written directly instead, so they are never discarded.
+namespace logging{
+	enum class Level : int{
+		Info=0,
+		Warn=1,
+		Error=2,
+		Fatal=3
+	};
+
+	///The least severe level of messages which will be recorded
+	extern std::atomic<int> minimumLevel;
+
+	///\return whether messages of the given level are currently recorded
+	inline bool enabled(Level level){
+		return static_cast<int>(level)>=minimumLevel.load(std::memory_order_relaxed);
 	}
-};
 
-extern logTarget logStdout;
-extern logTarget logStderr;
+	///Change the least severe level of messages which will be recorded. Fatal
+	///messages are always recorded.
+	void setLevel(Level level);
+
+	///\param name one of 'info', 'warn', or 'error'
+	///\throws std::runtime_error if name is not a recognized level
+	Level parseLevel(const std::string& name);
+
+	///Record a message. Info messages are sent to stdout, and all others to
+	///stderr.
+	///\param level the severity of the message
+	///\param message the text of the message, without a trailing newline
+	void write(Level level, std::string message);
+
+	///Wait until all messages recorded by any thread before this call have been
+	///written out
+	void flush();
+
+	///\return human-readable statistics on the volume of messages written
+	std::string getStatistics();
+}
 
 ///Log an informational message to stdout
 #define log_info(msg) \
 do{ \
-	std::ostringstream str; \
-	str << "INFO: [" << timestamp() << "] (TID " \
-	<< std::this_thread::get_id() << ") " << msg << std::endl; \
-	logStdout.write(str.str()); \
+	if(logging::enabled(logging::Level::Info)){ \
+		std::ostringstream str; \
+		str << msg; \
+		logging::write(logging::Level::Info,str.str()); \
+	} \
 } while(0)
 
 ///Log that an error or problem has occurred to stderr
 #define log_warn(msg) \
 do{ \
-	std::ostringstream str; \
-	str << "WARN: [" << timestamp() << "] (TID " \
-	<< std::this_thread::get_id() << ") " << msg << std::endl; \
-	logStderr.write(str.str()); \
+	if(logging::enabled(logging::Level::Warn)){ \
+		std::ostringstream str; \
+		str << msg; \
+		logging::write(logging::Level::Warn,str.str()); \
+	} \
 } while(0)
 
 ///Log that an error or problem has occurred to stderr
 #define log_error(msg) \
 do{ \
-	std::ostringstream str; \
-	str << "ERROR: [" << timestamp() << "] (TID " \
-	<< std::this_thread::get_id() << ") " << msg << std::endl; \
-	logStderr.write(str.str()); \
+	if(logging::enabled(logging::Level::Error)){ \
+		std::ostringstream str; \
+		str << msg; \
+		logging::write(logging::Level::Error,str.str()); \
+	} \
 } while(0)
 
 ///Log an error to stderr and abort the current activity by throwing an exception
+///The message is written out before the exception is thrown, in case nothing
+///catches it.
 ///\throws std::runtime_error
 #define log_fatal(msg) \
 do{ \
 	std::ostringstream mstr; \
 	mstr << msg; \
-	std::ostringstream str; \
-	str << "FATAL: [" << timestamp() << "] (TID " \
-	<< std::this_thread::get_id() << ") " << mstr.str() << std::endl; \
-	logStderr.write(str.str()); \
+	logging::write(logging::Level::Fatal,mstr.str()); \
+	logging::flush(); \
 	throw std::runtime_error(mstr.str()); \
 } while(0)
 
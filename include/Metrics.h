@@ -0,0 +1,100 @@
+#ifndef SLATE_METRICS_H
+#define SLATE_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libcuckoo/cuckoohash_map.hh>
+
+#include "LatencyHistogram.h"
+
+///Functions for exposing the service's statistics in the Prometheus text
+///exposition format, so that they can be scraped and alerted upon.
+namespace metrics{
+	///A set of label names with their values
+	using Labels=std::vector<std::pair<std::string,std::string>>;
+
+	///Write the HELP and TYPE lines which introduce a metric
+	///\param type the Prometheus metric type, e.g. 'counter' or 'histogram'
+	void writeHeader(std::ostream& os, const std::string& name,
+	                 const std::string& type, const std::string& help);
+
+	///Write a single sample of a counter or gauge
+	void writeSample(std::ostream& os, const std::string& name,
+	                 const Labels& labels, double value);
+
+	///Write the buckets, sum, and count of a histogram, in seconds
+	void writeHistogram(std::ostream& os, const std::string& name,
+	                    const Labels& labels, const LatencyHistogram& histogram);
+
+	///A collection of histograms for one metric, distinguished by the values
+	///of their labels. Each histogram is created the first time its label
+	///values are used and is never removed, so label values must be drawn from
+	///a small set. As a safeguard, once a limited number of histograms exist,
+	///any further combinations of label values share one histogram whose 
+	///labels are all 'other'.
+	class HistogramFamily{
+	public:
+		///\param name the metric name
+		///\param help a description of the metric
+		///\param labelNames the names of the labels, in the order in which
+		///                  their values will be given
+		///\param maxMembers the most histograms to create for distinct label 
+		///                  values, not counting the shared overflow histogram
+		HistogramFamily(std::string name, std::string help,
+		                std::vector<std::string> labelNames,
+		                std::size_t maxMembers=1000);
+
+		///\param labelValues the values for the labels, in the same order as
+		///                   the label names
+		///\return the histogram for the given label values, or the overflow
+		///        histogram if there is none and no more may be created
+		LatencyHistogram& get(const std::vector<std::string>& labelValues);
+
+		///Write all histograms in the family, sorted by their labels
+		void write(std::ostream& os) const;
+
+	private:
+		struct Member{
+			Labels labels;
+			LatencyHistogram histogram;
+		};
+
+		const std::string name;
+		const std::string help;
+		const std::vector<std::string> labelNames;
+		const std::size_t maxMembers;
+		///Members indexed by their concatenated label values
+		mutable cuckoohash_map<std::string,std::shared_ptr<Member>> members;
+		///The number of members counted against maxMembers, including any
+		///which are about to be inserted
+		std::atomic<std::size_t> memberCount;
+		
+		///Find or create the member for a set of label values
+		///\param key the concatenated label values
+		///\param created set to whether the member was newly created
+		std::shared_ptr<Member> insert(const std::string& key, 
+		                               const std::vector<std::string>& labelValues,
+		                               bool& created);
+	};
+
+	///Record the duration of an external command run by the service.
+	///This is suitable for use with setCommandObserver.
+	void recordCommand(const std::string& command, const std::vector<std::string>& args,
+	                   std::chrono::steady_clock::duration duration, int status);
+
+	///Write the latencies recorded for external commands
+	void writeCommandMetrics(std::ostream& os);
+
+	///\return the first argument to a command which is not an option or the
+	///        value of an option, such as the 'get' in 'kubectl -n foo get
+	///        pods', or 'other' if there is no plausible subcommand
+	std::string subcommand(const std::vector<std::string>& args);
+}
+
+#endif //SLATE_METRICS_H
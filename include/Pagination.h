@@ -0,0 +1,117 @@
+#ifndef SLATE_PAGINATION_H
+#define SLATE_PAGINATION_H
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "crow.h"
+
+///The ordering and paging options a client may request for a listing
+struct PageRequest{
+	PageRequest():limit(0),descending(false){}
+
+	///The maximum number of items to return, or zero for no limit
+	std::size_t limit;
+	///The name of the field by which items should be sorted
+	std::string sortBy;
+	///Whether items should be sorted in descending order
+	bool descending;
+	///The continuation token returned with the previous page, if any
+	std::string continueToken;
+
+	///\return whether the client requested any ordering or paging at all. If
+	///        not, listings are returned whole and in no particular order, as
+	///        they always have been.
+	bool active() const{
+		return limit || !sortBy.empty() || descending || !continueToken.empty();
+	}
+};
+
+///Extract the paging options (limit, sort, order, and continue) from a request's
+///query parameters
+///\throws std::runtime_error if any option has an invalid value
+PageRequest parsePageRequest(const crow::query_string& params);
+
+///Construct an opaque token identifying the last item returned in a page
+///\param sortBy the field by which the listing is sorted
+///\param value the value of the sort field for the last item
+///\param id the ID of the last item
+std::string encodeContinueToken(const std::string& sortBy, const std::string& value,
+                                const std::string& id);
+
+///Unpack a token created by encodeContinueToken
+///\return whether the token was well formed
+bool decodeContinueToken(const std::string& token, std::string& sortBy,
+                         std::string& value, std::string& id);
+
+///A function which extracts the value of a sortable field from an item
+template<typename T>
+using SortKey=std::function<const std::string&(const T&)>;
+
+///Order a listing and reduce it to the single page requested by the client.
+///Items are ordered by the requested field, with ties broken by ID, so a
+///continuation token remains meaningful even if items are added or removed
+///between requests. Only the items making up the page are fully sorted.
+///\param items the full listing, which will be replaced by the requested page
+///\param page the client's paging options
+///\param sortKeys the fields by which the listing may be sorted, which must
+///                include "id"
+///\return the continuation token for the next page, or an empty string if
+///        there are no further items
+///\throws std::runtime_error if the requested sort field is not supported or
+///        the continuation token is invalid
+template<typename T>
+std::string paginate(std::vector<T>& items, const PageRequest& page,
+                     const std::map<std::string,SortKey<T>>& sortKeys){
+	if(!page.active())
+		return "";
+	const std::string sortBy=page.sortBy.empty()?"id":page.sortBy;
+	auto keyIt=sortKeys.find(sortBy);
+	if(keyIt==sortKeys.end())
+		throw std::runtime_error("Unsupported sort field: "+sortBy);
+	const SortKey<T>& key=keyIt->second;
+	const bool descending=page.descending;
+
+	//compare (value, id) pairs in the requested direction
+	auto before=[descending](const std::string& v1, const std::string& id1,
+	                         const std::string& v2, const std::string& id2)->bool{
+		int c=v1.compare(v2);
+		if(!c)
+			c=id1.compare(id2);
+		return descending ? c>0 : c<0;
+	};
+	auto less=[&](const T& a, const T& b)->bool{
+		return before(key(a),a.id,key(b),b.id);
+	};
+
+	//skip over everything up to and including the last item previously returned
+	auto start=items.begin();
+	if(!page.continueToken.empty()){
+		std::string tokenSortBy, lastValue, lastID;
+		if(!decodeContinueToken(page.continueToken,tokenSortBy,lastValue,lastID)
+		   || tokenSortBy!=sortBy)
+			throw std::runtime_error("Invalid continuation token");
+		start=std::partition(items.begin(),items.end(),[&](const T& item)->bool{
+			return !before(lastValue,lastID,key(item),item.id);
+		});
+	}
+
+	std::size_t remaining=items.end()-start;
+	std::size_t count=(page.limit && page.limit<remaining) ? page.limit : remaining;
+	std::partial_sort(start,start+count,items.end(),less);
+
+	std::string token;
+	if(count<remaining){
+		const T& last=*(start+count-1);
+		token=encodeContinueToken(sortBy,key(last),last.id);
+	}
+	items.erase(start+count,items.end());
+	items.erase(items.begin(),start);
+	return token;
+}
+
+#endif //SLATE_PAGINATION_H
@@ -0,0 +1,137 @@
+#ifndef SLATE_PERMISSION_INDEX_H
+#define SLATE_PERMISSION_INDEX_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+///An in-memory index of all group access and application use permissions on
+///all clusters.
+///The index is meant to be loaded in bulk and then kept up to date by applying
+///each change as it is written to the database, so that permission checks can
+///be answered without any database traffic or allocations. Permission checks
+///are only meaningful while the index is valid(); once it expires (or if it has
+///never been loaded) the caller is responsible for reloading it.
+class PermissionIndex{
+public:
+	using steady_clock=std::chrono::steady_clock;
+
+	///The permissions of one group with respect to one cluster
+	struct GroupEntry{
+		///Whether the group has been explicitly granted access to the cluster
+		bool accessGranted;
+		///Whether an application use record exists for this group. When there
+		///is no record, all applications are allowed.
+		bool hasApplicationRecord;
+		///Whether the group may use all applications
+		bool allApplications;
+		///The names of the applications the group may use, sorted
+		std::vector<std::string> applications;
+
+		GroupEntry():accessGranted(false),hasApplicationRecord(false),allApplications(false){}
+	};
+
+	///All permissions associated with one cluster
+	struct ClusterEntry{
+		///Whether the cluster grants access to all groups
+		bool allowsAllGroups;
+		///Permission records of individual groups, indexed by group ID
+		std::unordered_map<std::string,GroupEntry> groups;
+
+		ClusterEntry():allowsAllGroups(false){}
+	};
+
+	///The full contents of the index, indexed by cluster ID
+	using Contents=std::unordered_map<std::string,ClusterEntry>;
+
+	PermissionIndex();
+
+	///\return whether the index currently contains a complete and unexpired
+	///        picture of all permissions
+	bool valid() const;
+
+	///Get a value which changes every time the index is modified. This should
+	///be sampled before starting a bulk load, and passed to replace() once the
+	///load is complete, so that a load which raced with an incremental update
+	///is discarded rather than overwriting the newer information.
+	unsigned long generation() const;
+
+	///Replace the entire contents of the index.
+	///\param contents the new data for the index
+	///\param expiration the time until which the new data should be considered
+	///                  valid
+	///\param expectedGeneration the value of generation() sampled before
+	///                          \p contents was collected
+	///\return whether the contents were installed, which will not be the case
+	///        if the index was modified after \p expectedGeneration was sampled
+	bool replace(Contents&& contents, steady_clock::time_point expiration,
+	             unsigned long expectedGeneration);
+
+	///Mark the index as invalid, so that it will be reloaded before it is next
+	///used.
+	void invalidate();
+
+	///Record a change in whether a group has access to a cluster
+	///\param cID the ID of the cluster
+	///\param groupID the ID of the group, or the wildcard to set whether the
+	///               cluster allows access to all groups
+	///\param wildcard the pseudo-ID used for universal access
+	///\param allowed whether access is now granted
+	void setGroupAccess(const std::string& cID, const std::string& groupID,
+	                    const std::string& wildcard, bool allowed);
+
+	///Record the set of applications which a group may use on a cluster
+	///\param cID the ID of the cluster
+	///\param groupID the ID of the group
+	///\param allApplications whether the group may use any application
+	///\param applications the names of the applications the group may use;
+	///                    ignored if \p allApplications is true
+	void setGroupApplications(const std::string& cID, const std::string& groupID,
+	                          bool allApplications, std::vector<std::string> applications);
+
+	///Drop all records associated with a cluster
+	///\param cID the ID of the cluster
+	void removeCluster(const std::string& cID);
+
+	///\pre valid() should be true
+	///\return whether the cluster grants access to all groups
+	bool clusterAllowsAllGroups(const std::string& cID) const;
+
+	///\pre valid() should be true
+	///\return whether the group may use the cluster, either because it has been
+	///        granted access specifically or because the cluster grants
+	///        universal access
+	bool groupAllowedOnCluster(const std::string& cID, const std::string& groupID) const;
+
+	///\pre valid() should be true
+	///\return whether the group may use the named application on the cluster
+	bool groupMayUseApplication(const std::string& cID, const std::string& groupID,
+	                            const std::string& appName) const;
+
+	///\pre valid() should be true
+	///\param allApplications will be set to whether the group may use all
+	///                       applications on the cluster
+	///\return the names of the specific applications the group may use, which
+	///        will be empty if \p allApplications is set
+	std::vector<std::string> applicationsForGroup(const std::string& cID,
+	                                              const std::string& groupID,
+	                                              bool& allApplications) const;
+
+	///\return the number of group/cluster pairs for which records are held
+	std::size_t size() const;
+
+private:
+	mutable std::mutex mut;
+	Contents data;
+	steady_clock::time_point expirationTime;
+	unsigned long currentGeneration;
+
+	///\pre mut must be held by the caller
+	///\return the entry for the given group on the given cluster, or nullptr if
+	///        there is none
+	const GroupEntry* findGroup(const std::string& cID, const std::string& groupID) const;
+};
+
+#endif //SLATE_PERMISSION_INDEX_H
@@ -2,22 +2,33 @@
 #define SLATE_PERSISTENT_STORE_H
 
 #include <atomic>
+#include <condition_variable>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 
 #include <aws/core/Aws.h>
 #include <aws/core/auth/AWSCredentialsProvider.h>
 #include <aws/dynamodb/DynamoDBClient.h>
+#include <aws/dynamodb/model/GetItemRequest.h>
+#include <aws/dynamodb/model/QueryRequest.h>
+#include <aws/dynamodb/model/WriteRequest.h>
 #include <aws/route53/Route53Client.h>
 
 #include <libcuckoo/cuckoohash_map.hh>
 
+#include <CacheManager.h>
+#include <ChangeFeed.h>
 #include <concurrent_multimap.h>
+#include <DatabaseClient.h>
 #include <DNSManipulator.h>
 #include <Entities.h>
 #include <FileHandle.h>
 #include <Geocoder.h>
+#include <PermissionIndex.h>
 
 //In libstdc++ versions < 5 std::atomic seems to be broken for non-integral types
 //In that case, we must use our own, minimal replacement
@@ -43,31 +54,31 @@ struct CacheRecord{
 	using value_type=RecordType;
 	
 	///default construct a record which is considered expired/invalid
-	CacheRecord():expirationTime(steady_clock::time_point::min()){}
+	CacheRecord():expirationTime(steady_clock::time_point::min()),referenced(true){}
 	
 	///construct a record which is considered expired but contains data
 	///\param record the cached data
 	CacheRecord(const value_type& record):
-	record(record),expirationTime(steady_clock::time_point::min()){}
+	record(record),expirationTime(steady_clock::time_point::min()),referenced(true){}
 	
 	///\param record the cached data
 	///\param exprTime the time after which the record expires
 	CacheRecord(const value_type& record, steady_clock::time_point exprTime):
-	record(record),expirationTime(exprTime){}
+	record(record),expirationTime(exprTime),referenced(true){}
 	
 	///\param validity duration until the record expires
 	template <typename DurationType>
 	CacheRecord(const value_type& record, DurationType validity):
-	record(record),expirationTime(steady_clock::now()+validity){}
+	record(record),expirationTime(steady_clock::now()+validity),referenced(true){}
 	
 	///\param exprTime the time after which the record expires
 	CacheRecord(value_type&& record, steady_clock::time_point exprTime):
-	record(std::move(record)),expirationTime(exprTime){}
+	record(std::move(record)),expirationTime(exprTime),referenced(true){}
 	
 	///\param validity duration until the record expires
 	template <typename DurationType>
 	CacheRecord(value_type&& record, DurationType validity):
-	record(std::move(record)),expirationTime(steady_clock::now()+validity){}
+	record(std::move(record)),expirationTime(steady_clock::now()+validity),referenced(true){}
 	
 	///\return whether the record's expiration time has passed and it should 
 	///        be discarded
@@ -86,6 +97,9 @@ struct CacheRecord{
 	value_type record;
 	///The time at which the cached data should be discarded
 	steady_clock::time_point expirationTime;
+	///Whether the record has been read from a cache since CacheManager last 
+	///considered it for eviction
+	mutable bool referenced;
 };
 
 ///Two cache records are equivalent if their contained data is equal, regardless
@@ -115,6 +129,8 @@ struct hash<std::set<T>>{
 };
 }
 
+class ClusterProber;
+
 class PersistentStore{
 public:
 	///\param credentials the AWS credentials used for authenitcation with the 
@@ -128,17 +144,32 @@ public:
 	///                            send monitoring data
 	///\param appLoggingServerPort port to which application instances should 
 	///                            send monitoring data
+	///\param changeFeedEndpoint the DynamoDB Streams endpoint from which to 
+	///                          follow changes made to the database by other 
+	///                          server instances, or empty to not follow them. 
+	///                          Cached records are kept for longer when changes
+	///                          are followed. 
 	PersistentStore(const Aws::Auth::AWSCredentials& credentials, 
 	                const Aws::Client::ClientConfiguration& clientConfig,
 	                std::string bootstrapUserFile,
 	                std::string encryptionKeyFile,
 	                std::string appLoggingServerName,
-	                unsigned int appLoggingServerPort);
+	                unsigned int appLoggingServerPort,
+	                std::string changeFeedEndpoint="");
+	
+	~PersistentStore();
 	
 	///Store a record for a new user
 	///\return Whether the user record was successfully added to the database
 	bool addUser(const User& user);
 	
+	///Store records for a number of new users, using as few database requests 
+	///as possible
+	///\param users the new users, which must all have distinct IDs
+	///\return Whether all of the user records were successfully added to the 
+	///        database
+	bool addUsers(const std::vector<User>& users);
+	
 	///Find information about the user with a given ID
 	///\param id the users ID
 	///\return the corresponding user or an invalid user object if the id is not known
@@ -181,6 +212,14 @@ public:
 	///\return wther the addition operation succeeded
 	bool addUserToGroup(const std::string& uID, std::string groupID);
 	
+	///Mark a number of users as members of groups, using as few database 
+	///requests as possible
+	///\param memberships pairs of user IDs and the IDs (not names) of the 
+	///                   groups to which they should be added. There should be 
+	///                   no duplicate pairs. 
+	///\return whether all of the additions succeeded
+	bool addUsersToGroups(const std::vector<std::pair<std::string,std::string>>& memberships);
+	
 	///Remove a user from a group
 	///\param uID the ID of the user to remove
 	///\param groupID the ID of the group from which to remove the user
@@ -476,7 +515,45 @@ public:
 	///\param cluster the ID or name of the cluster on which the secret is stored
 	///\param name the name of the secret
 	Secret findSecretByName(std::string group, std::string cluster, std::string name);
-	
+
+	//----
+
+	///Store a record for a new job
+	///\return Whether the record was successfully stored
+	bool addJob(const Job& job);
+
+	///Replace the record of a job with an updated version
+	///\return Whether the record was successfully stored
+	bool updateJob(const Job& job);
+
+	///Find information about the job with a given ID. Job records are never
+	///cached, since they change frequently and may be updated by any replica.
+	///\param id the job's ID
+	///\return the corresponding job or an invalid job object if the ID is
+	///        not known, or if its record has expired
+	Job getJob(const std::string& id);
+
+	///Record that a job which has not finished is still waiting or running,
+	///so that it is not taken to have been abandoned
+	///\param id the job's ID
+	///\return Whether the record was updated; false if the job has finished
+	///        or its record could not be updated
+	bool touchJob(const std::string& id);
+
+	///Find jobs which have not finished, but whose records have not been
+	///updated recently, presumably because the replica responsible for them
+	///stopped
+	///\param age how long a job's record must have gone without being updated
+	///\return the jobs found, which will be empty if the query failed
+	std::vector<Job> listStaleJobs(std::chrono::seconds age);
+
+	///Replace the record of a job found by listStaleJobs, provided that it 
+	///still has not finished or been updated recently
+	///\param job the updated version of the job
+	///\param age how long the job's record must have gone without being updated
+	///\return Whether the record was replaced
+	bool updateStaleJob(const Job& job, std::chrono::seconds age);
+
 	//----
 
 	///Look up one application, returning a cached result if possible.
@@ -500,12 +577,87 @@ public:
 	
 	//----
 	
+	//Asynchronous lookups, for handlers which need several independent records.
+	//Cached records are returned as ready futures; otherwise the request is 
+	//sent immediately by a thread from the database client's executor, and the
+	//result is decoded (and cached) in whichever thread waits for it. Results 
+	//are the same as for the synchronous versions. 
+	//Lookups start as soon as these are called, so callers should not request 
+	//records the user may not be allowed to see until authorization has been 
+	//checked. 
+	
+	///Find information about the user with a given ID
+	std::future<User> getUserAsync(const std::string& id);
+	
+	///Find all groups to which a user belongs
+	///\return the IDs of the groups, which will be empty if the user belongs to 
+	///        none or the database query failed
+	std::future<std::vector<std::string>> getUserGroupMembershipsAsync(const std::string& uID);
+	
+	///Find a group by ID or name. Lookups by name which are not cached are 
+	///performed on a separate thread, started with std::async, so destroying 
+	///the future without getting its value waits for the lookup to finish. 
+	std::future<Group> getGroupAsync(const std::string& idOrName);
+	
+	///Find a cluster by ID or name. Lookups by name which are not cached are 
+	///performed on a separate thread, started with std::async, so destroying 
+	///the future without getting its value waits for the lookup to finish. 
+	std::future<Cluster> getClusterAsync(const std::string& idOrName);
+	
+	///Find information about the application instance with a given ID
+	std::future<ApplicationInstance> getApplicationInstanceAsync(const std::string& id);
+	
+	///Find the configuration of the application instance with a given ID
+	std::future<std::string> getApplicationInstanceConfigAsync(const std::string& id);
+	
+	//----
+	
 	const std::string& getAppLoggingServerName() const{ return appLoggingServerName; }
 	const unsigned int getAppLoggingServerPort() const{ return appLoggingServerPort; }
 	
 	///Return human-readable performance statistics
 	std::string getStatistics() const;
 	
+	///Write performance statistics for database operations and caches in the 
+	///Prometheus text format
+	void writeMetrics(std::ostream& os) const;
+	
+	///Save the contents of the caches of users, group memberships, groups, 
+	///clusters, application instances, and the application catalog to a file,
+	///so that a later server instance can begin with them. Secrets are not 
+	///saved, and since user records contain access tokens and cluster records
+	///contain credentials, the file is encrypted with the same key as secrets.
+	///\param path the file to write, which is only replaced once the new 
+	///            snapshot is complete
+	///\return whether the snapshot was written
+	bool saveCacheSnapshot(const std::string& path);
+	
+	///Place the records from a file written by saveCacheSnapshot into the 
+	///caches. Records remain valid no longer than they would have in the 
+	///server which saved them, and no longer than snapshotRecordValidity, 
+	///since changes made while no server was following the database are not
+	///reflected in them. A missing or unreadable snapshot is not an error. 
+	///\param path the file to read
+	///\return the number of records loaded
+	std::size_t loadCacheSnapshot(const std::string& path);
+	
+	///Load a cache snapshot, if one exists, and then in the background refresh 
+	///the loaded records from the database and save a new snapshot 
+	///periodically. A final snapshot is saved when this object is destroyed. 
+	///\param path the snapshot file
+	///\param interval the time between saves
+	void startCacheSnapshots(const std::string& path, std::chrono::seconds interval);
+	
+	///Change the limits on the size of one of the internal caches
+	///\param cacheName the name of the cache, which is the same as the name of 
+	///                 the corresponding member variable, e.g. 'userCache'
+	///\param maxEntries the maximum number of entries, or zero for no limit
+	///\param maxBytes the maximum estimated memory use, or zero for no limit
+	///\return whether a cache with the given name exists
+	bool setCacheBudget(const std::string& cacheName, std::size_t maxEntries, std::size_t maxBytes){
+		return cacheManager.setBudget(cacheName,{maxEntries,maxBytes});
+	}
+	
 	///The pseudo-ID associated with wildcard permissions.
 	const static std::string wildcard;
 	///The pseudo-name associated with wildcard permissions.
@@ -538,9 +690,19 @@ public:
 	const Geocoder& getGeocoder(){ return geocoder; }
 	void setGeocoder(Geocoder&& g){ geocoder=std::move(g); }
 	
+	///\return the object which monitors cluster reachability in the 
+	///        background, or null if there is none
+	ClusterProber* getClusterProber(){ return clusterProber; }
+	///Cached reachability records are kept valid for at least twice the 
+	///longest time the prober may wait between probes of a cluster, so that
+	///they do not expire before being refreshed.
+	///\param p the object which monitors cluster reachability, which must 
+	///         remain valid until this function is called again
+	void setClusterProber(ClusterProber* p);
+	
 private:
 	///Database interface object
-	Aws::DynamoDB::DynamoDBClient dbClient;
+	DatabaseClient dbClient;
 	///Name of the users table in the database
 	const std::string userTableName;
 	///Name of the groups table in the database
@@ -549,9 +711,13 @@ private:
 	const std::string clusterTableName;
 	///Name of the application instances table in the database
 	const std::string instanceTableName;
+	///Name of the application instance configuration table in the database
+	const std::string instanceConfigTableName;
 	///Name of the secrets instances table in the database
 	const std::string secretTableName;
-	
+	///Name of the background jobs table in the database
+	const std::string jobTableName;
+
 	///Sub-object for handling DNS
 	DNSManipulator dnsClient;
 	///The DNS domain under which clusters subdomains will be placed
@@ -559,6 +725,8 @@ private:
 	
 	///Sub-object for handling geocoding lookups
 	Geocoder geocoder;
+	///Background monitor of cluster reachability, if any
+	ClusterProber* clusterProber;
 	
 	///Path to the temporary directory where cluster config files are written 
 	///in order for kubectl and helm to read
@@ -567,46 +735,116 @@ private:
 	///duration for which cached user records should remain valid
 	const std::chrono::seconds userCacheValidity;
 	slate_atomic<std::chrono::steady_clock::time_point> userCacheExpirationTime;
-	cuckoohash_map<std::string,CacheRecord<User>> userCache;
-	cuckoohash_map<std::string,CacheRecord<User>> userByTokenCache;
-	cuckoohash_map<std::string,CacheRecord<User>> userByGlobusIDCache;
+	cache_map<std::string,CacheRecord<User>> userCache;
+	cache_map<std::string,CacheRecord<User>> userByTokenCache;
+	cache_map<std::string,CacheRecord<User>> userByGlobusIDCache;
 	concurrent_multimap<std::string,CacheRecord<std::string>> userByGroupCache;
+	///The complete set of IDs of groups to which each user belongs, so that 
+	///both membership and non-membership can be answered from memory
+	cache_map<std::string,CacheRecord<std::set<std::string>>> userGroupMembershipCache;
+	///Incremented by every membership change, so that a load of a membership 
+	///set which raced with a change can be detected and not cached
+	std::atomic<unsigned long> membershipGeneration;
 	///duration for which cached group records should remain valid
 	const std::chrono::seconds groupCacheValidity;
 	slate_atomic<std::chrono::steady_clock::time_point> groupCacheExpirationTime;
-	cuckoohash_map<std::string,CacheRecord<Group>> groupCache;
-	cuckoohash_map<std::string,CacheRecord<Group>> groupByNameCache;
+	cache_map<std::string,CacheRecord<Group>> groupCache;
+	cache_map<std::string,CacheRecord<Group>> groupByNameCache;
 	concurrent_multimap<std::string,CacheRecord<Group>> groupByUserCache;
 	///duration for which cached cluster records should remain valid
 	const std::chrono::seconds clusterCacheValidity;
 	slate_atomic<std::chrono::steady_clock::time_point> clusterCacheExpirationTime;
-	cuckoohash_map<std::string,CacheRecord<Cluster>> clusterCache;
-	cuckoohash_map<std::string,CacheRecord<Cluster>> clusterByNameCache;
+	cache_map<std::string,CacheRecord<Cluster>> clusterCache;
+	cache_map<std::string,CacheRecord<Cluster>> clusterByNameCache;
 	concurrent_multimap<std::string,CacheRecord<Cluster>> clusterByGroupCache;
-	cuckoohash_map<std::string,SharedFileHandle> clusterConfigs;
+	///A cluster's config as written to the filesystem, with a copy of its 
+	///contents so that it is only rewritten when it changes
+	struct ClusterConfigFile{
+		std::string config;
+		SharedFileHandle file;
+	};
+	cuckoohash_map<std::string,ClusterConfigFile> clusterConfigs;
 	concurrent_multimap<std::string,CacheRecord<std::string>> clusterGroupAccessCache;
-	cuckoohash_map<std::string,CacheRecord<std::set<std::string>>> clusterGroupApplicationCache;
-	cuckoohash_map<std::string,CacheRecord<std::vector<GeoLocation>>> clusterLocationCache;
+	cache_map<std::string,CacheRecord<std::set<std::string>>> clusterGroupApplicationCache;
+	cache_map<std::string,CacheRecord<std::vector<GeoLocation>>> clusterLocationCache;
+	///Bulk-loaded index of all group access and application use permissions, 
+	///which is consulted before the per-record caches above
+	PermissionIndex permissionIndex;
+	///Serializes reloading of permissionIndex so that only one scan is in 
+	///flight at a time
+	std::mutex permissionIndexLoadMutex;
 	///This cache is a little tricky since it represents state of the network, 
 	///not something stored in the database, so it's data isn't directly handled
 	///by the persistent store. 
-	cuckoohash_map<std::string,CacheRecord<bool>> clusterConnectivityCache;
+	cache_map<std::string,CacheRecord<bool>> clusterConnectivityCache;
+	///duration for which cached cluster reachability should remain valid
+	slate_atomic<std::chrono::seconds> clusterConnectivityCacheValidity;
 	///duration for which cached instance records should remain valid
 	const std::chrono::seconds instanceCacheValidity;
 	slate_atomic<std::chrono::steady_clock::time_point> instanceCacheExpirationTime;
-	cuckoohash_map<std::string,CacheRecord<ApplicationInstance>> instanceCache;
-	cuckoohash_map<std::string,CacheRecord<std::string>> instanceConfigCache;
+	cache_map<std::string,CacheRecord<ApplicationInstance>> instanceCache;
+	///Instance configs, in their tagged and possibly compressed storage form
+	cache_map<std::string,CacheRecord<std::string>> instanceConfigCache;
 	concurrent_multimap<std::string,CacheRecord<ApplicationInstance>> instanceByGroupCache;
 	concurrent_multimap<std::string,CacheRecord<ApplicationInstance>> instanceByNameCache;
 	concurrent_multimap<std::string,CacheRecord<ApplicationInstance>> instanceByClusterCache;
 	concurrent_multimap<std::string,CacheRecord<ApplicationInstance>> instanceByGroupAndClusterCache;
 	///duration for which cached secret records should remain valid
 	const std::chrono::seconds secretCacheValidity;
-	cuckoohash_map<std::string,CacheRecord<Secret>> secretCache;
+	cache_map<std::string,CacheRecord<Secret>> secretCache;
 	concurrent_multimap<std::string,CacheRecord<Secret>> secretByGroupCache;
 	concurrent_multimap<std::string,CacheRecord<Secret>> secretByGroupAndClusterCache;
 	///This cache also contains data not directly managed by the persistent store
 	concurrent_multimap<std::string,CacheRecord<Application>> applicationCache;
+	///duration for which cached application records should remain valid
+	const std::chrono::seconds applicationCacheValidity;
+	///Enforces size budgets on, and removes expired records from, all of the 
+	///caches above. Declared after them so that it is destroyed, stopping its
+	///background thread, first. 
+	CacheManager cacheManager;
+	///Register all caches with cacheManager
+	void manageCaches();
+	
+	///The file to which cache snapshots are saved, if enabled
+	std::string snapshotPath;
+	///The time between saves of cache snapshots
+	std::chrono::seconds snapshotInterval;
+	///duration for which records loaded from a cache snapshot may be used
+	///before they must be fetched again
+	const std::chrono::seconds snapshotRecordValidity;
+	///Refreshes records loaded from a snapshot, then saves snapshots 
+	///periodically
+	std::thread snapshotThread;
+	std::mutex snapshotMutex;
+	std::condition_variable snapshotCondition;
+	///Set to request that snapshotThread stop
+	bool stopSnapshots;
+	///Body of snapshotThread
+	void runCacheSnapshots();
+	
+	///Follows changes made to the database by other server instances, if 
+	///enabled. Declared after the caches so that it is destroyed first, 
+	///although it is also explicitly stopped before anything else is torn 
+	///down. 
+	std::unique_ptr<ChangeFeed> changeFeed;
+	///Ensure that a table has a stream recording changes to its items
+	///\return the ARN of the table's stream
+	std::string enableTableStream(const std::string& tableName);
+	///Begin following changes to all tables whose data is cached
+	///\param clientConfig specification of the DynamoDB Streams endpoint
+	void startChangeFeed(const Aws::Auth::AWSCredentials& credentials,
+	                     const Aws::Client::ClientConfiguration& clientConfig);
+	///Bring the caches up to date with a change made to the database, 
+	///possibly by another server instance
+	void applyChange(const ChangeFeed::Change& change);
+	void applyUserChange(const ChangeFeed::Change& change);
+	void applyGroupChange(const ChangeFeed::Change& change);
+	void applyClusterChange(const ChangeFeed::Change& change);
+	void applyInstanceChange(const ChangeFeed::Change& change);
+	void applySecretChange(const ChangeFeed::Change& change);
+	///Discard all cached data derived from a table, after changes to it may 
+	///have been missed
+	void discardCachedTable(const std::string& tableName);
 	
 	///Check that all necessary tables exist in the database, and create them if 
 	///they do not
@@ -617,12 +855,39 @@ private:
 	void InitializeClusterTable();
 	void InitializeInstanceTable();
 	void InitializeSecretTable();
+	void InitializeInstanceConfigTable();
+	void InitializeJobTable();
+	///Add job records written before the by-activity index existed to it
+	void migrateActiveJobs();
+
+	///Move instance configurations stored in the instance table by older 
+	///versions (as items with sortKey '<ID>:config') to the instance 
+	///configuration table. Configurations are read from either location until
+	///this is complete, so it can run while requests are being served. 
+	void migrateInstanceConfigs();
+	///Runs migrateInstanceConfigs in the background
+	std::thread instanceConfigMigrationThread;
+	///Set to request that migrateInstanceConfigs stop early
+	std::atomic<bool> stopMigration;
+	
+	///Perform a set of writes (puts and/or deletes) to a table with 
+	///BatchWriteItem, in groups of as many items as DynamoDB allows per 
+	///request. Items which DynamoDB leaves unprocessed due to throttling are 
+	///retried with exponential backoff. 
+	///\param tableName the table to modify
+	///\param requests the writes to perform, which must all affect different 
+	///                items
+	///\return whether all writes were completed
+	bool batchWrite(const std::string& tableName, 
+	                const std::vector<Aws::DynamoDB::Model::WriteRequest>& requests);
 	
 	void loadEncyptionKey(const std::string& fileName);
 	
 	///For consumption by kubectl we store configs in the filesystem
 	///These files have implicit validity derived from the corresponding entries
 	///in clusterCache.
+	///If the existing file for the cluster already has the same contents, it is
+	///kept rather than being written again.
 	void writeClusterConfigToDisk(const Cluster& cluster);
 	
 	///Ensure that a string is a group ID, rather than a group name. 
@@ -639,6 +904,66 @@ private:
 	///        could not be because it was neither a valid cluster ID nor name. 
 	bool normalizeClusterID(std::string& cID);
 	
+	///Make sure that the permission index is loaded and unexpired, reloading it
+	///from the database if necessary. 
+	///\return whether the index can be used to answer permission queries
+	bool ensurePermissionIndex();
+	
+	///Get the complete set of groups to which a user belongs, from the cache 
+	///if possible, or otherwise with a single query of the database. 
+	///\param uID the ID of the user
+	///\param groups the set into which the group IDs will be placed
+	///\return whether the set could be determined
+	bool getUserGroupMembershipSet(const std::string& uID, std::set<std::string>& groups);
+	
+	///Construct the query for all of a user's group membership records
+	Aws::DynamoDB::Model::QueryRequest membershipQuery(const std::string& uID) const;
+	
+	///Gather the results of a group membership query, fetching any further 
+	///pages, and cache them if no membership has changed since the query began. 
+	///\param uID the ID of the user
+	///\param request the query which was made
+	///\param outcome the result of the first page of the query
+	///\param generation the value of membershipGeneration when the query began
+	///\param groups the set into which the group IDs will be placed
+	///\return whether the set could be determined
+	bool collectGroupMemberships(const std::string& uID, 
+	                             Aws::DynamoDB::Model::QueryRequest request, 
+	                             Aws::DynamoDB::Model::QueryOutcome outcome, 
+	                             unsigned long generation, 
+	                             std::set<std::string>& groups);
+	
+	///Find a group by ID, asynchronously
+	std::future<Group> findGroupByIDAsync(const std::string& id);
+	///Find a cluster by ID, asynchronously
+	std::future<Cluster> findClusterByIDAsync(const std::string& cID);
+	
+	//Decode the result of fetching a single record, and cache it
+	User userFromOutcome(const std::string& id, const Aws::DynamoDB::Model::GetItemOutcome& outcome);
+	Group groupFromOutcome(const std::string& id, const Aws::DynamoDB::Model::GetItemOutcome& outcome);
+	Cluster clusterFromOutcome(const std::string& cID, const Aws::DynamoDB::Model::GetItemOutcome& outcome);
+	ApplicationInstance instanceFromOutcome(const std::string& id, const Aws::DynamoDB::Model::GetItemOutcome& outcome);
+	std::string instanceConfigFromOutcome(const std::string& id, Aws::DynamoDB::Model::GetItemOutcome outcome);
+	
+	///Construct the request for an application instance's configuration
+	Aws::DynamoDB::Model::GetItemRequest instanceConfigRequest(const std::string& id) const;
+	
+	///Look up an unexpired record in a cache
+	///\param cache the cache to search
+	///\param key the key for which to search
+	///\param value the location in which to place the record, if found
+	///\return whether a valid record was found
+	template<typename Cache, typename T>
+	bool findCached(Cache& cache, const std::string& key, T& value){
+		CacheRecord<T> record;
+		if(cache.find(key,record) && record){
+			cacheHits++;
+			value=std::move(record.record);
+			return true;
+		}
+		return false;
+	}
+	
 	///The encryption key used for secrets
 	SecretData secretKey;
 	
@@ -648,6 +973,8 @@ private:
 	unsigned int appLoggingServerPort;
 	
 	std::atomic<size_t> cacheHits, databaseQueries, databaseScans;
+	std::atomic<size_t> configWrites, configWritesAvoided;
+	std::atomic<size_t> snapshotsSaved, snapshotRecordsLoaded;
 };
 
 ///\param store the database in which to look up the user
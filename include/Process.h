@@ -3,8 +3,12 @@
 
 #include <atomic>
 #include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <istream>
 #include <map>
+#include <mutex>
 #include <ostream>
 #include <streambuf>
 #include <vector>
@@ -132,6 +136,9 @@ public:
 	bool done() const;
 	///Only valid if the child process has not been detached and done() is true
 	char exitStatus() const;
+	///Block until the child process has exited, after which done() is true.
+	///Only valid if the child process has not been detached
+	void wait();
 private:
 	pid_t child;
 	ProcessIOBuffer inoutBuf, errBuf;
@@ -139,6 +146,9 @@ private:
 	std::istream out, err;
 	unsigned char exitStatusValue;
 	std::atomic<bool> hasExitStatus;
+	///Used to wake threads in wait() when the exit status is set
+	std::mutex exitMutex;
+	std::condition_variable exitCondition;
 	
 	///Terminate the child process if it is still running
 	void shutDown();
@@ -219,4 +229,19 @@ commandResult runCommandWithInput(const std::string& command,
                                   const std::vector<std::string>& args={}, 
                                   const std::map<std::string,std::string>& env={});
 
+///A function to be informed of each command completed by runCommand or 
+///runCommandWithInput
+///\param command the command which was run
+///\param args the arguments passed to the command
+///\param duration the time from starting the command to collecting its output
+///\param status the command's exit status
+using CommandObserver=std::function<void(const std::string& command, 
+                                         const std::vector<std::string>& args,
+                                         std::chrono::steady_clock::duration duration,
+                                         int status)>;
+
+///Set the function to be informed of completed commands. This should be done
+///before any commands are run concurrently. 
+void setCommandObserver(CommandObserver observer);
+
 #endif //SLATE_PROCESS_H
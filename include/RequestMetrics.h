@@ -0,0 +1,37 @@
+#ifndef SLATE_REQUEST_METRICS_H
+#define SLATE_REQUEST_METRICS_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+#include "crow.h"
+#include "Metrics.h"
+
+///Crow middleware which records the time taken to handle each request, by
+///method, route, and class of response status.
+struct RequestMetrics{
+	struct context{
+		std::chrono::steady_clock::time_point start;
+	};
+
+	RequestMetrics();
+
+	void before_handle(crow::request& req, crow::response& res, context& ctx);
+	void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+	///Write the recorded request latencies in the Prometheus text format
+	void writeMetrics(std::ostream& os) const;
+
+private:
+	metrics::HistogramFamily latencies;
+};
+
+///Reduce a request path to the form of the route which handles it, replacing
+///the IDs and names of objects with placeholders, e.g. 
+///'/v1alpha3/users/User_1234/groups' becomes '/v1alpha3/users/<string>/groups'.
+///Paths which do not have the form of any API route become 'other', so that
+///the number of distinct results is bounded.
+std::string routeTemplate(const std::string& path);
+
+#endif //SLATE_REQUEST_METRICS_H
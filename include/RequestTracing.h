@@ -0,0 +1,69 @@
+#ifndef SLATE_REQUEST_TRACING_H
+#define SLATE_REQUEST_TRACING_H
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "crow.h"
+#include "Tracing.h"
+
+///Crow middleware which traces requests whose clients ask for this, with
+///either the X-Slate-Trace header or the 'trace' query parameter, and which
+///are permitted by the authorizer. The time spent on each kind of work is
+///returned in the Server-Timing header of the response, and the trace's ID in
+///the X-Slate-Trace-ID header. If an export directory is set, the full trace
+///is also written there as a Chrome trace file named after its ID, once 
+///nothing, including any background job started by the request, is still 
+///recording into it.
+struct RequestTracer{
+	///Decides whether a request may be traced
+	using Authorizer=std::function<bool(const crow::request&)>;
+
+	struct context{
+		std::shared_ptr<tracing::Trace> trace;
+		std::unique_ptr<tracing::Scope> scope;
+	};
+
+	RequestTracer(){}
+
+	void before_handle(crow::request& req, crow::response& res, context& ctx);
+	void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+	///Traces reveal the internal workings of the service, so no request is
+	///traced until an authorizer has been set.
+	///\param authorizer the function deciding which requests may be traced
+	void setAuthorizer(Authorizer authorizer){ this->authorizer=std::move(authorizer); }
+
+	///\param path the directory in which to write trace files, or the
+	///            empty string to not write them
+	///\param maxFiles the most trace files to keep in the directory; once
+	///                there are this many the oldest is deleted each time
+	///                another is written
+	void setExportDirectory(const std::string& path, std::size_t maxFiles);
+
+private:
+	///Writes traces to files. This is shared with the traces themselves, 
+	///since a trace carried into a background job may outlive the tracer. 
+	struct Exporter{
+		std::string directory;
+		std::size_t maxFiles;
+		///Protects files
+		std::mutex mutex;
+		///The paths of the trace files in the directory, oldest first
+		std::deque<std::string> files;
+
+		///Write a trace to the directory, deleting the oldest trace file if
+		///there are too many
+		void write(const tracing::Trace& trace);
+	};
+
+	Authorizer authorizer;
+	///The destination for complete traces, if any
+	std::shared_ptr<Exporter> exporter;
+};
+
+#endif //SLATE_REQUEST_TRACING_H
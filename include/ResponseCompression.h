@@ -0,0 +1,43 @@
+#ifndef SLATE_RESPONSE_COMPRESSION_H
+#define SLATE_RESPONSE_COMPRESSION_H
+
+#include <atomic>
+#include <string>
+
+#include "crow.h"
+
+///Crow middleware which transparently gzip compresses response bodies for
+///clients which advertise support for it via the Accept-Encoding header.
+///Small responses are sent as-is, since for them the compression overhead
+///outweighs the savings.
+struct ResponseCompressor{
+	///Responses with bodies smaller than this many bytes are not compressed
+	static const std::size_t minimumSize=1024;
+	///The zlib compression level used. Level 6 gets most of the size reduction
+	///available from level 9 at a fraction of the CPU cost.
+	static const int compressionLevel=6;
+
+	struct context{
+		///Whether the client indicated that it will accept gzipped data
+		bool acceptsGzip;
+	};
+
+	ResponseCompressor():compressedResponses(0),originalBytes(0),compressedBytes(0){}
+
+	void before_handle(crow::request& req, crow::response& res, context& ctx);
+	void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+	///Return human-readable statistics about compression performed so far
+	std::string getStatistics() const;
+
+private:
+	std::atomic<unsigned long long> compressedResponses;
+	std::atomic<unsigned long long> originalBytes;
+	std::atomic<unsigned long long> compressedBytes;
+};
+
+///Determine whether the value of an Accept-Encoding header permits gzip
+///encoding, either by name or by wildcard, without a zero quality value
+bool acceptsGzipEncoding(const std::string& acceptEncoding);
+
+#endif //SLATE_RESPONSE_COMPRESSION_H
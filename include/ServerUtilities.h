@@ -89,5 +89,54 @@ std::string to_string(const JSONDocument& json){
 	return buf.GetString();
 }
 
+///Give a response a strong ETag computed from its body, and replace it with
+///304 Not Modified if the request's If-None-Match header shows that the client 
+///already has the same data. 
+///\param req the request being answered
+///\param res the complete, successful response to the request
+///\return the response which should be sent
+crow::response conditionalResponse(const crow::request& req, crow::response res);
+
+///The suffix added to the ETag of a response when its body is compressed, 
+///since the compressed representation is not byte-for-byte identical
+extern const std::string compressedETagSuffix;
+
+///A rapidjson output stream which appends directly to an existing string
+struct StringAppendStream{
+	using Ch=char;
+
+	explicit StringAppendStream(std::string& target):target(target){}
+	void Put(Ch c){ target.push_back(c); }
+	void Flush(){}
+
+	std::string& target;
+};
+
+///Serializes JSON directly into the body of an HTTP response.
+///This avoids building a rapidjson::Document, which copies every string into
+///its allocator, and then copying the serialized data again on its way from a
+///StringBuffer into the response.
+class JSONResponseWriter{
+public:
+	///\param expectedSize an estimate of the size of the serialized data, used
+	///                    to reserve space in the response body up front
+	explicit JSONResponseWriter(std::size_t expectedSize=0):
+	stream(res.body),writer(stream){
+		res.body.reserve(expectedSize);
+	}
+
+	///\return the writer which should be used to emit the JSON data
+	rapidjson::Writer<StringAppendStream>& json(){ return writer; }
+
+	///Obtain the completed response. No further data may be written after
+	///this is called.
+	crow::response response(){ return std::move(res); }
+
+private:
+	crow::response res;
+	StringAppendStream stream;
+	rapidjson::Writer<StringAppendStream> writer;
+};
+
 
 #endif //SLATE_SERVER_UTILITIES_H
@@ -0,0 +1,107 @@
+#ifndef SLATE_TRACING_H
+#define SLATE_TRACING_H
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+///Lightweight tracing of where the time taken to handle a request goes.
+///A Trace is made current on the thread handling a request, and the code it
+///calls records Spans into it, such as DynamoDB operations and external
+///commands. When no trace is current, recording a span costs only a check of
+///a thread-local pointer.
+namespace tracing{
+	using clock=std::chrono::steady_clock;
+
+	///One timed piece of work within a trace
+	struct SpanRecord{
+		///The kind of work, e.g. 'dynamodb' or 'command'
+		std::string category;
+		///A description of the work, e.g. 'GetItem' or 'helm install'
+		std::string name;
+		clock::time_point start;
+		clock::duration duration;
+		///A small number identifying the thread which did the work
+		unsigned int thread;
+	};
+
+	///The spans recorded while handling one request
+	class Trace{
+	public:
+		///\param id an identifier for the trace, which should be unique
+		explicit Trace(std::string id);
+
+		const std::string& id() const{ return traceID; }
+		///\return the time at which the trace was created
+		clock::time_point start() const{ return startTime; }
+
+		///Add a completed span. This may be called from any thread.
+		void record(std::string category, std::string name,
+		            clock::time_point start, clock::duration duration);
+
+		///\return a copy of all spans recorded so far, in the order in
+		///        which they were completed
+		std::vector<SpanRecord> spans() const;
+
+	private:
+		const std::string traceID;
+		const clock::time_point startTime;
+		mutable std::mutex mutex;
+		std::vector<SpanRecord> recorded;
+	};
+
+	///\return the trace which is current on this thread, if any
+	std::shared_ptr<Trace> current();
+
+	///Makes a trace current on the calling thread for the lifetime of this
+	///object. This is used to start tracing a request, and to carry a trace
+	///to another thread which does work on the request's behalf.
+	class Scope{
+	public:
+		///\param trace the trace to make current, which may be null to stop
+		///             tracing for the duration of the scope
+		explicit Scope(std::shared_ptr<Trace> trace);
+		///Restores the trace which was previously current
+		~Scope();
+		Scope(const Scope&)=delete;
+		Scope& operator=(const Scope&)=delete;
+	private:
+		std::shared_ptr<Trace> previous;
+	};
+
+	///Records the lifetime of this object as a span of the trace which was
+	///current when it was created, if any
+	class Span{
+	public:
+		Span(const char* category, std::string name);
+		~Span();
+		Span(const Span&)=delete;
+		Span& operator=(const Span&)=delete;
+	private:
+		std::shared_ptr<Trace> trace;
+		const char* category;
+		std::string name;
+		clock::time_point start;
+	};
+
+	///Record a span which has already completed, ending now, in the trace
+	///which is current on this thread, if any
+	///\param duration how long the work took
+	void recordCompleted(const char* category, std::string name, clock::duration duration);
+
+	///\return a new, random trace ID
+	std::string generateTraceID();
+
+	///Summarize a trace as the value of a Server-Timing header, with the total
+	///time spent on each distinct kind of work
+	///\param total the overall duration of the request
+	std::string serverTiming(const Trace& trace, clock::duration total);
+
+	///Render a trace in the Chrome trace event format, which can be loaded
+	///into chrome://tracing or Perfetto
+	std::string chromeTrace(const Trace& trace);
+}
+
+#endif //SLATE_TRACING_H
@@ -19,6 +19,8 @@ crow::response addUserToGroup(PersistentStore& store, const crow::request& req,
 crow::response removeUserFromGroup(PersistentStore& store, const crow::request& req, 
                                 const std::string uID, const std::string& groupID);
 crow::response findUser(PersistentStore& store, const crow::request& req);
+///Create any users not already registered and add users to groups, in bulk
+crow::response importUsers(PersistentStore& store, const crow::request& req);
 crow::response replaceUserToken(PersistentStore& store, const crow::request& req,
                                 const std::string uID);
 
@@ -41,4 +41,9 @@ std::string removeShellEscapeSequences(std::string s);
 ///Get the filesystem path for the main executable
 std::string program_location();
 
+///Compute a fast, non-cryptographic (64 bit FNV-1a) hash of some data, which 
+///is stable across runs and platforms
+///\return the hash rendered as 16 hexadecimal digits
+std::string contentHash(const std::string& data);
+
 #endif
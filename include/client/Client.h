@@ -188,8 +188,10 @@ struct InstanceLogOptions : public InstanceOptions{
 	unsigned long maxLines;
 	std::string container;
 	bool previousLogs;
+	///Whether to keep showing new log output as it is written
+	bool follow;
 	
-	InstanceLogOptions():maxLines(20),previousLogs(false){}
+	InstanceLogOptions():maxLines(20),previousLogs(false),follow(false){}
 };
 
 struct InstanceScaleOptions : public InstanceOptions{
@@ -395,6 +397,15 @@ private:
 	}
 	
 	httpRequests::Options defaultOptions() const;
+	///Perform a GET request, using a copy of the response stored under 
+	///~/.slate/cache if the server reports that the data has not changed. 
+	///Only responses which the server marks with an ETag are stored. 
+	httpRequests::Response cachedGet(const std::string& url);
+	///If the server has accepted a request to be run in the background (with 
+	///status 202), wait for the resulting job to finish, showing its progress.
+	///\return the response which the operation produced, or \p response 
+	///        itself if the operation was performed immediately
+	httpRequests::Response awaitJob(httpRequests::Response response);
 	rapidjson::Document getClusterList(std::string group);
 	
 #ifdef USE_CURLOPT_CAINFO
@@ -448,6 +459,9 @@ private:
 	  ///\param value a fraction in [0,1]
 	  void SetProgress(float value);
 	  void ShowSomeProgress();
+	  ///Display a description of the current step of the operation in 
+	  ///progress
+	  void ShowProgressMessage(std::string message);
 	  void StopShowingProgress();
 	};
 	
@@ -492,6 +506,18 @@ private:
 	std::string formatOutput(const rapidjson::Value& jdata, const rapidjson::Value& original,
 				 const std::vector<columnSpec>& columns) const;
 	
+	///Fetch a listing from the API server and print it. If a page size has 
+	///been set, the listing is requested one page at a time, and when the 
+	///output format allows, each page is printed as soon as it arrives. 
+	///\param url the URL of the listing, including any query parameters
+	///\param columns the columns to print
+	///\param errMsg the message to print if fetching the listing fails
+	///\param prepare an optional function to apply to each page before it is 
+	///                printed
+	void printListing(std::string url, const std::vector<columnSpec>& columns,
+	                  const std::string& errMsg,
+	                  std::function<void(rapidjson::Document&)> prepare=nullptr);
+	
 	///return true if the argument mtaches the correct format for an instance ID
 	static bool verifyInstanceID(const std::string& id);
 	///return true if the argument mtaches the correct format for a secret ID
@@ -508,6 +534,9 @@ private:
 	std::size_t outputWidth;
 	std::string outputFormat;
 	std::string orderBy = "";
+	///The number of items to request per page for listings, or zero to fetch
+	///each listing in a single request
+	std::size_t pageSize = 0;
 #ifdef USE_CURLOPT_CAINFO
 	mutable std::string caBundlePath;
 #endif
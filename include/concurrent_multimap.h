@@ -1,19 +1,27 @@
 #ifndef SLATE_CONCURRENT_MULTIMAP_H
 #define SLATE_CONCURRENT_MULTIMAP_H
 
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <unordered_set>
+#include <utility>
 
 #include <libcuckoo/cuckoohash_map.hh>
 
 ///Implements a multimap by storing items within unordered sets indexed by the 
 ///keys. This requires not only the keys but the values as well to be hasable 
 ///and equality comparable. 
+///Each set is shared, immutably, with any readers which have looked it up, so
+///lookups copy only a pointer. A modification copies the set and replaces 
+///it, leaving any copy held by a reader unchanged. 
 ///Suports concurrent access to the extent that operations on different buckets
 ///in the underlying cuckoohash_map can proceed concurrently, however, operations
 ///involving different values with the same key are guaranteed to map to the same
 ///bucket and thus will block each other waiting for its lock. 
-///Does not currently have allocation or iteration support.
+///Does not currently have allocation support, and iteration is only possible 
+///by locking the whole table.
 template<typename Key, typename Value, 
          typename KeyHash=std::hash<Key>, typename KeyEqual=std::equal_to<Key>, 
          typename ValueHash=std::hash<Value>, typename ValueEqual=std::equal_to<Value>>
@@ -22,8 +30,36 @@ public:
 	using steady_clock=std::chrono::steady_clock;
 	///The collection of values to which a key maps
 	using set_type=std::unordered_set<Value,ValueHash,ValueEqual>;
-	///The set of values the key maps to with its associated expiration time
-	using category_type=std::pair<set_type,steady_clock::time_point>;
+	///The set of values the key maps to with its associated expiration time.
+	///Lookups also mark the category as referenced, which CacheManager uses
+	///to choose categories to evict. 
+	struct category_type{
+		///Construct an empty category
+		category_type():
+		values(emptySet()),expiration(),referenced(true){}
+		category_type(set_type values, steady_clock::time_point expiration):
+		values(std::make_shared<set_type>(std::move(values))),
+		expiration(expiration),referenced(true){}
+		
+		///\return the values in the category
+		const set_type& items() const{ return *values; }
+		
+		///The values in the category. These must not be modified while they 
+		///may be shared. 
+		std::shared_ptr<const set_type> values;
+		///The time until which the set of values is known to be complete
+		steady_clock::time_point expiration;
+		///Whether the category has been read since it was last examined
+		mutable bool referenced;
+	private:
+		///A shared empty set, so that constructing an empty category, as is 
+		///done for every lookup, does not allocate. Since this is always 
+		///shared, it is never modified. 
+		static const std::shared_ptr<set_type>& emptySet(){
+			static const std::shared_ptr<set_type> empty=std::make_shared<set_type>();
+			return empty;
+		}
+	};
 	///The underlying hash table type
 	using Table=cuckoohash_map<Key,category_type,KeyHash,KeyEqual>;
 	using key_type=Key;
@@ -52,6 +88,18 @@ public:
 		return *this;
 	}
 	
+	///Get a version of a category's values which may be modified. 
+	///Must only be called while holding the lock on the category's bucket. 
+	///The values are always copied, and the category updated to refer to the
+	///copy, since a reader may still hold the existing values, and the 
+	///reference count alone cannot safely show that it has finished with them.
+	static set_type& mutableItems(category_type& cat){
+		auto copy=std::make_shared<set_type>(*cat.values);
+		set_type& items=*copy;
+		cat.values=std::move(copy);
+		return items;
+	}
+	
 	//concurrency-safe access and manipulation functions
 	
 	///Removes all elements in the table, calling their destructors.
@@ -81,7 +129,7 @@ public:
 	size_type erase(const K& k){
 		size_type erased=0;
 		data.erase_fn(k,[&erased](const category_type& cat){
-			erased=cat.first.size();
+			erased=cat.items().size();
 			return true;
 		});
 		return erased;
@@ -94,14 +142,16 @@ public:
 	size_type erase(const K& k, const mapped_type& v){
 		size_type erased=0;
 		data.erase_fn(k,[&erased,&v](category_type& cat){
-			erased=cat.first.erase(v);
-			return cat.first.empty(); //only erase whole category if empty
+			if(!cat.items().count(v))
+				return false;
+			erased=mutableItems(cat).erase(v);
+			return cat.items().empty(); //only erase whole category if empty
 		});
 		return erased;
 	}
 	
 	///Searches the table for \p k and returns the associated value it
-	///finds. @c mapped_type must be @c CopyConstructible.
+	///finds. This does not copy the values. 
 	///\tparam K type of the key
 	///\param k the key for which to search
 	///\return the collection of values associated with the key, or any empty 
@@ -109,7 +159,13 @@ public:
 	template <typename K>
 	category_type find(const K& key) const{
 		category_type items;
-		data.find_fn(key,[&items](const category_type& cat){ items=cat;	});
+		bool found=data.find_fn(key,[&items](const category_type& cat){
+			cat.referenced=true;
+			items=cat;
+		});
+		lookupCount.fetch_add(1,std::memory_order_relaxed);
+		if(found && items.expiration>=steady_clock::now())
+			hitCount.fetch_add(1,std::memory_order_relaxed);
 		return items;
 	}
 	
@@ -129,12 +185,13 @@ public:
 		//may be unneeded.
 		data.upsert(std::forward<K>(key), 
 					[&](category_type& cat){
-						if(cat.first.count(val)){
+						set_type& items=mutableItems(cat);
+						if(items.count(val)){
 							inserted=false;
 							//ensure replacement
-							cat.first.erase(val);
+							items.erase(val);
 						}
-						cat.first.emplace(val);
+						items.emplace(val);
 			    },category_type({val}, steady_clock::now()));
 		return inserted;
 	}
@@ -149,7 +206,10 @@ public:
 		//may be unneeded.
 		data.upsert(std::forward<K>(key), 
 					[&](category_type& cat){
-						inserted=cat.first.emplace(val).second;
+						if(cat.items().count(val))
+							inserted=false;
+						else
+							mutableItems(cat).emplace(val);
 			    },category_type({mapped_type{val}}, steady_clock::now()));
 		return inserted;
 	}
@@ -166,11 +226,12 @@ public:
 	bool update(K&& key, V&& val){
 		bool updated=false;
 		data.update_fn(key,[&](category_type& cat){
-			if(cat.first.count(val)){
+			if(cat.items().count(val)){
 				updated=true;
 				//ensure replacement
-				cat.first.erase(val);
-				cat.first.emplace(val);
+				set_type& items=mutableItems(cat);
+				items.erase(val);
+				items.emplace(val);
 			}
 		});
 		return updated;
@@ -185,7 +246,7 @@ public:
 	bool update_expiration(K&& key, steady_clock::time_point time){
 		bool updated=false;
 		data.update_fn(key,[&](category_type& cat){
-		    cat.second = time;
+		    cat.expiration = time;
 		    updated=true;
 		});
 		return updated;
@@ -209,7 +270,10 @@ public:
 	template <typename K, typename V>
 	bool contains(const K& key, V&& val) const{
 		bool found=false;
-		data.find_fn(key,[&](const category_type& cat){ found=cat.first.count(val); });
+		data.find_fn(key,[&](const category_type& cat){
+			cat.referenced=true;
+			found=cat.items().count(val);
+		});
 		return found;
 	}
 	
@@ -221,7 +285,7 @@ public:
 	template <typename K>
 	size_type count(const K& k) const{
 		size_type n=0;
-		data.find_fn(k,[&n](const category_type& cat){ n=cat.first.size(); });
+		data.find_fn(k,[&n](const category_type& cat){ n=cat.items().size(); });
 		return n;
 	}
 	
@@ -234,7 +298,7 @@ public:
 	template <typename K, typename V>
 	size_type count(const K& k, V&& v) const{
 		size_type n=0;
-		data.find_fn(k,[&](const category_type& cat){ n=cat.first.count(v); });
+		data.find_fn(k,[&](const category_type& cat){ n=cat.items().count(v); });
 		return n;
 	}
 	
@@ -248,15 +312,32 @@ public:
 	bool find(const K& key, V&& val) const{
 		bool found=false;
 		data.find_fn(key,[&](const category_type& cat){
-			found=cat.first.count(val);
+			cat.referenced=true;
+			found=cat.items().count(val);
 			if(found)
-				val=*cat.first.find(val);
+				val=*cat.items().find(val);
 		});
 		return found;
 	}
 
+	///\return the number of keys in the table
+	size_type size() const{ return data.size(); }
+	
+	///\return the number of categories looked up
+	unsigned long long lookups() const{ return lookupCount.load(std::memory_order_relaxed); }
+	///\return the number of category lookups which found a category known to 
+	///        be complete
+	unsigned long long hits() const{ return hitCount.load(std::memory_order_relaxed); }
+	
+	///Lock the entire table, for iteration or bulk modification. No other 
+	///operation can proceed until the returned object is destroyed or 
+	///unlocked. 
+	typename Table::locked_table lock_table(){ return data.lock_table(); }
+
 private:
 	Table data;
+	mutable std::atomic<unsigned long long> lookupCount{0};
+	mutable std::atomic<unsigned long long> hitCount{0};
 };
 
 #endif //SLATE_CONCURRENT_MULTIMAP_H
@@ -5,6 +5,10 @@
 #include <boost/array.hpp>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "crow/http_parser_merged.h"
@@ -388,6 +392,17 @@ namespace crow
             static std::string seperator = ": ";
             static std::string crlf = "\r\n";
 
+            const bool streaming = bool(res.body_producer);
+            if (streaming)
+            {
+                // the end of a body of unknown length may have to be marked by
+                // closing the connection, and in any case the connection is
+                // not worth keeping once the producer is done
+                close_connection_ = true;
+                add_keep_alive_ = false;
+                stream_chunked_ = parser_.check_version(1, 1);
+            }
+
             buffers_.clear();
             buffers_.reserve(4*(res.headers.size()+5)+3);
 
@@ -403,7 +418,7 @@ namespace crow
                 buffers_.emplace_back(status.data(), status.size());
             }
 
-            if (res.code >= 400 && res.body.empty())
+            if (res.code >= 400 && res.body.empty() && !streaming)
                 res.body = statusCodes[res.code].substr(9);
 
             for(auto& kv : res.headers)
@@ -415,7 +430,15 @@ namespace crow
 
             }
 
-            if (!res.headers.count("content-length"))
+            if (streaming)
+            {
+                static std::string chunked_tag = "Transfer-Encoding: chunked\r\n";
+                static std::string close_tag = "Connection: close\r\n";
+                if (stream_chunked_)
+                    buffers_.emplace_back(chunked_tag.data(), chunked_tag.size());
+                buffers_.emplace_back(close_tag.data(), close_tag.size());
+            }
+            else if (!res.headers.count("content-length"))
             {
                 content_length_ = std::to_string(res.body.size());
                 static std::string content_length_tag = "Content-Length: ";
@@ -446,6 +469,14 @@ namespace crow
             }
 
             buffers_.emplace_back(crlf.data(), crlf.size());
+
+            if (streaming)
+            {
+                need_to_start_read_after_complete_ = false;
+                begin_stream();
+                return;
+            }
+
             res_body_copy_.swap(res.body);
             buffers_.emplace_back(res_body_copy_.data(), res_body_copy_.size());
 
@@ -534,10 +565,162 @@ namespace crow
                 });
         }
 
+        // Sends the headers assembled in buffers_, and then runs the
+        // response's body producer on a separate thread, passing what it
+        // produces to the io_service's thread to be written. The connection is
+        // closed when the producer has finished and everything it produced has
+        // been written, or as soon as the client goes away.
+        void begin_stream()
+        {
+            is_streaming = true;
+            stream_finished_ = false;
+            stream_broken_ = false;
+            stream_pump_scheduled_ = false;
+            stream_queue_.clear();
+            for (auto& buffer : buffers_)
+                stream_queue_.append(asio::buffer_cast<const char*>(buffer), asio::buffer_size(buffer));
+            buffers_.clear();
+            auto producer = std::move(res.body_producer);
+            res.body_producer = nullptr;
+
+            // the read which delivered this request may still be completing,
+            // so watch for the client disconnecting only once it has finished
+            adaptor_.get_io_service().post([this]{ watch_for_disconnect(); });
+            stream_pump();
+
+            stream_thread_ = std::thread([this, producer]{
+                try
+                {
+                    producer([this](const std::string& data){ return stream_send(data); });
+                }
+                catch (std::exception& e)
+                {
+                    CROW_LOG_ERROR << "Exception while streaming response: " << e.what();
+                }
+                catch (...)
+                {
+                    CROW_LOG_ERROR << "Unknown exception while streaming response";
+                }
+                std::lock_guard<std::mutex> lock(stream_mutex_);
+                if (stream_chunked_ && !stream_broken_)
+                    stream_queue_ += "0\r\n\r\n";
+                stream_finished_ = true;
+                schedule_stream_pump();
+            });
+        }
+
+        // Called from the producer's thread. Blocks while too much data is
+        // waiting to be written, so that a slow client slows the producer
+        // rather than consuming memory.
+        bool stream_send(const std::string& data)
+        {
+            std::unique_lock<std::mutex> lock(stream_mutex_);
+            stream_cv_.wait(lock, [this]{ return stream_broken_ || stream_queue_.size() < stream_buffer_limit; });
+            if (stream_broken_)
+                return false;
+            if (data.empty())
+                return true;
+            if (stream_chunked_)
+            {
+                char size[20];
+                std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+                stream_queue_ += size;
+            }
+            stream_queue_ += data;
+            if (stream_chunked_)
+                stream_queue_ += "\r\n";
+            schedule_stream_pump();
+            return true;
+        }
+
+        // Must be called with stream_mutex_ held
+        void schedule_stream_pump()
+        {
+            if (stream_pump_scheduled_)
+                return;
+            stream_pump_scheduled_ = true;
+            adaptor_.get_io_service().post([this]{ stream_pump(); });
+        }
+
+        // Runs on the io_service's thread. Writes everything queued so far in
+        // one operation, or ends the stream if there is nothing more to write.
+        void stream_pump()
+        {
+            std::unique_lock<std::mutex> lock(stream_mutex_);
+            stream_pump_scheduled_ = false;
+            if (is_writing)
+                return; // the write in progress will pump again when it completes
+            if (!stream_broken_ && !stream_queue_.empty())
+            {
+                stream_writing_.clear();
+                stream_writing_.swap(stream_queue_);
+                lock.unlock();
+                stream_cv_.notify_all();
+                is_writing = true;
+                asio::async_write(adaptor_.socket(), asio::buffer(stream_writing_),
+                    [this](const boost::system::error_code& ec, std::size_t /*bytes_transferred*/)
+                    {
+                        is_writing = false;
+                        if (ec)
+                        {
+                            std::lock_guard<std::mutex> lock(stream_mutex_);
+                            stream_broken_ = true;
+                            stream_cv_.notify_all();
+                        }
+                        stream_pump();
+                    });
+                return;
+            }
+            if (stream_finished_)
+            {
+                lock.unlock();
+                end_stream();
+            }
+        }
+
+        void end_stream()
+        {
+            // the producer has returned, so this does not wait long
+            if (stream_thread_.joinable())
+                stream_thread_.join();
+            is_streaming = false;
+            stream_writing_.clear();
+            res.clear();
+            adaptor_.close();
+            CROW_LOG_DEBUG << this << " from end_stream";
+            check_destroy();
+        }
+
+        // Nothing more is expected from the client while a response is being
+        // streamed to it, but a read must be kept pending to notice it going
+        // away, since otherwise that would only be noticed by a failed write
+        // and a producer which is waiting for input might never write.
+        void watch_for_disconnect()
+        {
+            is_reading = true;
+            adaptor_.socket().async_read_some(asio::buffer(buffer_),
+                [this](const boost::system::error_code& ec, std::size_t /*bytes_transferred*/)
+                {
+                    if (!ec && is_streaming)
+                    {
+                        watch_for_disconnect();
+                        return;
+                    }
+                    is_reading = false;
+                    {
+                        std::lock_guard<std::mutex> lock(stream_mutex_);
+                        stream_broken_ = true;
+                    }
+                    stream_cv_.notify_all();
+                    CROW_LOG_DEBUG << this << " from watch_for_disconnect";
+                    check_destroy();
+                });
+        }
+
         void check_destroy()
         {
-            CROW_LOG_DEBUG << this << " is_reading " << is_reading << " is_writing " << is_writing;
-            if (!is_reading && !is_writing)
+            CROW_LOG_DEBUG << this << " is_reading " << is_reading << " is_writing " << is_writing << " is_streaming " << is_streaming;
+            if (!is_reading && !is_writing && !is_streaming)
             {
                 CROW_LOG_DEBUG << this << " delete (idle) ";
                 delete this;
@@ -584,11 +767,27 @@ namespace crow
         std::string date_str_;
         std::string res_body_copy_;
 
+        // The most data which may wait to be written before a body producer
+        // is made to wait
+        static constexpr std::size_t stream_buffer_limit = 1 << 20;
+        // Protects stream_queue_, stream_finished_, stream_broken_, and
+        // stream_pump_scheduled_, which are shared with the producer's thread
+        std::mutex stream_mutex_;
+        std::condition_variable stream_cv_;
+        std::string stream_queue_;
+        std::string stream_writing_;
+        std::thread stream_thread_;
+        bool stream_chunked_{};
+        bool stream_finished_{};
+        bool stream_broken_{};
+        bool stream_pump_scheduled_{};
+
         //boost::asio::deadline_timer deadline_;
         detail::dumb_timer_queue::key timer_cancel_key_;
 
         bool is_reading{};
         bool is_writing{};
+        bool is_streaming{};
         bool need_to_call_after_handlers_{};
         bool need_to_start_read_after_complete_{};
         bool add_keep_alive_{};
@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <unordered_map>
 
@@ -22,6 +23,18 @@ namespace crow
         // `headers' stores HTTP headers.
         ci_map headers;
 
+        // Writes one piece of a streamed body. Returns false once the client
+        // has gone away. An empty string sends nothing, but still reports
+        // whether the client is connected.
+        using body_writer = std::function<bool(const std::string&)>;
+
+        // If set, the body is not taken from `body' but produced incrementally
+        // by this function, which is run on its own thread once the headers
+        // have been sent. The body is sent with chunked transfer encoding (or
+        // delimited by closing the connection, for HTTP/1.0 clients), and the
+        // connection is closed when the function returns.
+        std::function<void(body_writer)> body_producer;
+
         void set_header(std::string key, std::string value)
         {
             headers.erase(key);
@@ -68,6 +81,7 @@ namespace crow
             json_value = std::move(r.json_value);
             code = r.code;
             headers = std::move(r.headers);
+            body_producer = std::move(r.body_producer);
             completed_ = r.completed_;
             return *this;
         }
@@ -83,6 +97,7 @@ namespace crow
             json_value.clear();
             code = 200;
             headers.clear();
+            body_producer = nullptr;
             completed_ = false;
         }
 
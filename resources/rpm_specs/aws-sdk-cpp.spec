@@ -42,6 +42,20 @@ Requires: aws-sdk-cpp-core-libs
 %description dynamodb-libs
 %{summary}.
 
+%package dynamodbstreams-devel
+Summary: headers for AWS C++ SDK for DynamoDB Streams
+Group: Development/Libraries
+Requires: aws-sdk-cpp-core-devel
+%description dynamodbstreams-devel
+%{summary}.
+
+%package dynamodbstreams-libs
+Summary: AWS C++ SDK runtime libraries for DynamoDB Streams
+Group: System Environment/Libraries
+Requires: aws-sdk-cpp-core-libs
+%description dynamodbstreams-libs
+%{summary}.
+
 %package route53-devel
 Summary: headers for AWS C++ SDK for Route53
 Group: Development/Libraries
@@ -63,7 +77,7 @@ Requires: aws-sdk-cpp-core-libs
 cd %{name}-%{version}
 mkdir build
 cd build
-cmake3 .. -DBUILD_ONLY="dynamodb;route53" -DBUILD_SHARED_LIBS=Off
+cmake3 .. -DBUILD_ONLY="dynamodb;dynamodbstreams;route53" -DBUILD_SHARED_LIBS=Off
 make
 
 %install
@@ -443,6 +457,17 @@ rm -rf $RPM_BUILD_ROOT
 %{_libdir}/cmake/aws-cpp-sdk-dynamodb/aws-cpp-sdk-dynamodb-targets.cmake
 %{_libdir}/libaws-cpp-sdk-dynamodb.a
 
+%files dynamodbstreams-devel
+%{_includedir}/aws/dynamodbstreams/*.h
+%{_includedir}/aws/dynamodbstreams/model/*.h
+
+%files dynamodbstreams-libs
+%{_libdir}/cmake/aws-cpp-sdk-dynamodbstreams/aws-cpp-sdk-dynamodbstreams-config-version.cmake
+%{_libdir}/cmake/aws-cpp-sdk-dynamodbstreams/aws-cpp-sdk-dynamodbstreams-config.cmake
+%{_libdir}/cmake/aws-cpp-sdk-dynamodbstreams/aws-cpp-sdk-dynamodbstreams-targets-noconfig.cmake
+%{_libdir}/cmake/aws-cpp-sdk-dynamodbstreams/aws-cpp-sdk-dynamodbstreams-targets.cmake
+%{_libdir}/libaws-cpp-sdk-dynamodbstreams.a
+
 %files route53-devel
 %{_includedir}/aws/route53/Route53Client.h
 %{_includedir}/aws/route53/Route53Endpoint.h
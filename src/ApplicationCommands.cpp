@@ -11,6 +11,7 @@
 #include "yaml-cpp/node/detail/impl.h"
 #include <yaml-cpp/node/parse.h>
 
+#include "JobEngine.h"
 #include "KubeInterface.h"
 #include "Logging.h"
 #include "Archive.h"
@@ -99,7 +100,7 @@ crow::response listApplications(PersistentStore& store, const crow::request& req
 
 	high_resolution_clock::time_point t2 = high_resolution_clock::now();
 	log_info("application listing completed in " << duration_cast<duration<double>>(t2-t1).count() << " seconds");
-	return crow::response(to_string(result));
+	return conditionalResponse(req,crow::response(to_string(result)));
 }
 
 crow::response fetchApplicationConfig(PersistentStore& store, const crow::request& req, const std::string& appName){
@@ -225,6 +226,11 @@ crow::response installApplicationImpl(PersistentStore& store, const User& user,
 	if(!body["cluster"].IsString())
 		return crow::response(400,generateError("Incorrect type for cluster"));
 	const std::string clusterID=body["cluster"].GetString();
+	//start looking up the Group and cluster, which can proceed while the 
+	//configuration is examined. The cluster record includes its credentials, 
+	//so it must not be used until the user's membership has been checked. 
+	auto groupLookup=store.getGroupAsync(groupID);
+	auto clusterLookup=store.getClusterAsync(clusterID);
 	
 	if(!body.HasMember("configuration"))
 		return crow::response(400,generateError("Missing configuration"));
@@ -286,15 +292,15 @@ crow::response installApplicationImpl(PersistentStore& store, const User& user,
 		return crow::response(400,generateError("Instance tags names may not end with a dash"));
 	
 	//validate input
-	const Group group=store.getGroup(groupID);
+	const Group group=groupLookup.get();
 	if(!group)
 		return crow::response(400,generateError("Invalid Group"));
-	const Cluster cluster=store.getCluster(clusterID);
-	if(!cluster)
-		return crow::response(400,generateError("Invalid Cluster"));
 	//A user must belong to a Group to install applications on its behalf
 	if(!store.userInGroup(user.id,group.id))
 		return crow::response(403,generateError("Not authorized"));
+	const Cluster cluster=clusterLookup.get();
+	if(!cluster)
+		return crow::response(400,generateError("Invalid Cluster"));
 	//The Group must own or be allowed to access to the cluster to install
 	//applications to it. If the Group is not the cluster owner it must also have 
 	//permission to install the specific application. 
@@ -359,6 +365,7 @@ crow::response installApplicationImpl(PersistentStore& store, const User& user,
 
 	auto clusterConfig=store.configPathForCluster(cluster.id);
 	
+	JobEngine::reportProgress("Creating namespace "+group.namespaceName());
 	try{
 		kubernetes::kubectl_create_namespace(*clusterConfig, group);
 	}
@@ -382,6 +389,7 @@ crow::response installApplicationImpl(PersistentStore& store, const User& user,
 		installArgs.push_back("--tiller-namespace");
 		installArgs.push_back(cluster.systemNamespace);
 	}
+	JobEngine::reportProgress("Installing "+instance.name+" with helm");
 	auto commandResult=runCommand("helm",installArgs,{{"KUBECONFIG",*clusterConfig}});
 	
 	//if application instantiation fails, remove record from DB again
@@ -11,12 +11,20 @@
 #include "yaml-cpp/node/detail/impl.h"
 #include <yaml-cpp/node/parse.h>
 
+#include "JobEngine.h"
 #include "KubeInterface.h"
 #include "Logging.h"
+#include "Pagination.h"
 #include "ServerUtilities.h"
 #include "ApplicationCommands.h"
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 crow::response listApplicationInstances(PersistentStore& store, const crow::request& req){
 	using namespace std::chrono;
@@ -45,35 +53,66 @@ crow::response listApplicationInstances(PersistentStore& store, const crow::requ
 	} else
 		instances=store.listApplicationInstances();
 	
-	rapidjson::Document result(rapidjson::kObjectType);
-	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
+	static const std::map<std::string,SortKey<ApplicationInstance>> sortKeys={
+		{"id",[](const ApplicationInstance& i)->const std::string&{ return i.id; }},
+		{"name",[](const ApplicationInstance& i)->const std::string&{ return i.name; }},
+		{"application",[](const ApplicationInstance& i)->const std::string&{ return i.application; }},
+		{"created",[](const ApplicationInstance& i)->const std::string&{ return i.ctime; }},
+	};
+	std::string continueToken;
+	try{
+		continueToken=paginate(instances,parsePageRequest(req.url_params),sortKeys);
+	}catch(std::runtime_error& err){
+		return crow::response(400,generateError(err.what()));
+	}
 	
-	result.AddMember("apiVersion", "v1alpha3", alloc);
-	rapidjson::Value resultItems(rapidjson::kArrayType);
-	resultItems.Reserve(instances.size(), alloc);
+	JSONResponseWriter out(64+320*instances.size());
+	auto& json=out.json();
+	json.StartObject();
+	json.Key("apiVersion");
+	json.String("v1alpha3");
+	json.Key("items");
+	json.StartArray();
 	for(const ApplicationInstance& instance : instances){
-		rapidjson::Value instanceResult(rapidjson::kObjectType);
-		instanceResult.AddMember("apiVersion", "v1alpha3", alloc);
-		instanceResult.AddMember("kind", "ApplicationInstance", alloc);
-		rapidjson::Value instanceData(rapidjson::kObjectType);
-		instanceData.AddMember("id", instance.id, alloc);
-		instanceData.AddMember("name", instance.name, alloc);
-		std::string application=instance.application;
-		if(application.find('/')!=std::string::npos && application.find('/')<application.size()-1)
-			application=application.substr(application.find('/')+1);
-		instanceData.AddMember("application", application, alloc);
-		instanceData.AddMember("group", store.getGroup(instance.owningGroup).name, alloc);
-		instanceData.AddMember("cluster", store.getCluster(instance.cluster).name, alloc);
-		instanceData.AddMember("created", instance.ctime, alloc);
-		instanceResult.AddMember("metadata", instanceData, alloc);
-		resultItems.PushBack(instanceResult, alloc);
+		json.StartObject();
+		json.Key("apiVersion");
+		json.String("v1alpha3");
+		json.Key("kind");
+		json.String("ApplicationInstance");
+		json.Key("metadata");
+		json.StartObject();
+		json.Key("id");
+		json.String(instance.id);
+		json.Key("name");
+		json.String(instance.name);
+		//strip the repository prefix from the application name, without copying
+		const std::string& application=instance.application;
+		std::size_t slash=application.find('/');
+		json.Key("application");
+		if(slash!=std::string::npos && slash<application.size()-1)
+			json.String(application.c_str()+slash+1,application.size()-slash-1);
+		else
+			json.String(application);
+		json.Key("group");
+		json.String(store.getGroup(instance.owningGroup).name);
+		json.Key("cluster");
+		json.String(store.getCluster(instance.cluster).name);
+		json.Key("created");
+		json.String(instance.ctime);
+		json.EndObject();
+		json.EndObject();
 		//TODO: query helm to get current status (helm list {instance.name})?
 	}
-	result.AddMember("items", resultItems, alloc);
+	json.EndArray();
+	if(!continueToken.empty()){
+		json.Key("continue");
+		json.String(continueToken);
+	}
+	json.EndObject();
 
 	high_resolution_clock::time_point t2 = high_resolution_clock::now();
 	log_info("instance listing completed in " << duration_cast<duration<double>>(t2-t1).count() << " seconds");
-	return crow::response(to_string(result));
+	return out.response();
 }
 
 struct ServiceInterface{
@@ -400,11 +439,15 @@ crow::response fetchApplicationInstanceInfo(PersistentStore& store, const crow::
 	if(!user.admin && !store.userInGroup(user.id,instance.owningGroup))
 		return crow::response(403,generateError("Not authorized"));
 	
-	//fetch the full configuration for the instance
-	instance.config=store.getApplicationInstanceConfig(instanceID);
-	
-	//get information on the owning Group, needed to look up services, etc.
-	const Group group=store.getGroup(instance.owningGroup);
+	//the instance's configuration is stored separately from the main record, 
+	//and information on the owning Group (needed to look up services, etc.) 
+	//and on the cluster is also needed, so fetch them all at once
+	auto configLookup=store.getApplicationInstanceConfigAsync(instanceID);
+	auto groupLookup=store.getGroupAsync(instance.owningGroup);
+	auto clusterLookup=store.getClusterAsync(instance.cluster);
+	instance.config=configLookup.get();
+	const Group group=groupLookup.get();
+	const Cluster cluster=clusterLookup.get();
 	
 	//TODO: serialize the instance configuration as JSON
 	rapidjson::Document result(rapidjson::kObjectType);
@@ -419,8 +462,8 @@ crow::response fetchApplicationInstanceInfo(PersistentStore& store, const crow::
 	if(application.find('/')!=std::string::npos && application.find('/')<application.size()-1)
 			application=application.substr(application.find('/')+1);
 	instanceData.AddMember("application", application, alloc);
-	instanceData.AddMember("group", store.getGroup(instance.owningGroup).name, alloc);
-	instanceData.AddMember("cluster", store.getCluster(instance.cluster).name, alloc);
+	instanceData.AddMember("group", group.name, alloc);
+	instanceData.AddMember("cluster", cluster.name, alloc);
 	instanceData.AddMember("created", rapidjson::StringRef(instance.ctime.c_str()), alloc);
 	instanceData.AddMember("configuration", rapidjson::StringRef(instance.config.c_str()),
 			       alloc);
@@ -428,7 +471,7 @@ crow::response fetchApplicationInstanceInfo(PersistentStore& store, const crow::
 
 	
 	auto configPath=store.configPathForCluster(instance.cluster);
-	auto systemNamespace=store.getCluster(instance.cluster).systemNamespace;
+	auto systemNamespace=cluster.systemNamespace;
 	auto services=getServices(configPath,instance.name,group.namespaceName(),systemNamespace);
 	rapidjson::Value serviceData(rapidjson::kArrayType);
 	for(const auto& service : services){
@@ -455,7 +498,7 @@ crow::response fetchApplicationInstanceInfo(PersistentStore& store, const crow::
 		}
 	}
 
-	return crow::response(to_string(result));
+	return conditionalResponse(req,crow::response(to_string(result)));
 }
 
 crow::response deleteApplicationInstance(PersistentStore& store, const crow::request& req, const std::string& instanceID){
@@ -523,6 +566,97 @@ std::string deleteApplicationInstance(PersistentStore& store, const ApplicationI
 }
 }
 
+namespace{
+///List the objects belonging to a helm release which remain on a cluster
+///\return references to the objects in the form kubectl accepts, e.g. 
+///        'deployment.apps/name'
+///\throws std::runtime_error if the objects cannot be listed
+std::vector<std::string> listReleaseObjects(const std::string& configPath,
+                                            const std::string& release,
+                                            const std::string& nspace){
+	auto objsResult=kubernetes::kubectl(configPath,{"get","all","-l release="+release,"-n",nspace,"-o=json"});
+	if(objsResult.status)
+		throw std::runtime_error(objsResult.error);
+	rapidjson::Document objData;
+	objData.Parse(objsResult.output.c_str());
+	if(objData.HasParseError() || !objData.IsObject() || !objData.HasMember("items") 
+	   || !objData["items"].IsArray())
+		throw std::runtime_error("Unable to parse kubectl output for get all -l release="+release+" -n "+nspace);
+	std::vector<std::string> objects;
+	for(const auto& item : objData["items"].GetArray()){
+		if(!item.IsObject() || !item.HasMember("kind") || !item["kind"].IsString()
+		   || !item.HasMember("metadata") || !item["metadata"].IsObject()
+		   || !item["metadata"].HasMember("name") || !item["metadata"]["name"].IsString())
+			continue;
+		std::string resource=item["kind"].GetString();
+		std::transform(resource.begin(),resource.end(),resource.begin(),::tolower);
+		//qualify the kind with its API group, if any, since kind names alone 
+		//can be ambiguous
+		if(item.HasMember("apiVersion") && item["apiVersion"].IsString()){
+			const std::string apiVersion=item["apiVersion"].GetString();
+			auto slash=apiVersion.find('/');
+			if(slash!=std::string::npos)
+				resource+="."+apiVersion.substr(0,slash);
+		}
+		objects.push_back(resource+"/"+item["metadata"]["name"].GetString());
+	}
+	return objects;
+}
+
+///Wait for all objects belonging to a deleted helm release to be removed from
+///a cluster. Rather than polling, this has kubectl watch the objects, so that 
+///it returns as soon as the last one is gone. 
+///\param maxTime the longest time to wait
+///\return a warning to pass on to the user if the objects could not be 
+///        confirmed to be deleted, or an empty string
+std::string waitForReleaseDeletion(const std::string& configPath, const std::string& release,
+                                   const std::string& nspace, std::chrono::seconds maxTime){
+	using std::chrono::steady_clock;
+	const auto deadline=steady_clock::now()+maxTime;
+	while(true){
+		std::vector<std::string> remaining;
+		try{
+			remaining=listReleaseObjects(configPath,release,nspace);
+		}
+		catch(std::runtime_error& err){
+			log_error("Failed to check for deleted instance objects: " << err.what());
+			return "[Warning] Failed to check whether objects from old instance are fully deleted; reinstall may fail\n";
+		}
+		if(remaining.empty())
+			return "";
+		if(steady_clock::now()>=deadline)
+			break;
+		//Objects being deleted can still create others (e.g. a ReplicaSet 
+		//creating pods), so after the wait the release is listed again. 
+		//kubectl applies its timeout to each object in turn, so objects are 
+		//waited for one at a time, with the time remaining recomputed for 
+		//each, to keep the total within maxTime. Since the objects are all 
+		//being deleted at once, later waits are usually brief. 
+		//kubectl's default request timeout is not applied, as it would cut 
+		//the watch short. 
+		for(const auto& object : remaining){
+			const auto timeLeft=std::chrono::duration_cast<std::chrono::seconds>(deadline-steady_clock::now());
+			if(timeLeft.count()<=0)
+				break;
+			auto waitResult=runCommand("kubectl",{"--kubeconfig="+configPath,"wait","--for=delete",
+			                                      "-n",nspace,"--timeout="+std::to_string(timeLeft.count())+"s",
+			                                      object});
+			if(waitResult.status){
+				//this is expected on timeout, so only check the final state
+				log_info("kubectl wait for deletion of " << object << " from " << release 
+				         << " ended with status " << waitResult.status << ": " << waitResult.error);
+				//if the watch itself failed, avoid retrying it in a tight loop
+				if(steady_clock::now()<deadline)
+					std::this_thread::sleep_for(std::chrono::seconds(1));
+				break;
+			}
+		}
+	}
+	log_warn("Object deletion check timeout reached; proceeding with reinstall anyway");
+	return "[Warning] Object deletion check timeout reached; proceeding with reinstall anyway\n";
+}
+}
+
 crow::response restartApplicationInstance(PersistentStore& store, const crow::request& req, const std::string& instanceID){
 	const User user=authenticateUser(store, req.url_params.get("token"));
 	log_info(user << " requested to restart " << instanceID << " from " << req.remote_endpoint);
@@ -551,6 +685,7 @@ crow::response restartApplicationInstance(PersistentStore& store, const crow::re
 	//TODO: it would be good to detect if there is nothing to stop and proceed 
 	//      with restarting in that case
 	log_info("Stopping old " << instance);
+	JobEngine::reportProgress("Stopping old instance");
 	try{
 		auto systemNamespace=store.getCluster(instance.cluster).systemNamespace;
 		std::vector<std::string> deleteArgs={"delete",instance.name};
@@ -581,45 +716,12 @@ crow::response restartApplicationInstance(PersistentStore& store, const crow::re
 	}
 	
 	log_info("Waiting to ensure that all previous objects from " << instance << " have been deleted");
-	std::chrono::seconds maxTime(120), elapsedTime(0), maxPollDelay(10), pollDelay(1);
-	while(elapsedTime<maxTime){
-		pollDelay+=pollDelay;
-		if(pollDelay>maxPollDelay)
-			pollDelay=maxPollDelay;
-		std::this_thread::sleep_for(pollDelay);
-		try{
-			auto objsResult=kubernetes::kubectl(*clusterConfig,{"get","all","-l release="+instance.name,"-n",group.namespaceName(),"-o=json"});
-			if(objsResult.status){
-				log_error("Failed to check for deleted instance objects: " << objsResult.error);
-				resultMessage+="Failed to check whether objects from old instance are fully deleted; reinstall may fail\n";
-				break;
-			}
-			rapidjson::Document objData;
-			try{
-				objData.Parse(objsResult.output.c_str());
-			}
-			catch(std::runtime_error& err){
-				log_error("Unable to parse kubectl output for " << "get all -l release=" << instance.name << " -n" << group.namespaceName() << " -o=json");
-			}
-			//check whether any objects remain
-			if(objData.HasMember("items") && objData["items"].IsArray() && objData["items"].Empty())
-				break;
-		}
-		catch(std::runtime_error& e){
-			log_error("Failed to check for deleted instance objects: " << e.what());
-			resultMessage+="[Warning] Failed to check whether objects from old instance are fully deleted; reinstall may fail\n";
-			break;
-		}
-		//We only count up the time we deliberately waited, which will miss any 
-		//latency added by kubernetes. This could be accounted for if necessary.
-		elapsedTime+=pollDelay;
-	}
-	if(elapsedTime>=maxTime){
-		log_warn("Object deletion check timeout reached; proceeding with reinstall anyway");
-		resultMessage+="[Warning] Object deletion check timeout reached; proceeding with reinstall anyway\n";
-	}
+	JobEngine::reportProgress("Waiting for old instance's objects to be deleted");
+	resultMessage+=waitForReleaseDeletion(*clusterConfig,instance.name,group.namespaceName(),
+	                                      std::chrono::seconds(120));
 	
 	log_info("Starting new " << instance);
+	JobEngine::reportProgress("Starting new instance");
 	//write configuration to a file for helm's benefit
 	FileHandle instanceConfig=makeTemporaryFile(instance.id);
 	{
@@ -877,6 +979,153 @@ crow::response scaleApplicationInstance(PersistentStore& store, const crow::requ
 	return crow::response(to_string(result));
 }
 
+namespace{
+///List the containers in all of an instance's pods
+///\param selectedContainer if not empty, the name of the only container to list
+///\return the names of the containers, each paired with the name of its pod
+///\throws std::runtime_error if the pods cannot be listed
+std::vector<std::pair<std::string,std::string>> findInstanceContainers(const std::string& configPath,
+                                                                       const ApplicationInstance& instance,
+                                                                       const std::string& nspace,
+                                                                       const std::string& selectedContainer){
+	std::vector<std::pair<std::string,std::string>> allContainers;
+	auto podsResult=kubernetes::kubectl(configPath,{"get","pods","-l release="+instance.name,"-n",nspace,"-o=json"});
+	if(podsResult.status){
+		log_error("Failed to look up pods for " << instance << ": " << podsResult.error);
+		throw std::runtime_error("Failed to look up pods");
+	}
+	rapidjson::Document podData;
+	podData.Parse(podsResult.output.c_str());
+	if(podData.HasParseError() || !podData.IsObject() || !podData.HasMember("items")){
+		log_error("Unable to parse kubectl output for " << instance << " pods");
+		throw std::runtime_error("Could not find pods for instance");
+	}
+	for(const auto& pod : podData["items"].GetArray()){
+		if(!pod["spec"].HasMember("containers"))
+			continue;
+		std::string podName=pod["metadata"]["name"].GetString();
+		for(const auto& container : pod["spec"]["containers"].GetArray()){
+			std::string containerName=container["name"].GetString();
+			if(selectedContainer.empty() || containerName==selectedContainer)
+				allContainers.push_back(std::make_pair(podName,containerName));
+		}
+	}
+	return allContainers;
+}
+
+///How long the log stream may be idle before checking whether the client is
+///still connected
+const std::chrono::seconds logStreamIdleInterval(1);
+///The most log data which may be waiting to be sent before reading from
+///kubectl pauses
+const std::size_t logStreamBufferLimit=1<<20;
+
+///Run kubectl logs for each of a set of containers, and pass each line of
+///output, prefixed by its pod and container, to \p write as soon as it arrives.
+///Returns when all of the kubectl processes have exited, or when the client
+///goes away, in which case any which are still running are stopped.
+void streamContainerLogs(const SharedFileHandle& configPath, const std::string& nspace,
+                         const std::vector<std::pair<std::string,std::string>>& containers,
+                         unsigned long maxLines, bool previousLogs, bool follow,
+                         const crow::response::body_writer& write){
+	std::mutex mutex;
+	std::condition_variable dataReady, spaceReady;
+	std::deque<std::string> lines;
+	std::size_t queuedBytes=0;
+	std::size_t running=containers.size();
+	bool stopping=false;
+	
+	std::vector<ProcessHandle> processes;
+	processes.reserve(containers.size());
+	for(const auto& container : containers){
+		std::vector<std::string> args={"--kubeconfig="+*configPath,"logs",container.first,
+		                               "-c",container.second,"-n",nspace};
+		//a followed log has no natural end, so it must not be cut off
+		if(follow)
+			args.push_back("-f");
+		else
+			args.insert(args.begin(),"--request-timeout=10s");
+		if(maxLines)
+			args.push_back("--tail="+std::to_string(maxLines));
+		if(previousLogs)
+			args.push_back("-p");
+		processes.push_back(startProcessAsync("kubectl",args));
+	}
+	
+	auto enqueue=[&](std::string line){
+		std::unique_lock<std::mutex> lock(mutex);
+		spaceReady.wait(lock,[&]{ return stopping || queuedBytes<logStreamBufferLimit; });
+		if(stopping)
+			return;
+		queuedBytes+=line.size();
+		lines.push_back(std::move(line));
+		dataReady.notify_one();
+	};
+	std::vector<std::thread> readers;
+	for(std::size_t i=0; i<containers.size(); i++){
+		readers.emplace_back([&,i]{
+			const std::string prefix="["+containers[i].first+"/"+containers[i].second+"] ";
+			ProcessHandle& process=processes[i];
+			//stderr must be drained at the same time as stdout, or kubectl 
+			//could fill the pipe and stop before finishing its output
+			std::ostringstream error;
+			std::thread errorReader([&]{ error << process.getStderr().rdbuf(); });
+			std::string line;
+			try{
+				while(std::getline(process.getStdout(),line))
+					enqueue(prefix+removeShellEscapeSequences(line)+'\n');
+			}
+			catch(std::runtime_error& err){
+				log_error("Failed to read logs for " << containers[i].first << "/"
+				          << containers[i].second << ": " << err.what());
+				process.kill();
+			}
+			//stdout has ended, so the process has exited or soon will
+			errorReader.join();
+			process.wait();
+			if(process.exitStatus()){
+				std::string message=removeShellEscapeSequences(error.str());
+				while(!message.empty() && message.back()=='\n')
+					message.pop_back();
+				enqueue(prefix+"Failed to get logs: "+message+'\n');
+			}
+			std::lock_guard<std::mutex> lock(mutex);
+			running--;
+			dataReady.notify_one();
+		});
+	}
+	
+	std::unique_lock<std::mutex> lock(mutex);
+	while(true){
+		dataReady.wait_for(lock,logStreamIdleInterval,[&]{ return !lines.empty() || !running; });
+		if(lines.empty() && !running)
+			break;
+		//send everything which has accumulated as one piece
+		std::string data;
+		data.reserve(queuedBytes);
+		for(const auto& line : lines)
+			data+=line;
+		lines.clear();
+		queuedBytes=0;
+		spaceReady.notify_all();
+		lock.unlock();
+		//with no data, this just checks that the client is still there
+		bool connected=write(data);
+		lock.lock();
+		if(!connected){
+			stopping=true;
+			spaceReady.notify_all();
+			for(auto& process : processes)
+				process.kill();
+			break;
+		}
+	}
+	lock.unlock();
+	for(auto& reader : readers)
+		reader.join();
+}
+}
+
 crow::response getApplicationInstanceLogs(PersistentStore& store, 
                                           const crow::request& req, 
                                           const std::string& instanceID){
@@ -922,28 +1171,11 @@ crow::response getApplicationInstanceLogs(PersistentStore& store,
 	
 	//Make a list of all containers in all pods, including any filtering requested by the user
 	std::vector<std::pair<std::string,std::string>> allContainers;
-	auto podsResult=kubernetes::kubectl(*configPath,{"get","pods","-l release="+instance.name,"-n",nspace,"-o=json"});
-	if(podsResult.status){
-		log_error("Failed to look up pods for " << instance << ": " << podsResult.error);
-		return crow::response(500,generateError("Failed to look up pods"));
-	}
-	rapidjson::Document podData;
 	try{
-		podData.Parse(podsResult.output.c_str());
+		allContainers=findInstanceContainers(*configPath,instance,nspace,selectedContainer);
 	}
 	catch(std::runtime_error& err){
-		log_error("Unable to parse kubectl output for " << instance << " pods");
-		throw std::runtime_error("Could not find pods for instance");
-	}
-	for(const auto& pod : podData["items"].GetArray()){
-		if(!pod["spec"].HasMember("containers"))
-			continue;
-		std::string podName=pod["metadata"]["name"].GetString();
-		for(const auto& container : pod["spec"]["containers"].GetArray()){
-			std::string containerName=container["name"].GetString();
-			if(selectedContainer.empty() || containerName==selectedContainer)
-				allContainers.push_back(std::make_pair(podName,containerName));
-		}
+		return crow::response(500,generateError(err.what()));
 	}
 	
 	//check whether the user specified a container name, but we didn't find any matches
@@ -998,3 +1230,64 @@ crow::response getApplicationInstanceLogs(PersistentStore& store,
 	
 	return crow::response(to_string(result));
 }
+
+crow::response streamApplicationInstanceLogs(PersistentStore& store, 
+                                             const crow::request& req, 
+                                             const std::string& instanceID){
+	const User user=authenticateUser(store, req.url_params.get("token"));
+	log_info(user << " requested to stream logs from " << instanceID << " from " << req.remote_endpoint);
+	if(!user)
+		return crow::response(403,generateError("Not authorized"));
+	
+	auto instance=store.getApplicationInstance(instanceID);
+	if(!instance)
+		return crow::response(404,generateError("Application instance not found"));
+	
+	//only admins or member of the Group which owns an instance may read its logs
+	if(!user.admin && !store.userInGroup(user.id,instance.owningGroup))
+		return crow::response(403,generateError("Not authorized"));
+	
+	unsigned long maxLines=20; //default is 20
+	{
+		const char* reqMaxLines=req.url_params.get("max_lines");
+		if(reqMaxLines){
+			try{
+				maxLines=std::stoul(reqMaxLines);
+			}
+			catch(...){
+				//do nothing; leaving maxLines at default is fine
+			}
+		}
+	}
+	std::string selectedContainer;
+	{
+		const char* reqContainer=req.url_params.get("container");
+		if(reqContainer)
+			selectedContainer=reqContainer;
+	}
+	bool previousLogs=req.url_params.get("previous");
+	bool follow=req.url_params.get("follow");
+	
+	auto configPath=store.configPathForCluster(instance.cluster);
+	const Group group=store.getGroup(instance.owningGroup);
+	const std::string nspace=group.namespaceName();
+	
+	std::vector<std::pair<std::string,std::string>> allContainers;
+	try{
+		allContainers=findInstanceContainers(*configPath,instance,nspace,selectedContainer);
+	}
+	catch(std::runtime_error& err){
+		return crow::response(500,generateError(err.what()));
+	}
+	if(allContainers.empty() && !selectedContainer.empty())
+		return crow::response(400,generateError("No containers found matching the name '"+selectedContainer+"'"));
+	
+	log_info("Streaming logs from " << instance << " to " << user);
+	crow::response res;
+	res.set_header("Content-Type","text/plain; charset=utf-8");
+	res.body_producer=[=](crow::response::body_writer write){
+		streamContainerLogs(configPath,nspace,allContainers,maxLines,previousLogs,follow,write);
+		log_info("Finished streaming logs from " << instance);
+	};
+	return res;
+}
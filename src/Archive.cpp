@@ -341,6 +341,79 @@ void gzipCompress(std::istream& src, std::ostream& dest){
 	dest.write((const char*)&totalSize,sizeof(totalSize));
 }
 
+std::string gzipCompress(const std::string& data, int level){
+	z_stream zs;
+	zs.zalloc = Z_NULL;
+	zs.zfree = Z_NULL;
+	zs.opaque = Z_NULL;
+	int result=deflateInit2(&zs, 
+	                        level,
+	                        Z_DEFLATED, //required
+	                        15+16, //window bits, plus 16 to have zlib write the gzip header and trailer
+	                        8, //memory level
+	                        Z_DEFAULT_STRATEGY);
+	if(result!=Z_OK)
+		throw std::runtime_error("zlib initilization failed");
+	struct deflateCleanup{ //ensure that deflateEnd is always called on zs
+		z_stream* s;
+		deflateCleanup(z_stream* s):s(s){}
+		~deflateCleanup(){ deflateEnd(s); }
+	} c(&zs);
+	
+	//allocate the worst case output size up front so that the whole input can
+	//be compressed in a single call
+	std::string output(deflateBound(&zs,data.size()),'\0');
+	zs.next_in = (unsigned char*)data.data();
+	zs.avail_in = data.size();
+	zs.next_out = (unsigned char*)&output[0];
+	zs.avail_out = output.size();
+	result = deflate(&zs,Z_FINISH);
+	if(result!=Z_STREAM_END)
+		throw std::runtime_error("zlib compression failed");
+	output.resize(zs.total_out);
+	return output;
+}
+
+std::string gzipDecompress(const std::string& data){
+	z_stream zs;
+	zs.zalloc = Z_NULL;
+	zs.zfree = Z_NULL;
+	zs.opaque = Z_NULL;
+	zs.next_in = Z_NULL;
+	zs.avail_in = 0;
+	int result=inflateInit2(&zs, 15+16); //window bits, plus 16 to expect a gzip header
+	if(result!=Z_OK)
+		throw std::runtime_error("zlib initilization failed");
+	struct inflateCleanup{ //ensure that inflateEnd is always called on zs
+		z_stream* s;
+		inflateCleanup(z_stream* s):s(s){}
+		~inflateCleanup(){ inflateEnd(s); }
+	} c(&zs);
+	
+	//the decompressed size is recorded (modulo 2^32) in the last four bytes
+	std::size_t expectedSize=0;
+	if(data.size()>=18){
+		const unsigned char* isize=(const unsigned char*)data.data()+data.size()-4;
+		expectedSize=isize[0] | (isize[1]<<8) | (isize[2]<<16) | ((std::size_t)isize[3]<<24);
+	}
+	std::string output(std::max(expectedSize,data.size()+64),'\0');
+	zs.next_in = (unsigned char*)data.data();
+	zs.avail_in = data.size();
+	while(true){
+		zs.next_out = (unsigned char*)&output[zs.total_out];
+		zs.avail_out = output.size()-zs.total_out;
+		result = inflate(&zs,Z_FINISH);
+		if(result==Z_STREAM_END)
+			break;
+		//running out of output space is the only acceptable failure
+		if((result!=Z_BUF_ERROR && result!=Z_OK) || zs.avail_out!=0)
+			throw std::runtime_error("zlib decompression failed");
+		output.resize(2*output.size());
+	}
+	output.resize(zs.total_out);
+	return output;
+}
+
 struct header_posix_ustar {
 	enum typeCode{
 		RegularFile = 0,
@@ -0,0 +1,208 @@
+#include "CacheManager.h"
+
+#include <sstream>
+
+#include "Logging.h"
+#include "Metrics.h"
+
+std::size_t dynamicSize(const std::string& s){
+	//short strings are stored within the string object itself
+	return s.capacity()>=sizeof(std::string) ? s.capacity()+1 : 0;
+}
+
+std::size_t dynamicSize(const User& user){
+	return dynamicSize(user.id)+dynamicSize(user.name)+dynamicSize(user.email)
+	      +dynamicSize(user.phone)+dynamicSize(user.institution)+dynamicSize(user.token)
+	      +dynamicSize(user.globusID);
+}
+
+std::size_t dynamicSize(const Group& group){
+	return dynamicSize(group.id)+dynamicSize(group.name)+dynamicSize(group.email)
+	      +dynamicSize(group.phone)+dynamicSize(group.scienceField)+dynamicSize(group.description);
+}
+
+std::size_t dynamicSize(const Cluster& cluster){
+	return dynamicSize(cluster.id)+dynamicSize(cluster.name)+dynamicSize(cluster.config)
+	      +dynamicSize(cluster.systemNamespace)+dynamicSize(cluster.owningGroup)
+	      +dynamicSize(cluster.owningOrganization);
+}
+
+std::size_t dynamicSize(const GeoLocation& location){
+	return dynamicSize(location.description);
+}
+
+std::size_t dynamicSize(const Application& application){
+	return dynamicSize(application.name)+dynamicSize(application.version)
+	      +dynamicSize(application.chartVersion)+dynamicSize(application.description);
+}
+
+std::size_t dynamicSize(const ApplicationInstance& instance){
+	return dynamicSize(instance.id)+dynamicSize(instance.name)+dynamicSize(instance.application)
+	      +dynamicSize(instance.owningGroup)+dynamicSize(instance.cluster)+dynamicSize(instance.config)
+	      +dynamicSize(instance.ctime);
+}
+
+std::size_t dynamicSize(const Secret& secret){
+	return dynamicSize(secret.id)+dynamicSize(secret.name)+dynamicSize(secret.group)
+	      +dynamicSize(secret.cluster)+dynamicSize(secret.ctime)+dynamicSize(secret.data);
+}
+
+CacheManager::CacheManager():stopRequested(false){}
+
+CacheManager::~CacheManager(){
+	stopSweeping();
+}
+
+void CacheManager::manageTable(const std::string& name, Budget budget,
+                               std::function<std::size_t()> size,
+                               std::function<HitCounts()> hitCounts,
+                               std::function<SweepResult(Budget,std::size_t&)> sweep){
+	std::unique_ptr<ManagedCache> cache(new ManagedCache);
+	cache->name=name;
+	cache->budget=budget;
+	cache->size=std::move(size);
+	cache->hitCounts=std::move(hitCounts);
+	cache->sweep=std::move(sweep);
+	cache->hand=0;
+	cache->bytes=0;
+	cache->meanEntryBytes=0;
+	cache->expired=0;
+	cache->evicted=0;
+	std::lock_guard<std::mutex> lock(cachesMutex);
+	caches.push_back(std::move(cache));
+}
+
+bool CacheManager::setBudget(const std::string& name, Budget budget){
+	std::lock_guard<std::mutex> lock(cachesMutex);
+	for(auto& cache : caches){
+		if(cache->name==name){
+			cache->budget=budget;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CacheManager::canHold(const std::string& name, std::size_t entries) const{
+	std::lock_guard<std::mutex> lock(cachesMutex);
+	for(const auto& cache : caches){
+		if(cache->name==name){
+			const Budget& budget=cache->budget;
+			if(budget.maxEntries && entries>budget.maxEntries)
+				return false;
+			if(budget.maxBytes && entries*cache->meanEntryBytes.load()>budget.maxBytes)
+				return false;
+			return true;
+		}
+	}
+	return false;
+}
+
+void CacheManager::sweep(){
+	std::size_t nCaches;
+	{
+		std::lock_guard<std::mutex> lock(cachesMutex);
+		nCaches=caches.size();
+	}
+	for(std::size_t i=0; i<nCaches; i++){
+		ManagedCache* cache;
+		Budget budget;
+		std::size_t hand;
+		{
+			std::lock_guard<std::mutex> lock(cachesMutex);
+			cache=caches[i].get();
+			budget=cache->budget;
+			hand=cache->hand;
+		}
+		//the cache itself is locked by its sweep function, so this can proceed
+		//without holding cachesMutex
+		SweepResult result=cache->sweep(budget,hand);
+		{
+			std::lock_guard<std::mutex> lock(cachesMutex);
+			cache->hand=hand;
+		}
+		cache->bytes=result.bytes;
+		if(result.entries)
+			cache->meanEntryBytes=result.bytes/result.entries;
+		cache->expired+=result.expired;
+		cache->evicted+=result.evicted;
+		if(result.evicted)
+			log_info("Evicted " << result.evicted << " entries from " << cache->name
+			         << " to fit its budget");
+	}
+}
+
+void CacheManager::startSweeping(std::chrono::milliseconds interval){
+	stopSweeping();
+	{
+		std::lock_guard<std::mutex> lock(sweeperMutex);
+		stopRequested=false;
+	}
+	sweeper=std::thread([this,interval]{
+		std::unique_lock<std::mutex> lock(sweeperMutex);
+		while(!sweeperCondition.wait_for(lock,interval,[this]{ return stopRequested; })){
+			lock.unlock();
+			sweep();
+			lock.lock();
+		}
+	});
+}
+
+void CacheManager::stopSweeping(){
+	{
+		std::lock_guard<std::mutex> lock(sweeperMutex);
+		stopRequested=true;
+	}
+	sweeperCondition.notify_all();
+	if(sweeper.joinable())
+		sweeper.join();
+}
+
+std::string CacheManager::getStatistics() const{
+	std::ostringstream os;
+	std::lock_guard<std::mutex> lock(cachesMutex);
+	for(const auto& cache : caches){
+		os << "Cache " << cache->name << ": " << cache->size() << " entries";
+		if(cache->budget.maxEntries)
+			os << " (limit " << cache->budget.maxEntries << ")";
+		os << ", ~" << cache->bytes.load() << " bytes";
+		if(cache->budget.maxBytes)
+			os << " (limit " << cache->budget.maxBytes << ")";
+		HitCounts counts=cache->hitCounts();
+		if(counts.lookups)
+			os << ", " << 100*counts.hits/counts.lookups << "% of "
+			   << counts.lookups << " lookups hit";
+		os << ", " << cache->expired.load() << " expired, "
+		   << cache->evicted.load() << " evicted\n";
+	}
+	return os.str();
+}
+
+void CacheManager::writeMetrics(std::ostream& os) const{
+	std::lock_guard<std::mutex> lock(cachesMutex);
+	struct Metric{
+		const char* name;
+		const char* type;
+		const char* help;
+		std::function<double(const ManagedCache&)> value;
+	};
+	const std::vector<Metric> cacheMetrics={
+		{"slate_cache_entries","gauge","Number of entries in each cache",
+			[](const ManagedCache& cache){ return cache.size(); }},
+		{"slate_cache_bytes","gauge","Estimated memory used by each cache as of its last sweep",
+			[](const ManagedCache& cache){ return cache.bytes.load(); }},
+		{"slate_cache_lookups_total","counter","Number of searches of each cache",
+			[](const ManagedCache& cache){ return cache.hitCounts().lookups; }},
+		{"slate_cache_hits_total","counter","Number of searches of each cache which found unexpired data",
+			[](const ManagedCache& cache){ return cache.hitCounts().hits; }},
+		{"slate_cache_expired_total","counter","Number of entries removed from each cache due to expiry",
+			[](const ManagedCache& cache){ return cache.expired.load(); }},
+		{"slate_cache_evicted_total","counter","Number of entries evicted from each cache to fit its budget",
+			[](const ManagedCache& cache){ return cache.evicted.load(); }},
+	};
+	for(const auto& metric : cacheMetrics){
+		metrics::writeHeader(os,metric.name,metric.type,metric.help);
+		for(const auto& cache : caches)
+			metrics::writeSample(os,metric.name,{{"cache",cache->name}},metric.value(*cache));
+	}
+}
@@ -0,0 +1,186 @@
+#include "CacheSnapshot.h"
+
+#include <stdexcept>
+
+void SnapshotWriter::writeInteger(std::uint64_t value){
+	do{
+		unsigned char byte=value&0x7F;
+		value>>=7;
+		if(value)
+			byte|=0x80;
+		buffer.push_back((char)byte);
+	}while(value);
+}
+
+void SnapshotWriter::writeString(const std::string& s){
+	writeInteger(s.size());
+	buffer.append(s);
+}
+
+void SnapshotWriter::write(const User& user){
+	writeString(user.id);
+	writeString(user.name);
+	writeString(user.email);
+	writeString(user.phone);
+	writeString(user.institution);
+	writeString(user.token);
+	writeString(user.globusID);
+	writeInteger(user.admin);
+}
+
+void SnapshotWriter::write(const Group& group){
+	writeString(group.id);
+	writeString(group.name);
+	writeString(group.email);
+	writeString(group.phone);
+	writeString(group.scienceField);
+	writeString(group.description);
+}
+
+void SnapshotWriter::write(const Cluster& cluster){
+	writeString(cluster.id);
+	writeString(cluster.name);
+	writeString(cluster.config);
+	writeString(cluster.systemNamespace);
+	writeString(cluster.owningGroup);
+	writeString(cluster.owningOrganization);
+}
+
+void SnapshotWriter::write(const ApplicationInstance& instance){
+	writeString(instance.id);
+	writeString(instance.name);
+	writeString(instance.application);
+	writeString(instance.owningGroup);
+	writeString(instance.cluster);
+	writeString(instance.config);
+	writeString(instance.ctime);
+}
+
+void SnapshotWriter::write(const Application& application){
+	writeInteger(application.valid);
+	writeString(application.name);
+	writeString(application.version);
+	writeString(application.chartVersion);
+	writeString(application.description);
+}
+
+void SnapshotWriter::write(const std::set<std::string>& items){
+	writeInteger(items.size());
+	for(const auto& item : items)
+		writeString(item);
+}
+
+void SnapshotWriter::beginSection(std::uint64_t kind){
+	sectionKind=kind;
+	sectionStart=buffer.size();
+}
+
+void SnapshotWriter::endSection(){
+	//the length is only known once the contents are written, so move them
+	//aside and write the header in front of them
+	std::string contents=buffer.substr(sectionStart);
+	buffer.resize(sectionStart);
+	writeInteger(sectionKind);
+	writeInteger(contents.size());
+	buffer.append(contents);
+}
+
+SnapshotReader::SnapshotReader(const char* data, std::size_t size):
+data(data),size(size),position(0){}
+
+std::uint64_t SnapshotReader::readInteger(){
+	std::uint64_t value=0;
+	for(unsigned int shift=0; ; shift+=7){
+		if(position==size)
+			throw std::runtime_error("Snapshot data ends within an integer");
+		if(shift>63)
+			throw std::runtime_error("Snapshot data contains an overlong integer");
+		unsigned char byte=data[position++];
+		value|=(std::uint64_t)(byte&0x7F)<<shift;
+		if(!(byte&0x80))
+			return value;
+	}
+}
+
+std::string SnapshotReader::readString(){
+	std::uint64_t length=readInteger();
+	if(length>size-position)
+		throw std::runtime_error("Snapshot data ends within a string");
+	std::string result(data+position,length);
+	position+=length;
+	return result;
+}
+
+void SnapshotReader::read(User& user){
+	user.valid=true;
+	user.id=readString();
+	user.name=readString();
+	user.email=readString();
+	user.phone=readString();
+	user.institution=readString();
+	user.token=readString();
+	user.globusID=readString();
+	user.admin=readInteger();
+}
+
+void SnapshotReader::read(Group& group){
+	group.valid=true;
+	group.id=readString();
+	group.name=readString();
+	group.email=readString();
+	group.phone=readString();
+	group.scienceField=readString();
+	group.description=readString();
+}
+
+void SnapshotReader::read(Cluster& cluster){
+	cluster.valid=true;
+	cluster.id=readString();
+	cluster.name=readString();
+	cluster.config=readString();
+	cluster.systemNamespace=readString();
+	cluster.owningGroup=readString();
+	cluster.owningOrganization=readString();
+}
+
+void SnapshotReader::read(ApplicationInstance& instance){
+	instance.valid=true;
+	instance.id=readString();
+	instance.name=readString();
+	instance.application=readString();
+	instance.owningGroup=readString();
+	instance.cluster=readString();
+	instance.config=readString();
+	instance.ctime=readString();
+}
+
+void SnapshotReader::read(Application& application){
+	//the catalog also caches the absence of applications
+	application.valid=readInteger();
+	application.name=readString();
+	application.version=readString();
+	application.chartVersion=readString();
+	application.description=readString();
+}
+
+void SnapshotReader::read(std::set<std::string>& items){
+	items.clear();
+	std::uint64_t count=readInteger();
+	for(std::uint64_t i=0; i<count; i++)
+		items.insert(readString());
+}
+
+std::uint64_t SnapshotReader::readSectionHeader(std::size_t& length){
+	std::uint64_t kind=readInteger();
+	std::uint64_t sectionLength=readInteger();
+	if(sectionLength>size-position)
+		throw std::runtime_error("Snapshot data ends within a section");
+	length=sectionLength;
+	return kind;
+}
+
+void SnapshotReader::skip(std::size_t length){
+	if(length>size-position)
+		throw std::runtime_error("Snapshot data ends too soon");
+	position+=length;
+}
@@ -0,0 +1,260 @@
+#include "ChangeFeed.h"
+
+#include <sstream>
+
+#include <aws/dynamodbstreams/model/DescribeStreamRequest.h>
+#include <aws/dynamodbstreams/model/GetRecordsRequest.h>
+#include <aws/dynamodbstreams/model/GetShardIteratorRequest.h>
+
+#include "Logging.h"
+
+namespace{
+	///How often to list each stream's shards to find new ones
+	const std::chrono::seconds describeInterval(30);
+	///How long to wait before polling again when no changes were found
+	const std::chrono::milliseconds idleInterval(1000);
+
+	ChangeFeed::Item convertItem(const Aws::Map<Aws::String,Aws::DynamoDBStreams::Model::AttributeValue>& item){
+		//The two services use distinct but identically serialized types for
+		//attribute values, so the simplest complete conversion is through JSON
+		ChangeFeed::Item result;
+		for(const auto& attribute : item)
+			result.emplace(attribute.first,Aws::DynamoDB::Model::AttributeValue(attribute.second.Jsonize().View()));
+		return result;
+	}
+}
+
+ChangeFeed::ChangeFeed(const Aws::Auth::AWSCredentials& credentials,
+                       const Aws::Client::ClientConfiguration& clientConfig,
+                       std::function<void(const Change&)> onChange,
+                       std::function<void(const std::string&)> onGap):
+client(credentials,clientConfig),
+onChange(std::move(onChange)),
+onGap(std::move(onGap)),
+stopRequested(false),
+changesReceived(0),
+gaps(0){}
+
+ChangeFeed::~ChangeFeed(){
+	stop();
+}
+
+void ChangeFeed::follow(const std::string& table, const std::string& streamArn){
+	Stream stream;
+	stream.table=table;
+	stream.arn=streamArn;
+	stream.described=false;
+	stream.nextDescribe=std::chrono::steady_clock::now();
+	streams.push_back(std::move(stream));
+}
+
+void ChangeFeed::start(){
+	stop();
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		stopRequested=false;
+	}
+	//list all shards before returning, so that changes made after this
+	//function returns are not missed
+	for(auto& stream : streams)
+		describe(stream);
+	worker=std::thread(&ChangeFeed::run,this);
+}
+
+void ChangeFeed::stop(){
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		stopRequested=true;
+	}
+	workerCondition.notify_all();
+	if(worker.joinable())
+		worker.join();
+}
+
+void ChangeFeed::run(){
+	while(true){
+		std::size_t received=0;
+		for(auto& stream : streams){
+			if(std::chrono::steady_clock::now()>=stream.nextDescribe)
+				describe(stream);
+			received+=poll(stream);
+		}
+		std::unique_lock<std::mutex> lock(workerMutex);
+		//if changes were found there may be more waiting, so poll again
+		//immediately
+		if(received ? stopRequested : workerCondition.wait_for(lock,idleInterval,[this]{ return stopRequested; }))
+			break;
+	}
+}
+
+void ChangeFeed::describe(Stream& stream){
+	using namespace Aws::DynamoDBStreams::Model;
+	stream.nextDescribe=std::chrono::steady_clock::now()+describeInterval;
+
+	std::vector<Shard> shards;
+	auto request=DescribeStreamRequest().WithStreamArn(stream.arn);
+	bool keepGoing=false;
+	do{
+		auto outcome=client.DescribeStream(request);
+		if(!outcome.IsSuccess()){
+			log_error("Failed to describe stream for " << stream.table << ": "
+			          << outcome.GetError().GetMessage());
+			return;
+		}
+		const StreamDescription& description=outcome.GetResult().GetStreamDescription();
+		shards.insert(shards.end(),description.GetShards().begin(),description.GetShards().end());
+		keepGoing=!description.GetLastEvaluatedShardId().empty();
+		if(keepGoing)
+			request.SetExclusiveStartShardId(description.GetLastEvaluatedShardId());
+	}while(keepGoing);
+
+	std::set<std::string> listed;
+	for(const Shard& shard : shards){
+		const std::string id=shard.GetShardId();
+		listed.insert(id);
+		if(stream.iterators.count(id) || stream.finished.count(id))
+			continue;
+		const bool closed=!shard.GetSequenceNumberRange().GetEndingSequenceNumber().empty();
+		if(!stream.described){
+			//Changes before now are not of interest, so only the newest
+			//shards need to be read, and only from their ends.
+			if(closed)
+				stream.finished.insert(id);
+			else{
+				std::string iterator=shardIterator(stream,id,true);
+				if(!iterator.empty())
+					stream.iterators.emplace(id,iterator);
+			}
+			continue;
+		}
+		//A shard which has appeared since following began must be read from
+		//its beginning, but only after its parent has been finished, to
+		//preserve ordering of changes.
+		if(stream.iterators.count(shard.GetParentShardId()))
+			continue;
+		std::string iterator=shardIterator(stream,id,false);
+		if(!iterator.empty())
+			stream.iterators.emplace(id,iterator);
+	}
+	//forget shards which have been removed from the stream
+	for(auto it=stream.finished.begin(); it!=stream.finished.end();){
+		if(listed.count(*it))
+			++it;
+		else
+			it=stream.finished.erase(it);
+	}
+	stream.described=true;
+}
+
+std::string ChangeFeed::shardIterator(const Stream& stream, const std::string& shardID, bool latest){
+	using namespace Aws::DynamoDBStreams::Model;
+	auto outcome=client.GetShardIterator(GetShardIteratorRequest()
+	                                     .WithStreamArn(stream.arn)
+	                                     .WithShardId(shardID)
+	                                     .WithShardIteratorType(latest ? ShardIteratorType::LATEST
+	                                                                   : ShardIteratorType::TRIM_HORIZON));
+	if(!outcome.IsSuccess()){
+		log_error("Failed to get iterator for shard " << shardID << " of stream for "
+		          << stream.table << ": " << outcome.GetError().GetMessage());
+		return "";
+	}
+	return outcome.GetResult().GetShardIterator();
+}
+
+std::size_t ChangeFeed::poll(Stream& stream){
+	using namespace Aws::DynamoDBStreams::Model;
+	using Aws::DynamoDBStreams::DynamoDBStreamsErrors;
+	std::size_t received=0;
+	for(auto it=stream.iterators.begin(); it!=stream.iterators.end();){
+		auto outcome=client.GetRecords(GetRecordsRequest().WithShardIterator(it->second));
+		if(!outcome.IsSuccess()){
+			const auto& err=outcome.GetError();
+			if(err.GetErrorType()==DynamoDBStreamsErrors::EXPIRED_ITERATOR
+			   || err.GetErrorType()==DynamoDBStreamsErrors::TRIMMED_DATA_ACCESS
+			   || err.GetErrorType()==DynamoDBStreamsErrors::RESOURCE_NOT_FOUND){
+				//The position in the shard has been lost, so some changes may
+				//have been missed. Resume from the current end of the shard,
+				//and only then report the gap, so that nothing read from the
+				//database after the report can be missed.
+				log_warn("Lost position in stream for " << stream.table << ": " << err.GetMessage());
+				std::string iterator=shardIterator(stream,it->first,true);
+				gaps++;
+				onGap(stream.table);
+				if(iterator.empty()){
+					stream.finished.insert(it->first);
+					it=stream.iterators.erase(it);
+					stream.nextDescribe=std::chrono::steady_clock::now();
+				}
+				else{
+					it->second=iterator;
+					++it;
+				}
+			}
+			else{
+				//probably a transient problem; try again on the next round
+				log_error("Failed to read stream for " << stream.table << ": " << err.GetMessage());
+				++it;
+			}
+			continue;
+		}
+		const auto& result=outcome.GetResult();
+		for(const Record& record : result.GetRecords())
+			deliver(stream,record);
+		received+=result.GetRecords().size();
+		if(result.GetNextShardIterator().empty()){
+			//the shard has been closed and completely read; look for its
+			//children promptly
+			stream.finished.insert(it->first);
+			it=stream.iterators.erase(it);
+			stream.nextDescribe=std::chrono::steady_clock::now();
+		}
+		else{
+			it->second=result.GetNextShardIterator();
+			++it;
+		}
+	}
+	return received;
+}
+
+void ChangeFeed::deliver(const Stream& stream, const Aws::DynamoDBStreams::Model::Record& record){
+	using Aws::DynamoDBStreams::Model::OperationType;
+	Change change;
+	switch(record.GetEventName()){
+		case OperationType::INSERT: change.kind=Change::Insert; break;
+		case OperationType::MODIFY: change.kind=Change::Modify; break;
+		case OperationType::REMOVE: change.kind=Change::Remove; break;
+		default:
+			log_warn("Ignoring stream record for " << stream.table << " with unknown event type");
+			return;
+	}
+	const auto& data=record.GetDynamodb();
+	change.table=stream.table;
+	change.keys=convertItem(data.GetKeys());
+	change.oldImage=convertItem(data.GetOldImage());
+	change.newImage=convertItem(data.GetNewImage());
+
+	changesReceived++;
+	auto delay=std::chrono::milliseconds(Aws::Utils::DateTime::CurrentTimeMillis()
+	                                     -data.GetApproximateCreationDateTime().Millis());
+	if(delay.count()>=0)
+		delays.record(delay);
+
+	try{
+		onChange(change);
+	}catch(std::exception& ex){
+		//the consumer may now be in an inconsistent state, so treat this as
+		//a lost change
+		log_error("Failed to apply change to " << stream.table << ": " << ex.what());
+		gaps++;
+		onGap(stream.table);
+	}
+}
+
+std::string ChangeFeed::getStatistics() const{
+	std::ostringstream os;
+	os << "Change feed: " << changesReceived.load() << " changes received, "
+	   << gaps.load() << " gaps\n";
+	if(delays.count())
+		os << "Change feed delay: " << delays.summary() << "\n";
+	return os.str();
+}
@@ -15,8 +15,11 @@
 #include "yaml-cpp/node/detail/impl.h"
 #include <yaml-cpp/node/parse.h>
 
+#include "ClusterProber.h"
+#include "JobEngine.h"
 #include "KubeInterface.h"
 #include "Logging.h"
+#include "Pagination.h"
 #include "ServerUtilities.h"
 #include "ApplicationInstanceCommands.h"
 #include "SecretCommands.h"
@@ -35,40 +38,66 @@ crow::response listClusters(PersistentStore& store, const crow::request& req){
 		clusters=store.listClustersByGroup(group);
 	else
 		clusters=store.listClusters();
-
-	rapidjson::Document result(rapidjson::kObjectType);
-	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
 	
-	result.AddMember("apiVersion", "v1alpha3", alloc);
-	rapidjson::Value resultItems(rapidjson::kArrayType);
-	resultItems.Reserve(clusters.size(), alloc);
+	static const std::map<std::string,SortKey<Cluster>> sortKeys={
+		{"id",[](const Cluster& c)->const std::string&{ return c.id; }},
+		{"name",[](const Cluster& c)->const std::string&{ return c.name; }},
+		{"owningOrganization",[](const Cluster& c)->const std::string&{ return c.owningOrganization; }},
+	};
+	std::string continueToken;
+	try{
+		continueToken=paginate(clusters,parsePageRequest(req.url_params),sortKeys);
+	}catch(std::runtime_error& err){
+		return crow::response(400,generateError(err.what()));
+	}
+
+	JSONResponseWriter out(64+256*clusters.size());
+	auto& json=out.json();
+	json.StartObject();
+	json.Key("apiVersion");
+	json.String("v1alpha3");
+	json.Key("items");
+	json.StartArray();
 	for(const Cluster& cluster : clusters){
-		rapidjson::Value clusterResult(rapidjson::kObjectType);
-		clusterResult.AddMember("apiVersion", "v1alpha3", alloc);
-		clusterResult.AddMember("kind", "Cluster", alloc);
-		rapidjson::Value clusterData(rapidjson::kObjectType);
-		clusterData.AddMember("id", cluster.id, alloc);
-		clusterData.AddMember("name", cluster.name, alloc);
-		clusterData.AddMember("owningGroup", store.findGroupByID(cluster.owningGroup).name, alloc);
-		clusterData.AddMember("owningOrganization", cluster.owningOrganization, alloc);
-		std::vector<GeoLocation> locations=store.getLocationsForCluster(cluster.id);
-		rapidjson::Value clusterLocation(rapidjson::kArrayType);
-		clusterLocation.Reserve(locations.size(), alloc);
-		for(const auto& location : locations){
-			rapidjson::Value entry(rapidjson::kObjectType);
-			entry.AddMember("lat",location.lat, alloc);
-			entry.AddMember("lon",location.lon, alloc);
-			clusterLocation.PushBack(entry, alloc);
+		json.StartObject();
+		json.Key("apiVersion");
+		json.String("v1alpha3");
+		json.Key("kind");
+		json.String("Cluster");
+		json.Key("metadata");
+		json.StartObject();
+		json.Key("id");
+		json.String(cluster.id);
+		json.Key("name");
+		json.String(cluster.name);
+		json.Key("owningGroup");
+		json.String(store.findGroupByID(cluster.owningGroup).name);
+		json.Key("owningOrganization");
+		json.String(cluster.owningOrganization);
+		json.Key("location");
+		json.StartArray();
+		for(const auto& location : store.getLocationsForCluster(cluster.id)){
+			json.StartObject();
+			json.Key("lat");
+			json.Double(location.lat);
+			json.Key("lon");
+			json.Double(location.lon);
+			json.EndObject();
 		}
-		clusterData.AddMember("location", clusterLocation, alloc);
-		clusterResult.AddMember("metadata", clusterData, alloc);
-		resultItems.PushBack(clusterResult, alloc);
+		json.EndArray();
+		json.EndObject();
+		json.EndObject();
 	}
-	result.AddMember("items", resultItems, alloc);
+	json.EndArray();
+	if(!continueToken.empty()){
+		json.Key("continue");
+		json.String(continueToken);
+	}
+	json.EndObject();
 
 	high_resolution_clock::time_point t2 = high_resolution_clock::now();
 	log_info("cluster listing completed in " << duration_cast<duration<double>>(t2-t1).count() << " seconds");
-	return crow::response(to_string(result));
+	return conditionalResponse(req,out.response());
 }
 
 namespace internal{
@@ -642,6 +671,7 @@ crow::response deleteCluster(PersistentStore& store, const crow::request& req,
 namespace internal{
 std::string deleteCluster(PersistentStore& store, const Cluster& cluster, bool force){
 	// Delete any remaining instances that are present on the cluster
+	JobEngine::reportProgress("Deleting application instances");
 	auto configPath=store.configPathForCluster(cluster.id);
 	auto instances=store.listApplicationInstances();
 	for (const ApplicationInstance& instance : instances){
@@ -656,6 +686,7 @@ std::string deleteCluster(PersistentStore& store, const Cluster& cluster, bool f
 	std::vector<std::future<void>> namespaceDeletions;
 	
 	// Delete any remaining secrets present on the cluster
+	JobEngine::reportProgress("Deleting secrets");
 	auto secrets=store.listSecrets("",cluster.id);
 	for (const Secret& secret : secrets){
 		//std::string result=internal::deleteSecret(store,secret,/*force*/true);
@@ -673,6 +704,7 @@ std::string deleteCluster(PersistentStore& store, const Cluster& cluster, bool f
 
 	// Delete namespaces remaining on the cluster
 	log_info("Deleting namespaces on cluster " << cluster.id);
+	JobEngine::reportProgress("Deleting namespaces");
 	auto vos = store.listGroups();
 	for (const Group& group : vos){
 		namespaceDeletions.emplace_back(std::async(std::launch::async,[&cluster,&configPath,group](){
@@ -687,8 +719,10 @@ std::string deleteCluster(PersistentStore& store, const Cluster& cluster, bool f
 	}
 	for(auto& item : namespaceDeletions)
 		item.wait();
+	kubernetes::forgetNamespaces(*configPath);
 	
 	// Delete our DNS record for the cluster
+	JobEngine::reportProgress("Removing DNS record");
 	auto dnsName="*."+store.dnsNameForCluster(cluster);
 	if(store.canUpdateDNS()){
 		Aws::Route53::Model::RRType type=Aws::Route53::Model::RRType::A;
@@ -818,6 +852,8 @@ crow::response updateCluster(PersistentStore& store, const crow::request& req,
 	#warning TODO: after updating config we should re-perform contact and helm initialization
 	
 	if(updateConfig){
+		if(ClusterProber* prober=store.getClusterProber())
+			prober->probeSoon(cluster.id);
 		std::string resultMessage;
 		try{
 			resultMessage=internal::ensureClusterSetup(store,cluster);
@@ -1123,8 +1159,12 @@ ClusterConsistencyResult::ClusterConsistencyResult(PersistentStore& store, const
 	
 	status=ClusterConsistencyState::Consistent;
 	
-	//check that the cluster can be reached
-	if(!internal::pingCluster(store, cluster)){
+	//check that the cluster can be reached, relying on the background prober 
+	//if it has a current answer
+	CacheRecord<bool> reachability;
+	if(store.getClusterProber())
+		reachability=store.getCachedClusterReachability(cluster.id);
+	if(reachability ? !reachability.record : !internal::pingCluster(store, cluster)){
 		status=ClusterConsistencyState::Unreachable;
 		return;
 	}
@@ -1284,7 +1324,9 @@ crow::response pingCluster(PersistentStore& store, const crow::request& req,
 	if(!cluster)
 		return crow::response(404,generateError("Cluster not found"));
 		
-	bool useCache=req.url_params.get("cache");
+	//when clusters are probed in the background the cached result is current, 
+	//so there is no need to wait for the cluster
+	bool useCache=req.url_params.get("cache") || store.getClusterProber();
 	
 	CacheRecord<bool> cacheResult;
 	if(useCache)
@@ -0,0 +1,193 @@
+#include "ClusterProber.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "Logging.h"
+#include "PersistentStore.h"
+
+namespace{
+	///How often to check whether any probes have come due
+	const std::chrono::seconds tickInterval(1);
+}
+
+ClusterProber::ClusterProber(PersistentStore& store, std::function<bool(const Cluster&)> probe,
+                             Schedule schedule):
+store(store),
+probe(std::move(probe)),
+schedule(schedule),
+stopRequested(false){
+	if(!this->schedule.maxConcurrent)
+		throw std::logic_error("At least one concurrent cluster probe must be allowed");
+}
+
+ClusterProber::~ClusterProber(){
+	stop();
+}
+
+void ClusterProber::start(){
+	stop();
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopRequested=false;
+	}
+	worker=std::thread(&ClusterProber::run,this);
+}
+
+void ClusterProber::stop(){
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopRequested=true;
+	}
+	workerCondition.notify_all();
+	if(worker.joinable())
+		worker.join();
+}
+
+void ClusterProber::probeSoon(const std::string& cID){
+	std::lock_guard<std::mutex> lock(stateMutex);
+	auto it=clusters.find(cID);
+	//clusters not yet known will be probed as soon as they are listed
+	if(it!=clusters.end())
+		it->second.nextProbe=std::min(it->second.nextProbe,
+		                              std::chrono::steady_clock::now()+schedule.afterChange);
+}
+
+void ClusterProber::run(){
+	std::unique_lock<std::mutex> lock(stateMutex);
+	while(!stopRequested){
+		lock.unlock();
+		try{
+			startDueProbes();
+		}catch(std::exception& ex){
+			log_error("Failed to schedule cluster probes: " << ex.what());
+		}
+		lock.lock();
+		workerCondition.wait_for(lock,tickInterval,[this]{ return stopRequested; });
+	}
+	//let probes in progress finish, since they refer to this object
+	std::vector<std::future<void>> unfinished;
+	std::swap(unfinished,pending);
+	lock.unlock();
+	for(auto& task : unfinished)
+		task.wait();
+}
+
+void ClusterProber::startDueProbes(){
+	//this may need to query the database, so do it before locking
+	std::vector<Cluster> current=store.listClusters();
+
+	std::lock_guard<std::mutex> lock(stateMutex);
+	const auto now=std::chrono::steady_clock::now();
+	std::hash<std::string> hasher;
+	std::set<std::string> listed;
+	for(const Cluster& cluster : current){
+		listed.insert(cluster.id);
+		const std::size_t configHash=hasher(cluster.config);
+		auto it=clusters.find(cluster.id);
+		if(it==clusters.end()){
+			ClusterState state;
+			state.name=cluster.name;
+			state.configHash=configHash;
+			state.nextProbe=now;
+			state.probed=false;
+			state.reachable=false;
+			state.failures=0;
+			state.inProgress=false;
+			state.latency.reset(new LatencyHistogram);
+			clusters.emplace(cluster.id,std::move(state));
+			continue;
+		}
+		ClusterState& state=it->second;
+		state.name=cluster.name;
+		if(state.configHash!=configHash){
+			state.configHash=configHash;
+			state.nextProbe=std::min(state.nextProbe,now+schedule.afterChange);
+		}
+	}
+	//forget clusters which have been deleted
+	for(auto it=clusters.begin(); it!=clusters.end();){
+		if(!listed.count(it->first) && !it->second.inProgress)
+			it=clusters.erase(it);
+		else
+			++it;
+	}
+	//discard the results of finished probes
+	pending.erase(std::remove_if(pending.begin(),pending.end(),[](const std::future<void>& task){
+		return task.wait_for(std::chrono::seconds(0))==std::future_status::ready;
+	}),pending.end());
+
+	std::size_t running=std::count_if(clusters.begin(),clusters.end(),
+	  [](const std::pair<const std::string,ClusterState>& entry){ return entry.second.inProgress; });
+	for(const Cluster& cluster : current){
+		if(running>=schedule.maxConcurrent)
+			break;
+		ClusterState& state=clusters.find(cluster.id)->second;
+		if(state.inProgress || state.nextProbe>now)
+			continue;
+		state.inProgress=true;
+		running++;
+		pending.push_back(std::async(std::launch::async,&ClusterProber::probeCluster,this,cluster));
+	}
+}
+
+void ClusterProber::probeCluster(Cluster cluster){
+	using namespace std::chrono;
+	const auto start=steady_clock::now();
+	bool reachable=false;
+	try{
+		reachable=probe(cluster);
+	}catch(std::exception& ex){
+		log_error("Failed to probe " << cluster << ": " << ex.what());
+	}
+	const auto end=steady_clock::now();
+	store.cacheClusterReachability(cluster.id,reachable);
+
+	std::lock_guard<std::mutex> lock(stateMutex);
+	auto it=clusters.find(cluster.id);
+	if(it==clusters.end())
+		return;
+	ClusterState& state=it->second;
+	state.latency->record(end-start);
+	const bool changed=state.probed && state.reachable!=reachable;
+	state.probed=true;
+	state.reachable=reachable;
+	state.inProgress=false;
+	if(reachable){
+		state.failures=0;
+		state.nextProbe=end+schedule.interval;
+	}
+	else{
+		state.failures++;
+		//back off exponentially, taking care not to overflow
+		seconds delay=schedule.maxBackoff;
+		if(state.failures<16)
+			delay=std::min(delay,schedule.interval*(1u<<(state.failures-1)));
+		state.nextProbe=end+delay;
+	}
+	//confirm a change of state promptly
+	if(changed){
+		log_info(cluster << " has become " << (reachable ? "reachable" : "unreachable"));
+		state.nextProbe=std::min(state.nextProbe,end+schedule.afterChange);
+	}
+}
+
+std::string ClusterProber::getStatistics() const{
+	std::ostringstream os;
+	std::lock_guard<std::mutex> lock(stateMutex);
+	for(const auto& entry : clusters){
+		const ClusterState& state=entry.second;
+		os << "Cluster " << state.name << " (" << entry.first << "): ";
+		if(!state.probed)
+			os << "not yet probed";
+		else{
+			os << (state.reachable ? "reachable" : "unreachable");
+			if(state.failures)
+				os << " (" << state.failures << " consecutive failed probes)";
+		}
+		if(state.latency->count())
+			os << ", probe time: " << state.latency->summary();
+		os << '\n';
+	}
+	return os.str();
+}
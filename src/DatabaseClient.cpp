@@ -0,0 +1,186 @@
+#include "DatabaseClient.h"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+#include <aws/dynamodb/model/BatchWriteItemRequest.h>
+#include <aws/dynamodb/model/CreateTableRequest.h>
+#include <aws/dynamodb/model/DeleteItemRequest.h>
+#include <aws/dynamodb/model/DeleteTableRequest.h>
+#include <aws/dynamodb/model/DescribeTableRequest.h>
+#include <aws/dynamodb/model/DescribeTimeToLiveRequest.h>
+#include <aws/dynamodb/model/GetItemRequest.h>
+#include <aws/dynamodb/model/PutItemRequest.h>
+#include <aws/dynamodb/model/QueryRequest.h>
+#include <aws/dynamodb/model/ScanRequest.h>
+#include <aws/dynamodb/model/UpdateItemRequest.h>
+#include <aws/dynamodb/model/UpdateTableRequest.h>
+#include <aws/dynamodb/model/UpdateTimeToLiveRequest.h>
+
+#include "Metrics.h"
+#include "Tracing.h"
+
+JitteredRetryStrategy::JitteredRetryStrategy(long maxRetries, long baseDelay, long maxDelay):
+maxRetries(maxRetries),baseDelay(std::max(baseDelay,1L)),maxDelay(std::max(maxDelay,1L)),
+retryCount(0){}
+
+bool JitteredRetryStrategy::ShouldRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+                                        long attemptedRetries) const{
+	if(attemptedRetries>=maxRetries || !error.ShouldRetry())
+		return false;
+	retryCount++;
+	return true;
+}
+
+long JitteredRetryStrategy::CalculateDelayBeforeNextRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+                                                          long attemptedRetries) const{
+	//compute the limit without overflowing for large numbers of attempts
+	long limit=baseDelay;
+	for(long i=0; i<attemptedRetries && limit<maxDelay; i++)
+		limit*=2;
+	limit=std::min(limit,maxDelay);
+	thread_local std::mt19937 rng(std::random_device{}());
+	return std::uniform_int_distribution<long>(0,limit)(rng);
+}
+
+DatabaseClient::DatabaseClient(const Aws::Auth::AWSCredentials& credentials,
+                               const Aws::Client::ClientConfiguration& clientConfig):
+client(credentials,clientConfig),
+retryStrategy(std::dynamic_pointer_cast<const JitteredRetryStrategy>(clientConfig.retryStrategy)){}
+
+using namespace Aws::DynamoDB::Model;
+using Aws::DynamoDB::DynamoDBClient;
+
+BatchWriteItemOutcome DatabaseClient::BatchWriteItem(const BatchWriteItemRequest& request) const{
+	return timed(Operation::BatchWriteItem,&DynamoDBClient::BatchWriteItem,request);
+}
+
+CreateTableOutcome DatabaseClient::CreateTable(const CreateTableRequest& request) const{
+	return timed(Operation::CreateTable,&DynamoDBClient::CreateTable,request);
+}
+
+DeleteItemOutcome DatabaseClient::DeleteItem(const DeleteItemRequest& request) const{
+	return timed(Operation::DeleteItem,&DynamoDBClient::DeleteItem,request);
+}
+
+DeleteTableOutcome DatabaseClient::DeleteTable(const DeleteTableRequest& request) const{
+	return timed(Operation::DeleteTable,&DynamoDBClient::DeleteTable,request);
+}
+
+DescribeTableOutcome DatabaseClient::DescribeTable(const DescribeTableRequest& request) const{
+	return timed(Operation::DescribeTable,&DynamoDBClient::DescribeTable,request);
+}
+
+DescribeTimeToLiveOutcome DatabaseClient::DescribeTimeToLive(const DescribeTimeToLiveRequest& request) const{
+	return timed(Operation::DescribeTimeToLive,&DynamoDBClient::DescribeTimeToLive,request);
+}
+
+GetItemOutcome DatabaseClient::GetItem(const GetItemRequest& request) const{
+	return timed(Operation::GetItem,&DynamoDBClient::GetItem,request);
+}
+
+PutItemOutcome DatabaseClient::PutItem(const PutItemRequest& request) const{
+	return timed(Operation::PutItem,&DynamoDBClient::PutItem,request);
+}
+
+QueryOutcome DatabaseClient::Query(const QueryRequest& request) const{
+	return timed(Operation::Query,&DynamoDBClient::Query,request);
+}
+
+ScanOutcome DatabaseClient::Scan(const ScanRequest& request) const{
+	return timed(Operation::Scan,&DynamoDBClient::Scan,request);
+}
+
+UpdateItemOutcome DatabaseClient::UpdateItem(const UpdateItemRequest& request) const{
+	return timed(Operation::UpdateItem,&DynamoDBClient::UpdateItem,request);
+}
+
+UpdateTableOutcome DatabaseClient::UpdateTable(const UpdateTableRequest& request) const{
+	return timed(Operation::UpdateTable,&DynamoDBClient::UpdateTable,request);
+}
+
+UpdateTimeToLiveOutcome DatabaseClient::UpdateTimeToLive(const UpdateTimeToLiveRequest& request) const{
+	return timed(Operation::UpdateTimeToLive,&DynamoDBClient::UpdateTimeToLive,request);
+}
+
+std::future<GetItemOutcome> DatabaseClient::GetItemCallable(const GetItemRequest& request) const{
+	auto result=std::make_shared<std::promise<GetItemOutcome>>();
+	auto start=std::chrono::steady_clock::now();
+	LatencyHistogram& histogram=latencies[(std::size_t)Operation::GetItem];
+	//the outcome arrives on another thread, so the trace must be carried to it
+	auto trace=tracing::current();
+	client.GetItemAsync(request,
+	  [result,start,&histogram,trace](const DynamoDBClient*, const GetItemRequest&, const GetItemOutcome& outcome,
+	                                  const std::shared_ptr<const Aws::Client::AsyncCallerContext>&){
+		const auto duration=std::chrono::steady_clock::now()-start;
+		histogram.record(duration);
+		if(trace)
+			trace->record("dynamodb","GetItem",start,duration);
+		result->set_value(outcome);
+	});
+	return result->get_future();
+}
+
+std::future<QueryOutcome> DatabaseClient::QueryCallable(const QueryRequest& request) const{
+	auto result=std::make_shared<std::promise<QueryOutcome>>();
+	auto start=std::chrono::steady_clock::now();
+	LatencyHistogram& histogram=latencies[(std::size_t)Operation::Query];
+	//the outcome arrives on another thread, so the trace must be carried to it
+	auto trace=tracing::current();
+	client.QueryAsync(request,
+	  [result,start,&histogram,trace](const DynamoDBClient*, const QueryRequest&, const QueryOutcome& outcome,
+	                                  const std::shared_ptr<const Aws::Client::AsyncCallerContext>&){
+		const auto duration=std::chrono::steady_clock::now()-start;
+		histogram.record(duration);
+		if(trace)
+			trace->record("dynamodb","Query",start,duration);
+		result->set_value(outcome);
+	});
+	return result->get_future();
+}
+
+const char* DatabaseClient::operationName(Operation op){
+	switch(op){
+		case Operation::BatchWriteItem: return "BatchWriteItem";
+		case Operation::CreateTable: return "CreateTable";
+		case Operation::DeleteItem: return "DeleteItem";
+		case Operation::DeleteTable: return "DeleteTable";
+		case Operation::DescribeTable: return "DescribeTable";
+		case Operation::DescribeTimeToLive: return "DescribeTimeToLive";
+		case Operation::GetItem: return "GetItem";
+		case Operation::PutItem: return "PutItem";
+		case Operation::Query: return "Query";
+		case Operation::Scan: return "Scan";
+		case Operation::UpdateItem: return "UpdateItem";
+		case Operation::UpdateTable: return "UpdateTable";
+		case Operation::UpdateTimeToLive: return "UpdateTimeToLive";
+		default: return "Unknown";
+	}
+}
+
+std::string DatabaseClient::getStatistics() const{
+	std::ostringstream os;
+	for(std::size_t i=0; i<(std::size_t)Operation::Count; i++){
+		if(!latencies[i].count())
+			continue;
+		os << "Database " << operationName((Operation)i) << " latency: "
+		   << latencies[i].summary() << "\n";
+	}
+	if(retryStrategy)
+		os << "Database request retries: " << retryStrategy->retries() << "\n";
+	return os.str();
+}
+
+void DatabaseClient::writeMetrics(std::ostream& os) const{
+	const std::string name="slate_dynamodb_operation_duration_seconds";
+	metrics::writeHeader(os,name,"histogram","Time taken by DynamoDB operations, including retries");
+	for(std::size_t i=0; i<(std::size_t)Operation::Count; i++){
+		if(latencies[i].count())
+			metrics::writeHistogram(os,name,{{"operation",operationName((Operation)i)}},latencies[i]);
+	}
+	if(retryStrategy){
+		metrics::writeHeader(os,"slate_dynamodb_retries_total","counter","Number of DynamoDB requests retried");
+		metrics::writeSample(os,"slate_dynamodb_retries_total",{},retryStrategy->retries());
+	}
+}
@@ -85,6 +85,12 @@ std::ostream& operator<<(std::ostream& os, const Secret& s){
 	return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const Job& j){
+	if(!j)
+		return os << "invalid job";
+	return os << j.id << " (" << j.kind << ')';
+}
+
 std::ostream& operator<<(std::ostream& os, const GeoLocation& gl){
 	os << gl.lat << ',' << gl.lon;
 	if(!gl.description.empty())
@@ -143,6 +149,7 @@ const std::string IDGenerator::clusterIDPrefix="cluster_";
 const std::string IDGenerator::groupIDPrefix="group_";
 const std::string IDGenerator::instanceIDPrefix="instance_";
 const std::string IDGenerator::secretIDPrefix="secret_";
+const std::string IDGenerator::jobIDPrefix="job_";
 
 std::string IDGenerator::generateRawID(){
 	uint64_t value;
@@ -7,7 +7,9 @@
 #include "rapidjson/stringbuffer.h"
 
 #include "Logging.h"
+#include "Pagination.h"
 #include "ServerUtilities.h"
+#include "JobEngine.h"
 #include "KubeInterface.h"
 #include "ApplicationInstanceCommands.h"
 #include "ClusterCommands.h"
@@ -115,33 +117,59 @@ crow::response listGroups(PersistentStore& store, const crow::request& req){
 		vos=store.listGroupsForUser(user.id);
 	else
 		vos=store.listGroups();
-
-	rapidjson::Document result(rapidjson::kObjectType);
-	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
 	
-	result.AddMember("apiVersion", "v1alpha3", alloc);
-	rapidjson::Value resultItems(rapidjson::kArrayType);
-	resultItems.Reserve(vos.size(), alloc);
-	for (const Group& group : vos){
-		rapidjson::Value metadata(rapidjson::kObjectType);
-		metadata.AddMember("id", rapidjson::StringRef(group.id.c_str()), alloc);
-		metadata.AddMember("name", rapidjson::StringRef(group.name.c_str()), alloc);
-		metadata.AddMember("email", rapidjson::StringRef(group.email.c_str()), alloc);
-		metadata.AddMember("phone", rapidjson::StringRef(group.phone.c_str()), alloc);
-		metadata.AddMember("scienceField", rapidjson::StringRef(group.scienceField.c_str()), alloc);
-		metadata.AddMember("description", rapidjson::StringRef(group.description.c_str()), alloc);
+	static const std::map<std::string,SortKey<Group>> sortKeys={
+		{"id",[](const Group& g)->const std::string&{ return g.id; }},
+		{"name",[](const Group& g)->const std::string&{ return g.name; }},
+		{"scienceField",[](const Group& g)->const std::string&{ return g.scienceField; }},
+	};
+	std::string continueToken;
+	try{
+		continueToken=paginate(vos,parsePageRequest(req.url_params),sortKeys);
+	}catch(std::runtime_error& err){
+		return crow::response(400,generateError(err.what()));
+	}
 
-		rapidjson::Value groupResult(rapidjson::kObjectType);
-		groupResult.AddMember("apiVersion", "v1alpha3", alloc);
-		groupResult.AddMember("kind", "Group", alloc);
-		groupResult.AddMember("metadata", metadata, alloc);
-		resultItems.PushBack(groupResult, alloc);
+	JSONResponseWriter out(64+320*vos.size());
+	auto& json=out.json();
+	json.StartObject();
+	json.Key("apiVersion");
+	json.String("v1alpha3");
+	json.Key("items");
+	json.StartArray();
+	for (const Group& group : vos){
+		json.StartObject();
+		json.Key("apiVersion");
+		json.String("v1alpha3");
+		json.Key("kind");
+		json.String("Group");
+		json.Key("metadata");
+		json.StartObject();
+		json.Key("id");
+		json.String(group.id);
+		json.Key("name");
+		json.String(group.name);
+		json.Key("email");
+		json.String(group.email);
+		json.Key("phone");
+		json.String(group.phone);
+		json.Key("scienceField");
+		json.String(group.scienceField);
+		json.Key("description");
+		json.String(group.description);
+		json.EndObject();
+		json.EndObject();
 	}
-	result.AddMember("items", resultItems, alloc);
+	json.EndArray();
+	if(!continueToken.empty()){
+		json.Key("continue");
+		json.String(continueToken);
+	}
+	json.EndObject();
 	
 	high_resolution_clock::time_point t2 = high_resolution_clock::now();
 	log_info("group listing completed in " << duration_cast<duration<double>>(t2-t1).count() << " seconds");
-	return crow::response(to_string(result));
+	return out.response();
 }
 
 crow::response createGroup(PersistentStore& store, const crow::request& req){
@@ -388,6 +416,7 @@ crow::response deleteGroup(PersistentStore& store, const crow::request& req, con
 	
 	std::vector<std::future<void>> work;
 	
+	JobEngine::reportProgress("Deleting application instances, secrets, and namespaces");
 	// Remove all instances owned by the group
 	for(auto& instance : store.listApplicationInstancesByClusterOrGroup(targetGroup.id,""))
 		work.emplace_back(std::async(std::launch::async,[&store,instance](){ internal::deleteApplicationInstance(store,instance,true); }));
@@ -417,6 +446,7 @@ crow::response deleteGroup(PersistentStore& store, const crow::request& req, con
 	work.clear();
 	
 	// Remove all clusters owned by the group
+	JobEngine::reportProgress("Deleting clusters");
 	for(auto& cluster : cluster_names){
 		if(cluster.owningGroup==targetGroup.id)
 			work.emplace_back(std::async(std::launch::async,[&store,cluster](){
@@ -5,6 +5,8 @@
 #include <sstream>
 #include <string>
 
+#include <strings.h> //strncasecmp
+
 #include <curl/curl.h>
 
 #include "HTTPRequests.h"
@@ -19,6 +21,11 @@ struct CurlOutputData{
 	std::string output;
 	///Context information to be included in messages if an error occurs
 	std::string context;
+	///If set, the function to which data from a successful response should 
+	///be passed, instead of being collected in output
+	const std::function<bool(const char*,std::size_t)>* sink;
+	///The session whose status is checked before passing data to sink
+	CURL* session;
 };
 
 ///Helper data used for sending input data to libcurl
@@ -45,7 +52,14 @@ size_t collectCurlOutput(void* buffer, size_t size, size_t nmemb, void* userp){
 	CurlOutputData& data=*static_cast<CurlOutputData*>(userp);
 	//curl can't tolerate exceptions, so stop them and log them to stderr here
 	try{
-		data.output.append((char*)buffer,size*nmemb);
+		long status=0;
+		if(data.sink && curl_easy_getinfo(data.session,CURLINFO_RESPONSE_CODE,&status)==CURLE_OK
+		   && status>=200 && status<300){
+			if(!(*data.sink)((const char*)buffer,size*nmemb))
+				return(size*nmemb?0:1); //return a different number to stop the transfer
+		}
+		else
+			data.output.append((char*)buffer,size*nmemb);
 	}catch(std::exception& ex){
 		std::cerr << data.context << " Exception thrown while collecting output: " 
 		  << ex.what() << std::endl;
@@ -57,6 +71,27 @@ size_t collectCurlOutput(void* buffer, size_t size, size_t nmemb, void* userp){
 	return(size*nmemb);//return full size to indicate success
 }
 
+///Callback function for collecting response headers from libcurl, and only to be called by libcurl. 
+///Currently only the ETag header is retained. 
+///See https://curl.haxx.se/libcurl/c/CURLOPT_HEADERFUNCTION.html
+///\param buffer the header line being provided by libcurl
+///\param size the number of 'items' in the available data
+///\param nitems the size of each 'item' of available data
+///\param userp pointer to a string where the ETag should be stored
+size_t collectCurlHeader(char* buffer, size_t size, size_t nitems, void* userp){
+	std::string& etag=*static_cast<std::string*>(userp);
+	const size_t length=size*nitems;
+	const static std::string name="etag:";
+	if(length>name.size() && strncasecmp(buffer,name.c_str(),name.size())==0){
+		std::string value(buffer+name.size(),length-name.size());
+		auto start=value.find_first_not_of(" \t");
+		auto end=value.find_last_not_of(" \t\r\n");
+		if(start!=std::string::npos)
+			etag=value.substr(start,end-start+1);
+	}
+	return length;
+}
+
 ///Callback function for sending data to libcurl, and only to be called by libcurl. 
 ///See https://curl.haxx.se/libcurl/c/CURLOPT_READFUNCTION.html
 ///\param buffer the location to which data is to be written
@@ -114,6 +149,31 @@ Response httpGet(const std::string& url, const Options& options){
 	err=curl_easy_setopt(curlSession.get(), CURLOPT_WRITEDATA, &data);
 	if(err!=CURLE_OK)
 		detail::reportCurlError("Failed to set curl output callback data",err,errBuf.get());
+	if(options.outputSink){
+		data.sink=&options.outputSink;
+		data.session=curlSession.get();
+	}
+	std::string etag;
+	err=curl_easy_setopt(curlSession.get(), CURLOPT_HEADERFUNCTION, detail::collectCurlHeader);
+	if(err!=CURLE_OK)
+		reportCurlError("Failed to set curl header callback",err,errBuf.get());
+	err=curl_easy_setopt(curlSession.get(), CURLOPT_HEADERDATA, &etag);
+	if(err!=CURLE_OK)
+		reportCurlError("Failed to set curl header callback data",err,errBuf.get());
+	std::unique_ptr<curl_slist,void (*)(curl_slist*)> headerList(nullptr,curl_slist_free_all);
+	if(!options.ifNoneMatch.empty()){
+		headerList.reset(curl_slist_append(headerList.release(),("If-None-Match: "+options.ifNoneMatch).c_str()));
+		err=curl_easy_setopt(curlSession.get(), CURLOPT_HTTPHEADER, headerList.get());
+		if(err!=CURLE_OK)
+			reportCurlError("Failed to set request headers",err,errBuf.get());
+	}
+	if(options.acceptCompression){
+		//an empty string requests all encodings curl supports, which it will
+		//then decode transparently
+		err=curl_easy_setopt(curlSession.get(), CURLOPT_ACCEPT_ENCODING, "");
+		if(err!=CURLE_OK)
+			reportCurlError("Failed to set curl accepted encodings",err,errBuf.get());
+	}
 	if(!options.caBundlePath.empty()){
 		err=curl_easy_setopt(curlSession.get(), CURLOPT_CAINFO, options.caBundlePath.c_str());
 		if(err!=CURLE_OK)
@@ -129,7 +189,7 @@ Response httpGet(const std::string& url, const Options& options){
 		detail::reportCurlError("Failed to get HTTP response code from curl",err,errBuf.get());
 	assert(code>=0);
 		
-	return Response{(unsigned int)code,data.output};
+	return Response{(unsigned int)code,data.output,etag};
 }
 
 Response httpDelete(const std::string& url, const Options& options){
@@ -156,6 +216,13 @@ Response httpDelete(const std::string& url, const Options& options){
 	err=curl_easy_setopt(curlSession.get(), CURLOPT_WRITEDATA, &data);
 	if(err!=CURLE_OK)
 		reportCurlError("Failed to set curl output callback data",err,errBuf.get());
+	if(options.acceptCompression){
+		//an empty string requests all encodings curl supports, which it will
+		//then decode transparently
+		err=curl_easy_setopt(curlSession.get(), CURLOPT_ACCEPT_ENCODING, "");
+		if(err!=CURLE_OK)
+			reportCurlError("Failed to set curl accepted encodings",err,errBuf.get());
+	}
 	if(!options.caBundlePath.empty()){
 		err=curl_easy_setopt(curlSession.get(), CURLOPT_CAINFO, options.caBundlePath.c_str());
 		if(err!=CURLE_OK)
@@ -215,6 +282,13 @@ Response httpPut(const std::string& url, const std::string& body,
 	err=curl_easy_setopt(curlSession.get(), CURLOPT_HTTPHEADER, headerList.get());
 	if(err!=CURLE_OK)
 		reportCurlError("Failed to set request headers",err,errBuf.get());
+	if(options.acceptCompression){
+		//an empty string requests all encodings curl supports, which it will
+		//then decode transparently
+		err=curl_easy_setopt(curlSession.get(), CURLOPT_ACCEPT_ENCODING, "");
+		if(err!=CURLE_OK)
+			reportCurlError("Failed to set curl accepted encodings",err,errBuf.get());
+	}
 	if(!options.caBundlePath.empty()){
 		err=curl_easy_setopt(curlSession.get(), CURLOPT_CAINFO, options.caBundlePath.c_str());
 		if(err!=CURLE_OK)
@@ -268,6 +342,13 @@ Response httpPost(const std::string& url, const std::string& body,
 	err=curl_easy_setopt(curlSession.get(), CURLOPT_HTTPHEADER, headerList.get());
 	if(err!=CURLE_OK)
 		reportCurlError("Failed to set request headers",err,errBuf.get());
+	if(options.acceptCompression){
+		//an empty string requests all encodings curl supports, which it will
+		//then decode transparently
+		err=curl_easy_setopt(curlSession.get(), CURLOPT_ACCEPT_ENCODING, "");
+		if(err!=CURLE_OK)
+			reportCurlError("Failed to set curl accepted encodings",err,errBuf.get());
+	}
 	if(!options.caBundlePath.empty()){
 		err=curl_easy_setopt(curlSession.get(), CURLOPT_CAINFO, options.caBundlePath.c_str());
 		if(err!=CURLE_OK)
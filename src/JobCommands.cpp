@@ -0,0 +1,91 @@
+#include "JobCommands.h"
+
+#include <memory>
+
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "Logging.h"
+#include "ServerUtilities.h"
+#include "Tracing.h"
+
+crow::response runAsJob(PersistentStore& store, JobEngine& jobs, const crow::request& req,
+                        const std::string& kind, const std::function<std::string()>& findCluster,
+                        std::function<crow::response(const crow::request&)> handler){
+	//older clients expect the outcome of the operation in the response
+	if(!req.url_params.get("async"))
+		return handler(req);
+
+	const User user=authenticateUser(store, req.url_params.get("token"));
+	log_info(user << " requested to run " << kind << " as a job from " << req.remote_endpoint);
+	if(!user)
+		return crow::response(403,generateError("Not authorized"));
+
+	//the original request belongs to its connection, which will be gone by
+	//the time the job runs
+	auto jobRequest=std::make_shared<crow::request>(req);
+	jobRequest->middleware_context=nullptr;
+	jobRequest->io_service=nullptr;
+	//the work done by the job belongs to the request's trace, if any, which 
+	//is written out once the job has finished with it
+	auto trace=tracing::current();
+	Job job=jobs.submit(kind,user,findCluster(),[jobRequest,handler,trace,kind]{
+		tracing::Scope scope(trace);
+		tracing::Span span("job",kind);
+		return handler(*jobRequest);
+	});
+	if(!job)
+		return crow::response(503,generateError("Too many operations are in progress; try again later"));
+
+	rapidjson::Document result(rapidjson::kObjectType);
+	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
+
+	result.AddMember("apiVersion", "v1alpha3", alloc);
+	result.AddMember("kind", "Job", alloc);
+	rapidjson::Value metadata(rapidjson::kObjectType);
+	metadata.AddMember("id", job.id, alloc);
+	metadata.AddMember("status", job.status, alloc);
+	result.AddMember("metadata", metadata, alloc);
+
+	crow::response resp(202,to_string(result));
+	resp.add_header("Location","/v1alpha3/jobs/"+job.id);
+	return resp;
+}
+
+crow::response getJob(PersistentStore& store, const crow::request& req,
+                      const std::string& jobID){
+	const User user=authenticateUser(store, req.url_params.get("token"));
+	log_info(user << " requested to get job " << jobID << " from " << req.remote_endpoint);
+	if(!user)
+		return crow::response(403,generateError("Not authorized"));
+
+	Job job=store.getJob(jobID);
+	if(!job)
+		return crow::response(404,generateError("Job not found"));
+	//only admins and the user who started a job may see it
+	if(!user.admin && job.owner!=user.id)
+		return crow::response(403,generateError("Not authorized"));
+
+	rapidjson::Document result(rapidjson::kObjectType);
+	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
+
+	result.AddMember("apiVersion", "v1alpha3", alloc);
+	result.AddMember("kind", "Job", alloc);
+	rapidjson::Value metadata(rapidjson::kObjectType);
+	metadata.AddMember("id", job.id, alloc);
+	metadata.AddMember("kind", job.kind, alloc);
+	metadata.AddMember("status", job.status, alloc);
+	metadata.AddMember("progress", job.progress, alloc);
+	metadata.AddMember("created", job.ctime, alloc);
+	metadata.AddMember("updated", job.mtime, alloc);
+	result.AddMember("metadata", metadata, alloc);
+	if(job.finished()){
+		//the result is passed on verbatim, as the body of the response which
+		//the operation would have produced
+		result.AddMember("resultCode", job.resultCode, alloc);
+		result.AddMember("result", job.result, alloc);
+	}
+
+	return crow::response(to_string(result));
+}
@@ -0,0 +1,262 @@
+#include "JobEngine.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "Logging.h"
+#include "Metrics.h"
+#include "PersistentStore.h"
+#include "ServerUtilities.h"
+
+namespace{
+	///The engine running the job on this thread, if any
+	thread_local JobEngine* currentEngine=nullptr;
+	///The job running on this thread, if any
+	thread_local Job* currentJob=nullptr;
+}
+
+JobEngine::JobEngine(PersistentStore& store, Limits limits,
+                     std::chrono::seconds heartbeatInterval):
+store(store),
+limits(limits),
+heartbeatInterval(heartbeatInterval),
+stopRequested(false),
+jobsSubmitted(0),
+jobsRejected(0),
+jobsSucceeded(0),
+jobsFailed(0),
+jobsRunning(0),
+jobsAbandoned(0){
+	if(!this->limits.maxConcurrent || !this->limits.maxPerCluster)
+		throw std::logic_error("At least one job must be allowed to run at a time");
+	if(heartbeatInterval.count()<=0)
+		throw std::logic_error("The job heartbeat interval must be positive");
+	for(unsigned int i=0; i<this->limits.maxConcurrent; i++)
+		workers.emplace_back(&JobEngine::work,this);
+	monitor=std::thread(&JobEngine::monitorJobs,this);
+}
+
+JobEngine::~JobEngine(){
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopRequested=true;
+	}
+	queueCondition.notify_all();
+	monitorCondition.notify_all();
+	monitor.join();
+	for(auto& worker : workers)
+		worker.join();
+	//nothing will now run the jobs still waiting, so their clients should
+	//not wait for them
+	for(Task& task : queue){
+		task.job.status="failed";
+		task.job.resultCode=503;
+		task.job.result=generateError("The server shut down before this job could be started");
+		task.job.mtime=timestamp();
+		store.updateJob(task.job);
+		jobsFailed++;
+	}
+}
+
+Job JobEngine::submit(const std::string& kind, const User& owner, const std::string& cluster,
+                      Operation operation){
+	Task task;
+	task.job.valid=true;
+	task.job.id=idGenerator.generateJobID();
+	task.job.kind=kind;
+	task.job.owner=owner.id;
+	task.job.cluster=cluster;
+	task.job.status="pending";
+	task.job.ctime=timestamp();
+	task.job.mtime=task.job.ctime;
+	task.operation=std::move(operation);
+
+	auto full=[this]{ return stopRequested || queue.size()>=limits.maxQueued; };
+	//avoid recording jobs which would be immediately rejected
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if(full()){
+			jobsRejected++;
+			return Job();
+		}
+	}
+	if(!store.addJob(task.job))
+		return Job();
+	Job job=task.job;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		//the queue may have filled while the job was being recorded
+		if(full()){
+			jobsRejected++;
+			job.status="failed";
+			job.resultCode=503;
+			job.result=generateError("Too many operations are waiting to run");
+			job.mtime=timestamp();
+			store.updateJob(job);
+			return Job();
+		}
+		task.submitted=std::chrono::steady_clock::now();
+		queue.push_back(std::move(task));
+		activeJobs.insert(job.id);
+	}
+	jobsSubmitted++;
+	queueCondition.notify_one();
+	log_info("Queued " << job << " for " << owner);
+	return job;
+}
+
+void JobEngine::reportProgress(const std::string& progress){
+	if(!currentJob)
+		return;
+	log_info(*currentJob << ": " << progress);
+	currentJob->progress=progress;
+	currentJob->mtime=timestamp();
+	//progress is only informational, so failing to record it is not an error
+	currentEngine->store.updateJob(*currentJob);
+}
+
+std::deque<JobEngine::Task>::iterator JobEngine::nextRunnable(){
+	return std::find_if(queue.begin(),queue.end(),[this](const Task& task){
+		if(task.job.cluster.empty())
+			return true;
+		auto it=runningByCluster.find(task.job.cluster);
+		return it==runningByCluster.end() || it->second<limits.maxPerCluster;
+	});
+}
+
+void JobEngine::work(){
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while(true){
+		auto next=queue.end();
+		queueCondition.wait(lock,[&]{ return stopRequested || (next=nextRunnable())!=queue.end(); });
+		if(stopRequested)
+			return;
+		Task task=std::move(*next);
+		queue.erase(next);
+		const std::string cluster=task.job.cluster;
+		if(!cluster.empty())
+			runningByCluster[cluster]++;
+		lock.unlock();
+		run(task);
+		lock.lock();
+		if(!cluster.empty() && !--runningByCluster[cluster])
+			runningByCluster.erase(cluster);
+		//a job for this cluster which was passed over may now be able to run
+		if(!cluster.empty())
+			queueCondition.notify_all();
+	}
+}
+
+void JobEngine::run(Task& task){
+	using namespace std::chrono;
+	const auto start=steady_clock::now();
+	waitTimes.record(start-task.submitted);
+	jobsRunning++;
+	Job& job=task.job;
+	job.status="running";
+	job.mtime=timestamp();
+	store.updateJob(job);
+	log_info("Starting " << job);
+
+	crow::response result;
+	currentEngine=this;
+	currentJob=&job;
+	try{
+		result=task.operation();
+	}catch(std::exception& ex){
+		log_error("Unexpected failure of " << job << ": " << ex.what());
+		result=crow::response(500,generateError("Internal server error"));
+	}
+	currentJob=nullptr;
+	currentEngine=nullptr;
+	runTimes.record(steady_clock::now()-start);
+	jobsRunning--;
+
+	const bool success=result.code<400;
+	(success ? jobsSucceeded : jobsFailed)++;
+	job.status=(success ? "succeeded" : "failed");
+	job.resultCode=result.code;
+	job.result=result.body;
+	job.mtime=timestamp();
+	if(!store.updateJob(job))
+		log_error("Failed to record outcome of " << job);
+	log_info(job << " " << job.status << " with status " << job.resultCode);
+	std::lock_guard<std::mutex> lock(queueMutex);
+	activeJobs.erase(job.id);
+}
+
+void JobEngine::monitorJobs(){
+	//a previous instance of the service may have left jobs unfinished
+	failAbandonedJobs();
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while(true){
+		monitorCondition.wait_for(lock,heartbeatInterval,[this]{ return stopRequested; });
+		if(stopRequested)
+			return;
+		std::vector<std::string> active(activeJobs.begin(),activeJobs.end());
+		lock.unlock();
+		for(const auto& id : active)
+			store.touchJob(id);
+		failAbandonedJobs();
+		lock.lock();
+	}
+}
+
+void JobEngine::failAbandonedJobs(){
+	//allow for a few refreshes being delayed or failing before giving up on
+	//a job
+	const auto staleAge=3*heartbeatInterval;
+	for(Job& job : store.listStaleJobs(staleAge)){
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if(activeJobs.count(job.id))
+				continue;
+		}
+		log_warn("Marking " << job << " as failed, since it was left " << job.status
+		         << " by a server instance which has stopped");
+		job.status="failed";
+		job.resultCode=503;
+		job.result=generateError("The server running this job stopped before it finished");
+		job.mtime=timestamp();
+		if(store.updateStaleJob(job,staleAge))
+			jobsAbandoned++;
+	}
+}
+
+std::string JobEngine::getStatistics() const{
+	std::size_t queued;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		queued=queue.size();
+	}
+	std::ostringstream os;
+	os << "Jobs: " << jobsSubmitted.load() << " submitted, " << jobsRejected.load() << " rejected, "
+	   << queued << " queued, " << jobsRunning.load() << " running, "
+	   << jobsSucceeded.load() << " succeeded, " << jobsFailed.load() << " failed, "
+	   << jobsAbandoned.load() << " abandoned by other instances\n";
+	if(waitTimes.count())
+		os << "Job wait time: " << waitTimes.summary() << '\n';
+	if(runTimes.count())
+		os << "Job run time: " << runTimes.summary() << '\n';
+	return os.str();
+}
+
+void JobEngine::writeMetrics(std::ostream& os) const{
+	std::size_t queued;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		queued=queue.size();
+	}
+	metrics::writeHeader(os,"slate_jobs_total","counter","Number of background jobs by outcome");
+	metrics::writeSample(os,"slate_jobs_total",{{"outcome","rejected"}},jobsRejected.load());
+	metrics::writeSample(os,"slate_jobs_total",{{"outcome","succeeded"}},jobsSucceeded.load());
+	metrics::writeSample(os,"slate_jobs_total",{{"outcome","failed"}},jobsFailed.load());
+	metrics::writeSample(os,"slate_jobs_total",{{"outcome","abandoned"}},jobsAbandoned.load());
+	metrics::writeHeader(os,"slate_jobs","gauge","Number of background jobs by state");
+	metrics::writeSample(os,"slate_jobs",{{"state","queued"}},queued);
+	metrics::writeSample(os,"slate_jobs",{{"state","running"}},jobsRunning.load());
+	metrics::writeHeader(os,"slate_job_wait_seconds","histogram","Time from background jobs being submitted to their being started");
+	metrics::writeHistogram(os,"slate_job_wait_seconds",{},waitTimes);
+	metrics::writeHeader(os,"slate_job_run_seconds","histogram","Time taken to run background jobs");
+	metrics::writeHistogram(os,"slate_job_run_seconds",{},runTimes);
+}
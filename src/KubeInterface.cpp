@@ -1,10 +1,15 @@
 #include "KubeInterface.h"
 
+#include <chrono>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
 
 #include "Logging.h"
+#include "Tracing.h"
 #include "Utilities.h"
 #include "FileHandle.h"
 
@@ -21,35 +26,126 @@ commandResult kubectl(const std::string& configPath,
 	                     removeShellEscapeSequences(result.error),result.status};
 }
 
+namespace{
+	///How long the list of a cluster's namespaces is trusted before being 
+	///fetched again, in case namespaces are removed by other means
+	const std::chrono::minutes namespaceListValidity(5);
+	
+	///The group namespaces known to exist on one cluster
+	struct KnownNamespaces{
+		std::set<std::string> names;
+		std::chrono::steady_clock::time_point expires;
+	};
+	
+	///Known namespaces, indexed by the path to each cluster's kubeconfig
+	std::map<std::string,KnownNamespaces> knownNamespaces;
+	///Incremented whenever namespaces are deleted or forgotten, so that 
+	///listings which began before then, and may include them, are discarded
+	unsigned long long namespaceGeneration=0;
+	std::mutex knownNamespacesMutex;
+	
+	///Check whether a namespace is known to exist on a cluster, fetching the
+	///cluster's namespaces if they are not already known.
+	bool namespaceKnown(const std::string& clusterConfig, const std::string& name){
+		const auto now=std::chrono::steady_clock::now();
+		unsigned long long generation;
+		{
+			std::lock_guard<std::mutex> lock(knownNamespacesMutex);
+			auto it=knownNamespaces.find(clusterConfig);
+			if(it!=knownNamespaces.end() && it->second.expires>now)
+				return it->second.names.count(name);
+			generation=namespaceGeneration;
+		}
+		
+		auto result=kubectl(clusterConfig,{"get","clusternamespaces",
+		                                   "-o=jsonpath={.items[*].metadata.name}"});
+		if(result.status){
+			log_warn("Failed to list namespaces on cluster: " << result.error);
+			return false;
+		}
+		KnownNamespaces known;
+		std::istringstream ss(result.output);
+		std::string item;
+		while(ss >> item)
+			known.names.insert(item);
+		known.expires=now+namespaceListValidity;
+		const bool found=known.names.count(name);
+		
+		std::lock_guard<std::mutex> lock(knownNamespacesMutex);
+		//a namespace deleted while the listing was fetched may still appear 
+		//in it, so it cannot be trusted, and the namespace is treated as 
+		//missing, which at worst causes it to be applied again
+		if(namespaceGeneration!=generation)
+			return false;
+		//drop lists for clusters which are no longer being used
+		for(auto it=knownNamespaces.begin(); it!=knownNamespaces.end();){
+			if(it->second.expires<=now)
+				it=knownNamespaces.erase(it);
+			else
+				++it;
+		}
+		knownNamespaces[clusterConfig]=std::move(known);
+		return found;
+	}
+	
+	void setNamespaceKnown(const std::string& clusterConfig, const std::string& name, bool exists){
+		std::lock_guard<std::mutex> lock(knownNamespacesMutex);
+		if(!exists)
+			namespaceGeneration++;
+		auto it=knownNamespaces.find(clusterConfig);
+		//if the cluster's namespaces have not been listed, there is nothing to
+		//keep up to date
+		if(it==knownNamespaces.end())
+			return;
+		if(exists)
+			it->second.names.insert(name);
+		else
+			it->second.names.erase(name);
+	}
+}
+
 void kubectl_create_namespace(const std::string& clusterConfig, const Group& group) {
+	tracing::Span span("kubernetes","ensure namespace");
+	const std::string name=group.namespaceName();
+	if(namespaceKnown(clusterConfig,name))
+		return;
+	
 	std::string input=
 R"(apiVersion: nrp-nautilus.io/v1alpha1
 kind: ClusterNamespace
 metadata:
-  name: )"+group.namespaceName()+"\n";
-	
-	auto tmpFile=makeTemporaryFile("namespace_yaml_");
-	std::ofstream tmpfile(tmpFile);
-	tmpfile << input;
-	tmpfile.close();
+  name: )"+name+"\n";
 	
-	auto result=runCommand("kubectl",{"--kubeconfig",clusterConfig,"create","-f",tmpFile});
-	if(result.status){
-		//if the namespace already existed we do not have a problem, otherwise we do
-		if(result.error.find("AlreadyExists")==std::string::npos)
-			throw std::runtime_error("Namespace creation failed: "+result.error);
-	}
+	//server-side apply succeeds whether or not the namespace already exists
+	auto result=runCommandWithInput("kubectl",input,{"--request-timeout=10s",
+		"--kubeconfig="+clusterConfig,"apply","--server-side",
+		"--field-manager=slate","-f","-"});
+	if(result.status)
+		throw std::runtime_error("Namespace creation failed: "+removeShellEscapeSequences(result.error));
+	setNamespaceKnown(clusterConfig,name,true);
 }
 
 void kubectl_delete_namespace(const std::string& clusterConfig, const Group& group) {
+	//forget the namespace first, so that a concurrent creation cannot be 
+	//skipped on the basis of it still existing
+	setNamespaceKnown(clusterConfig,group.namespaceName(),false);
 	auto result=runCommand("kubectl",{"--kubeconfig",clusterConfig,
 		"delete","clusternamespace",group.namespaceName()});
+	//and again once it is gone, discarding any listing made while it was 
+	//being deleted
+	setNamespaceKnown(clusterConfig,group.namespaceName(),false);
 	if(result.status){
 		//if the namespace did not exist we do not have a problem, otherwise we do
 		if(result.error.find("NotFound")==std::string::npos)
 			throw std::runtime_error("Namespace deletion failed: "+result.error);
 	}
 }
+
+void forgetNamespaces(const std::string& clusterConfig){
+	std::lock_guard<std::mutex> lock(knownNamespacesMutex);
+	namespaceGeneration++;
+	knownNamespaces.erase(clusterConfig);
+}
 	
 commandResult helm(const std::string& configPath,
                    const std::string& tillerNamespace,
@@ -0,0 +1,73 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <sstream>
+
+const std::size_t LatencyHistogram::nBounds;
+
+const std::array<unsigned long long,LatencyHistogram::nBounds> LatencyHistogram::bucketBounds={{
+	500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+	1000000, 2000000, 5000000, 10000000
+}};
+
+LatencyHistogram::LatencyHistogram():total(0),totalMicroseconds(0){
+	for(auto& bucket : buckets)
+		bucket.store(0);
+}
+
+void LatencyHistogram::recordMicroseconds(long long duration){
+	if(duration<0)
+		duration=0;
+	std::size_t bucket=std::lower_bound(bucketBounds.begin(),bucketBounds.end(),
+	                                    (unsigned long long)duration)-bucketBounds.begin();
+	buckets[bucket].fetch_add(1,std::memory_order_relaxed);
+	totalMicroseconds.fetch_add(duration,std::memory_order_relaxed);
+	total.fetch_add(1,std::memory_order_relaxed);
+}
+
+unsigned long long LatencyHistogram::quantile(double q) const{
+	//sum the buckets rather than using total, since the two may disagree
+	//slightly while other threads are recording
+	std::array<unsigned long long,nBounds+1> counts;
+	unsigned long long n=0;
+	for(std::size_t i=0; i<buckets.size(); i++)
+		n+=(counts[i]=buckets[i].load(std::memory_order_relaxed));
+	if(!n)
+		return 0;
+	unsigned long long rank=q*n, seen=0;
+	for(std::size_t i=0; i<nBounds; i++){
+		seen+=counts[i];
+		if(seen>rank)
+			return bucketBounds[i];
+	}
+	//the quantile falls in the unbounded bucket, for which the best available
+	//answer is its lower bound
+	return bucketBounds.back();
+}
+
+namespace{
+	std::string formatMicroseconds(unsigned long long us){
+		std::ostringstream os;
+		if(us>=1000000)
+			os << us/1000000. << " s";
+		else if(us>=1000)
+			os << us/1000. << " ms";
+		else
+			os << us << " us";
+		return os.str();
+	}
+}
+
+std::string LatencyHistogram::summary() const{
+	std::ostringstream os;
+	unsigned long long n=count();
+	os << n << " calls";
+	if(n){
+		os << ", mean " << formatMicroseconds(sum()/n)
+		   << ", p50 <= " << formatMicroseconds(quantile(0.5))
+		   << ", p99 <= " << formatMicroseconds(quantile(0.99));
+		if(bucketCount(nBounds))
+			os << ", " << bucketCount(nBounds) << " over " << formatMicroseconds(bucketBounds.back());
+	}
+	return os.str();
+}
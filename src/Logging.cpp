@@ -1,4 +1,348 @@
 #include <Logging.h>
 
-logTarget logStdout{std::cout};
-logTarget logStderr{std::cerr};
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace logging{
+
+std::atomic<int> minimumLevel(static_cast<int>(Level::Info));
+
+namespace{
+
+///The messages produced by one thread, waiting to be written.
+///This is a single-producer, single-consumer ring: only the owning thread
+///advances head, and only the writer thread advances tail.
+struct MessageQueue{
+	static const std::size_t capacity=1024;
+	struct Entry{
+		bool toStdout;
+		std::string text;
+	};
+	Entry entries[capacity];
+	///The total number of messages ever added
+	std::atomic<std::size_t> head;
+	///The total number of messages ever removed
+	std::atomic<std::size_t> tail;
+	///Whether the owning thread has exited, so that once empty the queue can
+	///be discarded
+	std::atomic<bool> orphaned;
+
+	MessageQueue():head(0),tail(0),orphaned(false){}
+};
+
+///Write a collection of complete lines to a file descriptor, retrying as
+///necessary to deal with interruptions and partial writes
+void writeLines(int fd, const std::vector<std::string>& lines){
+#ifdef IOV_MAX
+	const std::size_t maxVectors=std::min<std::size_t>(IOV_MAX,512);
+#else
+	const std::size_t maxVectors=16;
+#endif
+	std::vector<iovec> vectors;
+	vectors.reserve(std::min(lines.size(),maxVectors));
+	auto line=lines.begin();
+	while(line!=lines.end()){
+		vectors.clear();
+		for(; line!=lines.end() && vectors.size()<maxVectors; line++)
+			vectors.push_back(iovec{const_cast<char*>(line->data()),line->size()});
+		iovec* next=vectors.data();
+		std::size_t remaining=vectors.size();
+		while(remaining){
+			ssize_t written=writev(fd,next,std::min<std::size_t>(remaining,INT_MAX));
+			if(written<0){
+				if(errno==EINTR)
+					continue;
+				return; //there is nowhere to report this
+			}
+			//skip over whatever was completely written, and adjust the
+			//first vector which was only partially written
+			while(remaining && (std::size_t)written>=next->iov_len){
+				written-=next->iov_len;
+				next++;
+				remaining--;
+			}
+			if(remaining){
+				next->iov_base=static_cast<char*>(next->iov_base)+written;
+				next->iov_len-=written;
+			}
+		}
+	}
+}
+
+///State shared between all threads which log messages and the writer thread.
+///This is never destroyed, so that threads may continue to log while static
+///objects are being destroyed at exit.
+struct Writer{
+	///Protects queues, stopRequested, and the flush counters
+	std::mutex mutex;
+	std::condition_variable wakeWriter;
+	std::condition_variable flushDone;
+	std::vector<std::shared_ptr<MessageQueue>> queues;
+	bool stopRequested;
+	///Whether the writer thread is still collecting messages. This is read 
+	///without locking by threads logging messages.
+	std::atomic<bool> running;
+	unsigned long long flushesRequested;
+	unsigned long long flushesCompleted;
+	std::thread thread;
+	///Serializes messages written directly, rather than by the writer thread
+	std::mutex directMutex;
+
+	std::atomic<unsigned long long> messagesQueued;
+	std::atomic<unsigned long long> messagesDirect;
+	std::atomic<unsigned long long> batchesWritten;
+
+	Writer():stopRequested(false),running(true),flushesRequested(0),
+	flushesCompleted(0),messagesQueued(0),messagesDirect(0),batchesWritten(0){
+		thread=std::thread(&Writer::run,this);
+	}
+
+	void run(){
+		std::vector<std::string> toStdout, toStderr;
+		std::unique_lock<std::mutex> lock(mutex);
+		while(true){
+			const unsigned long long flushTarget=flushesRequested;
+			const bool stopping=stopRequested;
+			//take a snapshot of the queues so that threads which start logging
+			//are not blocked while messages are written
+			std::vector<std::shared_ptr<MessageQueue>> current=queues;
+			lock.unlock();
+
+			for(const auto& queue : current){
+				const std::size_t head=queue->head.load(std::memory_order_acquire);
+				std::size_t tail=queue->tail.load(std::memory_order_relaxed);
+				for(; tail!=head; tail++){
+					auto& entry=queue->entries[tail%MessageQueue::capacity];
+					(entry.toStdout ? toStdout : toStderr).push_back(std::move(entry.text));
+				}
+				queue->tail.store(tail,std::memory_order_release);
+			}
+			const bool idle=toStdout.empty() && toStderr.empty();
+			if(!toStdout.empty()){
+				writeLines(STDOUT_FILENO,toStdout);
+				batchesWritten++;
+				toStdout.clear();
+			}
+			if(!toStderr.empty()){
+				writeLines(STDERR_FILENO,toStderr);
+				batchesWritten++;
+				toStderr.clear();
+			}
+
+			lock.lock();
+			//discard the queues of threads which have exited, once drained
+			queues.erase(std::remove_if(queues.begin(),queues.end(),
+				[](const std::shared_ptr<MessageQueue>& queue){
+					return queue->orphaned.load() &&
+					       queue->tail.load()==queue->head.load();
+				}),queues.end());
+			if(flushTarget!=flushesCompleted){
+				flushesCompleted=flushTarget;
+				flushDone.notify_all();
+			}
+			if(stopping){
+				running=false;
+				flushDone.notify_all();
+				current=queues;
+				lock.unlock();
+				//messages added after the queues were last drained will not
+				//be written by their threads if they saw this thread running
+				std::lock_guard<std::mutex> directLock(directMutex);
+				for(const auto& queue : current)
+					drainDirect(*queue);
+				return;
+			}
+			//rather than having every message wake this thread, collect
+			//messages for a short time unless a flush or stop is requested
+			if(idle || flushesRequested==flushesCompleted)
+				wakeWriter.wait_for(lock,std::chrono::milliseconds(idle ? 50 : 5),
+				                    [this]{ return stopRequested || flushesRequested!=flushesCompleted; });
+		}
+	}
+
+	///Stop the writer thread after it has written all pending messages
+	void stop(){
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(stopRequested)
+				return;
+			stopRequested=true;
+		}
+		wakeWriter.notify_one();
+		thread.join();
+	}
+
+	void flush(){
+		std::unique_lock<std::mutex> lock(mutex);
+		if(!running)
+			return;
+		const unsigned long long target=++flushesRequested;
+		wakeWriter.notify_one();
+		flushDone.wait(lock,[&]{ return !running || flushesCompleted>=target; });
+	}
+
+	///Write all messages in a queue immediately, once the writer thread has
+	///stopped
+	///\pre directMutex is held
+	void drainDirect(MessageQueue& queue){
+		const std::size_t head=queue.head.load();
+		std::size_t tail=queue.tail.load(std::memory_order_relaxed);
+		for(; tail!=head; tail++){
+			auto& entry=queue.entries[tail%MessageQueue::capacity];
+			writeLines(entry.toStdout ? STDOUT_FILENO : STDERR_FILENO,{entry.text});
+			messagesDirect++;
+		}
+		queue.tail.store(tail,std::memory_order_release);
+	}
+
+	void writeDirect(bool toStdout, const std::string& text){
+		messagesDirect++;
+		std::lock_guard<std::mutex> lock(directMutex);
+		writeLines(toStdout ? STDOUT_FILENO : STDERR_FILENO,{text});
+	}
+};
+
+Writer& getWriter(){
+	static Writer* writer=[]{
+		Writer* w=new Writer;
+		std::atexit([]{ getWriter().stop(); });
+		return w;
+	}();
+	return *writer;
+}
+
+///Per-thread logging state
+struct ThreadState{
+	std::shared_ptr<MessageQueue> queue;
+	///The formatted ID of the thread
+	std::string threadID;
+	///The second for which timePrefix was formatted
+	std::time_t timePrefixSecond;
+	///The formatted date and time, to the second
+	std::string timePrefix;
+
+	ThreadState():queue(std::make_shared<MessageQueue>()),timePrefixSecond(-1){
+		std::ostringstream ss;
+		ss << std::this_thread::get_id();
+		threadID=ss.str();
+		Writer& writer=getWriter();
+		std::lock_guard<std::mutex> lock(writer.mutex);
+		writer.queues.push_back(queue);
+	}
+	~ThreadState(){
+		queue->orphaned.store(true);
+	}
+
+	///Produce a timestamp in the same format as timestamp(), reformatting
+	///the date and time only when the second changes
+	void appendTimestamp(std::string& out){
+		using namespace std::chrono;
+		const auto now=system_clock::now().time_since_epoch();
+		const auto secs=duration_cast<seconds>(now);
+		const std::time_t second=secs.count();
+		if(second!=timePrefixSecond){
+			std::tm parts;
+			gmtime_r(&second,&parts);
+			char buffer[32];
+			std::size_t len=std::strftime(buffer,sizeof(buffer),"%Y-%b-%d %H:%M:%S",&parts);
+			timePrefix.assign(buffer,len);
+			timePrefixSecond=second;
+		}
+		char fraction[16];
+		std::snprintf(fraction,sizeof(fraction),".%06ld UTC",
+		              (long)duration_cast<microseconds>(now-secs).count());
+		out+=timePrefix;
+		out+=fraction;
+	}
+};
+
+const char* levelName(Level level){
+	switch(level){
+		case Level::Info: return "INFO";
+		case Level::Warn: return "WARN";
+		case Level::Error: return "ERROR";
+		case Level::Fatal: return "FATAL";
+	}
+	return "UNKNOWN";
+}
+
+} //anonymous namespace
+
+void setLevel(Level level){
+	minimumLevel.store(std::min(static_cast<int>(level),static_cast<int>(Level::Fatal)));
+}
+
+Level parseLevel(const std::string& name){
+	if(name=="info")
+		return Level::Info;
+	if(name=="warn")
+		return Level::Warn;
+	if(name=="error")
+		return Level::Error;
+	throw std::runtime_error("Unrecognized log level: '"+name+"'");
+}
+
+void write(Level level, std::string message){
+	thread_local ThreadState state;
+
+	std::string line;
+	line.reserve(message.size()+80);
+	line+=levelName(level);
+	line+=": [";
+	state.appendTimestamp(line);
+	line+="] (TID ";
+	line+=state.threadID;
+	line+=") ";
+	line+=message;
+	line+='\n';
+	const bool toStdout=(level==Level::Info);
+
+	MessageQueue& queue=*state.queue;
+	const std::size_t head=queue.head.load(std::memory_order_relaxed);
+	Writer& writer=getWriter();
+	if(head-queue.tail.load(std::memory_order_acquire)>=MessageQueue::capacity){
+		//rather than waiting or dropping the message, write it immediately
+		writer.writeDirect(toStdout,line);
+		return;
+	}
+	auto& entry=queue.entries[head%MessageQueue::capacity];
+	entry.toStdout=toStdout;
+	entry.text=std::move(line);
+	//this must be sequentially consistent with the check of running below
+	queue.head.store(head+1);
+	writer.messagesQueued++;
+
+	//if the writer has stopped (during exit), make sure that this message
+	//does not sit in the queue forever
+	if(!writer.running.load()){
+		std::lock_guard<std::mutex> lock(writer.directMutex);
+		writer.drainDirect(queue);
+	}
+}
+
+void flush(){
+	getWriter().flush();
+}
+
+std::string getStatistics(){
+	Writer& writer=getWriter();
+	std::ostringstream os;
+	os << "Log messages: " << writer.messagesQueued.load() << " queued, "
+	   << writer.messagesDirect.load() << " written directly, "
+	   << writer.batchesWritten.load() << " batches written\n";
+	return os.str();
+}
+
+} //namespace logging
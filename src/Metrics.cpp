@@ -0,0 +1,190 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace metrics{
+
+namespace{
+	std::string escapeLabelValue(const std::string& value){
+		std::string escaped;
+		escaped.reserve(value.size());
+		for(char c : value){
+			switch(c){
+				case '\\': escaped+="\\\\"; break;
+				case '"': escaped+="\\\""; break;
+				case '\n': escaped+="\\n"; break;
+				default: escaped+=c;
+			}
+		}
+		return escaped;
+	}
+
+	void writeLabels(std::ostream& os, const Labels& labels){
+		if(labels.empty())
+			return;
+		os << '{';
+		bool first=true;
+		for(const auto& label : labels){
+			if(!first)
+				os << ',';
+			first=false;
+			os << label.first << "=\"" << escapeLabelValue(label.second) << '"';
+		}
+		os << '}';
+	}
+
+	std::string formatValue(double value){
+		std::ostringstream os;
+		os << std::setprecision(std::numeric_limits<double>::digits10) << value;
+		return os.str();
+	}
+}
+
+void writeHeader(std::ostream& os, const std::string& name,
+                 const std::string& type, const std::string& help){
+	os << "# HELP " << name << ' ' << help << '\n';
+	os << "# TYPE " << name << ' ' << type << '\n';
+}
+
+void writeSample(std::ostream& os, const std::string& name,
+                 const Labels& labels, double value){
+	os << name;
+	writeLabels(os,labels);
+	os << ' ' << formatValue(value) << '\n';
+}
+
+void writeHistogram(std::ostream& os, const std::string& name,
+                    const Labels& labels, const LatencyHistogram& histogram){
+	//read the buckets once, and derive the count from them, so that the
+	//output is consistent even while other threads are recording
+	unsigned long long cumulative=0;
+	Labels bucketLabels=labels;
+	bucketLabels.emplace_back("le","");
+	for(std::size_t i=0; i<LatencyHistogram::nBounds; i++){
+		cumulative+=histogram.bucketCount(i);
+		bucketLabels.back().second=formatValue(LatencyHistogram::bucketBounds[i]/1e6);
+		writeSample(os,name+"_bucket",bucketLabels,cumulative);
+	}
+	cumulative+=histogram.bucketCount(LatencyHistogram::nBounds);
+	bucketLabels.back().second="+Inf";
+	writeSample(os,name+"_bucket",bucketLabels,cumulative);
+	writeSample(os,name+"_sum",labels,histogram.sum()/1e6);
+	writeSample(os,name+"_count",labels,cumulative);
+}
+
+HistogramFamily::HistogramFamily(std::string name, std::string help,
+                                 std::vector<std::string> labelNames,
+                                 std::size_t maxMembers):
+name(std::move(name)),help(std::move(help)),labelNames(std::move(labelNames)),
+maxMembers(maxMembers),memberCount(0){}
+
+namespace{
+	std::string joinLabelValues(const std::vector<std::string>& labelValues){
+		std::string key;
+		for(const auto& value : labelValues){
+			key+=value;
+			key+='\0';
+		}
+		return key;
+	}
+}
+
+LatencyHistogram& HistogramFamily::get(const std::vector<std::string>& labelValues){
+	const std::string key=joinLabelValues(labelValues);
+	std::shared_ptr<Member> member;
+	if(members.find(key,member))
+		return member->histogram;
+
+	if(memberCount.fetch_add(1)>=maxMembers){
+		memberCount--;
+		//the overflow member is not counted, so that it can always be created
+		const std::vector<std::string> overflowValues(labelNames.size(),"other");
+		bool created;
+		return insert(joinLabelValues(overflowValues),overflowValues,created)->histogram;
+	}
+	bool created;
+	member=insert(key,labelValues,created);
+	//another thread created the member, and counted it
+	if(!created)
+		memberCount--;
+	return member->histogram;
+}
+
+std::shared_ptr<HistogramFamily::Member> 
+HistogramFamily::insert(const std::string& key, const std::vector<std::string>& labelValues,
+                        bool& created){
+	std::shared_ptr<Member> member;
+	auto newMember=std::make_shared<Member>();
+	for(std::size_t i=0; i<labelNames.size() && i<labelValues.size(); i++)
+		newMember->labels.emplace_back(labelNames[i],labelValues[i]);
+	//if another thread created the member first, use that one
+	members.upsert(key,[&member](std::shared_ptr<Member>& existing){ member=existing; },newMember);
+	created=!member;
+	return (member ? member : newMember);
+}
+
+void HistogramFamily::write(std::ostream& os) const{
+	std::vector<std::pair<std::string,std::shared_ptr<Member>>> sorted;
+	{
+		auto table=members.lock_table();
+		for(const auto& entry : table)
+			sorted.emplace_back(entry.first,entry.second);
+	}
+	if(sorted.empty())
+		return;
+	std::sort(sorted.begin(),sorted.end(),
+	          [](const std::pair<std::string,std::shared_ptr<Member>>& a,
+	             const std::pair<std::string,std::shared_ptr<Member>>& b){
+	          	return a.first<b.first;
+	          });
+	writeHeader(os,name,"histogram",help);
+	for(const auto& entry : sorted)
+		writeHistogram(os,name,entry.second->labels,entry.second->histogram);
+}
+
+namespace{
+	HistogramFamily& commandLatencies(){
+		static HistogramFamily family("slate_command_duration_seconds",
+		                              "Time taken by external commands run by the service",
+		                              {"command","subcommand","outcome"});
+		return family;
+	}
+}
+
+void recordCommand(const std::string& command, const std::vector<std::string>& args,
+                   std::chrono::steady_clock::duration duration, int status){
+	commandLatencies().get({command,subcommand(args),status ? "failure" : "success"}).record(duration);
+}
+
+void writeCommandMetrics(std::ostream& os){
+	commandLatencies().write(os);
+}
+
+std::string subcommand(const std::vector<std::string>& args){
+	//options which are commonly given with their values as separate arguments
+	static const std::vector<std::string> optionsWithValues={
+		"--kubeconfig","-n","--namespace","--context","--tiller-namespace",
+		"-o","--output","-f","--filename","-l","--selector"
+	};
+	for(auto arg=args.begin(); arg!=args.end(); arg++){
+		if(arg->empty())
+			continue;
+		if((*arg)[0]=='-'){
+			if(std::find(optionsWithValues.begin(),optionsWithValues.end(),*arg)!=optionsWithValues.end()
+			   && arg+1!=args.end())
+				arg++;
+			continue;
+		}
+		//anything resembling a path or name is not a subcommand, and would
+		//make the set of label values unbounded
+		const bool plausible=arg->size()<=32 && std::all_of(arg->begin(),arg->end(),
+			[](char c){ return (c>='a' && c<='z') || c=='-'; });
+		return plausible ? *arg : "other";
+	}
+	return "other";
+}
+
+} //namespace metrics
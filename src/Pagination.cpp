@@ -0,0 +1,90 @@
+#include "Pagination.h"
+
+namespace{
+	const char hexDigits[]="0123456789abcdef";
+	
+	///Tokens are hex encoded so that they can be placed in URLs without escaping
+	std::string hexEncode(const std::string& raw){
+		std::string encoded;
+		encoded.reserve(2*raw.size());
+		for(unsigned char c : raw){
+			encoded+=hexDigits[c>>4];
+			encoded+=hexDigits[c&0xF];
+		}
+		return encoded;
+	}
+	
+	int hexValue(char c){
+		if(c>='0' && c<='9')
+			return c-'0';
+		if(c>='a' && c<='f')
+			return c-'a'+10;
+		if(c>='A' && c<='F')
+			return c-'A'+10;
+		return -1;
+	}
+	
+	bool hexDecode(const std::string& coded, std::string& raw){
+		if(coded.size()%2)
+			return false;
+		raw.clear();
+		raw.reserve(coded.size()/2);
+		for(std::size_t i=0; i<coded.size(); i+=2){
+			int high=hexValue(coded[i]), low=hexValue(coded[i+1]);
+			if(high<0 || low<0)
+				return false;
+			raw+=(char)((high<<4)|low);
+		}
+		return true;
+	}
+}
+
+PageRequest parsePageRequest(const crow::query_string& params){
+	PageRequest page;
+	if(const char* limit=params.get("limit")){
+		try{
+			std::size_t end=0;
+			unsigned long value=std::stoul(limit,&end);
+			if(limit[end]!='\0')
+				throw std::invalid_argument(limit);
+			page.limit=value;
+		}
+		catch(std::exception&){
+			throw std::runtime_error("Invalid limit: "+std::string(limit));
+		}
+	}
+	if(const char* sortBy=params.get("sort"))
+		page.sortBy=sortBy;
+	if(const char* order=params.get("order")){
+		std::string orderStr=order;
+		if(orderStr=="desc")
+			page.descending=true;
+		else if(orderStr!="asc")
+			throw std::runtime_error("Invalid sort order: "+orderStr);
+	}
+	if(const char* token=params.get("continue"))
+		page.continueToken=token;
+	return page;
+}
+
+std::string encodeContinueToken(const std::string& sortBy, const std::string& value,
+                                const std::string& id){
+	return hexEncode(sortBy+'\0'+value+'\0'+id);
+}
+
+bool decodeContinueToken(const std::string& token, std::string& sortBy,
+                         std::string& value, std::string& id){
+	std::string raw;
+	if(!hexDecode(token,raw))
+		return false;
+	std::size_t first=raw.find('\0');
+	if(first==std::string::npos)
+		return false;
+	std::size_t second=raw.find('\0',first+1);
+	if(second==std::string::npos)
+		return false;
+	sortBy=raw.substr(0,first);
+	value=raw.substr(first+1,second-first-1);
+	id=raw.substr(second+1);
+	return true;
+}
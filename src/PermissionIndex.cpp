@@ -0,0 +1,125 @@
+#include "PermissionIndex.h"
+
+#include <algorithm>
+
+PermissionIndex::PermissionIndex():
+expirationTime(steady_clock::now()),
+currentGeneration(0)
+{}
+
+bool PermissionIndex::valid() const{
+	std::lock_guard<std::mutex> lock(mut);
+	return expirationTime>steady_clock::now();
+}
+
+unsigned long PermissionIndex::generation() const{
+	std::lock_guard<std::mutex> lock(mut);
+	return currentGeneration;
+}
+
+bool PermissionIndex::replace(Contents&& contents, steady_clock::time_point expiration,
+                              unsigned long expectedGeneration){
+	std::lock_guard<std::mutex> lock(mut);
+	if(currentGeneration!=expectedGeneration)
+		return false;
+	data.swap(contents);
+	expirationTime=expiration;
+	currentGeneration++;
+	return true;
+}
+
+void PermissionIndex::invalidate(){
+	std::lock_guard<std::mutex> lock(mut);
+	expirationTime=steady_clock::now();
+	currentGeneration++;
+}
+
+void PermissionIndex::setGroupAccess(const std::string& cID, const std::string& groupID,
+                                     const std::string& wildcard, bool allowed){
+	std::lock_guard<std::mutex> lock(mut);
+	ClusterEntry& cluster=data[cID];
+	if(groupID==wildcard)
+		cluster.allowsAllGroups=allowed;
+	else
+		cluster.groups[groupID].accessGranted=allowed;
+	currentGeneration++;
+}
+
+void PermissionIndex::setGroupApplications(const std::string& cID, const std::string& groupID,
+                                           bool allApplications, std::vector<std::string> applications){
+	if(allApplications)
+		applications.clear();
+	else
+		std::sort(applications.begin(),applications.end());
+	std::lock_guard<std::mutex> lock(mut);
+	GroupEntry& group=data[cID].groups[groupID];
+	group.hasApplicationRecord=true;
+	group.allApplications=allApplications;
+	group.applications.swap(applications);
+	currentGeneration++;
+}
+
+void PermissionIndex::removeCluster(const std::string& cID){
+	std::lock_guard<std::mutex> lock(mut);
+	data.erase(cID);
+	currentGeneration++;
+}
+
+bool PermissionIndex::clusterAllowsAllGroups(const std::string& cID) const{
+	std::lock_guard<std::mutex> lock(mut);
+	auto it=data.find(cID);
+	return it!=data.end() && it->second.allowsAllGroups;
+}
+
+bool PermissionIndex::groupAllowedOnCluster(const std::string& cID, const std::string& groupID) const{
+	std::lock_guard<std::mutex> lock(mut);
+	auto it=data.find(cID);
+	if(it==data.end())
+		return false;
+	if(it->second.allowsAllGroups)
+		return true;
+	auto git=it->second.groups.find(groupID);
+	return git!=it->second.groups.end() && git->second.accessGranted;
+}
+
+bool PermissionIndex::groupMayUseApplication(const std::string& cID, const std::string& groupID,
+                                             const std::string& appName) const{
+	std::lock_guard<std::mutex> lock(mut);
+	const GroupEntry* group=findGroup(cID,groupID);
+	//the absence of a record means that all applications are allowed
+	if(!group || !group->hasApplicationRecord || group->allApplications)
+		return true;
+	return std::binary_search(group->applications.begin(),group->applications.end(),appName);
+}
+
+std::vector<std::string> PermissionIndex::applicationsForGroup(const std::string& cID,
+                                                               const std::string& groupID,
+                                                               bool& allApplications) const{
+	std::lock_guard<std::mutex> lock(mut);
+	const GroupEntry* group=findGroup(cID,groupID);
+	if(!group || !group->hasApplicationRecord || group->allApplications){
+		allApplications=true;
+		return {};
+	}
+	allApplications=false;
+	return group->applications;
+}
+
+std::size_t PermissionIndex::size() const{
+	std::lock_guard<std::mutex> lock(mut);
+	std::size_t total=0;
+	for(const auto& cluster : data)
+		total+=cluster.second.groups.size()+(cluster.second.allowsAllGroups?1:0);
+	return total;
+}
+
+const PermissionIndex::GroupEntry* PermissionIndex::findGroup(const std::string& cID,
+                                                              const std::string& groupID) const{
+	auto it=data.find(cID);
+	if(it==data.end())
+		return nullptr;
+	auto git=it->second.groups.find(groupID);
+	if(git==it->second.groups.end())
+		return nullptr;
+	return &git->second;
+}
@@ -1,17 +1,26 @@
 #include <PersistentStore.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
 #include <thread>
 
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <boost/lexical_cast.hpp>
 
 #include <aws/core/utils/Outcome.h>
+#include <aws/dynamodb/model/BatchWriteItemRequest.h>
 #include <aws/dynamodb/model/DeleteItemRequest.h>
 #include <aws/dynamodb/model/GetItemRequest.h>
 #include <aws/dynamodb/model/PutItemRequest.h>
@@ -23,9 +32,16 @@
 #include <aws/dynamodb/model/CreateTableRequest.h>
 #include <aws/dynamodb/model/DeleteTableRequest.h>
 #include <aws/dynamodb/model/DescribeTableRequest.h>
+#include <aws/dynamodb/model/DescribeTimeToLiveRequest.h>
 #include <aws/dynamodb/model/UpdateTableRequest.h>
+#include <aws/dynamodb/model/UpdateTimeToLiveRequest.h>
 
+#include <Archive.h>
+#include <CacheSnapshot.h>
+#include <ClusterProber.h>
+#include <Futures.h>
 #include <Logging.h>
+#include <Metrics.h>
 #include <ServerUtilities.h>
 #include <Process.h>
 extern "C"{
@@ -82,13 +98,24 @@ updateTableWithNewSecondaryIndex(const std::string& tableName, const Aws::Dynamo
 	                                       .WithCreate(secondaryIndexToCreateAction(index)));
 	return request;
 }
+
+///Sleep between checks of a table whose status is changing. Checks are 
+///frequent at first, since new tables often become active within a second, 
+///and then back off to limit the rate of DescribeTable requests during long 
+///index builds.
+///\param delay the time to wait, which is updated for the following check
+void waitBeforeNextCheck(std::chrono::milliseconds& delay){
+	std::this_thread::sleep_for(delay);
+	delay=std::min(2*delay,std::chrono::milliseconds(2000));
+}
 	
-void waitTableReadiness(Aws::DynamoDB::DynamoDBClient& dbClient, const std::string& tableName){
+void waitTableReadiness(DatabaseClient& dbClient, const std::string& tableName){
 	using namespace Aws::DynamoDB::Model;
 	log_info("Waiting for table " << tableName << " to reach active status");
 	DescribeTableOutcome outcome;
+	std::chrono::milliseconds delay(100);
 	do{
-		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		waitBeforeNextCheck(delay);
 		outcome=dbClient.DescribeTable(DescribeTableRequest()
 		                               .WithTableName(tableName));
 	}while(outcome.IsSuccess() && 
@@ -98,17 +125,18 @@ void waitTableReadiness(Aws::DynamoDB::DynamoDBClient& dbClient, const std::stri
 				  "Dynamo error: " << outcome.GetError().GetMessage());
 }
 
-void waitIndexReadiness(Aws::DynamoDB::DynamoDBClient& dbClient, 
+void waitIndexReadiness(DatabaseClient& dbClient, 
                         const std::string& tableName, 
                         const std::string& indexName){
 	using namespace Aws::DynamoDB::Model;
 	log_info("Waiting for index " << indexName << " of table " << tableName << " to reach active status");
 	DescribeTableOutcome outcome;
+	std::chrono::milliseconds delay(100);
 	using GSID=GlobalSecondaryIndexDescription;
 	Aws::Vector<GSID> indices;
 	Aws::Vector<GSID>::iterator index;
 	do{
-		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		waitBeforeNextCheck(delay);
 		outcome=dbClient.DescribeTable(DescribeTableRequest()
 		                               .WithTableName(tableName));
 	}while(outcome.IsSuccess() && (
@@ -122,17 +150,18 @@ void waitIndexReadiness(Aws::DynamoDB::DynamoDBClient& dbClient,
 	
 
 
-void waitUntilIndexDeleted(Aws::DynamoDB::DynamoDBClient& dbClient, 
+void waitUntilIndexDeleted(DatabaseClient& dbClient, 
                         const std::string& tableName, 
                         const std::string& indexName){
 	using namespace Aws::DynamoDB::Model;
 	log_info("Waiting for index " << indexName << " of table " << tableName << " to be deleted");
 	DescribeTableOutcome outcome;
+	std::chrono::milliseconds delay(100);
 	using GSID=GlobalSecondaryIndexDescription;
 	Aws::Vector<GSID> indices;
 	Aws::Vector<GSID>::iterator index;
 	do{
-		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		waitBeforeNextCheck(delay);
 		outcome=dbClient.DescribeTable(DescribeTableRequest()
 		                               .WithTableName(tableName));
 	}while(outcome.IsSuccess() &&
@@ -147,6 +176,239 @@ void waitUntilIndexDeleted(Aws::DynamoDB::DynamoDBClient& dbClient,
 ///trivial value is not a big concern
 const Aws::DynamoDB::Model::AttributeValue missingString(" ");
 
+///Tags identifying the encoding of stored configuration data (instance configs 
+///and cluster kubeconfigs). This data is stored in binary attributes whose 
+///first byte is one of these tags, followed by the encoded data. Records 
+///written by older versions instead hold the raw data as a string attribute. 
+enum class ConfigFormat : char{
+	Plain=0,
+	Gzip=1
+};
+
+///Data smaller than this is stored without attempting to compress it
+const std::size_t configCompressionThreshold=256;
+
+///Encode configuration data into its tagged storage form, compressing it if 
+///that is worthwhile. Configs are written rarely and read often, and zlib's 
+///decompression speed does not depend on the level used, so the highest level
+///is used. 
+std::string packConfig(const std::string& config){
+	if(config.size()>=configCompressionThreshold){
+		try{
+			std::string compressed=gzipCompress(config,9);
+			if(compressed.size()<config.size())
+				return (char)ConfigFormat::Gzip+compressed;
+		}catch(std::runtime_error& err){
+			log_error("Failed to compress config data: " << err.what());
+		}
+	}
+	return (char)ConfigFormat::Plain+config;
+}
+
+///Decode tagged configuration data
+///\throws std::runtime_error if the data is not in a known format
+std::string unpackConfig(const std::string& packed){
+	if(packed.empty())
+		throw std::runtime_error("Stored config data is missing format tag");
+	switch((ConfigFormat)packed.front()){
+		case ConfigFormat::Plain:
+			return packed.substr(1);
+		case ConfigFormat::Gzip:
+			return gzipDecompress(packed.substr(1));
+	}
+	throw std::runtime_error("Stored config data has unknown format "+std::to_string((int)packed.front()));
+}
+
+///Extract tagged configuration data from a database attribute
+std::string storedConfig(const Aws::DynamoDB::Model::AttributeValue& value){
+	if(value.GetType()==Aws::DynamoDB::Model::ValueType::BYTEBUFFER){
+		const auto& data=value.GetB();
+		return std::string((const std::string::value_type*)data.GetUnderlyingData(),data.GetLength());
+	}
+	//a string attribute written by an older version
+	return (char)ConfigFormat::Plain+value.GetS();
+}
+
+///Construct the database attribute holding tagged configuration data
+Aws::DynamoDB::Model::AttributeValue configAttribute(const std::string& packed){
+	return Aws::DynamoDB::Model::AttributeValue()
+	       .SetB(Aws::Utils::ByteBuffer((const unsigned char*)packed.data(),packed.size()));
+}
+
+///Construct a request for the main record of an entity, whose sort key is the 
+///same as its ID
+Aws::DynamoDB::Model::GetItemRequest recordRequest(const std::string& table, const std::string& id){
+	using Aws::DynamoDB::Model::AttributeValue;
+	return Aws::DynamoDB::Model::GetItemRequest()
+	       .WithTableName(table)
+	       .WithKey({{"ID",AttributeValue(id)},
+	                 {"sortKey",AttributeValue(id)}});
+}
+
+///Construct a batch write request which stores an item
+Aws::DynamoDB::Model::WriteRequest 
+putRequest(const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& item){
+	using namespace Aws::DynamoDB::Model;
+	return WriteRequest().WithPutRequest(PutRequest().WithItem(item));
+}
+
+///Construct a batch write request which deletes an item
+Aws::DynamoDB::Model::WriteRequest 
+deleteRequest(const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& key){
+	using namespace Aws::DynamoDB::Model;
+	return WriteRequest().WithDeleteRequest(DeleteRequest().WithKey(key));
+}
+
+///Construct the database item which stores a user's basic information
+Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue> userItem(const User& user){
+	using Aws::DynamoDB::Model::AttributeValue;
+	return {
+		{"ID",AttributeValue(user.id)},
+		{"sortKey",AttributeValue(user.id)},
+		{"name",AttributeValue(user.name)},
+		{"globusID",AttributeValue(user.globusID)},
+		{"token",AttributeValue(user.token)},
+		{"email",AttributeValue(user.email)},
+		{"phone",AttributeValue(user.phone)},
+		{"institution",AttributeValue(user.institution)},
+		{"admin",AttributeValue().SetBool(user.admin)}
+	};
+}
+
+///Construct the database item which records a user's membership in a group
+Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue> 
+membershipItem(const std::string& uID, const std::string& groupID){
+	using Aws::DynamoDB::Model::AttributeValue;
+	return {
+		{"ID",AttributeValue(uID)},
+		{"sortKey",AttributeValue(uID+":"+groupID)},
+		{"groupID",AttributeValue(groupID)}
+	};
+}
+
+//Decode the stored forms of entities' main records
+
+User userFromItem(const std::string& id, const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& item){
+	User user;
+	user.valid=true;
+	user.id=id;
+	user.name=findOrThrow(item,"name","user record missing name attribute").GetS();
+	user.email=findOrThrow(item,"email","user record missing email attribute").GetS();
+	user.phone=findOrDefault(item,"phone",missingString).GetS();
+	user.institution=findOrDefault(item,"institution",missingString).GetS();
+	user.token=findOrThrow(item,"token","user record missing token attribute").GetS();
+	user.globusID=findOrThrow(item,"globusID","user record missing globusID attribute").GetS();
+	user.admin=findOrThrow(item,"admin","user record missing admin attribute").GetBool();
+	return user;
+}
+
+Group groupFromItem(const std::string& id, const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& item){
+	Group group;
+	group.valid=true;
+	group.id=id;
+	group.name=findOrThrow(item,"name","Group record missing name attribute").GetS();
+	group.email=findOrDefault(item,"email",missingString).GetS();
+	group.phone=findOrDefault(item,"phone",missingString).GetS();
+	group.scienceField=findOrDefault(item,"scienceField",missingString).GetS();
+	group.description=findOrDefault(item,"description",missingString).GetS();
+	return group;
+}
+
+Cluster clusterFromItem(const std::string& cID, const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& item){
+	Cluster cluster;
+	cluster.valid=true;
+	cluster.id=cID;
+	cluster.name=findOrThrow(item,"name","Cluster record missing name attribute").GetS();
+	cluster.owningGroup=findOrThrow(item,"owningGroup","Cluster record missing owningGroup attribute").GetS();
+	cluster.config=unpackConfig(storedConfig(findOrThrow(item,"config","Cluster record missing config attribute")));
+	cluster.systemNamespace=findOrThrow(item,"systemNamespace","Cluster record missing systemNamespace attribute").GetS();
+	cluster.owningOrganization=findOrDefault(item,"owningOrganization",missingString).GetS();
+	return cluster;
+}
+
+ApplicationInstance instanceFromItem(const std::string& id, const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& item){
+	ApplicationInstance inst;
+	inst.valid=true;
+	inst.id=id;
+	inst.name=findOrThrow(item,"name","Instance record missing name attribute").GetS();
+	inst.application=findOrThrow(item,"application","Instance record missing application attribute").GetS();
+	inst.owningGroup=findOrThrow(item,"owningGroup","Instance record missing owningGroup attribute").GetS();
+	inst.cluster=findOrThrow(item,"cluster","Instance record missing cluster attribute").GetS();
+	inst.ctime=findOrThrow(item,"ctime","Instance record missing ctime attribute").GetS();
+	return inst;
+}
+
+Secret secretFromItem(const std::string& id, const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& item){
+	Secret secret;
+	secret.valid=true;
+	secret.id=id;
+	secret.name=findOrThrow(item,"name","Secret record missing name attribute").GetS();
+	secret.group=findOrThrow(item,"owningGroup","Secret record missing owning group attribute").GetS();
+	secret.cluster=findOrThrow(item,"cluster","Secret record missing cluster attribute").GetS();
+	secret.ctime=findOrThrow(item,"ctime","Secret record missing ctime attribute").GetS();
+	const auto& secret_data=findOrThrow(item,"contents","Secret record missing contents attribute").GetB();
+	secret.data=std::string((const std::string::value_type*)secret_data.GetUnderlyingData(),secret_data.GetLength());
+	return secret;
+}
+
+///How long the record of a job is kept after it was last updated
+const std::chrono::hours jobRetention(24*7);
+
+///\return a time as a number of seconds since the Unix epoch
+long long epochSeconds(std::chrono::system_clock::time_point time){
+	return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue> jobItem(const Job& job){
+	using Aws::DynamoDB::Model::AttributeValue;
+	const auto now=std::chrono::system_clock::now();
+	const auto expires=epochSeconds(now+jobRetention);
+	Aws::Map<Aws::String,AttributeValue> item{
+		{"ID",AttributeValue(job.id)},
+		{"kind",AttributeValue(job.kind)},
+		{"owner",AttributeValue(job.owner)},
+		{"status",AttributeValue(job.status)},
+		{"resultCode",AttributeValue().SetN(std::to_string(job.resultCode))},
+		{"ctime",AttributeValue(job.ctime)},
+		{"mtime",AttributeValue(job.mtime)},
+		//unlike mtime, this is also refreshed while the job is unchanged, to
+		//show that the replica responsible for it is still alive
+		{"updated",AttributeValue().SetN(std::to_string(epochSeconds(now)))},
+		{"expires",AttributeValue().SetN(std::to_string(expires))}
+	};
+	//Dynamo will not accept empty strings, so optional attributes are omitted
+	//when they have no value
+	if(!job.cluster.empty())
+		item["cluster"]=AttributeValue(job.cluster);
+	if(!job.progress.empty())
+		item["progress"]=AttributeValue(job.progress);
+	if(!job.result.empty())
+		item["result"]=AttributeValue(job.result);
+	//Only unfinished jobs carry this attribute, so that only they appear in 
+	//the ByActivity index used to find abandoned jobs
+	if(job.status=="pending" || job.status=="running")
+		item["active"]=AttributeValue("1");
+	return item;
+}
+
+Job jobFromItem(const std::string& id, const Aws::Map<Aws::String,Aws::DynamoDB::Model::AttributeValue>& item){
+	Job job;
+	job.valid=true;
+	job.id=id;
+	job.kind=findOrThrow(item,"kind","Job record missing kind attribute").GetS();
+	job.owner=findOrThrow(item,"owner","Job record missing owner attribute").GetS();
+	job.status=findOrThrow(item,"status","Job record missing status attribute").GetS();
+	job.resultCode=std::stoul(findOrThrow(item,"resultCode","Job record missing resultCode attribute").GetN());
+	job.ctime=findOrThrow(item,"ctime","Job record missing ctime attribute").GetS();
+	job.mtime=findOrThrow(item,"mtime","Job record missing mtime attribute").GetS();
+	//unlike missingString, absent values here must read back as empty
+	const Aws::DynamoDB::Model::AttributeValue empty("");
+	job.cluster=findOrDefault(item,"cluster",empty).GetS();
+	job.progress=findOrDefault(item,"progress",empty).GetS();
+	job.result=findOrDefault(item,"result",empty).GetS();
+	return job;
+}
+
 template<typename Cache, typename Key=typename Cache::key_type, typename Value=typename Cache::mapped_type>
 void replaceCacheRecord(Cache& cache, const Key& key, const Value& value){
 	cache.upsert(key,[&value](Value& existing){ existing=value; },value);
@@ -161,8 +423,9 @@ do{ \
 	auto cachedCategory = cache.find(key); \
 	using ResultType=typename decltype(cache)::mapped_type::value_type; \
 	std::vector<ResultType> results; \
-	if(cachedCategory.second > std::chrono::steady_clock::now()){ \
-		for(const auto record : cachedCategory.first){ \
+	if(cachedCategory.expiration > std::chrono::steady_clock::now()){ \
+		results.reserve(cachedCategory.items().size()); \
+		for(const auto& record : cachedCategory.items()){ \
 			if(record){ \
 				results.push_back(record); \
 				cacheHits++; \
@@ -180,36 +443,437 @@ PersistentStore::PersistentStore(const Aws::Auth::AWSCredentials& credentials,
                                  std::string bootstrapUserFile,
                                  std::string encryptionKeyFile,
                                  std::string appLoggingServerName,
-                                 unsigned int appLoggingServerPort):
+                                 unsigned int appLoggingServerPort,
+                                 std::string changeFeedEndpoint):
 	dbClient(credentials,clientConfig),
 	userTableName("SLATE_users"),
 	groupTableName("SLATE_groups"),
 	clusterTableName("SLATE_clusters"),
 	instanceTableName("SLATE_instances"),
+	instanceConfigTableName("SLATE_instance_configs"),
 	secretTableName("SLATE_secrets"),
+	jobTableName("SLATE_jobs"),
 	dnsClient(credentials,clientConfig),
 	baseDomain("slateci.net"),
+	clusterProber(nullptr),
 	clusterConfigDir(makeTemporaryDir("/var/tmp/slate_")),
-	userCacheValidity(std::chrono::minutes(5)),
+	//When changes made by other server instances are followed, cached records
+	//only become stale if a change is missed, which is noticed and handled 
+	//by discarding the affected caches, so they can be kept much longer. 
+	userCacheValidity(changeFeedEndpoint.empty() ? std::chrono::minutes(5) : std::chrono::minutes(60)),
 	userCacheExpirationTime(std::chrono::steady_clock::now()),
-	groupCacheValidity(std::chrono::minutes(30)),
+	membershipGeneration(0),
+	groupCacheValidity(changeFeedEndpoint.empty() ? std::chrono::minutes(30) : std::chrono::minutes(240)),
 	groupCacheExpirationTime(std::chrono::steady_clock::now()),
-	clusterCacheValidity(std::chrono::minutes(30)),
+	clusterCacheValidity(changeFeedEndpoint.empty() ? std::chrono::minutes(30) : std::chrono::minutes(240)),
 	clusterCacheExpirationTime(std::chrono::steady_clock::now()),
-	instanceCacheValidity(std::chrono::minutes(5)),
+	clusterConnectivityCacheValidity(std::chrono::minutes(30)),
+	instanceCacheValidity(changeFeedEndpoint.empty() ? std::chrono::minutes(5) : std::chrono::minutes(60)),
 	instanceCacheExpirationTime(std::chrono::steady_clock::now()),
-	secretCacheValidity(std::chrono::minutes(5)),
+	secretCacheValidity(changeFeedEndpoint.empty() ? std::chrono::minutes(5) : std::chrono::minutes(60)),
+	applicationCacheValidity(std::chrono::minutes(5)),
+	snapshotInterval(0),
+	snapshotRecordValidity(std::chrono::minutes(5)),
+	stopSnapshots(false),
+	stopMigration(false),
 	secretKey(1024),
 	appLoggingServerName(appLoggingServerName),
 	appLoggingServerPort(appLoggingServerPort),
-	cacheHits(0),databaseQueries(0),databaseScans(0)
+	cacheHits(0),databaseQueries(0),databaseScans(0),
+	configWrites(0),configWritesAvoided(0),
+	snapshotsSaved(0),snapshotRecordsLoaded(0)
 {
 	loadEncyptionKey(encryptionKeyFile);
 	log_info("Starting database client");
 	InitializeTables(bootstrapUserFile);
+	instanceConfigMigrationThread=std::thread(&PersistentStore::migrateInstanceConfigs,this);
+	manageCaches();
+	cacheManager.startSweeping(std::chrono::minutes(1));
+	if(!changeFeedEndpoint.empty()){
+		Aws::Client::ClientConfiguration streamsConfig=clientConfig;
+		streamsConfig.endpointOverride=changeFeedEndpoint;
+		startChangeFeed(credentials,streamsConfig);
+	}
 	log_info("Database client ready");
 }
 
+PersistentStore::~PersistentStore(){
+	if(snapshotThread.joinable()){
+		{
+			std::lock_guard<std::mutex> lock(snapshotMutex);
+			stopSnapshots=true;
+		}
+		snapshotCondition.notify_all();
+		snapshotThread.join();
+		saveCacheSnapshot(snapshotPath);
+	}
+	if(changeFeed)
+		changeFeed->stop();
+	cacheManager.stopSweeping();
+	stopMigration=true;
+	if(instanceConfigMigrationThread.joinable())
+		instanceConfigMigrationThread.join();
+}
+
+void PersistentStore::manageCaches(){
+	using Budget=CacheManager::Budget;
+	const std::size_t MB=1024*1024;
+	//Caches which are iterated to list all records of a kind are only complete 
+	//until something is removed from them
+	auto invalidate=[](slate_atomic<std::chrono::steady_clock::time_point>& expirationTime){
+		return [&expirationTime]{ expirationTime=std::chrono::steady_clock::now(); };
+	};
+	
+	cacheManager.manage("userCache",userCache,Budget{20000,32*MB},invalidate(userCacheExpirationTime));
+	cacheManager.manage("userByTokenCache",userByTokenCache,Budget{20000,32*MB});
+	cacheManager.manage("userByGlobusIDCache",userByGlobusIDCache,Budget{20000,32*MB});
+	cacheManager.manage("userByGroupCache",userByGroupCache,Budget{5000,16*MB});
+	cacheManager.manage("userGroupMembershipCache",userGroupMembershipCache,Budget{20000,16*MB});
+	
+	cacheManager.manage("groupCache",groupCache,Budget{10000,16*MB},invalidate(groupCacheExpirationTime));
+	cacheManager.manage("groupByNameCache",groupByNameCache,Budget{10000,16*MB});
+	cacheManager.manage("groupByUserCache",groupByUserCache,Budget{20000,32*MB});
+	
+	//cluster records include kubeconfigs, so they are comparatively large
+	cacheManager.manage("clusterCache",clusterCache,Budget{2000,64*MB},invalidate(clusterCacheExpirationTime));
+	cacheManager.manage("clusterByNameCache",clusterByNameCache,Budget{2000,64*MB});
+	cacheManager.manage("clusterByGroupCache",clusterByGroupCache,Budget{2000,64*MB});
+	cacheManager.manage("clusterGroupAccessCache",clusterGroupAccessCache,Budget{2000,8*MB});
+	cacheManager.manage("clusterGroupApplicationCache",clusterGroupApplicationCache,Budget{20000,16*MB});
+	cacheManager.manage("clusterLocationCache",clusterLocationCache,Budget{2000,4*MB});
+	cacheManager.manage("clusterConnectivityCache",clusterConnectivityCache,Budget{2000,1*MB});
+	
+	cacheManager.manage("instanceCache",instanceCache,Budget{20000,64*MB},invalidate(instanceCacheExpirationTime));
+	cacheManager.manage("instanceConfigCache",instanceConfigCache,Budget{5000,64*MB});
+	cacheManager.manage("instanceByGroupCache",instanceByGroupCache,Budget{10000,64*MB});
+	cacheManager.manage("instanceByNameCache",instanceByNameCache,Budget{10000,64*MB});
+	cacheManager.manage("instanceByClusterCache",instanceByClusterCache,Budget{10000,64*MB});
+	cacheManager.manage("instanceByGroupAndClusterCache",instanceByGroupAndClusterCache,Budget{10000,64*MB});
+	
+	cacheManager.manage("secretCache",secretCache,Budget{10000,32*MB});
+	cacheManager.manage("secretByGroupCache",secretByGroupCache,Budget{5000,32*MB});
+	cacheManager.manage("secretByGroupAndClusterCache",secretByGroupAndClusterCache,Budget{5000,32*MB});
+	
+	cacheManager.manage("applicationCache",applicationCache,Budget{16,16*MB});
+}
+
+std::string PersistentStore::enableTableStream(const std::string& tableName){
+	using namespace Aws::DynamoDB::Model;
+	auto outcome=dbClient.DescribeTable(DescribeTableRequest().WithTableName(tableName));
+	if(!outcome.IsSuccess())
+		log_fatal("Unable to describe table " << tableName << ": " << outcome.GetError().GetMessage());
+	const TableDescription& tableDesc=outcome.GetResult().GetTable();
+	if(tableDesc.GetStreamSpecification().GetStreamEnabled()){
+		if(tableDesc.GetStreamSpecification().GetStreamViewType()!=StreamViewType::NEW_AND_OLD_IMAGES)
+			log_warn("The stream for table " << tableName << " does not record old and new item "
+			         "images, so all cached data from the table will be discarded on every change");
+		return tableDesc.GetLatestStreamArn();
+	}
+	
+	log_info("Enabling stream for table " << tableName);
+	auto updateOutcome=dbClient.UpdateTable(UpdateTableRequest()
+	                                        .WithTableName(tableName)
+	                                        .WithStreamSpecification(StreamSpecification()
+	                                                                 .WithStreamEnabled(true)
+	                                                                 .WithStreamViewType(StreamViewType::NEW_AND_OLD_IMAGES)));
+	if(!updateOutcome.IsSuccess())
+		log_fatal("Failed to enable stream for table " << tableName << ": " << updateOutcome.GetError().GetMessage());
+	waitTableReadiness(dbClient,tableName);
+	return updateOutcome.GetResult().GetTableDescription().GetLatestStreamArn();
+}
+
+void PersistentStore::startChangeFeed(const Aws::Auth::AWSCredentials& credentials,
+                                      const Aws::Client::ClientConfiguration& clientConfig){
+	changeFeed.reset(new ChangeFeed(credentials,clientConfig,
+	                                [this](const ChangeFeed::Change& change){ applyChange(change); },
+	                                [this](const std::string& table){ discardCachedTable(table); }));
+	//enabling a stream requires waiting for the table to be updated, so do 
+	//this for all tables at once
+	std::vector<std::pair<std::string,std::future<std::string>>> streams;
+	for(const std::string& table : {userTableName,groupTableName,clusterTableName,
+	                                instanceTableName,instanceConfigTableName,secretTableName})
+		streams.emplace_back(table,std::async(std::launch::async,[this,table]{ return enableTableStream(table); }));
+	for(auto& stream : streams)
+		changeFeed->follow(stream.first,stream.second.get());
+	changeFeed->start();
+	log_info("Following database changes");
+}
+
+void PersistentStore::applyChange(const ChangeFeed::Change& change){
+	using Change=ChangeFeed::Change;
+	//Without the item images there is no way to tell which cached data was 
+	//derived from the item, so all data from the table must be discarded. 
+	const bool complete=(change.kind==Change::Insert || !change.oldImage.empty())
+	                 && (change.kind==Change::Remove || !change.newImage.empty());
+	if(!complete){
+		discardCachedTable(change.table);
+		return;
+	}
+	
+	if(change.table==userTableName)
+		applyUserChange(change);
+	else if(change.table==groupTableName)
+		applyGroupChange(change);
+	else if(change.table==clusterTableName)
+		applyClusterChange(change);
+	else if(change.table==instanceTableName)
+		applyInstanceChange(change);
+	else if(change.table==secretTableName)
+		applySecretChange(change);
+	else if(change.table==instanceConfigTableName){
+		//configs are only cached in their stored form, which is cheap to fetch 
+		//again, so just drop any cached copy
+		instanceConfigCache.erase(findOrThrow(change.keys,"ID","Instance config record missing ID attribute").GetS());
+	}
+}
+
+void PersistentStore::applyUserChange(const ChangeFeed::Change& change){
+	const std::string id=findOrThrow(change.keys,"ID","User record missing ID attribute").GetS();
+	const std::string sortKey=findOrThrow(change.keys,"sortKey","User record missing sortKey attribute").GetS();
+	
+	if(sortKey==id){ //the user's main record
+		User old=change.oldImage.empty() ? User() : userFromItem(id,change.oldImage);
+		User current=change.newImage.empty() ? User() : userFromItem(id,change.newImage);
+		if(old && old.token!=current.token)
+			userByTokenCache.erase(old.token);
+		if(old && old.globusID!=current.globusID)
+			userByGlobusIDCache.erase(old.globusID);
+		if(current){
+			CacheRecord<User> record(current,userCacheValidity);
+			replaceCacheRecord(userCache,id,record);
+			replaceCacheRecord(userByTokenCache,current.token,record);
+			replaceCacheRecord(userByGlobusIDCache,current.globusID,record);
+		}
+		else{
+			userCache.erase(id);
+			userGroupMembershipCache.erase(id);
+		}
+		return;
+	}
+	
+	//otherwise, a membership record, with a sort key of the form uID:groupID
+	if(sortKey.size()<=id.size()+1 || sortKey.compare(0,id.size()+1,id+":")!=0){
+		log_warn("Ignoring change to unrecognized user record " << sortKey);
+		return;
+	}
+	const std::string groupID=sortKey.substr(id.size()+1);
+	const bool member=(change.kind!=ChangeFeed::Change::Remove);
+	membershipGeneration++;
+	if(member)
+		userByGroupCache.insert_or_assign(groupID,CacheRecord<std::string>(id,userCacheValidity));
+	else
+		userByGroupCache.erase(groupID,CacheRecord<std::string>(id));
+	//the group record is needed to update the user's list of groups, so if 
+	//it is not at hand just drop the list
+	CacheRecord<Group> groupRecord;
+	if(groupCache.find(groupID,groupRecord)){
+		if(member)
+			groupByUserCache.insert_or_assign(id,CacheRecord<Group>(groupRecord.record,groupCacheValidity));
+		else
+			groupByUserCache.erase(id,groupRecord);
+	}
+	else
+		groupByUserCache.erase(id);
+	userGroupMembershipCache.update_fn(id,[&](CacheRecord<std::set<std::string>>& memberships){
+		if(member)
+			memberships.record.insert(groupID);
+		else
+			memberships.record.erase(groupID);
+	});
+}
+
+void PersistentStore::applyGroupChange(const ChangeFeed::Change& change){
+	const std::string id=findOrThrow(change.keys,"ID","Group record missing ID attribute").GetS();
+	Group old=change.oldImage.empty() ? Group() : groupFromItem(id,change.oldImage);
+	Group current=change.newImage.empty() ? Group() : groupFromItem(id,change.newImage);
+	if(old && old.name!=current.name)
+		groupByNameCache.erase(old.name);
+	if(current){
+		CacheRecord<Group> record(current,groupCacheValidity);
+		replaceCacheRecord(groupCache,id,record);
+		replaceCacheRecord(groupByNameCache,current.name,record);
+	}
+	else
+		groupCache.erase(id);
+}
+
+void PersistentStore::applyClusterChange(const ChangeFeed::Change& change){
+	const std::string cID=findOrThrow(change.keys,"ID","Cluster record missing ID attribute").GetS();
+	const std::string sortKey=findOrThrow(change.keys,"sortKey","Cluster record missing sortKey attribute").GetS();
+	
+	if(sortKey==cID){ //the cluster's main record
+		Cluster old=change.oldImage.empty() ? Cluster() : clusterFromItem(cID,change.oldImage);
+		Cluster current=change.newImage.empty() ? Cluster() : clusterFromItem(cID,change.newImage);
+		if(old && old.name!=current.name)
+			clusterByNameCache.erase(old.name);
+		if(old && old.owningGroup!=current.owningGroup)
+			clusterByGroupCache.erase(old.owningGroup,CacheRecord<Cluster>(old));
+		if(current){
+			CacheRecord<Cluster> record(current,clusterCacheValidity);
+			replaceCacheRecord(clusterCache,cID,record);
+			clusterByNameCache.insert_or_assign(current.name,record);
+			clusterByGroupCache.insert_or_assign(current.owningGroup,record);
+			writeClusterConfigToDisk(current);
+		}
+		else{
+			clusterCache.erase(cID);
+			clusterConfigs.erase(cID);
+			clusterLocationCache.erase(cID);
+			clusterGroupAccessCache.erase(cID);
+			permissionIndex.removeCluster(cID);
+		}
+		return;
+	}
+	
+	//otherwise, one of the cluster's subsidiary records
+	if(sortKey.size()<=cID.size()+1 || sortKey.compare(0,cID.size()+1,cID+":")!=0){
+		log_warn("Ignoring change to unrecognized cluster record " << sortKey);
+		return;
+	}
+	const std::string locationsSuffix=":Locations";
+	const std::string applicationsSuffix=":Applications";
+	auto hasSuffix=[&sortKey](const std::string& suffix){
+		return sortKey.size()>=suffix.size() 
+		    && sortKey.compare(sortKey.size()-suffix.size(),suffix.size(),suffix)==0;
+	};
+	if(sortKey==cID+locationsSuffix)
+		clusterLocationCache.erase(cID);
+	else if(hasSuffix(applicationsSuffix) && sortKey.size()>cID.size()+1+applicationsSuffix.size()){
+		//sort key is cID:groupID:Applications
+		const std::string groupID=sortKey.substr(cID.size()+1,
+		  sortKey.size()-cID.size()-1-applicationsSuffix.size());
+		if(change.newImage.empty()){
+			//the absence of a record has a special meaning, which the index 
+			//cannot represent incrementally
+			clusterGroupApplicationCache.erase(sortKey);
+			permissionIndex.invalidate();
+			return;
+		}
+		auto applications=findOrThrow(change.newImage,"applications","Cluster record missing applications attribute").GetSS();
+		std::set<std::string> allowed(applications.begin(),applications.end());
+		if(allowed.count("<none>"))
+			allowed={};
+		CacheRecord<std::set<std::string>> record(allowed,clusterCacheValidity);
+		replaceCacheRecord(clusterGroupApplicationCache,sortKey,record);
+		permissionIndex.setGroupApplications(cID,groupID,allowed.count(wildcardName),
+		                                     std::vector<std::string>(allowed.begin(),allowed.end()));
+	}
+	else{ //a group access record, with a sort key of the form cID:groupID
+		const std::string groupID=sortKey.substr(cID.size()+1);
+		if(change.kind==ChangeFeed::Change::Remove){
+			clusterGroupAccessCache.erase(cID,CacheRecord<std::string>(groupID));
+			permissionIndex.setGroupAccess(cID,groupID,wildcard,false);
+		}
+		else{
+			clusterGroupAccessCache.insert_or_assign(cID,CacheRecord<std::string>(groupID,clusterCacheValidity));
+			permissionIndex.setGroupAccess(cID,groupID,wildcard,true);
+		}
+	}
+}
+
+void PersistentStore::applyInstanceChange(const ChangeFeed::Change& change){
+	const std::string id=findOrThrow(change.keys,"ID","Instance record missing ID attribute").GetS();
+	const std::string sortKey=findOrThrow(change.keys,"sortKey","Instance record missing sortKey attribute").GetS();
+	if(sortKey!=id){
+		//a config record written by an older version, with sort key ID:config
+		instanceConfigCache.erase(id);
+		return;
+	}
+	
+	ApplicationInstance old=change.oldImage.empty() ? ApplicationInstance() : instanceFromItem(id,change.oldImage);
+	ApplicationInstance current=change.newImage.empty() ? ApplicationInstance() : instanceFromItem(id,change.newImage);
+	if(old && (!current || old.owningGroup!=current.owningGroup || old.name!=current.name 
+	           || old.cluster!=current.cluster)){
+		CacheRecord<ApplicationInstance> record(old);
+		instanceByGroupCache.erase(old.owningGroup,record);
+		instanceByNameCache.erase(old.name,record);
+		instanceByClusterCache.erase(old.cluster,record);
+		instanceByGroupAndClusterCache.erase(old.owningGroup+":"+old.cluster,record);
+	}
+	if(current){
+		CacheRecord<ApplicationInstance> record(current,instanceCacheValidity);
+		replaceCacheRecord(instanceCache,id,record);
+		instanceByGroupCache.insert_or_assign(current.owningGroup,record);
+		instanceByNameCache.insert_or_assign(current.name,record);
+		instanceByClusterCache.insert_or_assign(current.cluster,record);
+		instanceByGroupAndClusterCache.insert_or_assign(current.owningGroup+":"+current.cluster,record);
+	}
+	else{
+		instanceCache.erase(id);
+		instanceConfigCache.erase(id);
+	}
+}
+
+void PersistentStore::applySecretChange(const ChangeFeed::Change& change){
+	const std::string id=findOrThrow(change.keys,"ID","Secret record missing ID attribute").GetS();
+	Secret old=change.oldImage.empty() ? Secret() : secretFromItem(id,change.oldImage);
+	Secret current=change.newImage.empty() ? Secret() : secretFromItem(id,change.newImage);
+	if(old && (!current || old.group!=current.group || old.cluster!=current.cluster)){
+		CacheRecord<Secret> record(old);
+		secretByGroupCache.erase(old.group,record);
+		secretByGroupAndClusterCache.erase(old.group+":"+old.cluster,record);
+	}
+	if(current){
+		CacheRecord<Secret> record(current,secretCacheValidity);
+		replaceCacheRecord(secretCache,id,record);
+		secretByGroupCache.insert_or_assign(current.group,record);
+		secretByGroupAndClusterCache.insert_or_assign(current.group+":"+current.cluster,record);
+	}
+	else
+		secretCache.erase(id);
+}
+
+void PersistentStore::discardCachedTable(const std::string& tableName){
+	log_info("Discarding all cached data from " << tableName);
+	const auto now=std::chrono::steady_clock::now();
+	//Mark listings as incomplete before removing anything, so that no listing 
+	//is assembled from a partially cleared cache. 
+	if(tableName==userTableName){
+		userCacheExpirationTime=now;
+		membershipGeneration++;
+		userCache.clear();
+		userByTokenCache.clear();
+		userByGlobusIDCache.clear();
+		userByGroupCache.clear();
+		userGroupMembershipCache.clear();
+		groupByUserCache.clear();
+	}
+	else if(tableName==groupTableName){
+		groupCacheExpirationTime=now;
+		groupCache.clear();
+		groupByNameCache.clear();
+		groupByUserCache.clear();
+	}
+	else if(tableName==clusterTableName){
+		clusterCacheExpirationTime=now;
+		permissionIndex.invalidate();
+		//config files are left in place, since requests may be using them; 
+		//they are rewritten when cluster records are next fetched
+		clusterCache.clear();
+		clusterByNameCache.clear();
+		clusterByGroupCache.clear();
+		clusterGroupAccessCache.clear();
+		clusterGroupApplicationCache.clear();
+		clusterLocationCache.clear();
+	}
+	else if(tableName==instanceTableName){
+		instanceCacheExpirationTime=now;
+		instanceCache.clear();
+		instanceConfigCache.clear();
+		instanceByGroupCache.clear();
+		instanceByNameCache.clear();
+		instanceByClusterCache.clear();
+		instanceByGroupAndClusterCache.clear();
+	}
+	else if(tableName==instanceConfigTableName)
+		instanceConfigCache.clear();
+	else if(tableName==secretTableName){
+		secretCache.clear();
+		secretByGroupCache.clear();
+		secretByGroupAndClusterCache.clear();
+	}
+}
+
 void PersistentStore::InitializeUserTable(std::string bootstrapUserFile){
 	using namespace Aws::DynamoDB::Model;
 	using AttDef=Aws::DynamoDB::Model::AttributeDefinition;
@@ -336,7 +1000,7 @@ void PersistentStore::InitializeUserTable(std::string bootstrapUserFile){
 			auto updateResult=dbClient.UpdateTable(req);
 			if(!updateResult.IsSuccess())
 				log_fatal("Failed to delete incomplete ByToken secondary index from user table: " + updateResult.GetError().GetMessage());
-			waitUntilIndexDeleted(dbClient,groupTableName,"ByToken");
+			waitUntilIndexDeleted(dbClient,userTableName,"ByToken");
 			changed=true;
 		}
 		if(hasIndex(tableDesc,"ByGlobusID") && 
@@ -348,7 +1012,7 @@ void PersistentStore::InitializeUserTable(std::string bootstrapUserFile){
 			auto updateResult=dbClient.UpdateTable(req);
 			if(!updateResult.IsSuccess())
 				log_fatal("Failed to delete incomplete ByGlobusID secondary index from user table: " + updateResult.GetError().GetMessage());
-			waitUntilIndexDeleted(dbClient,groupTableName,"ByGlobusID");
+			waitUntilIndexDeleted(dbClient,userTableName,"ByGlobusID");
 			changed=true;
 		}
 		
@@ -740,16 +1404,289 @@ void PersistentStore::InitializeInstanceTable(){
 			waitTableReadiness(dbClient,instanceTableName);
 			log_info("Added by-name index to instance table");
 		}
-		if(!hasIndex(tableDesc,"ByCluster")){
-			auto request=updateTableWithNewSecondaryIndex(instanceTableName,getByClusterIndex());
-			request.WithAttributeDefinitions({AttDef().WithAttributeName("cluster").WithAttributeType(SAT::S)});
-			auto createOut=dbClient.UpdateTable(request);
-			if(!createOut.IsSuccess())
-				log_fatal("Failed to add by-cluster index to instance table: " + createOut.GetError().GetMessage());
-			waitTableReadiness(dbClient,instanceTableName);
-			log_info("Added by-cluster index to instance table");
+		if(!hasIndex(tableDesc,"ByCluster")){
+			auto request=updateTableWithNewSecondaryIndex(instanceTableName,getByClusterIndex());
+			request.WithAttributeDefinitions({AttDef().WithAttributeName("cluster").WithAttributeType(SAT::S)});
+			auto createOut=dbClient.UpdateTable(request);
+			if(!createOut.IsSuccess())
+				log_fatal("Failed to add by-cluster index to instance table: " + createOut.GetError().GetMessage());
+			waitTableReadiness(dbClient,instanceTableName);
+			log_info("Added by-cluster index to instance table");
+		}
+	}
+}
+
+void PersistentStore::InitializeInstanceConfigTable(){
+	using namespace Aws::DynamoDB::Model;
+	using AttDef=Aws::DynamoDB::Model::AttributeDefinition;
+	using SAT=Aws::DynamoDB::Model::ScalarAttributeType;
+	
+	auto configTableOut=dbClient.DescribeTable(DescribeTableRequest()
+	                                           .WithTableName(instanceConfigTableName));
+	if(!configTableOut.IsSuccess() &&
+	   configTableOut.GetError().GetErrorType()!=Aws::DynamoDB::DynamoDBErrors::RESOURCE_NOT_FOUND){
+		log_fatal("Unable to connect to DynamoDB: "
+		          << configTableOut.GetError().GetMessage());
+	}
+	if(!configTableOut.IsSuccess()){
+		log_info("Instance config table does not exist; creating");
+		auto request=CreateTableRequest();
+		request.SetTableName(instanceConfigTableName);
+		request.SetAttributeDefinitions({
+			AttDef().WithAttributeName("ID").WithAttributeType(SAT::S)
+		});
+		request.SetKeySchema({
+			KeySchemaElement().WithAttributeName("ID").WithKeyType(KeyType::HASH)
+		});
+		request.SetProvisionedThroughput(ProvisionedThroughput()
+		                                 .WithReadCapacityUnits(1)
+		                                 .WithWriteCapacityUnits(1));
+		
+		auto createOut=dbClient.CreateTable(request);
+		if(!createOut.IsSuccess())
+			log_fatal("Failed to create instance config table: " + createOut.GetError().GetMessage());
+		
+		waitTableReadiness(dbClient,instanceConfigTableName);
+		log_info("Created instance config table");
+	}
+}
+
+void PersistentStore::InitializeJobTable(){
+	using namespace Aws::DynamoDB::Model;
+	using AttDef=Aws::DynamoDB::Model::AttributeDefinition;
+	using SAT=Aws::DynamoDB::Model::ScalarAttributeType;
+
+	//define indices
+	auto getByActivityIndex=[](){
+		return GlobalSecondaryIndex()
+		       .WithIndexName("ByActivity")
+		       .WithKeySchema({KeySchemaElement()
+		                       .WithAttributeName("active")
+		                       .WithKeyType(KeyType::HASH),
+		                       KeySchemaElement()
+		                       .WithAttributeName("updated")
+		                       .WithKeyType(KeyType::RANGE)})
+		       .WithProjection(Projection()
+		                       .WithProjectionType(ProjectionType::ALL))
+		       .WithProvisionedThroughput(ProvisionedThroughput()
+		                                  .WithReadCapacityUnits(1)
+		                                  .WithWriteCapacityUnits(1));
+	};
+
+	auto jobTableOut=dbClient.DescribeTable(DescribeTableRequest()
+	                                        .WithTableName(jobTableName));
+	if(!jobTableOut.IsSuccess() &&
+	   jobTableOut.GetError().GetErrorType()!=Aws::DynamoDB::DynamoDBErrors::RESOURCE_NOT_FOUND){
+		log_fatal("Unable to connect to DynamoDB: "
+		          << jobTableOut.GetError().GetMessage());
+	}
+	if(!jobTableOut.IsSuccess()){
+		log_info("Job table does not exist; creating");
+		auto request=CreateTableRequest();
+		request.SetTableName(jobTableName);
+		request.SetAttributeDefinitions({
+			AttDef().WithAttributeName("ID").WithAttributeType(SAT::S),
+			AttDef().WithAttributeName("active").WithAttributeType(SAT::S),
+			AttDef().WithAttributeName("updated").WithAttributeType(SAT::N)
+		});
+		request.SetKeySchema({
+			KeySchemaElement().WithAttributeName("ID").WithKeyType(KeyType::HASH)
+		});
+		request.SetProvisionedThroughput(ProvisionedThroughput()
+		                                 .WithReadCapacityUnits(1)
+		                                 .WithWriteCapacityUnits(1));
+		request.AddGlobalSecondaryIndexes(getByActivityIndex());
+
+		auto createOut=dbClient.CreateTable(request);
+		if(!createOut.IsSuccess())
+			log_fatal("Failed to create job table: " + createOut.GetError().GetMessage());
+
+		waitTableReadiness(dbClient,jobTableName);
+		log_info("Created job table");
+	}
+	else if(!hasIndex(jobTableOut.GetResult().GetTable(),"ByActivity")){
+		auto request=updateTableWithNewSecondaryIndex(jobTableName,getByActivityIndex());
+		request.WithAttributeDefinitions({AttDef().WithAttributeName("active").WithAttributeType(SAT::S),
+		                                  AttDef().WithAttributeName("updated").WithAttributeType(SAT::N)});
+		auto createOut=dbClient.UpdateTable(request);
+		if(!createOut.IsSuccess())
+			log_fatal("Failed to add by-activity index to job table: " + createOut.GetError().GetMessage());
+		waitIndexReadiness(dbClient,jobTableName,"ByActivity");
+		log_info("Added by-activity index to job table");
+		migrateActiveJobs();
+	}
+
+	//Have old job records deleted automatically. This is not essential, and
+	//not all DynamoDB implementations support it, so failure is not fatal.
+	auto ttlOut=dbClient.DescribeTimeToLive(DescribeTimeToLiveRequest()
+	                                        .WithTableName(jobTableName));
+	if(!ttlOut.IsSuccess()){
+		log_warn("Unable to check expiration of job records: "
+		         << ttlOut.GetError().GetMessage());
+		return;
+	}
+	if(ttlOut.GetResult().GetTimeToLiveDescription().GetTimeToLiveStatus()==TimeToLiveStatus::DISABLED){
+		auto updateOut=dbClient.UpdateTimeToLive(UpdateTimeToLiveRequest()
+		                                         .WithTableName(jobTableName)
+		                                         .WithTimeToLiveSpecification(TimeToLiveSpecification()
+		                                                                      .WithAttributeName("expires")
+		                                                                      .WithEnabled(true)));
+		if(!updateOut.IsSuccess())
+			log_warn("Unable to enable expiration of job records: "
+			         << updateOut.GetError().GetMessage());
+	}
+}
+
+void PersistentStore::migrateActiveJobs(){
+	using AV=Aws::DynamoDB::Model::AttributeValue;
+	Aws::DynamoDB::Model::ScanRequest request;
+	request.SetTableName(jobTableName);
+	request.SetFilterExpression("#status IN (:pending, :running) AND attribute_not_exists(active)");
+	request.SetExpressionAttributeNames({{"#status","status"}});
+	request.SetExpressionAttributeValues({
+		{":pending",AV("pending")},
+		{":running",AV("running")}
+	});
+	std::size_t migrated=0;
+	bool keepGoing=false;
+	
+	do{
+		databaseScans++;
+		auto outcome=dbClient.Scan(request);
+		if(!outcome.IsSuccess()){
+			auto err=outcome.GetError();
+			log_error("Failed to scan for job records to migrate: " << err.GetMessage());
+			return;
+		}
+		const auto& result=outcome.GetResult();
+		if(!result.GetLastEvaluatedKey().empty()){
+			keepGoing=true;
+			request.SetExclusiveStartKey(result.GetLastEvaluatedKey());
+		}
+		else
+			keepGoing=false;
+		for(const auto& item : result.GetItems()){
+			//records without an update time were written by versions which 
+			//did not refresh them, so they are treated as long out of date
+			auto outcome=dbClient.UpdateItem(Aws::DynamoDB::Model::UpdateItemRequest()
+			                                 .WithTableName(jobTableName)
+			                                 .WithKey({{"ID",item.find("ID")->second}})
+			                                 .WithUpdateExpression("SET active = :active, updated = if_not_exists(updated, :never)")
+			                                 .WithExpressionAttributeValues({
+			                                   {":active",AV("1")},
+			                                   {":never",AV().SetN("0")}
+			                                 }));
+			if(!outcome.IsSuccess())
+				log_error("Failed to migrate job record: " << outcome.GetError().GetMessage());
+			else
+				migrated++;
+		}
+	}while(keepGoing);
+	if(migrated)
+		log_info("Added " << migrated << " unfinished job records to the by-activity index");
+}
+
+void PersistentStore::migrateInstanceConfigs(){
+	using AV=Aws::DynamoDB::Model::AttributeValue;
+	Aws::DynamoDB::Model::ScanRequest request;
+	request.SetTableName(instanceTableName);
+	request.SetFilterExpression("attribute_exists(#config)");
+	request.SetExpressionAttributeNames({{"#config","config"}});
+	std::size_t migrated=0;
+	bool keepGoing=false;
+	
+	do{
+		databaseScans++;
+		auto outcome=dbClient.Scan(request);
+		if(!outcome.IsSuccess()){
+			auto err=outcome.GetError();
+			log_error("Failed to scan for instance config records to migrate: " << err.GetMessage());
+			return;
+		}
+		const auto& result=outcome.GetResult();
+		if(!result.GetLastEvaluatedKey().empty()){
+			keepGoing=true;
+			request.SetExclusiveStartKey(result.GetLastEvaluatedKey());
+		}
+		else
+			keepGoing=false;
+		for(const auto& item : result.GetItems()){
+			if(stopMigration)
+				return;
+			auto idIt=item.find("ID"), sortKeyIt=item.find("sortKey"), configIt=item.find("config");
+			if(idIt==item.end() || sortKeyIt==item.end() || configIt==item.end())
+				continue;
+			const std::string& id=idIt->second.GetS();
+			//copy the config, unless it has somehow already been written to 
+			//the new table, in which case that copy is authoritative. 
+			//Old records always hold plain strings, so this is also where 
+			//they get compressed. 
+			auto putOutcome=dbClient.PutItem(Aws::DynamoDB::Model::PutItemRequest()
+			                                 .WithTableName(instanceConfigTableName)
+			                                 .WithItem({{"ID",AV(id)},
+			                                            {"config",configAttribute(packConfig(configIt->second.GetS()))}})
+			                                 .WithConditionExpression("attribute_not_exists(ID)"));
+			if(!putOutcome.IsSuccess() && putOutcome.GetError().GetErrorType()!=
+			   Aws::DynamoDB::DynamoDBErrors::CONDITIONAL_CHECK_FAILED){
+				log_error("Failed to migrate config for instance " << id << ": " 
+				          << putOutcome.GetError().GetMessage());
+				continue;
+			}
+			auto deleteOutcome=dbClient.DeleteItem(Aws::DynamoDB::Model::DeleteItemRequest()
+			                                       .WithTableName(instanceTableName)
+			                                       .WithKey({{"ID",idIt->second},
+			                                                 {"sortKey",sortKeyIt->second}}));
+			if(!deleteOutcome.IsSuccess()){
+				log_error("Failed to delete old config record for instance " << id << ": " 
+				          << deleteOutcome.GetError().GetMessage());
+				continue;
+			}
+			migrated++;
+		}
+	}while(keepGoing && !stopMigration);
+	if(migrated)
+		log_info("Migrated " << migrated << " instance configs to " << instanceConfigTableName);
+}
+
+bool PersistentStore::batchWrite(const std::string& tableName, 
+                                 const std::vector<Aws::DynamoDB::Model::WriteRequest>& requests){
+	using namespace Aws::DynamoDB::Model;
+	const std::size_t maxBatchSize=25; //the limit imposed by DynamoDB
+	const unsigned int maxAttempts=8;
+	const std::chrono::milliseconds initialDelay(50);
+	
+	for(std::size_t start=0; start<requests.size(); start+=maxBatchSize){
+		Aws::Vector<WriteRequest> batch(requests.begin()+start,
+		                                requests.begin()+std::min(start+maxBatchSize,requests.size()));
+		std::chrono::milliseconds delay=initialDelay;
+		for(unsigned int attempt=1; ; attempt++){
+			auto outcome=dbClient.BatchWriteItem(BatchWriteItemRequest()
+			                                     .WithRequestItems({{tableName,batch}}));
+			if(!outcome.IsSuccess()){
+				auto err=outcome.GetError();
+				if(!err.ShouldRetry() || attempt==maxAttempts){
+					log_error("Failed to write batch of records to " << tableName << ": " << err.GetMessage());
+					return false;
+				}
+			}
+			else{
+				//DynamoDB may decline to process some items if capacity is exceeded
+				const auto& unprocessed=outcome.GetResult().GetUnprocessedItems();
+				auto remaining=unprocessed.find(tableName);
+				if(remaining==unprocessed.end() || remaining->second.empty())
+					break;
+				if(attempt==maxAttempts){
+					log_error(remaining->second.size() << " records remained unprocessed after "
+					          << maxAttempts << " batch writes to " << tableName);
+					return false;
+				}
+				batch=remaining->second;
+			}
+			std::this_thread::sleep_for(delay);
+			delay*=2;
 		}
 	}
+	return true;
 }
 
 void PersistentStore::InitializeSecretTable(){
@@ -849,11 +1786,34 @@ void PersistentStore::InitializeSecretTable(){
 }
 
 void PersistentStore::InitializeTables(std::string bootstrapUserFile){
-	InitializeUserTable(bootstrapUserFile);
-	InitializeGroupTable();
-	InitializeClusterTable();
-	InitializeInstanceTable();
-	InitializeSecretTable();
+	//Tables are independent, so they are checked concurrently, and the time 
+	//taken is that of the slowest table rather than the sum for all of them. 
+	//Changes to any one table must still be made in order, since DynamoDB 
+	//allows only one index to be created at a time on each table. 
+	const auto start=std::chrono::steady_clock::now();
+	std::vector<std::future<void>> initializations;
+	initializations.push_back(std::async(std::launch::async,[this,bootstrapUserFile]{ InitializeUserTable(bootstrapUserFile); }));
+	initializations.push_back(std::async(std::launch::async,[this]{ InitializeGroupTable(); }));
+	initializations.push_back(std::async(std::launch::async,[this]{ InitializeClusterTable(); }));
+	initializations.push_back(std::async(std::launch::async,[this]{ InitializeInstanceTable(); }));
+	initializations.push_back(std::async(std::launch::async,[this]{ InitializeInstanceConfigTable(); }));
+	initializations.push_back(std::async(std::launch::async,[this]{ InitializeSecretTable(); }));
+	initializations.push_back(std::async(std::launch::async,[this]{ InitializeJobTable(); }));
+	//wait for every table, even if one fails, then report the first failure
+	std::exception_ptr failure;
+	for(auto& initialization : initializations){
+		try{
+			initialization.get();
+		}catch(...){
+			if(!failure)
+				failure=std::current_exception();
+		}
+	}
+	if(failure)
+		std::rethrow_exception(failure);
+	log_info("Database tables ready after " 
+	         << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start).count() 
+	         << " ms");
 }
 
 void PersistentStore::loadEncyptionKey(const std::string& fileName){
@@ -867,20 +1827,9 @@ void PersistentStore::loadEncyptionKey(const std::string& fileName){
 }
 
 bool PersistentStore::addUser(const User& user){
-	using Aws::DynamoDB::Model::AttributeValue;
 	auto request=Aws::DynamoDB::Model::PutItemRequest()
 	.WithTableName(userTableName)
-	.WithItem({
-		{"ID",AttributeValue(user.id)},
-		{"sortKey",AttributeValue(user.id)},
-		{"name",AttributeValue(user.name)},
-		{"globusID",AttributeValue(user.globusID)},
-		{"token",AttributeValue(user.token)},
-		{"email",AttributeValue(user.email)},
-		{"phone",AttributeValue(user.phone)},
-		{"institution",AttributeValue(user.institution)},
-		{"admin",AttributeValue().SetBool(user.admin)}
-	});
+	.WithItem(userItem(user));
 	auto outcome=dbClient.PutItem(request);
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
@@ -897,6 +1846,27 @@ bool PersistentStore::addUser(const User& user){
 	return true;
 }
 
+bool PersistentStore::addUsers(const std::vector<User>& users){
+	std::vector<Aws::DynamoDB::Model::WriteRequest> writes;
+	writes.reserve(users.size());
+	for(const User& user : users)
+		writes.push_back(putRequest(userItem(user)));
+	if(!batchWrite(userTableName,writes)){
+		log_error("Failed to add user records");
+		return false;
+	}
+	
+	//update caches
+	for(const User& user : users){
+		CacheRecord<User> record(user,userCacheValidity);
+		replaceCacheRecord(userCache,user.id,record);
+		replaceCacheRecord(userByTokenCache,user.token,record);
+		replaceCacheRecord(userByGlobusIDCache,user.globusID,record);
+	}
+	
+	return true;
+}
+
 User PersistentStore::getUser(const std::string& id){
 	//first see if we have this cached
 	{
@@ -912,11 +1882,10 @@ User PersistentStore::getUser(const std::string& id){
 	//need to query the database
 	databaseQueries++;
 	log_info("Querying database for user " << id);
-	using Aws::DynamoDB::Model::AttributeValue;
-	auto outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
-								  .WithTableName(userTableName)
-								  .WithKey({{"ID",AttributeValue(id)},
-	                                        {"sortKey",AttributeValue(id)}}));
+	return userFromOutcome(id,dbClient.GetItem(recordRequest(userTableName,id)));
+}
+
+User PersistentStore::userFromOutcome(const std::string& id, const Aws::DynamoDB::Model::GetItemOutcome& outcome){
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
 		log_error("Failed to fetch user record: " << err.GetMessage());
@@ -925,16 +1894,7 @@ User PersistentStore::getUser(const std::string& id){
 	const auto& item=outcome.GetResult().GetItem();
 	if(item.empty()) //no match found
 		return User{};
-	User user;
-	user.valid=true;
-	user.id=id;
-	user.name=findOrThrow(item,"name","user record missing name attribute").GetS();
-	user.email=findOrThrow(item,"email","user record missing email attribute").GetS();
-	user.phone=findOrDefault(item,"phone",missingString).GetS();
-	user.institution=findOrDefault(item,"institution",missingString).GetS();
-	user.token=findOrThrow(item,"token","user record missing token attribute").GetS();
-	user.globusID=findOrThrow(item,"globusID","user record missing globusID attribute").GetS();
-	user.admin=findOrThrow(item,"admin","user record missing admin attribute").GetBool();
+	User user=userFromItem(id,item);
 	
 	//update caches
 	CacheRecord<User> record(user,userCacheValidity);
@@ -945,6 +1905,16 @@ User PersistentStore::getUser(const std::string& id){
 	return user;
 }
 
+std::future<User> PersistentStore::getUserAsync(const std::string& id){
+	User result;
+	if(findCached(userCache,id,result))
+		return makeReadyFuture(result);
+	databaseQueries++;
+	log_info("Querying database for user " << id);
+	return then(dbClient.GetItemCallable(recordRequest(userTableName,id)),
+	            [this,id](const Aws::DynamoDB::Model::GetItemOutcome& outcome){ return userFromOutcome(id,outcome); });
+}
+
 User PersistentStore::findUserByToken(const std::string& token){
 	//first see if we have this cached
 	{
@@ -1109,6 +2079,7 @@ bool PersistentStore::removeUser(const std::string& id){
 			userByGlobusIDCache.erase(record.record.globusID);
 		}
 		userCache.erase(id);
+		userGroupMembershipCache.erase(id);
 	}
 	
 	using Aws::DynamoDB::Model::AttributeValue;
@@ -1175,11 +2146,16 @@ std::vector<User> PersistentStore::listUsers(){
 			user.institution=findOrDefault(item,"institution",missingString).GetS();
 			user.admin=item.find("admin")->second.GetBool();
 			collected.push_back(user);
-
-			CacheRecord<User> record(user,userCacheValidity);
-	replaceCacheRecord(		userCache,user.id,record);
 		}
 	}while(keepGoing);
+	//a listing which does not fit the cache's budget would just be evicted, 
+	//and so would not remain complete, so it is not worth caching
+	if(!cacheManager.canHold("userCache",collected.size()))
+		return collected;
+	for(const User& user : collected){
+		CacheRecord<User> record(user,userCacheValidity);
+		replaceCacheRecord(userCache,user.id,record);
+	}
 	userCacheExpirationTime=std::chrono::steady_clock::now()+userCacheValidity;
 	
 	return collected;
@@ -1188,10 +2164,10 @@ std::vector<User> PersistentStore::listUsers(){
 std::vector<User> PersistentStore::listUsersByGroup(const std::string& group){
 	//first check if list of users is cached
 	auto cached = userByGroupCache.find(group);
-	if (cached.second > std::chrono::steady_clock::now()) {
-		auto records = cached.first;
+	if (cached.expiration > std::chrono::steady_clock::now()) {
 		std::vector<User> users;
-		for (auto record : records) {
+		users.reserve(cached.items().size());
+		for (const auto& record : cached.items()) {
 			cacheHits++;
 			auto user = getUser(record);
 			users.push_back(user);
@@ -1246,14 +2222,9 @@ bool PersistentStore::addUserToGroup(const std::string& uID, std::string groupID
 	Group group = findGroupByID(groupID);
 	User user = getUser(uID);
 	
-	using Aws::DynamoDB::Model::AttributeValue;
 	auto request=Aws::DynamoDB::Model::PutItemRequest()
 	  .WithTableName(userTableName)
-	  .WithItem({
-		{"ID",AttributeValue(uID)},
-		{"sortKey",AttributeValue(uID+":"+groupID)},
-		{"groupID",AttributeValue(groupID)}
-	});
+	  .WithItem(membershipItem(uID,groupID));
 	auto outcome=dbClient.PutItem(request);
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
@@ -1266,6 +2237,44 @@ bool PersistentStore::addUserToGroup(const std::string& uID, std::string groupID
 	userByGroupCache.insert_or_assign(groupID,record);
 	CacheRecord<Group> groupRecord(group,groupCacheValidity); 
 	groupByUserCache.insert_or_assign(user.id, groupRecord);
+	membershipGeneration++;
+	userGroupMembershipCache.update_fn(uID,[&](CacheRecord<std::set<std::string>>& memberships){
+		memberships.record.insert(groupID);
+	});
+	
+	return true;
+}
+
+bool PersistentStore::addUsersToGroups(const std::vector<std::pair<std::string,std::string>>& memberships){
+	std::vector<Aws::DynamoDB::Model::WriteRequest> writes;
+	writes.reserve(memberships.size());
+	for(const auto& membership : memberships)
+		writes.push_back(putRequest(membershipItem(membership.first,membership.second)));
+	bool success=batchWrite(userTableName,writes);
+	membershipGeneration++;
+	if(!success){
+		log_error("Failed to add user Group membership records");
+		//some of the records may have been written, so cached membership 
+		//information for all of the users involved may be incomplete
+		for(const auto& membership : memberships)
+			userGroupMembershipCache.erase(membership.first);
+		return false;
+	}
+	
+	//update caches
+	std::map<std::string,CacheRecord<Group>> groupRecords;
+	for(const auto& membership : memberships){
+		const std::string& uID=membership.first;
+		const std::string& groupID=membership.second;
+		auto groupIt=groupRecords.find(groupID);
+		if(groupIt==groupRecords.end())
+			groupIt=groupRecords.emplace(groupID,CacheRecord<Group>(findGroupByID(groupID),groupCacheValidity)).first;
+		userByGroupCache.insert_or_assign(groupID,CacheRecord<std::string>(uID,userCacheValidity));
+		groupByUserCache.insert_or_assign(uID,groupIt->second);
+		userGroupMembershipCache.update_fn(uID,[&](CacheRecord<std::set<std::string>>& groups){
+			groups.record.insert(groupID);
+		});
+	}
 	
 	return true;
 }
@@ -1293,93 +2302,132 @@ bool PersistentStore::removeUserFromGroup(const std::string& uID, std::string gr
 		log_error("Failed to delete user Group membership record: " << err.GetMessage());
 		return false;
 	}
+	membershipGeneration++;
+	userGroupMembershipCache.update_fn(uID,[&](CacheRecord<std::set<std::string>>& memberships){
+		memberships.record.erase(groupID);
+	});
 	return true;
 }
 
-std::vector<std::string> PersistentStore::getUserGroupMemberships(const std::string& uID, bool useNames){
-	using Aws::DynamoDB::Model::AttributeValue;
+bool PersistentStore::getUserGroupMembershipSet(const std::string& uID, std::set<std::string>& groups){
+	//first see if we have this cached
+	{
+		CacheRecord<std::set<std::string>> record;
+		if(userGroupMembershipCache.find(uID,record)){
+			//we have a cached record; is it still valid?
+			if(record){ //it is, just return it
+				cacheHits++;
+				groups=std::move(record.record);
+				return true;
+			}
+		}
+	}
+	
+	//need to query the database
+	const unsigned long generation=membershipGeneration.load();
 	databaseQueries++;
 	log_info("Querying database for user " << uID << " Group memberships");
-	auto request=Aws::DynamoDB::Model::QueryRequest()
+	auto request=membershipQuery(uID);
+	return collectGroupMemberships(uID,request,dbClient.Query(request),generation,groups);
+}
+
+Aws::DynamoDB::Model::QueryRequest PersistentStore::membershipQuery(const std::string& uID) const{
+	using Aws::DynamoDB::Model::AttributeValue;
+	return Aws::DynamoDB::Model::QueryRequest()
 	.WithTableName(userTableName)
 	.WithKeyConditionExpression("#id = :id AND begins_with(#sortKey,:prefix)")
+	.WithProjectionExpression("#groupID")
 	.WithExpressionAttributeNames({
 		{"#id","ID"},
-		{"#sortKey","sortKey"}
+		{"#sortKey","sortKey"},
+		{"#groupID","groupID"}
 	})
 	.WithExpressionAttributeValues({
 		{":id",AttributeValue(uID)},
 		{":prefix",AttributeValue(uID+":"+IDGenerator::groupIDPrefix)}
 	});
-	auto outcome=dbClient.Query(request);
-	std::vector<std::string> vos;
-	if(!outcome.IsSuccess()){
-		auto err=outcome.GetError();
-		log_error("Failed to fetch user's Group membership records: " << err.GetMessage());
-		return vos;
+}
+
+bool PersistentStore::collectGroupMemberships(const std::string& uID, 
+                                              Aws::DynamoDB::Model::QueryRequest request, 
+                                              Aws::DynamoDB::Model::QueryOutcome outcome, 
+                                              unsigned long generation, 
+                                              std::set<std::string>& groups){
+	std::set<std::string> collected;
+	while(true){
+		if(!outcome.IsSuccess()){
+			auto err=outcome.GetError();
+			log_error("Failed to fetch user's Group membership records: " << err.GetMessage());
+			return false;
+		}
+		const auto& result=outcome.GetResult();
+		for(const auto& item : result.GetItems()){
+			if(item.count("groupID"))
+				collected.insert(item.find("groupID")->second.GetS());
+		}
+		if(result.GetLastEvaluatedKey().empty())
+			break;
+		//fetch the next page
+		request.SetExclusiveStartKey(result.GetLastEvaluatedKey());
+		outcome=dbClient.Query(request);
 	}
 	
-	const auto& queryResult=outcome.GetResult();
-	for(const auto& item : queryResult.GetItems()){
-		if(item.count("groupID"))
-			vos.push_back(item.find("groupID")->second.GetS());
+	//update cache, unless a membership changed while the query was in progress,
+	//in which case the result may already be stale
+	if(membershipGeneration.load()==generation){
+		CacheRecord<std::set<std::string>> record(collected,userCacheValidity);
+		replaceCacheRecord(userGroupMembershipCache,uID,record);
 	}
-	
-	if(useNames){
-		//do extra lookups to replace IDs with nicer names
-		for(std::string& groupStr : vos){
-			Group group=findGroupByID(groupStr);
-			groupStr=group.name;
-		}
+	groups=std::move(collected);
+	return true;
+}
+
+std::future<std::vector<std::string>> PersistentStore::getUserGroupMembershipsAsync(const std::string& uID){
+	std::set<std::string> groups;
+	if(findCached(userGroupMembershipCache,uID,groups))
+		return makeReadyFuture(std::vector<std::string>(groups.begin(),groups.end()));
+	const unsigned long generation=membershipGeneration.load();
+	databaseQueries++;
+	log_info("Querying database for user " << uID << " Group memberships");
+	auto request=membershipQuery(uID);
+	return then(dbClient.QueryCallable(request),
+	            [this,uID,request,generation](Aws::DynamoDB::Model::QueryOutcome outcome){
+	            	std::set<std::string> groups;
+	            	collectGroupMemberships(uID,request,std::move(outcome),generation,groups);
+	            	return std::vector<std::string>(groups.begin(),groups.end());
+	            });
+}
+
+std::vector<std::string> PersistentStore::getUserGroupMemberships(const std::string& uID, bool useNames){
+	std::set<std::string> groups;
+	std::vector<std::string> vos;
+	if(!getUserGroupMembershipSet(uID,groups))
+		return vos;
+	vos.reserve(groups.size());
+	if(useNames){ //do extra lookups to replace IDs with nicer names
+		std::vector<std::future<Group>> lookups;
+		lookups.reserve(groups.size());
+		for(const std::string& groupID : groups)
+			lookups.push_back(findGroupByIDAsync(groupID));
+		for(auto& lookup : lookups)
+			vos.push_back(lookup.get().name);
 	}
-	
+	else
+		vos.assign(groups.begin(),groups.end());
 	return vos;
 }
 
 bool PersistentStore::userInGroup(const std::string& uID, std::string groupID){
-	//TODO: possible issue: We only store memberships, so repeated queries about
-	//a user's belonging to a Group to which that user does not in fact belong will
-	//never be in the cache, and will always incur a database query. This should
-	//not be a problem for normal/well intentioned use, but seems like a way to
-	//turn accident or malice into denial of service or a large AWS bill. 
-	
 	//check whether the 'ID' we got was actually a name
 	if(!normalizeGroupID(groupID))
 		return false;
 	
-	//first see if we have this cached
-	{
-		CacheRecord<std::string> record(uID);
-		if(userByGroupCache.find(groupID,record)){
-			//we have a cached record; is it still valid?
-			if(record){ //it is, just return it
-				cacheHits++;
-				return record;
-			}
-		}
-	}
-	//need to query the database
-	databaseQueries++;
-	log_info("Querying database for user " << uID << " membership in Group " << groupID);
-	using Aws::DynamoDB::Model::AttributeValue;
-	auto outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
-								  .WithTableName(userTableName)
-								  .WithKey({{"ID",AttributeValue(uID)},
-	                                        {"sortKey",AttributeValue(uID+":"+groupID)}}));
-	if(!outcome.IsSuccess()){
-		auto err=outcome.GetError();
-		log_error("Failed to fetch user Group membership record: " << err.GetMessage());
-		return false;
-	}
-	const auto& item=outcome.GetResult().GetItem();
-	if(item.empty()) //no match found
+	//The full set of the user's memberships is cached, so this is answered 
+	//from memory whether or not the user actually belongs to the group
+	std::set<std::string> groups;
+	if(!getUserGroupMembershipSet(uID,groups))
 		return false;
-	
-	//update cache
-	CacheRecord<std::string> record(uID,userCacheValidity);
-	userByGroupCache.insert_or_assign(groupID,record);
-	
-	return true;
+	return groups.count(groupID);
 }
 
 //----
@@ -1422,9 +2470,27 @@ bool PersistentStore::removeGroup(const std::string& groupID){
 	using Aws::DynamoDB::Model::AttributeValue;
 	
 	//delete all memberships in the group
-	for(auto uID : getMembersOfGroup(groupID)){
-		if(!removeUserFromGroup(uID,groupID))
+	{
+		std::vector<std::string> members=getMembersOfGroup(groupID);
+		CacheRecord<Group> record;
+		bool cached=groupCache.find(groupID,record);
+		std::vector<Aws::DynamoDB::Model::WriteRequest> deletions;
+		deletions.reserve(members.size());
+		for(const auto& uID : members){
+			userByGroupCache.erase(groupID,CacheRecord<std::string>(uID));
+			if(cached)
+				groupByUserCache.erase(uID,record);
+			deletions.push_back(deleteRequest({{"ID",AttributeValue(uID)},
+			                                   {"sortKey",AttributeValue(uID+":"+groupID)}}));
+		}
+		bool success=batchWrite(userTableName,deletions);
+		membershipGeneration++;
+		for(const auto& uID : members)
+			userGroupMembershipCache.erase(uID);
+		if(!success){
+			log_error("Failed to delete Group membership records");
 			return false;
+		}
 	}
 	
 	//erase cache entries
@@ -1589,12 +2655,17 @@ std::vector<Group> PersistentStore::listGroups(){
 			group.scienceField=findOrDefault(item,"scienceField",missingString).GetS();
 			group.description=findOrDefault(item,"description",missingString).GetS();
 			collected.push_back(group);
-
-			CacheRecord<Group> record(group,groupCacheValidity);
-			replaceCacheRecord(groupCache,group.id,record);
-			replaceCacheRecord(groupByNameCache,group.name,record);
 		}
 	}while(keepGoing);
+	//a listing which does not fit the cache's budget would just be evicted, 
+	//and so would not remain complete, so it is not worth caching
+	if(!cacheManager.canHold("groupCache",collected.size()))
+		return collected;
+	for(const Group& group : collected){
+		CacheRecord<Group> record(group,groupCacheValidity);
+		replaceCacheRecord(groupCache,group.id,record);
+		replaceCacheRecord(groupByNameCache,group.name,record);
+	}
 	groupCacheExpirationTime=std::chrono::steady_clock::now()+groupCacheValidity;
 	
 	return collected;
@@ -1659,11 +2730,10 @@ Group PersistentStore::findGroupByID(const std::string& id){
 	//need to query the database
 	databaseQueries++;
 	log_info("Querying database for Group " << id);
-	using Aws::DynamoDB::Model::AttributeValue;
-	auto outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
-	                              .WithTableName(groupTableName)
-	                              .WithKey({{"ID",AttributeValue(id)},
-	                                        {"sortKey",AttributeValue(id)}}));
+	return groupFromOutcome(id,dbClient.GetItem(recordRequest(groupTableName,id)));
+}
+
+Group PersistentStore::groupFromOutcome(const std::string& id, const Aws::DynamoDB::Model::GetItemOutcome& outcome){
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
 		log_error("Failed to fetch Group record: " << err.GetMessage());
@@ -1672,14 +2742,7 @@ Group PersistentStore::findGroupByID(const std::string& id){
 	const auto& item=outcome.GetResult().GetItem();
 	if(item.empty()) //no match found
 		return Group{};
-	Group group;
-	group.valid=true;
-	group.id=id;
-	group.name=findOrThrow(item,"name","Group record missing name attribute").GetS();
-	group.email=findOrDefault(item,"email",missingString).GetS();
-	group.phone=findOrDefault(item,"phone",missingString).GetS();
-	group.scienceField=findOrDefault(item,"scienceField",missingString).GetS();
-	group.description=findOrDefault(item,"description",missingString).GetS();
+	Group group=groupFromItem(id,item);
 	
 	//update caches
 	CacheRecord<Group> record(group,groupCacheValidity);
@@ -1689,6 +2752,16 @@ Group PersistentStore::findGroupByID(const std::string& id){
 	return group;
 }
 
+std::future<Group> PersistentStore::findGroupByIDAsync(const std::string& id){
+	Group result;
+	if(findCached(groupCache,id,result))
+		return makeReadyFuture(result);
+	databaseQueries++;
+	log_info("Querying database for Group " << id);
+	return then(dbClient.GetItemCallable(recordRequest(groupTableName,id)),
+	            [this,id](const Aws::DynamoDB::Model::GetItemOutcome& outcome){ return groupFromOutcome(id,outcome); });
+}
+
 Group PersistentStore::findGroupByName(const std::string& name){
 	//first see if we have this cached
 	{
@@ -1747,12 +2820,23 @@ Group PersistentStore::getGroup(const std::string& idOrName){
 	return findGroupByName(idOrName);
 }
 
+std::future<Group> PersistentStore::getGroupAsync(const std::string& idOrName){
+	if(idOrName.find(IDGenerator::groupIDPrefix)==0)
+		return findGroupByIDAsync(idOrName);
+	Group group;
+	if(findCached(groupByNameCache,idOrName,group))
+		return makeReadyFuture(group);
+	//lookups by name use an index query, which is not worth splitting up, so
+	//just perform the whole operation in the background
+	return std::async(std::launch::async,[this,idOrName]{ return findGroupByName(idOrName); });
+}
+
 //----
 
 SharedFileHandle PersistentStore::configPathForCluster(const std::string& cID){
 	if(!findClusterByID(cID)) //need to do this to ensure local data is fresh
 		log_fatal(cID << " does not exist; cannot get config data");
-	return clusterConfigs.find(cID);
+	return clusterConfigs.find(cID).file;
 }
 
 bool PersistentStore::addCluster(const Cluster& cluster){
@@ -1763,7 +2847,7 @@ bool PersistentStore::addCluster(const Cluster& cluster){
 		{"ID",AttributeValue(cluster.id)},
 		{"sortKey",AttributeValue(cluster.id)},
 		{"name",AttributeValue(cluster.name)},
-		{"config",AttributeValue(cluster.config)},
+		{"config",configAttribute(packConfig(cluster.config))},
 		{"systemNamespace",AttributeValue(cluster.systemNamespace)},
 		{"owningGroup",AttributeValue(cluster.owningGroup)},
 		{"owningOrganization",AttributeValue(cluster.owningOrganization)},
@@ -1785,6 +2869,18 @@ bool PersistentStore::addCluster(const Cluster& cluster){
 }
 
 void PersistentStore::writeClusterConfigToDisk(const Cluster& cluster){
+	//cluster records are refreshed far more often than their configs change, 
+	//so avoid churning the filesystem when the contents would be the same
+	bool unchanged=false;
+	clusterConfigs.find_fn(cluster.id,[&](const ClusterConfigFile& existing){
+		unchanged=(existing.config==cluster.config);
+	});
+	if(unchanged){
+		configWritesAvoided++;
+		return;
+	}
+	
+	configWrites++;
 	FileHandle file=makeTemporaryFile(clusterConfigDir+"/"+cluster.id+"_v");
 	std::ofstream confFile(file.path());
 	if(!confFile)
@@ -1793,7 +2889,8 @@ void PersistentStore::writeClusterConfigToDisk(const Cluster& cluster){
 	if(confFile.fail())
 		log_fatal("Unable to write cluster config to " << file.path());
 	
-	replaceCacheRecord(clusterConfigs,cluster.id,std::make_shared<FileHandle>(std::move(file)));
+	replaceCacheRecord(clusterConfigs,cluster.id,
+	                   ClusterConfigFile{cluster.config,std::make_shared<FileHandle>(std::move(file))});
 }
 
 Cluster PersistentStore::findClusterByID(const std::string& cID){
@@ -1809,13 +2906,12 @@ Cluster PersistentStore::findClusterByID(const std::string& cID){
 		}
 	}
 	//need to query the database
-	using Aws::DynamoDB::Model::AttributeValue;
 	databaseQueries++;
 	log_info("Querying database for cluster " << cID);
-	auto outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
-								  .WithTableName(clusterTableName)
-								  .WithKey({{"ID",AttributeValue(cID)},
-	                                        {"sortKey",AttributeValue(cID)}}));
+	return clusterFromOutcome(cID,dbClient.GetItem(recordRequest(clusterTableName,cID)));
+}
+
+Cluster PersistentStore::clusterFromOutcome(const std::string& cID, const Aws::DynamoDB::Model::GetItemOutcome& outcome){
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
 		log_error("Failed to fetch cluster record: " << err.GetMessage());
@@ -1824,14 +2920,7 @@ Cluster PersistentStore::findClusterByID(const std::string& cID){
 	const auto& item=outcome.GetResult().GetItem();
 	if(item.empty()) //no match found
 		return Cluster{};
-	Cluster cluster;
-	cluster.valid=true;
-	cluster.id=cID;
-	cluster.name=findOrThrow(item,"name","Cluster record missing name attribute").GetS();
-	cluster.owningGroup=findOrThrow(item,"owningGroup","Cluster record missing owningGroup attribute").GetS();
-	cluster.config=findOrThrow(item,"config","Cluster record missing config attribute").GetS();
-	cluster.systemNamespace=findOrThrow(item,"systemNamespace","Cluster record missing systemNamespace attribute").GetS();
-	cluster.owningOrganization=findOrDefault(item,"owningOrganization",missingString).GetS();
+	Cluster cluster=clusterFromItem(cID,item);
 	
 	//cache this result for reuse
 	CacheRecord<Cluster> record(cluster,clusterCacheValidity);
@@ -1843,6 +2932,16 @@ Cluster PersistentStore::findClusterByID(const std::string& cID){
 	return cluster;
 }
 
+std::future<Cluster> PersistentStore::findClusterByIDAsync(const std::string& cID){
+	Cluster result;
+	if(findCached(clusterCache,cID,result))
+		return makeReadyFuture(result);
+	databaseQueries++;
+	log_info("Querying database for cluster " << cID);
+	return then(dbClient.GetItemCallable(recordRequest(clusterTableName,cID)),
+	            [this,cID](const Aws::DynamoDB::Model::GetItemOutcome& outcome){ return clusterFromOutcome(cID,outcome); });
+}
+
 Cluster PersistentStore::findClusterByName(const std::string& name){
 	//first see if we have this cached
 	{
@@ -1885,8 +2984,8 @@ Cluster PersistentStore::findClusterByName(const std::string& name){
 	const auto& item=queryResult.GetItems().front();
 	cluster.owningGroup=findOrThrow(item,"owningGroup",
 	                             "Cluster record missing owningGroup attribute").GetS();
-	cluster.config=findOrThrow(item,"config",
-	                           "Cluster record missing config attribute").GetS();
+	cluster.config=unpackConfig(storedConfig(findOrThrow(item,"config",
+	                                                     "Cluster record missing config attribute")));
 	cluster.systemNamespace=findOrThrow(item,"systemNamespace",
 	                                    "Cluster record missing systemNamespace attribute").GetS();
 	cluster.owningOrganization=findOrDefault(item,"owningOrganization",missingString).GetS();
@@ -1907,11 +3006,17 @@ Cluster PersistentStore::getCluster(const std::string& idOrName){
 	return findClusterByName(idOrName);
 }
 
+std::future<Cluster> PersistentStore::getClusterAsync(const std::string& idOrName){
+	if(idOrName.find(IDGenerator::clusterIDPrefix)==0)
+		return findClusterByIDAsync(idOrName);
+	Cluster cluster;
+	if(findCached(clusterByNameCache,idOrName,cluster))
+		return makeReadyFuture(cluster);
+	//as with groups, lookups by name are performed entirely in the background
+	return std::async(std::launch::async,[this,idOrName]{ return findClusterByName(idOrName); });
+}
+
 bool PersistentStore::removeCluster(const std::string& cID){
-	//remove all records of groups granted access to the cluster
-	for(const auto& guest : listgroupsAllowedOnCluster(cID))
-		removeGroupFromCluster(guest,cID);
-	
 	//erase cache entries
 	{
 		//Somewhat hacky: we can't erase the byName cache entry unless we know 
@@ -1932,24 +3037,49 @@ bool PersistentStore::removeCluster(const std::string& cID){
 	clusterCache.erase(cID);
 	clusterConfigs.erase(cID);
 	clusterLocationCache.erase(cID);
+	clusterGroupAccessCache.erase(cID);
+	permissionIndex.removeCluster(cID);
 	
+	//Find all of the records belonging to the cluster: the cluster record 
+	//itself, its locations, and the records of which groups may use it and 
+	//which applications they may install. 
 	using Aws::DynamoDB::Model::AttributeValue;
-	auto outcome=dbClient.DeleteItem(Aws::DynamoDB::Model::DeleteItemRequest()
-								     .WithTableName(clusterTableName)
-								     .WithKey({{"ID",AttributeValue(cID)},
-	                                           {"sortKey",AttributeValue(cID)}}));
-	if(!outcome.IsSuccess()){
-		auto err=outcome.GetError();
-		log_error("Failed to delete cluster record: " << err.GetMessage());
-		return false;
-	}
-	outcome=dbClient.DeleteItem(Aws::DynamoDB::Model::DeleteItemRequest()
-								.WithTableName(clusterTableName)
-								.WithKey({{"ID",AttributeValue(cID)},
-	                                      {"sortKey",AttributeValue(cID+":Locations")}}));
-	if(!outcome.IsSuccess()){
-		auto err=outcome.GetError();
-		log_error("Failed to delete cluster location record: " << err.GetMessage());
+	databaseQueries++;
+	auto request=Aws::DynamoDB::Model::QueryRequest()
+	.WithTableName(clusterTableName)
+	.WithKeyConditionExpression("#id = :id")
+	.WithProjectionExpression("#id, #sortKey")
+	.WithExpressionAttributeNames({
+		{"#id","ID"},
+		{"#sortKey","sortKey"}
+	})
+	.WithExpressionAttributeValues({{":id",AttributeValue(cID)}});
+	std::vector<Aws::DynamoDB::Model::WriteRequest> deletions;
+	bool keepGoing=false;
+	do{
+		auto outcome=dbClient.Query(request);
+		if(!outcome.IsSuccess()){
+			auto err=outcome.GetError();
+			log_error("Failed to list cluster records: " << err.GetMessage());
+			return false;
+		}
+		const auto& result=outcome.GetResult();
+		if(!result.GetLastEvaluatedKey().empty()){
+			keepGoing=true;
+			request.SetExclusiveStartKey(result.GetLastEvaluatedKey());
+		}
+		else
+			keepGoing=false;
+		for(const auto& item : result.GetItems()){
+			auto sortKeyIt=item.find("sortKey");
+			if(sortKeyIt!=item.end())
+				clusterGroupApplicationCache.erase(sortKeyIt->second.GetS());
+			deletions.push_back(deleteRequest(item));
+		}
+	}while(keepGoing);
+	
+	if(!batchWrite(clusterTableName,deletions)){
+		log_error("Failed to delete cluster records");
 		return false;
 	}
 	return true;
@@ -1964,7 +3094,7 @@ bool PersistentStore::updateCluster(const Cluster& cluster){
 	                                           {"sortKey",AV(cluster.id)}})
 	                                 .WithAttributeUpdates({
 	                                            {"name",AVU().WithValue(AV(cluster.name))},
-	                                            {"config",AVU().WithValue(AV(cluster.config))},
+	                                            {"config",AVU().WithValue(configAttribute(packConfig(cluster.config)))},
 	                                            {"systemNamespace",AVU().WithValue(AV(cluster.systemNamespace))},
 	                                            {"owningGroup",AVU().WithValue(AV(cluster.owningGroup))},
 	                                            {"owningOrganization",AVU().WithValue(AV(cluster.owningOrganization))}})
@@ -2032,18 +3162,23 @@ std::vector<Cluster> PersistentStore::listClusters(){
 			cluster.id=findOrThrow(item,"ID","Cluster record missing ID attribute").GetS();
 			cluster.name=findOrThrow(item,"name","Cluster record missing name attribute").GetS();
 			cluster.owningGroup=findOrThrow(item,"owningGroup","Cluster record missing owningGroup attribute").GetS();
-			cluster.config=findOrThrow(item,"config","Cluster record missing config attribute").GetS();
+			cluster.config=unpackConfig(storedConfig(findOrThrow(item,"config","Cluster record missing config attribute")));
 			cluster.systemNamespace=findOrThrow(item,"systemNamespace","Cluster record missing systemNamespace attribute").GetS();
 			cluster.owningOrganization=findOrDefault(item,"owningOrganization",missingString).GetS();
 			collected.push_back(cluster);
-			
-			CacheRecord<Cluster> record(cluster,clusterCacheValidity);
-			replaceCacheRecord(clusterCache,cluster.id,record);
-			clusterByNameCache.insert_or_assign(cluster.name,record);
-			clusterByGroupCache.insert_or_assign(cluster.owningGroup,record);
 			writeClusterConfigToDisk(cluster);
 		}
 	}while(keepGoing);
+	//a listing which does not fit the cache's budget would just be evicted, 
+	//and so would not remain complete, so it is not worth caching
+	if(!cacheManager.canHold("clusterCache",collected.size()))
+		return collected;
+	for(const Cluster& cluster : collected){
+		CacheRecord<Cluster> record(cluster,clusterCacheValidity);
+		replaceCacheRecord(clusterCache,cluster.id,record);
+		clusterByNameCache.insert_or_assign(cluster.name,record);
+		clusterByGroupCache.insert_or_assign(cluster.owningGroup,record);
+	}
 	clusterCacheExpirationTime=std::chrono::steady_clock::now()+clusterCacheValidity;
 	
 	return collected;
@@ -2098,6 +3233,7 @@ bool PersistentStore::addGroupToCluster(std::string groupID, std::string cID){
 	//update cache
 	CacheRecord<std::string> record(groupID,clusterCacheValidity);
 	clusterGroupAccessCache.insert_or_assign(cID,record);
+	permissionIndex.setGroupAccess(cID,groupID,wildcard,true);
 	
 	return true;
 }
@@ -2123,6 +3259,7 @@ bool PersistentStore::removeGroupFromCluster(std::string groupID, std::string cI
 		log_error("Failed to delete Group cluster access record: " << err.GetMessage());
 		return false;
 	}
+	permissionIndex.setGroupAccess(cID,groupID,wildcard,false);
 	return true;
 }
 
@@ -2178,18 +3315,24 @@ std::vector<std::string> PersistentStore::listgroupsAllowedOnCluster(std::string
 }
 
 bool PersistentStore::groupAllowedOnCluster(std::string groupID, std::string cID){
-	//TODO: possible issue: We only store memberships, so repeated queries about
-	//a Group's access to a cluster to which it does not have access belong will
-	//never be in the cache, and will always incur a database query. This should
-	//not be a problem for normal/well intentioned use, but seems like a way to
-	//turn accident or malice into denial of service or a large AWS bill. 
-	
 	//check whether the 'ID' we got was actually a name
 	if(!normalizeGroupID(groupID))
 		return false;
 	if(!normalizeClusterID(cID))
 		return false;
 	
+	//The permission index records both access and lack of access, so use it 
+	//whenever possible. 
+	if(ensurePermissionIndex()){
+		cacheHits++;
+		return permissionIndex.groupAllowedOnCluster(cID,groupID);
+	}
+	
+	//TODO: possible issue: We only store memberships, so repeated queries about
+	//a Group's access to a cluster to which it does not have access belong will
+	//never be in the cache below, and will always incur a database query if 
+	//the permission index cannot be loaded. 
+	
 	//before checking for the specific Group, see if a wildcard record exists
 	if(clusterAllowsAllgroups(cID))
 		return true;
@@ -2231,6 +3374,10 @@ bool PersistentStore::groupAllowedOnCluster(std::string groupID, std::string cID
 }
 
 bool PersistentStore::clusterAllowsAllgroups(std::string cID){
+	if(ensurePermissionIndex()){
+		cacheHits++;
+		return permissionIndex.clusterAllowsAllGroups(cID);
+	}
 	{ //check cache first
 		CacheRecord<std::string> record(wildcard);
 		if(clusterGroupAccessCache.find(cID,record)){
@@ -2272,6 +3419,15 @@ std::set<std::string> PersistentStore::listApplicationsGroupMayUseOnCluster(std:
 	if(!normalizeClusterID(cID))
 		return {};
 	
+	if(ensurePermissionIndex()){
+		cacheHits++;
+		bool allApplications;
+		auto applications=permissionIndex.applicationsForGroup(cID,groupID,allApplications);
+		if(allApplications)
+			return {wildcardName};
+		return std::set<std::string>(applications.begin(),applications.end());
+	}
+	
 	std::string sortKey=cID+":"+groupID+":Applications";
 	
 	{ //check cache first
@@ -2362,6 +3518,8 @@ bool PersistentStore::allowVoToUseApplication(std::string groupID, std::string c
 	//update cache
 	CacheRecord<std::set<std::string>> record(allowed,clusterCacheValidity);
 	replaceCacheRecord(clusterGroupApplicationCache,sortKey,record);
+	permissionIndex.setGroupApplications(cID,groupID,allowed.count(wildcardName),
+	                                     std::vector<std::string>(allowed.begin(),allowed.end()));
 	
 	return true;
 }
@@ -2420,12 +3578,21 @@ bool PersistentStore::denyGroupUseOfApplication(std::string groupID, std::string
 	//update cache
 	CacheRecord<std::set<std::string>> record(allowed,clusterCacheValidity);
 	replaceCacheRecord(clusterGroupApplicationCache,sortKey,record);
+	permissionIndex.setGroupApplications(cID,groupID,false,
+	                                     std::vector<std::string>(allowed.begin(),allowed.end()));
 	
 	return true;
 }
 
 bool PersistentStore::groupMayUseApplication(std::string groupID, std::string cID, std::string appName){
-	//no need to normalize groupID/cID because listApplicationsGroupMayUseOnCluster will do it
+	if(!normalizeGroupID(groupID,true))
+		return false;
+	if(!normalizeClusterID(cID))
+		return false;
+	if(ensurePermissionIndex()){
+		cacheHits++;
+		return permissionIndex.groupMayUseApplication(cID,groupID,appName);
+	}
 	auto allowed=listApplicationsGroupMayUseOnCluster(groupID,cID);
 	if(allowed.count(wildcardName))
 		return true;
@@ -2519,6 +3686,16 @@ bool PersistentStore::setLocationsForCluster(std::string cID, const std::vector<
 	return true;
 }
 
+void PersistentStore::setClusterProber(ClusterProber* p){
+	clusterProber=p;
+	std::chrono::seconds validity=std::chrono::minutes(30);
+	if(p){
+		const ClusterProber::Schedule& schedule=p->getSchedule();
+		validity=std::max(validity,2*std::max(schedule.interval,schedule.maxBackoff));
+	}
+	clusterConnectivityCacheValidity=validity;
+}
+
 CacheRecord<bool> PersistentStore::getCachedClusterReachability(std::string cID){
 	//check whether the cluster 'ID' we got was actually a name
 	if(!normalizeClusterID(cID)){
@@ -2538,7 +3715,7 @@ void PersistentStore::cacheClusterReachability(std::string cID, bool reachable){
 		log_error("Invalid cluster name");
 		return;
 	}
-	CacheRecord<bool> record(reachable,clusterCacheValidity);
+	CacheRecord<bool> record(reachable,clusterConnectivityCacheValidity.load());
 	replaceCacheRecord(clusterConnectivityCache,cID,record);
 }
 
@@ -2562,14 +3739,15 @@ bool PersistentStore::addApplicationInstance(const ApplicationInstance& inst){
 		return false;
 	}
 	//We assume that configs will be accessed less often than the rest of the 
-	//information about an instance, and they are relatively large, so we stroe 
-	//them in separate, secondary items
+	//information about an instance, and they are relatively large, so we store
+	//them in a separate table, where they do not add to the cost of scanning 
+	//the instance table
+	const std::string packedConfig=packConfig(inst.config);
 	request=Aws::DynamoDB::Model::PutItemRequest()
-	.WithTableName(instanceTableName)
+	.WithTableName(instanceConfigTableName)
 	.WithItem({
 		{"ID",AttributeValue(inst.id)},
-		{"sortKey",AttributeValue(inst.id+":config")},
-		{"config",AttributeValue(inst.config)}
+		{"config",configAttribute(packedConfig)}
 	});
 	outcome=dbClient.PutItem(request);
 	if(!outcome.IsSuccess()){
@@ -2585,7 +3763,7 @@ bool PersistentStore::addApplicationInstance(const ApplicationInstance& inst){
 	instanceByNameCache.insert_or_assign(inst.name,record);
 	instanceByClusterCache.insert_or_assign(inst.cluster,record);
 	instanceByGroupAndClusterCache.insert_or_assign(inst.owningGroup+":"+inst.cluster,record);
-	instanceConfigCache.insert(inst.id,inst.config,instanceCacheValidity);
+	instanceConfigCache.insert(inst.id,packedConfig,instanceCacheValidity);
 	
 	return true;
 }
@@ -2623,13 +3801,22 @@ bool PersistentStore::removeApplicationInstance(const std::string& id){
 		log_error("Failed to delete instance record: " << err.GetMessage());
 		return false;
 	}
+	outcome=dbClient.DeleteItem(Aws::DynamoDB::Model::DeleteItemRequest()
+	                                      .WithTableName(instanceConfigTableName)
+	                                      .WithKey({{"ID",AttributeValue(id)}}));
+	if(!outcome.IsSuccess()){
+		auto err=outcome.GetError();
+		log_error("Failed to delete instance config record: " << err.GetMessage());
+		return false;
+	}
+	//also remove any config record which has not yet been migrated
 	outcome=dbClient.DeleteItem(Aws::DynamoDB::Model::DeleteItemRequest()
 	                                      .WithTableName(instanceTableName)
 	                                      .WithKey({{"ID",AttributeValue(id)},
 	                                                {"sortKey",AttributeValue(id+":config")}}));
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
-		log_error("Failed to delete instance config record: " << err.GetMessage());
+		log_error("Failed to delete old instance config record: " << err.GetMessage());
 		return false;
 	}
 	return true;
@@ -2650,11 +3837,10 @@ ApplicationInstance PersistentStore::getApplicationInstance(const std::string& i
 	//need to query the database
 	databaseQueries++;
 	log_info("Querying database for instance " << id);
-	using Aws::DynamoDB::Model::AttributeValue;
-	auto outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
-								  .WithTableName(instanceTableName)
-								  .WithKey({{"ID",AttributeValue(id)},
-	                                        {"sortKey",AttributeValue(id)}}));
+	return instanceFromOutcome(id,dbClient.GetItem(recordRequest(instanceTableName,id)));
+}
+
+ApplicationInstance PersistentStore::instanceFromOutcome(const std::string& id, const Aws::DynamoDB::Model::GetItemOutcome& outcome){
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
 		log_error("Failed to fetch application instance record: " << err.GetMessage());
@@ -2663,14 +3849,7 @@ ApplicationInstance PersistentStore::getApplicationInstance(const std::string& i
 	const auto& item=outcome.GetResult().GetItem();
 	if(item.empty()) //no match found
 		return ApplicationInstance{};
-	ApplicationInstance inst;
-	inst.valid=true;
-	inst.id=id;
-	inst.name=findOrThrow(item,"name","Instance record missing name attribute").GetS();
-	inst.application=findOrThrow(item,"application","Instance record missing application attribute").GetS();
-	inst.owningGroup=findOrThrow(item,"owningGroup","Instance record missing owningGroup attribute").GetS();
-	inst.cluster=findOrThrow(item,"cluster","Instance record missing cluster attribute").GetS();
-	inst.ctime=findOrThrow(item,"ctime","Instance record missing ctime attribute").GetS();
+	ApplicationInstance inst=instanceFromItem(id,item);
 	
 	//update caches
 	CacheRecord<ApplicationInstance> record(inst,instanceCacheValidity);
@@ -2682,6 +3861,16 @@ ApplicationInstance PersistentStore::getApplicationInstance(const std::string& i
 	return inst;
 }
 
+std::future<ApplicationInstance> PersistentStore::getApplicationInstanceAsync(const std::string& id){
+	ApplicationInstance result;
+	if(findCached(instanceCache,id,result))
+		return makeReadyFuture(result);
+	databaseQueries++;
+	log_info("Querying database for instance " << id);
+	return then(dbClient.GetItemCallable(recordRequest(instanceTableName,id)),
+	            [this,id](const Aws::DynamoDB::Model::GetItemOutcome& outcome){ return instanceFromOutcome(id,outcome); });
+}
+
 std::string PersistentStore::getApplicationInstanceConfig(const std::string& id){
 	//first see if we have this cached
 	{
@@ -2690,33 +3879,63 @@ std::string PersistentStore::getApplicationInstanceConfig(const std::string& id)
 			//we have a cached record; is it still valid?
 			if(record){ //it is, just return it
 				cacheHits++;
-				return record;
+				return unpackConfig(record.record);
 			}
 		}
 	}
 	//need to query the database
 	databaseQueries++;
 	log_info("Querying database for instance " << id << " config");
+	return instanceConfigFromOutcome(id,dbClient.GetItem(instanceConfigRequest(id)));
+}
+
+std::string PersistentStore::instanceConfigFromOutcome(const std::string& id, Aws::DynamoDB::Model::GetItemOutcome outcome){
 	using Aws::DynamoDB::Model::AttributeValue;
-	auto outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
-	                              .WithTableName(instanceTableName)
-	                              .WithKey({{"ID",AttributeValue(id)},
-	                                        {"sortKey",AttributeValue(id+":config")}}));
 	if(!outcome.IsSuccess()){
 		auto err=outcome.GetError();
 		log_error("Failed to fetch application instance config record: " << err.GetMessage());
 		return std::string{};
 	}
+	if(outcome.GetResult().GetItem().empty()){
+		//the record may not have been migrated from the instance table yet
+		databaseQueries++;
+		outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
+		                         .WithTableName(instanceTableName)
+		                         .WithKey({{"ID",AttributeValue(id)},
+		                                   {"sortKey",AttributeValue(id+":config")}}));
+		if(!outcome.IsSuccess()){
+			auto err=outcome.GetError();
+			log_error("Failed to fetch application instance config record: " << err.GetMessage());
+			return std::string{};
+		}
+	}
 	const auto& item=outcome.GetResult().GetItem();
 	if(item.empty()) //no match found
 		return std::string{};
-	std::string config= findOrThrow(item,"config","Instance config record missing config attribute").GetS();
+	std::string packedConfig=storedConfig(findOrThrow(item,"config","Instance config record missing config attribute"));
 	
 	//update cache
-	CacheRecord<std::string> record(config,instanceCacheValidity);
+	CacheRecord<std::string> record(packedConfig,instanceCacheValidity);
 	replaceCacheRecord(instanceConfigCache,id,record);
 	
-	return config;
+	return unpackConfig(packedConfig);
+}
+
+std::future<std::string> PersistentStore::getApplicationInstanceConfigAsync(const std::string& id){
+	std::string packedConfig;
+	if(findCached(instanceConfigCache,id,packedConfig))
+		return makeReadyFuture(unpackConfig(packedConfig));
+	databaseQueries++;
+	log_info("Querying database for instance " << id << " config");
+	return then(dbClient.GetItemCallable(instanceConfigRequest(id)),
+	            [this,id](Aws::DynamoDB::Model::GetItemOutcome outcome){ return instanceConfigFromOutcome(id,std::move(outcome)); });
+}
+
+Aws::DynamoDB::Model::GetItemRequest PersistentStore::instanceConfigRequest(const std::string& id) const{
+	using Aws::DynamoDB::Model::AttributeValue;
+	return Aws::DynamoDB::Model::GetItemRequest()
+	       .WithTableName(instanceConfigTableName)
+	       .WithKey({{"ID",AttributeValue(id)}});
 }
 
 std::vector<ApplicationInstance> PersistentStore::listApplicationInstances(){
@@ -2737,7 +3956,19 @@ std::vector<ApplicationInstance> PersistentStore::listApplicationInstances(){
 	databaseScans++;
 	Aws::DynamoDB::Model::ScanRequest request;
 	request.SetTableName(instanceTableName);
-	request.SetFilterExpression("attribute_exists(ctime)");
+	//skip any config records which have not yet been migrated to their own table
+	request.SetFilterExpression("attribute_exists(#ctime)");
+	request.SetProjectionExpression("#id, #name, #application, #owningGroup, #cluster, #ctime");
+	request.SetExpressionAttributeNames({
+		{"#id","ID"},
+		{"#name","name"},
+		{"#application","application"},
+		{"#owningGroup","owningGroup"},
+		{"#cluster","cluster"},
+		{"#ctime","ctime"}
+	});
+	request.SetReturnConsumedCapacity(Aws::DynamoDB::Model::ReturnConsumedCapacity::TOTAL);
+	double consumedCapacity=0;
 	bool keepGoing=false;
 	
 	do{
@@ -2749,6 +3980,7 @@ std::vector<ApplicationInstance> PersistentStore::listApplicationInstances(){
 			return collected;
 		}
 		const auto& result=outcome.GetResult();
+		consumedCapacity+=result.GetConsumedCapacity().GetCapacityUnits();
 		//set up fetching the next page if necessary
 		if(!result.GetLastEvaluatedKey().empty()){
 			keepGoing=true;
@@ -2767,15 +3999,21 @@ std::vector<ApplicationInstance> PersistentStore::listApplicationInstances(){
 			inst.cluster=findOrThrow(item,"cluster","Instance record missing ID attribute").GetS();
 			inst.ctime=findOrThrow(item,"ctime","Instance record missing ID attribute").GetS();
 			collected.push_back(inst);
-
-			CacheRecord<ApplicationInstance> record(inst,instanceCacheValidity);
-			replaceCacheRecord(instanceCache,inst.id,record);
-			instanceByNameCache.insert_or_assign(inst.name,record);
-			instanceByGroupCache.insert_or_assign(inst.owningGroup,record);
-			instanceByClusterCache.insert_or_assign(inst.cluster,record);
-			instanceByGroupAndClusterCache.insert_or_assign(inst.owningGroup+":"+inst.cluster,record);
 		}
 	}while(keepGoing);
+	log_info("Instance scan consumed " << consumedCapacity << " read capacity units");
+	//a listing which does not fit the cache's budget would just be evicted, 
+	//and so would not remain complete, so it is not worth caching
+	if(!cacheManager.canHold("instanceCache",collected.size()))
+		return collected;
+	for(const ApplicationInstance& inst : collected){
+		CacheRecord<ApplicationInstance> record(inst,instanceCacheValidity);
+		replaceCacheRecord(instanceCache,inst.id,record);
+		instanceByNameCache.insert_or_assign(inst.name,record);
+		instanceByGroupCache.insert_or_assign(inst.owningGroup,record);
+		instanceByClusterCache.insert_or_assign(inst.cluster,record);
+		instanceByGroupAndClusterCache.insert_or_assign(inst.owningGroup+":"+inst.cluster,record);
+	}
 	instanceCacheExpirationTime=std::chrono::steady_clock::now()+instanceCacheValidity;
 	
 	return collected;
@@ -3043,15 +4281,7 @@ Secret PersistentStore::getSecret(const std::string& id){
 	const auto& item=outcome.GetResult().GetItem();
 	if(item.empty()) //no match found
 		return Secret{};
-	Secret secret;
-	secret.valid=true;
-	secret.id=id;
-	secret.name=findOrThrow(item,"name","Secret record missing name attribute").GetS();
-	secret.group=findOrThrow(item,"owningGroup","Secret record missing owning group attribute").GetS();
-	secret.cluster=findOrThrow(item,"cluster","Secret record missing cluster attribute").GetS();
-	secret.ctime=findOrThrow(item,"ctime","Secret record missing ctime attribute").GetS();
-	const auto& secret_data=findOrThrow(item,"contents","Secret record missing contents attribute").GetB();
-	secret.data=std::string((const std::string::value_type*)secret_data.GetUnderlyingData(),secret_data.GetLength());
+	Secret secret=secretFromItem(id,item);
 	
 	//update caches
 	CacheRecord<Secret> record(secret,secretCacheValidity);
@@ -3162,13 +4392,160 @@ Secret PersistentStore::findSecretByName(std::string group, std::string cluster,
 	return Secret();
 }
 
+bool PersistentStore::addJob(const Job& job){
+	auto request=Aws::DynamoDB::Model::PutItemRequest()
+	.WithTableName(jobTableName)
+	.WithItem(jobItem(job))
+	.WithConditionExpression("attribute_not_exists(ID)");
+	auto outcome=dbClient.PutItem(request);
+	if(!outcome.IsSuccess()){
+		auto err=outcome.GetError();
+		log_error("Failed to add job record: " << err.GetMessage());
+		return false;
+	}
+	return true;
+}
+
+bool PersistentStore::updateJob(const Job& job){
+	auto request=Aws::DynamoDB::Model::PutItemRequest()
+	.WithTableName(jobTableName)
+	.WithItem(jobItem(job));
+	auto outcome=dbClient.PutItem(request);
+	if(!outcome.IsSuccess()){
+		auto err=outcome.GetError();
+		log_error("Failed to update job record: " << err.GetMessage());
+		return false;
+	}
+	return true;
+}
+
+Job PersistentStore::getJob(const std::string& id){
+	databaseQueries++;
+	log_info("Querying database for job " << id);
+	using Aws::DynamoDB::Model::AttributeValue;
+	//jobs are updated by whichever replica runs them, so read the latest version
+	auto outcome=dbClient.GetItem(Aws::DynamoDB::Model::GetItemRequest()
+	                              .WithTableName(jobTableName)
+	                              .WithKey({{"ID",AttributeValue(id)}})
+	                              .WithConsistentRead(true));
+	if(!outcome.IsSuccess()){
+		auto err=outcome.GetError();
+		log_error("Failed to fetch job record: " << err.GetMessage());
+		return Job();
+	}
+	const auto& item=outcome.GetResult().GetItem();
+	if(item.empty()) //no match found
+		return Job();
+	//DynamoDB may take some time to delete records after they expire
+	auto expires=item.find("expires");
+	if(expires!=item.end() && std::stoll(expires->second.GetN())<
+	   epochSeconds(std::chrono::system_clock::now()))
+		return Job();
+	return jobFromItem(id,item);
+}
+
+bool PersistentStore::touchJob(const std::string& id){
+	using Aws::DynamoDB::Model::AttributeValue;
+	const auto now=std::chrono::system_clock::now();
+	//a job which has finished needs no further attention, and must not be
+	//recreated if its record has been deleted
+	auto outcome=dbClient.UpdateItem(Aws::DynamoDB::Model::UpdateItemRequest()
+	                                 .WithTableName(jobTableName)
+	                                 .WithKey({{"ID",AttributeValue(id)}})
+	                                 .WithUpdateExpression("SET updated = :now, expires = :expires")
+	                                 .WithConditionExpression("#status IN (:pending, :running)")
+	                                 .WithExpressionAttributeNames({{"#status","status"}})
+	                                 .WithExpressionAttributeValues({
+	                                   {":now",AttributeValue().SetN(std::to_string(epochSeconds(now)))},
+	                                   {":expires",AttributeValue().SetN(std::to_string(epochSeconds(now+jobRetention)))},
+	                                   {":pending",AttributeValue("pending")},
+	                                   {":running",AttributeValue("running")}
+	                                 }));
+	if(!outcome.IsSuccess()){
+		auto err=outcome.GetError();
+		if(err.GetErrorType()!=Aws::DynamoDB::DynamoDBErrors::CONDITIONAL_CHECK_FAILED)
+			log_error("Failed to refresh job record: " << err.GetMessage());
+		return false;
+	}
+	return true;
+}
+
+bool PersistentStore::updateStaleJob(const Job& job, std::chrono::seconds age){
+	using Aws::DynamoDB::Model::AttributeValue;
+	const auto cutoff=epochSeconds(std::chrono::system_clock::now()-age);
+	//the index from which stale jobs are listed may lag behind the table, so
+	//check that the job has still not been refreshed
+	auto request=Aws::DynamoDB::Model::PutItemRequest()
+	.WithTableName(jobTableName)
+	.WithItem(jobItem(job))
+	.WithConditionExpression("#status IN (:pending, :running) AND updated < :cutoff")
+	.WithExpressionAttributeNames({{"#status","status"}})
+	.WithExpressionAttributeValues({
+		{":pending",AttributeValue("pending")},
+		{":running",AttributeValue("running")},
+		{":cutoff",AttributeValue().SetN(std::to_string(cutoff))}
+	});
+	auto outcome=dbClient.PutItem(request);
+	if(!outcome.IsSuccess()){
+		auto err=outcome.GetError();
+		if(err.GetErrorType()!=Aws::DynamoDB::DynamoDBErrors::CONDITIONAL_CHECK_FAILED)
+			log_error("Failed to update job record: " << err.GetMessage());
+		return false;
+	}
+	return true;
+}
+
+std::vector<Job> PersistentStore::listStaleJobs(std::chrono::seconds age){
+	using Aws::DynamoDB::Model::AttributeValue;
+	std::vector<Job> collected;
+	const auto cutoff=epochSeconds(std::chrono::system_clock::now()-age);
+	//only unfinished jobs appear in this index, so this reads nothing when 
+	//there are no abandoned jobs
+	Aws::DynamoDB::Model::QueryRequest request;
+	request.SetTableName(jobTableName);
+	request.SetIndexName("ByActivity");
+	request.SetKeyConditionExpression("active = :active AND updated < :cutoff");
+	request.SetExpressionAttributeValues({
+		{":active",AttributeValue("1")},
+		{":cutoff",AttributeValue().SetN(std::to_string(cutoff))}
+	});
+	bool keepGoing=false;
+	
+	do{
+		databaseQueries++;
+		auto outcome=dbClient.Query(request);
+		if(!outcome.IsSuccess()){
+			auto err=outcome.GetError();
+			log_error("Failed to fetch job records: " << err.GetMessage());
+			return collected;
+		}
+		const auto& result=outcome.GetResult();
+		//set up fetching the next page if necessary
+		if(!result.GetLastEvaluatedKey().empty()){
+			keepGoing=true;
+			request.SetExclusiveStartKey(result.GetLastEvaluatedKey());
+		}
+		else
+			keepGoing=false;
+		//collect results from this page
+		for(const auto& item : result.GetItems()){
+			try{
+				collected.push_back(jobFromItem(item.find("ID")->second.GetS(),item));
+			}catch(std::runtime_error& err){
+				log_error("Ignoring malformed job record: " << err.what());
+			}
+		}
+	}while(keepGoing);
+	
+	return collected;
+}
+
 Application PersistentStore::findApplication(const std::string& repository, const std::string& appName){
 	{ //check for cached data first
 		log_info("Checking for application " << appName << " in cache");
 		auto cached = applicationCache.find(repository);
-		if(cached.second > std::chrono::steady_clock::now()){
-			auto records = cached.first;
-			for(const auto& record : records){
+		if(cached.expiration > std::chrono::steady_clock::now()){
+			for(const auto& record : cached.items()){
 				if(record.record.name==appName && record)
 					return record;
 			}
@@ -3205,7 +4582,7 @@ Application PersistentStore::findApplication(const std::string& repository, cons
 		}
 	}
 
-	CacheRecord<Application> record(app,instanceCacheValidity);
+	CacheRecord<Application> record(app,applicationCacheValidity);
 	applicationCache.insert_or_assign(repository,record);
 
 	return app;
@@ -3236,10 +4613,10 @@ std::vector<Application> PersistentStore::fetchApplications(const std::string& r
 		app.description=tokens[3];
 		app.valid=true;
 		results.push_back(app);
-		CacheRecord<Application> record(app,instanceCacheValidity);
+		CacheRecord<Application> record(app,applicationCacheValidity);
 		applicationCache.insert_or_assign(repository,record);
 	}
-	auto expirationTime = std::chrono::steady_clock::now() + instanceCacheValidity;
+	auto expirationTime = std::chrono::steady_clock::now() + applicationCacheValidity;
 	applicationCache.update_expiration(repository, expirationTime);
 	return results;
 }
@@ -3251,14 +4628,363 @@ std::vector<Application> PersistentStore::listApplications(const std::string& re
 	return fetchApplications(repository);
 }
 
+namespace{
+	///The kinds of sections in a cache snapshot
+	enum SnapshotSection : std::uint64_t{
+		UserSection=1,
+		MembershipSection=2,
+		GroupSection=3,
+		ClusterSection=4,
+		InstanceSection=5,
+		ApplicationSection=6
+	};
+	
+	const std::uint64_t snapshotFormatVersion=1;
+	
+	///\return the time remaining before a cached record expires, in 
+	///        milliseconds, for storage in a snapshot
+	std::uint64_t remainingValidity(std::chrono::steady_clock::time_point expiration,
+	                                std::chrono::steady_clock::time_point now){
+		if(expiration<=now)
+			return 0;
+		return std::chrono::duration_cast<std::chrono::milliseconds>(expiration-now).count();
+	}
+	
+	///Write the unexpired records from a cache as a snapshot section
+	template<typename Cache>
+	void writeCacheSection(SnapshotWriter& writer, SnapshotSection kind, Cache& cache){
+		using Record=typename Cache::mapped_type;
+		//copy the records so that the cache is locked only briefly
+		std::vector<std::pair<std::string,Record>> records;
+		{
+			auto table=cache.lock_table();
+			for(const auto& entry : table){
+				if(!entry.second.expired())
+					records.emplace_back(entry.first,entry.second);
+			}
+		}
+		const auto now=std::chrono::steady_clock::now();
+		writer.beginSection(kind);
+		writer.writeInteger(records.size());
+		for(const auto& entry : records){
+			writer.writeString(entry.first);
+			writer.writeInteger(remainingValidity(entry.second.expirationTime,now));
+			writer.write(entry.second.record);
+		}
+		writer.endSection();
+	}
+	
+	///Read the records in a snapshot section written by writeCacheSection
+	///\param expiration a function which computes the time at which a loaded 
+	///                  record should expire from the validity it had 
+	///                  remaining when saved, and returns whether it should be
+	///                  loaded at all
+	///\param load a function which places a key and record into the caches
+	///\return the number of records loaded
+	template<typename T, typename Expiration, typename Load>
+	std::size_t readCacheSection(SnapshotReader& reader, Expiration expiration, Load load){
+		std::size_t loaded=0;
+		std::uint64_t count=reader.readInteger();
+		for(std::uint64_t i=0; i<count; i++){
+			std::string key=reader.readString();
+			std::uint64_t remaining=reader.readInteger();
+			T item;
+			reader.read(item);
+			std::chrono::steady_clock::time_point expirationTime;
+			if(expiration(remaining,expirationTime)){
+				load(key,CacheRecord<T>(std::move(item),expirationTime));
+				loaded++;
+			}
+		}
+		return loaded;
+	}
+}
+
+bool PersistentStore::saveCacheSnapshot(const std::string& path){
+	const auto start=std::chrono::steady_clock::now();
+	SnapshotWriter writer;
+	writer.writeInteger(snapshotFormatVersion);
+	writer.writeInteger(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+	
+	//Records found by token or Globus ID are the same as those in userCache, 
+	//and likewise for other lookups by name, so they are reconstructed when 
+	//the snapshot is loaded rather than being saved. Secrets are not saved. 
+	writeCacheSection(writer,UserSection,userCache);
+	writeCacheSection(writer,MembershipSection,userGroupMembershipCache);
+	writeCacheSection(writer,GroupSection,groupCache);
+	writeCacheSection(writer,ClusterSection,clusterCache);
+	writeCacheSection(writer,InstanceSection,instanceCache);
+	{
+		//The application catalog is grouped by repository, and it matters 
+		//whether the list of each repository's applications is complete
+		struct Category{
+			std::string repository;
+			std::chrono::steady_clock::time_point expiration;
+			std::vector<CacheRecord<Application>> applications;
+		};
+		std::vector<Category> categories;
+		{
+			auto table=applicationCache.lock_table();
+			for(const auto& entry : table){
+				Category category{entry.first,entry.second.expiration,{}};
+				for(const auto& record : entry.second.items()){
+					if(!record.expired())
+						category.applications.push_back(record);
+				}
+				categories.push_back(std::move(category));
+			}
+		}
+		const auto now=std::chrono::steady_clock::now();
+		writer.beginSection(ApplicationSection);
+		writer.writeInteger(categories.size());
+		for(const auto& category : categories){
+			writer.writeString(category.repository);
+			writer.writeInteger(remainingValidity(category.expiration,now));
+			writer.writeInteger(category.applications.size());
+			for(const auto& record : category.applications){
+				writer.writeInteger(remainingValidity(record.expirationTime,now));
+				writer.write(record.record);
+			}
+		}
+		writer.endSection();
+	}
+	
+	std::string encrypted;
+	try{
+		SecretData plain(writer.data().size());
+		std::copy(writer.data().begin(),writer.data().end(),plain.data.get());
+		encrypted=encryptSecret(plain);
+	}catch(std::runtime_error& err){
+		log_error("Unable to encrypt cache snapshot: " << err.what());
+		return false;
+	}
+	
+	//write to a temporary file and then rename it, so that a reader never 
+	//sees a partial snapshot
+	const std::string tempPath=path+".tmp";
+	int fd=::open(tempPath.c_str(),O_WRONLY|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR);
+	if(fd<0){
+		int err=errno;
+		log_error("Unable to open " << tempPath << " to write cache snapshot: " << strerror(err));
+		return false;
+	}
+	std::size_t written=0;
+	while(written<encrypted.size()){
+		ssize_t result=::write(fd,encrypted.data()+written,encrypted.size()-written);
+		if(result<0){
+			int err=errno;
+			if(err==EINTR)
+				continue;
+			log_error("Unable to write cache snapshot to " << tempPath << ": " << strerror(err));
+			::close(fd);
+			unlink(tempPath.c_str());
+			return false;
+		}
+		written+=result;
+	}
+	if(fsync(fd)!=0 || ::close(fd)!=0){
+		int err=errno;
+		log_error("Unable to write cache snapshot to " << tempPath << ": " << strerror(err));
+		unlink(tempPath.c_str());
+		return false;
+	}
+	if(rename(tempPath.c_str(),path.c_str())!=0){
+		int err=errno;
+		log_error("Unable to replace cache snapshot " << path << ": " << strerror(err));
+		unlink(tempPath.c_str());
+		return false;
+	}
+	snapshotsSaved++;
+	log_info("Saved cache snapshot of " << writer.data().size() << " bytes to " << path << " in " 
+	         << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start).count() 
+	         << " ms");
+	return true;
+}
+
+std::size_t PersistentStore::loadCacheSnapshot(const std::string& path){
+	Secret encrypted;
+	{
+		std::ifstream file(path,std::ios::binary);
+		if(!file){
+			log_info("No cache snapshot found at " << path);
+			return 0;
+		}
+		encrypted.data.assign(std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>());
+		if(file.bad()){
+			log_warn("Unable to read cache snapshot from " << path);
+			return 0;
+		}
+	}
+	
+	std::size_t loaded=0;
+	try{
+		SecretData plain=decryptSecret(encrypted);
+		SnapshotReader reader(plain.data.get(),plain.dataSize);
+		if(reader.readInteger()!=snapshotFormatVersion){
+			log_warn("Cache snapshot " << path << " has an unsupported format; ignoring it");
+			return 0;
+		}
+		const std::chrono::milliseconds savedAt(reader.readInteger());
+		const std::chrono::milliseconds now=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+		const std::chrono::milliseconds age=std::max(now-savedAt,std::chrono::milliseconds(0));
+		const auto loadTime=std::chrono::steady_clock::now();
+		auto expiration=[&](std::uint64_t remaining, std::chrono::steady_clock::time_point& expirationTime){
+			std::chrono::milliseconds left=std::chrono::milliseconds(remaining)-age;
+			if(left<=std::chrono::milliseconds(0))
+				return false;
+			expirationTime=loadTime+std::min<std::chrono::milliseconds>(left,snapshotRecordValidity);
+			return true;
+		};
+		
+		while(!reader.atEnd()){
+			std::size_t length;
+			switch(reader.readSectionHeader(length)){
+				case UserSection:
+					loaded+=readCacheSection<User>(reader,expiration,[this](const std::string& id, const CacheRecord<User>& record){
+						userCache.insert(id,record);
+						userByTokenCache.insert(record.record.token,record);
+						userByGlobusIDCache.insert(record.record.globusID,record);
+					});
+					break;
+				case MembershipSection:
+					loaded+=readCacheSection<std::set<std::string>>(reader,expiration,[this](const std::string& uID, const CacheRecord<std::set<std::string>>& record){
+						userGroupMembershipCache.insert(uID,record);
+					});
+					break;
+				case GroupSection:
+					loaded+=readCacheSection<Group>(reader,expiration,[this](const std::string& id, const CacheRecord<Group>& record){
+						groupCache.insert(id,record);
+						groupByNameCache.insert(record.record.name,record);
+					});
+					break;
+				case ClusterSection:
+					loaded+=readCacheSection<Cluster>(reader,expiration,[this](const std::string& id, const CacheRecord<Cluster>& record){
+						writeClusterConfigToDisk(record.record);
+						clusterCache.insert(id,record);
+						clusterByNameCache.insert(record.record.name,record);
+					});
+					break;
+				case InstanceSection:
+					loaded+=readCacheSection<ApplicationInstance>(reader,expiration,[this](const std::string& id, const CacheRecord<ApplicationInstance>& record){
+						instanceCache.insert(id,record);
+					});
+					break;
+				case ApplicationSection:
+				{
+					std::uint64_t categories=reader.readInteger();
+					for(std::uint64_t i=0; i<categories; i++){
+						std::string repository=reader.readString();
+						std::uint64_t categoryRemaining=reader.readInteger();
+						std::uint64_t count=reader.readInteger();
+						for(std::uint64_t j=0; j<count; j++){
+							std::uint64_t remaining=reader.readInteger();
+							Application application;
+							reader.read(application);
+							std::chrono::steady_clock::time_point expirationTime;
+							if(expiration(remaining,expirationTime)){
+								applicationCache.insert_or_assign(repository,CacheRecord<Application>(std::move(application),expirationTime));
+								loaded++;
+							}
+						}
+						std::chrono::steady_clock::time_point expirationTime;
+						if(expiration(categoryRemaining,expirationTime))
+							applicationCache.update_expiration(repository,expirationTime);
+					}
+					break;
+				}
+				default: //written by a newer version; ignore it
+					reader.skip(length);
+			}
+		}
+	}catch(std::runtime_error& err){
+		//records loaded before the problem was found are intact, and remain
+		log_warn("Unable to load cache snapshot from " << path << ": " << err.what());
+	}
+	snapshotRecordsLoaded+=loaded;
+	log_info("Loaded " << loaded << " records from cache snapshot " << path);
+	return loaded;
+}
+
+void PersistentStore::startCacheSnapshots(const std::string& path, std::chrono::seconds interval){
+	snapshotPath=path;
+	snapshotInterval=interval;
+	loadCacheSnapshot(snapshotPath);
+	snapshotThread=std::thread(&PersistentStore::runCacheSnapshots,this);
+}
+
+void PersistentStore::runCacheSnapshots(){
+	auto stopping=[this]{
+		std::lock_guard<std::mutex> lock(snapshotMutex);
+		return stopSnapshots;
+	};
+	//Records loaded from a snapshot may be out of date, so replace them with 
+	//current data as soon as possible. Scanning each table once costs far 
+	//less than fetching the records individually as they are requested. 
+	if(snapshotRecordsLoaded){
+		log_info("Refreshing records loaded from cache snapshot");
+		std::vector<std::function<void()>> refreshes={
+			[this]{ listUsers(); },
+			[this]{ listGroups(); },
+			[this]{ listClusters(); },
+			[this]{ listApplicationInstances(); },
+			[this]{ ensurePermissionIndex(); }
+		};
+		for(const auto& refresh : refreshes){
+			if(stopping())
+				return;
+			try{
+				refresh();
+			}catch(std::exception& ex){
+				log_error("Failed to refresh records loaded from cache snapshot: " << ex.what());
+			}
+		}
+	}
+	
+	std::unique_lock<std::mutex> lock(snapshotMutex);
+	while(!snapshotCondition.wait_for(lock,snapshotInterval,[this]{ return stopSnapshots; })){
+		lock.unlock();
+		saveCacheSnapshot(snapshotPath);
+		lock.lock();
+	}
+}
+
 std::string PersistentStore::getStatistics() const{
 	std::ostringstream os;
 	os << "Cache hits: " << cacheHits.load() << "\n";
 	os << "Database queries: " << databaseQueries.load() << "\n";
 	os << "Database scans: " << databaseScans.load() << "\n";
+	os << "Cluster config writes: " << configWrites.load() << ", " 
+	   << configWritesAvoided.load() << " avoided\n";
+	os << "Permission index entries: " << permissionIndex.size() << "\n";
+	if(!snapshotPath.empty())
+		os << "Cache snapshots saved: " << snapshotsSaved.load() << ", "
+		   << snapshotRecordsLoaded.load() << " records loaded\n";
+	os << dbClient.getStatistics();
+	os << cacheManager.getStatistics();
+	if(changeFeed)
+		os << changeFeed->getStatistics();
+	if(clusterProber)
+		os << clusterProber->getStatistics();
 	return os.str();
 }
 
+void PersistentStore::writeMetrics(std::ostream& os) const{
+	metrics::writeHeader(os,"slate_store_cache_hits_total","counter","Number of requests for records answered from any cache");
+	metrics::writeSample(os,"slate_store_cache_hits_total",{},cacheHits.load());
+	metrics::writeHeader(os,"slate_store_database_queries_total","counter","Number of individual records fetched from the database");
+	metrics::writeSample(os,"slate_store_database_queries_total",{},databaseQueries.load());
+	metrics::writeHeader(os,"slate_store_database_scans_total","counter","Number of full table scans performed");
+	metrics::writeSample(os,"slate_store_database_scans_total",{},databaseScans.load());
+	if(!snapshotPath.empty()){
+		metrics::writeHeader(os,"slate_store_cache_snapshots_saved_total","counter","Number of cache snapshots saved");
+		metrics::writeSample(os,"slate_store_cache_snapshots_saved_total",{},snapshotsSaved.load());
+		metrics::writeHeader(os,"slate_store_cache_snapshot_records_loaded","gauge","Number of records loaded from the cache snapshot at startup");
+		metrics::writeSample(os,"slate_store_cache_snapshot_records_loaded",{},snapshotRecordsLoaded.load());
+	}
+	dbClient.writeMetrics(os);
+	cacheManager.writeMetrics(os);
+}
+
 bool PersistentStore::normalizeGroupID(std::string& groupID, bool allowWildcard){
 	if(allowWildcard){
 		if(groupID==wildcard)
@@ -3293,6 +5019,93 @@ bool PersistentStore::normalizeClusterID(std::string& cID){
 	return true;
 }
 
+bool PersistentStore::ensurePermissionIndex(){
+	if(permissionIndex.valid())
+		return true;
+	std::lock_guard<std::mutex> lock(permissionIndexLoadMutex);
+	//another thread may have finished reloading while we were waiting
+	if(permissionIndex.valid())
+		return true;
+	
+	const unsigned long generation=permissionIndex.generation();
+	PermissionIndex::Contents contents;
+	const std::string applicationsSuffix=":Applications";
+	
+	databaseScans++;
+	log_info("Scanning database for cluster permission records");
+	Aws::DynamoDB::Model::ScanRequest request;
+	request.SetTableName(clusterTableName);
+	request.SetFilterExpression("attribute_exists(#groupID) OR attribute_exists(#applications)");
+	request.SetProjectionExpression("#id, #sortKey, #groupID, #applications");
+	request.SetExpressionAttributeNames({{"#id","ID"},{"#sortKey","sortKey"},
+	                                     {"#groupID","groupID"},{"#applications","applications"}});
+	bool keepGoing=false;
+	
+	do{
+		auto outcome=dbClient.Scan(request);
+		if(!outcome.IsSuccess()){
+			auto err=outcome.GetError();
+			log_error("Failed to fetch cluster permission records: " << err.GetMessage());
+			return false;
+		}
+		const auto& result=outcome.GetResult();
+		//set up fetching the next page if necessary
+		if(!result.GetLastEvaluatedKey().empty()){
+			keepGoing=true;
+			request.SetExclusiveStartKey(result.GetLastEvaluatedKey());
+		}
+		else
+			keepGoing=false;
+		//collect results from this page
+		for(const auto& item : result.GetItems()){
+			if(!item.count("ID") || !item.count("sortKey"))
+				continue;
+			const std::string cID=item.find("ID")->second.GetS();
+			if(item.count("groupID")){
+				const std::string groupID=item.find("groupID")->second.GetS();
+				if(groupID==wildcard)
+					contents[cID].allowsAllGroups=true;
+				else
+					contents[cID].groups[groupID].accessGranted=true;
+			}
+			if(item.count("applications")){
+				//application records have sort keys of the form cID:groupID:Applications
+				const std::string sortKey=item.find("sortKey")->second.GetS();
+				if(sortKey.size()<=cID.size()+1+applicationsSuffix.size() 
+				   || sortKey.compare(sortKey.size()-applicationsSuffix.size(),
+				                      applicationsSuffix.size(),applicationsSuffix)!=0){
+					log_warn("Malformed application use record " << sortKey);
+					continue;
+				}
+				const std::string groupID=sortKey.substr(cID.size()+1,
+				  sortKey.size()-cID.size()-1-applicationsSuffix.size());
+				auto applications=item.find("applications")->second.GetSS();
+				PermissionIndex::GroupEntry& entry=contents[cID].groups[groupID];
+				entry.hasApplicationRecord=true;
+				for(const auto& application : applications){
+					if(application==wildcardName)
+						entry.allApplications=true;
+					else if(application!="<none>")
+						entry.applications.push_back(application);
+				}
+				if(entry.allApplications)
+					entry.applications.clear();
+				std::sort(entry.applications.begin(),entry.applications.end());
+			}
+		}
+	}while(keepGoing);
+	
+	if(!permissionIndex.replace(std::move(contents),
+	                            std::chrono::steady_clock::now()+clusterCacheValidity,
+	                            generation)){
+		//permissions were changed while the scan was running, so what we 
+		//collected may already be out of date
+		log_info("Permission index changed during reload; discarding scan results");
+		return false;
+	}
+	return true;
+}
+
 std::string PersistentStore::dnsNameForCluster(const Cluster& cluster) const{
 	return cluster.name+'.'+baseDomain;
 }
@@ -332,9 +332,19 @@ char ProcessHandle::exitStatus() const{
 	return exitStatusValue;
 }
 
+void ProcessHandle::wait(){
+	assert(child && "child process must not be detatched");
+	std::unique_lock<std::mutex> lock(exitMutex);
+	exitCondition.wait(lock,[this]{ return hasExitStatus.load(); });
+}
+
 void ProcessHandle::setExitStatus(unsigned char status){
-	exitStatusValue=status;
-	hasExitStatus=true;
+	{
+		std::lock_guard<std::mutex> lock(exitMutex);
+		exitStatusValue=status;
+		hasExitStatus=true;
+	}
+	exitCondition.notify_all();
 }
 
 void reapProcesses(){
@@ -583,12 +593,23 @@ namespace{
 	}
 }
 
+namespace{
+CommandObserver commandObserver;
+}
+
+void setCommandObserver(CommandObserver observer){
+	commandObserver=std::move(observer);
+}
+
 commandResult runCommand(const std::string& command, 
                          const std::vector<std::string>& args,
                          const std::map<std::string,std::string>& env){
+	const auto start=std::chrono::steady_clock::now();
 	commandResult result;
 	ProcessHandle child=startProcessAsync(command,args,env);
 	collectChildOutput(child,result);
+	if(commandObserver)
+		commandObserver(command,args,std::chrono::steady_clock::now()-start,result.status);
 	return result;
 }
 
@@ -596,11 +617,14 @@ commandResult runCommandWithInput(const std::string& command,
                                   const std::string& input,
                                   const std::vector<std::string>& args,
                                   const std::map<std::string,std::string>& env){
+	const auto start=std::chrono::steady_clock::now();
 	commandResult result;
 	ProcessHandle child=startProcessAsync(command,args,env);
 	child.getStdin() << input;
 	child.getStdin().flush();
 	child.endInput();
 	collectChildOutput(child,result);
+	if(commandObserver)
+		commandObserver(command,args,std::chrono::steady_clock::now()-start,result.status);
 	return result;
 }
@@ -0,0 +1,62 @@
+#include "RequestMetrics.h"
+
+#include <set>
+
+#include "ServerUtilities.h"
+
+RequestMetrics::RequestMetrics():
+latencies("slate_http_request_duration_seconds",
+          "Time taken to handle API requests",
+          {"method","route","code"}){}
+
+void RequestMetrics::before_handle(crow::request& req, crow::response& res, context& ctx){
+	ctx.start=std::chrono::steady_clock::now();
+}
+
+void RequestMetrics::after_handle(crow::request& req, crow::response& res, context& ctx){
+	const auto duration=std::chrono::steady_clock::now()-ctx.start;
+	//individual status codes are not needed to compute error rates, and 
+	//would multiply the number of histograms kept
+	const std::string code=std::to_string(res.code/100)+"xx";
+	latencies.get({crow::method_name(req.method),routeTemplate(req.url),code}).record(duration);
+}
+
+void RequestMetrics::writeMetrics(std::ostream& os) const{
+	latencies.write(os);
+}
+
+std::string routeTemplate(const std::string& path){
+	const static std::string apiPrefix="/v1alpha3/";
+	if(path=="/version")
+		return path;
+	if(path.compare(0,apiPrefix.size(),apiPrefix)!=0)
+		return "other";
+	
+	//the fixed names which appear in routes; anything else in their place 
+	//cannot match a route
+	const static std::set<std::string> routeNames={
+		"ad-hoc","allowed_groups","applications","apps","clusters","find_user",
+		"groups","import_users","info","instances","jobs","logs","members",
+		"metrics","multiplex","ping","replace_token","restart","scale",
+		"secrets","stats","stream","update_apps","users","verify"
+	};
+	
+	auto segments=string_split_columns(path.substr(apiPrefix.size()),'/',false);
+	//no route has more than six segments after the version
+	if(segments.empty() || segments.size()>6)
+		return "other";
+	std::string result="/v1alpha3";
+	for(std::size_t i=0; i<segments.size(); i++){
+		//routes alternate between fixed names of collections, and the IDs or
+		//names of items within them, except for a few fixed names which 
+		//appear where an item could
+		if(i%2==1 && segments[i]!="ad-hoc" && segments[i]!="stream")
+			result+="/<string>";
+		else{
+			if(!routeNames.count(segments[i]))
+				return "other";
+			result+="/"+segments[i];
+		}
+	}
+	return result;
+}
@@ -0,0 +1,96 @@
+#include "RequestTracing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "FileSystem.h"
+#include "Logging.h"
+#include "RequestMetrics.h"
+
+void RequestTracer::before_handle(crow::request& req, crow::response& res, context& ctx){
+	if(req.get_header_value("X-Slate-Trace").empty() && !req.url_params.get("trace"))
+		return;
+	if(!authorizer || !authorizer(req))
+		return;
+	if(exporter){
+		//write the trace out when the last reference to it is released
+		std::shared_ptr<Exporter> destination=exporter;
+		ctx.trace.reset(new tracing::Trace(tracing::generateTraceID()),
+		                [destination](tracing::Trace* trace){
+		                	try{
+		                		destination->write(*trace);
+		                	}catch(std::exception& ex){
+		                		log_warn("Failed to write trace " << trace->id() << ": " << ex.what());
+		                	}
+		                	delete trace;
+		                });
+	}
+	else
+		ctx.trace=std::make_shared<tracing::Trace>(tracing::generateTraceID());
+	ctx.scope.reset(new tracing::Scope(ctx.trace));
+}
+
+void RequestTracer::after_handle(crow::request& req, crow::response& res, context& ctx){
+	if(!ctx.trace)
+		return;
+	ctx.scope.reset();
+	const auto total=tracing::clock::now()-ctx.trace->start();
+	ctx.trace->record("request",crow::method_name(req.method)+" "+routeTemplate(req.url),
+	                  ctx.trace->start(),total);
+	res.add_header("Server-Timing",tracing::serverTiming(*ctx.trace,total));
+	res.add_header("X-Slate-Trace-ID",ctx.trace->id());
+	ctx.trace.reset();
+}
+
+void RequestTracer::setExportDirectory(const std::string& path, std::size_t maxFiles){
+	exporter.reset();
+	if(path.empty())
+		return;
+	std::shared_ptr<Exporter> newExporter=std::make_shared<Exporter>();
+	newExporter->directory=path;
+	newExporter->maxFiles=maxFiles;
+	std::deque<std::string>& traceFiles=newExporter->files;
+	//files left by earlier runs count towards the limit, oldest first
+	std::vector<std::pair<time_t,std::string>> existing;
+	for(const auto& entry : directory(path)){
+		const std::string name=entry.path().name();
+		if(!is_regular_file(entry) || name.find("trace-")!=0 || entry.path().extension()!="json")
+			continue;
+		struct stat info;
+		if(stat(entry.path().str().c_str(),&info)==0)
+			existing.emplace_back(info.st_mtime,entry.path().str());
+	}
+	std::sort(existing.begin(),existing.end());
+	for(const auto& file : existing)
+		traceFiles.push_back(file.second);
+	while(traceFiles.size()>maxFiles){
+		std::remove(traceFiles.front().c_str());
+		traceFiles.pop_front();
+	}
+	exporter=newExporter;
+}
+
+void RequestTracer::Exporter::write(const tracing::Trace& trace){
+	if(!maxFiles)
+		return;
+	const std::string path=directory+"/trace-"+trace.id()+".json";
+	{
+		std::ofstream traceFile(path);
+		traceFile << tracing::chromeTrace(trace);
+		if(!traceFile){
+			log_warn("Failed to write trace to " << path);
+			return;
+		}
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	files.push_back(path);
+	while(files.size()>maxFiles){
+		std::remove(files.front().c_str());
+		files.pop_front();
+	}
+}
@@ -0,0 +1,82 @@
+#include "ResponseCompression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+#include "Archive.h"
+#include "Logging.h"
+#include "ServerUtilities.h"
+
+const std::size_t ResponseCompressor::minimumSize;
+const int ResponseCompressor::compressionLevel;
+
+bool acceptsGzipEncoding(const std::string& acceptEncoding){
+	bool wildcard=false;
+	for(const std::string& item : string_split_columns(acceptEncoding,',',false)){
+		auto parts=string_split_columns(item,';',false);
+		if(parts.empty())
+			continue;
+		std::string coding=trim(parts.front());
+		std::transform(coding.begin(),coding.end(),coding.begin(),
+		               [](char c)->char{ return std::tolower(c); });
+		bool allowed=true;
+		for(std::size_t i=1; i<parts.size(); i++){
+			std::string param=trim(parts[i]);
+			if(param.size()>2 && (param[0]=='q' || param[0]=='Q') && param[1]=='='){
+				double quality=1;
+				std::istringstream(param.substr(2)) >> quality;
+				allowed=quality>0;
+			}
+		}
+		if(coding=="gzip" || coding=="x-gzip")
+			return allowed; //an explicit entry overrides any wildcard
+		if(coding=="*")
+			wildcard=allowed;
+	}
+	return wildcard;
+}
+
+void ResponseCompressor::before_handle(crow::request& req, crow::response& res, context& ctx){
+	ctx.acceptsGzip=acceptsGzipEncoding(req.get_header_value("Accept-Encoding"));
+}
+
+void ResponseCompressor::after_handle(crow::request& req, crow::response& res, context& ctx){
+	if(!ctx.acceptsGzip || res.body.size()<minimumSize || res.headers.count("Content-Encoding"))
+		return;
+	std::string compressed;
+	try{
+		compressed=gzipCompress(res.body,compressionLevel);
+	}catch(std::runtime_error& err){
+		log_error("Failed to compress response to " << req.url << ": " << err.what());
+		return;
+	}
+	//incompressible data is better sent as it is
+	if(compressed.size()>=res.body.size())
+		return;
+	compressedResponses++;
+	originalBytes+=res.body.size();
+	compressedBytes+=compressed.size();
+	res.body.swap(compressed);
+	res.set_header("Content-Encoding","gzip");
+	//the compressed body is a different representation, so it must not share
+	//a strong ETag with the uncompressed one
+	const std::string& etag=res.get_header_value("ETag");
+	if(etag.size()>=2 && etag.back()=='"')
+		res.set_header("ETag",etag.substr(0,etag.size()-1)+compressedETagSuffix+'"');
+	res.add_header("Vary","Accept-Encoding");
+}
+
+std::string ResponseCompressor::getStatistics() const{
+	std::ostringstream os;
+	//original sizes are recorded first, so reading them second ensures that
+	//they cover at least all of the compressed sizes read
+	unsigned long long compressed=compressedBytes.load();
+	unsigned long long original=originalBytes.load();
+	os << "Compressed responses: " << compressedResponses.load() << "\n";
+	os << "Response bytes saved by compression: " << (original-compressed);
+	if(original)
+		os << " (" << 100*(original-compressed)/original << "%)";
+	os << "\n";
+	return os.str();
+}
@@ -5,6 +5,7 @@
 #include "rapidjson/stringbuffer.h"
 
 #include "Logging.h"
+#include "Pagination.h"
 #include "ServerUtilities.h"
 #include "KubeInterface.h"
 #include "Archive.h"
@@ -99,29 +100,56 @@ crow::response listSecrets(PersistentStore& store, const crow::request& req){
 	
 	std::vector<Secret> secrets=store.listSecrets(group.id,cluster);
 	
-	rapidjson::Document result(rapidjson::kObjectType);
-	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
-	
-	result.AddMember("apiVersion", "v1alpha3", alloc);
-	rapidjson::Value resultItems(rapidjson::kArrayType);
-	resultItems.Reserve(secrets.size(), alloc);
+	static const std::map<std::string,SortKey<Secret>> sortKeys={
+		{"id",[](const Secret& s)->const std::string&{ return s.id; }},
+		{"name",[](const Secret& s)->const std::string&{ return s.name; }},
+		{"created",[](const Secret& s)->const std::string&{ return s.ctime; }},
+	};
+	std::string continueToken;
+	try{
+		continueToken=paginate(secrets,parsePageRequest(req.url_params),sortKeys);
+	}catch(std::runtime_error& err){
+		return crow::response(400,generateError(err.what()));
+	}
 	
+	JSONResponseWriter out(64+256*secrets.size());
+	auto& json=out.json();
+	json.StartObject();
+	json.Key("apiVersion");
+	json.String("v1alpha3");
+	json.Key("items");
+	json.StartArray();
+	//all secrets belong to the same group, so only look up its name once
+	const std::string& groupName=group.name;
 	for(const Secret& secret : secrets){
-		rapidjson::Value secretResult(rapidjson::kObjectType);
-		secretResult.AddMember("apiVersion", "v1alpha3", alloc);
-		secretResult.AddMember("kind", "Secret", alloc);
-		rapidjson::Value secretData(rapidjson::kObjectType);
-		secretData.AddMember("id", secret.id, alloc);
-		secretData.AddMember("name", secret.name, alloc);
-		secretData.AddMember("group", store.getGroup(secret.group).name, alloc);
-		secretData.AddMember("cluster", store.getCluster(secret.cluster).name, alloc);
-		secretData.AddMember("created", secret.ctime, alloc);
-		secretResult.AddMember("metadata", secretData, alloc);
-		resultItems.PushBack(secretResult, alloc);
+		json.StartObject();
+		json.Key("apiVersion");
+		json.String("v1alpha3");
+		json.Key("kind");
+		json.String("Secret");
+		json.Key("metadata");
+		json.StartObject();
+		json.Key("id");
+		json.String(secret.id);
+		json.Key("name");
+		json.String(secret.name);
+		json.Key("group");
+		json.String(groupName);
+		json.Key("cluster");
+		json.String(store.getCluster(secret.cluster).name);
+		json.Key("created");
+		json.String(secret.ctime);
+		json.EndObject();
+		json.EndObject();
 	}
-	result.AddMember("items", resultItems, alloc);
+	json.EndArray();
+	if(!continueToken.empty()){
+		json.Key("continue");
+		json.String(continueToken);
+	}
+	json.EndObject();
 	
-	return crow::response(to_string(result));
+	return out.response();
 }
 
 crow::response createSecret(PersistentStore& store, const crow::request& req){
@@ -208,3 +208,29 @@ std::vector<std::string> string_split_columns(const std::string& line, char deli
     }
     return tokens;
 }
+
+const std::string compressedETagSuffix="-gzip";
+
+crow::response conditionalResponse(const crow::request& req, crow::response res){
+	const std::string tag=contentHash(res.body);
+	const std::string etag='"'+tag+'"';
+	const std::string& ifNoneMatch=req.get_header_value("If-None-Match");
+	bool matched=false;
+	for(std::string candidate : string_split_columns(ifNoneMatch,',',false)){
+		//If-None-Match uses the weak comparison, so the weakness indicator is 
+		//irrelevant
+		if(candidate.find("W/")==0)
+			candidate=candidate.substr(2);
+		if(candidate=="*" || candidate==etag || candidate=='"'+tag+compressedETagSuffix+'"'){
+			matched=true;
+			break;
+		}
+	}
+	if(matched){
+		crow::response notModified(304);
+		notModified.set_header("ETag",etag);
+		return notModified;
+	}
+	res.set_header("ETag",etag);
+	return res;
+}
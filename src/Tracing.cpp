@@ -0,0 +1,159 @@
+#include "Tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <sstream>
+
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+namespace tracing{
+
+namespace{
+	thread_local std::shared_ptr<Trace> currentTrace;
+
+	unsigned int threadNumber(){
+		static std::atomic<unsigned int> nextThread(1);
+		thread_local unsigned int number=nextThread++;
+		return number;
+	}
+}
+
+Trace::Trace(std::string id):traceID(std::move(id)),startTime(clock::now()){}
+
+void Trace::record(std::string category, std::string name,
+                   clock::time_point start, clock::duration duration){
+	SpanRecord span{std::move(category),std::move(name),start,duration,threadNumber()};
+	std::lock_guard<std::mutex> lock(mutex);
+	recorded.push_back(std::move(span));
+}
+
+std::vector<SpanRecord> Trace::spans() const{
+	std::lock_guard<std::mutex> lock(mutex);
+	return recorded;
+}
+
+std::shared_ptr<Trace> current(){
+	return currentTrace;
+}
+
+Scope::Scope(std::shared_ptr<Trace> trace):previous(std::move(currentTrace)){
+	currentTrace=std::move(trace);
+}
+
+Scope::~Scope(){
+	currentTrace=std::move(previous);
+}
+
+Span::Span(const char* category, std::string name):trace(currentTrace),category(category){
+	//avoid any work when not tracing
+	if(trace){
+		this->name=std::move(name);
+		start=clock::now();
+	}
+}
+
+Span::~Span(){
+	if(trace)
+		trace->record(category,std::move(name),start,clock::now()-start);
+}
+
+void recordCompleted(const char* category, std::string name, clock::duration duration){
+	if(currentTrace){
+		const auto end=clock::now();
+		currentTrace->record(category,std::move(name),end-duration,duration);
+	}
+}
+
+std::string generateTraceID(){
+	thread_local std::mt19937_64 generator(std::random_device{}());
+	char buffer[33];
+	std::snprintf(buffer,sizeof(buffer),"%016llx%016llx",
+	              (unsigned long long)generator(),(unsigned long long)generator());
+	return buffer;
+}
+
+std::string serverTiming(const Trace& trace, clock::duration total){
+	struct Summary{
+		std::string description;
+		clock::duration duration;
+		unsigned int count;
+	};
+	//keep the kinds of work in the order in which they first occurred
+	std::vector<std::string> order;
+	std::map<std::string,Summary> summaries;
+	for(const auto& span : trace.spans()){
+		//metric names must be HTTP tokens
+		std::string name=span.category+"."+span.name;
+		for(char& c : name){
+			if(!std::isalnum((unsigned char)c) && c!='.' && c!='-' && c!='_')
+				c='_';
+		}
+		auto it=summaries.find(name);
+		if(it==summaries.end()){
+			order.push_back(name);
+			it=summaries.emplace(name,Summary{span.category+" "+span.name,clock::duration::zero(),0}).first;
+		}
+		it->second.duration+=span.duration;
+		it->second.count++;
+	}
+
+	auto milliseconds=[](clock::duration d){
+		return std::chrono::duration_cast<std::chrono::microseconds>(d).count()/1000.;
+	};
+	std::ostringstream os;
+	os << "total;dur=" << milliseconds(total);
+	//very long headers may be rejected by proxies, and the full detail is
+	//available from the exported trace
+	const std::size_t maxEntries=32;
+	for(std::size_t i=0; i<order.size() && i<maxEntries; i++){
+		const Summary& summary=summaries[order[i]];
+		std::string description=summary.description;
+		description.erase(std::remove_if(description.begin(),description.end(),
+		                                 [](char c){ return c=='"' || c=='\\' || !std::isprint((unsigned char)c); }),
+		                  description.end());
+		os << ", " << order[i] << ";dur=" << milliseconds(summary.duration)
+		   << ";desc=\"" << description;
+		if(summary.count>1)
+			os << " x" << summary.count;
+		os << '"';
+	}
+	return os.str();
+}
+
+std::string chromeTrace(const Trace& trace){
+	rapidjson::Document result(rapidjson::kObjectType);
+	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
+
+	auto microseconds=[](clock::duration d)->int64_t{
+		return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+	};
+	rapidjson::Value events(rapidjson::kArrayType);
+	for(const auto& span : trace.spans()){
+		rapidjson::Value event(rapidjson::kObjectType);
+		event.AddMember("name", span.name, alloc);
+		event.AddMember("cat", span.category, alloc);
+		event.AddMember("ph", "X", alloc);
+		event.AddMember("ts", microseconds(span.start-trace.start()), alloc);
+		event.AddMember("dur", microseconds(span.duration), alloc);
+		event.AddMember("pid", 1, alloc);
+		event.AddMember("tid", span.thread, alloc);
+		events.PushBack(event, alloc);
+	}
+	result.AddMember("traceEvents", events, alloc);
+	rapidjson::Value metadata(rapidjson::kObjectType);
+	metadata.AddMember("traceID", trace.id(), alloc);
+	result.AddMember("otherData", metadata, alloc);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	result.Accept(writer);
+	return buffer.GetString();
+}
+
+} //namespace tracing
@@ -1,6 +1,8 @@
 #include "UserCommands.h"
 
+#include "Futures.h"
 #include "Logging.h"
+#include "Pagination.h"
 #include "ServerUtilities.h"
 
 crow::response listUsers(PersistentStore& store, const crow::request& req){
@@ -15,29 +17,56 @@ crow::response listUsers(PersistentStore& store, const crow::request& req){
 		users = store.listUsersByGroup(group);
 	else
 		users = store.listUsers();
-
-	rapidjson::Document result(rapidjson::kObjectType);
-	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
 	
-	result.AddMember("apiVersion", "v1alpha3", alloc);
-	rapidjson::Value resultItems(rapidjson::kArrayType);
-	resultItems.Reserve(users.size(), alloc);
+	static const std::map<std::string,SortKey<User>> sortKeys={
+		{"id",[](const User& u)->const std::string&{ return u.id; }},
+		{"name",[](const User& u)->const std::string&{ return u.name; }},
+		{"email",[](const User& u)->const std::string&{ return u.email; }},
+		{"institution",[](const User& u)->const std::string&{ return u.institution; }},
+	};
+	std::string continueToken;
+	try{
+		continueToken=paginate(users,parsePageRequest(req.url_params),sortKeys);
+	}catch(std::runtime_error& err){
+		return crow::response(400,generateError(err.what()));
+	}
+
+	JSONResponseWriter out(64+256*users.size());
+	auto& json=out.json();
+	json.StartObject();
+	json.Key("apiVersion");
+	json.String("v1alpha3");
+	json.Key("items");
+	json.StartArray();
 	for(const User& user : users){
-		rapidjson::Value userResult(rapidjson::kObjectType);
-		userResult.AddMember("apiVersion", "v1alpha3", alloc);
-		userResult.AddMember("kind", "User", alloc);
-		rapidjson::Value userData(rapidjson::kObjectType);
-		userData.AddMember("id", rapidjson::StringRef(user.id.c_str()), alloc);
-		userData.AddMember("name", rapidjson::StringRef(user.name.c_str()), alloc);
-		userData.AddMember("email", rapidjson::StringRef(user.email.c_str()), alloc);
-		userData.AddMember("phone", rapidjson::StringRef(user.phone.c_str()), alloc);
-		userData.AddMember("institution", rapidjson::StringRef(user.institution.c_str()), alloc);
-		userResult.AddMember("metadata", userData, alloc);
-		resultItems.PushBack(userResult, alloc);
+		json.StartObject();
+		json.Key("apiVersion");
+		json.String("v1alpha3");
+		json.Key("kind");
+		json.String("User");
+		json.Key("metadata");
+		json.StartObject();
+		json.Key("id");
+		json.String(user.id);
+		json.Key("name");
+		json.String(user.name);
+		json.Key("email");
+		json.String(user.email);
+		json.Key("phone");
+		json.String(user.phone);
+		json.Key("institution");
+		json.String(user.institution);
+		json.EndObject();
+		json.EndObject();
 	}
-	result.AddMember("items", resultItems, alloc);
+	json.EndArray();
+	if(!continueToken.empty()){
+		json.Key("continue");
+		json.String(continueToken);
+	}
+	json.EndObject();
 	
-	return crow::response(to_string(result));
+	return out.response();
 }
 
 crow::response createUser(PersistentStore& store, const crow::request& req){
@@ -178,9 +207,16 @@ crow::response getUserInfo(PersistentStore& store, const crow::request& req, con
 	if(!user.admin && user.id!=uID)
 		return crow::response(403,generateError("Not authorized"));
 	
-	User targetUser=store.getUser(uID);
+	//the user record and the membership records are independent, so fetch 
+	//them concurrently
+	auto userLookup=store.getUserAsync(uID);
+	auto membershipLookup=store.getUserGroupMembershipsAsync(uID);
+	User targetUser=userLookup.get();
 	if(!targetUser)
 		return crow::response(404,generateError("Not found"));
+	std::vector<std::future<Group>> groupLookups;
+	for(const std::string& groupID : membershipLookup.get())
+		groupLookups.push_back(store.getGroupAsync(groupID));
 
 	rapidjson::Document result(rapidjson::kObjectType);
 	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
@@ -196,10 +232,9 @@ crow::response getUserInfo(PersistentStore& store, const crow::request& req, con
 	metadata.AddMember("access_token", rapidjson::StringRef(targetUser.token.c_str()), alloc);
 	metadata.AddMember("admin", targetUser.admin, alloc);
 	rapidjson::Value groupMemberships(rapidjson::kArrayType);
-	std::vector<std::string> groupMembershipList = store.getUserGroupMemberships(uID,true);
-	for (auto group : groupMembershipList) {
+	for (const Group& group : getAll(groupLookups)) {
 		rapidjson::Value entry(rapidjson::kStringType);
-		entry.SetString(group, alloc);
+		entry.SetString(group.name, alloc);
 		groupMemberships.PushBack(entry, alloc);
 	}
 	metadata.AddMember("groups", groupMemberships, alloc);
@@ -421,6 +456,158 @@ crow::response findUser(PersistentStore& store, const crow::request& req){
 	return crow::response(to_string(result));
 }
 
+namespace{
+	///Extract the information about one user from a bulk import request
+	///\param item the JSON data for the user
+	///\param user the user object to fill in
+	///\param groups the IDs or names of the groups the user should belong to
+	///\return a description of the problem if the data is invalid, otherwise
+	///        an empty string
+	std::string parseImportedUser(const rapidjson::Value& item, User& user, 
+	                              std::set<std::string>& groups){
+		if(!item.IsObject() || !item.HasMember("metadata") || !item["metadata"].IsObject())
+			return "Missing user metadata in request";
+		const rapidjson::Value& metadata=item["metadata"];
+		for(const char* field : {"globusID","name","email","phone","institution"}){
+			if(!metadata.HasMember(field))
+				return std::string("Missing user ")+field+" in request";
+			if(!metadata[field].IsString())
+				return std::string("Incorrect type for user ")+field;
+		}
+		user.globusID=metadata["globusID"].GetString();
+		user.name=metadata["name"].GetString();
+		user.email=metadata["email"].GetString();
+		user.phone=metadata["phone"].GetString();
+		user.institution=metadata["institution"].GetString();
+		user.admin=false;
+		if(metadata.HasMember("admin")){
+			if(!metadata["admin"].IsBool())
+				return "Incorrect type for user admin flag";
+			user.admin=metadata["admin"].GetBool();
+		}
+		if(metadata.HasMember("groups")){
+			if(!metadata["groups"].IsArray())
+				return "Incorrect type for user groups";
+			for(const auto& group : metadata["groups"].GetArray()){
+				if(!group.IsString())
+					return "Incorrect type for user group";
+				groups.insert(group.GetString());
+			}
+		}
+		return "";
+	}
+}
+
+crow::response importUsers(PersistentStore& store, const crow::request& req){
+	//important: user is the user issuing the command, not the users being imported
+	const User user=authenticateUser(store, req.url_params.get("token"));
+	log_info(user << " requested to import users from " << req.remote_endpoint);
+	if(!user || !user.admin) //only administrators can create users
+		return crow::response(403,generateError("Not authorized"));
+	
+	rapidjson::Document body;
+	try{
+		body.Parse(req.body.c_str());
+	}catch(std::runtime_error& err){
+		return crow::response(400,generateError("Invalid JSON in request body"));
+	}
+	if(body.IsNull() || !body.IsObject())
+		return crow::response(400,generateError("Invalid JSON in request body"));
+	if(!body.HasMember("items") || !body["items"].IsArray())
+		return crow::response(400,generateError("Missing user list in request"));
+	
+	//Validate everything before changing anything, so that a bad request has 
+	//no effect
+	struct ImportedUser{
+		User user;
+		std::set<std::string> groups;
+		bool created;
+		std::vector<std::string> addedGroups;
+	};
+	std::vector<ImportedUser> imported;
+	imported.reserve(body["items"].Size());
+	std::set<std::string> globusIDs;
+	std::map<std::string,Group> groups;
+	for(const auto& item : body["items"].GetArray()){
+		imported.emplace_back();
+		ImportedUser& entry=imported.back();
+		std::string problem=parseImportedUser(item,entry.user,entry.groups);
+		if(!problem.empty())
+			return crow::response(400,generateError(problem));
+		if(!globusIDs.insert(entry.user.globusID).second)
+			return crow::response(400,generateError("Globus ID "+entry.user.globusID+" appears more than once"));
+		for(const auto& groupName : entry.groups){
+			if(groups.count(groupName))
+				continue;
+			Group group=store.getGroup(groupName);
+			if(!group)
+				return crow::response(404,generateError("Group "+groupName+" not found"));
+			groups.emplace(groupName,group);
+		}
+	}
+	
+	std::vector<User> newUsers;
+	std::vector<std::pair<std::string,std::string>> newMemberships;
+	for(ImportedUser& entry : imported){
+		User existing=store.findUserByGlobusID(entry.user.globusID);
+		entry.created=!existing;
+		std::set<std::string> currentGroups;
+		if(existing){
+			//details of existing users are left as they are
+			entry.user.id=existing.id;
+			for(const auto& groupID : store.getUserGroupMemberships(existing.id))
+				currentGroups.insert(groupID);
+		}
+		else{
+			entry.user.id=idGenerator.generateUserID();
+			entry.user.token=idGenerator.generateUserToken();
+			entry.user.valid=true;
+			newUsers.push_back(entry.user);
+		}
+		//the same group may have been named in different ways
+		std::set<std::string> addedIDs;
+		for(const auto& groupName : entry.groups){
+			const Group& group=groups.find(groupName)->second;
+			if(currentGroups.count(group.id) || !addedIDs.insert(group.id).second)
+				continue;
+			newMemberships.emplace_back(entry.user.id,group.id);
+			entry.addedGroups.push_back(group.name);
+		}
+	}
+	
+	log_info("Importing " << newUsers.size() << " new users and " 
+	         << newMemberships.size() << " group memberships");
+	if(!store.addUsers(newUsers))
+		return crow::response(500,generateError("User account creation failed"));
+	if(!store.addUsersToGroups(newMemberships))
+		return crow::response(500,generateError("User addition to Group failed"));
+	
+	rapidjson::Document result(rapidjson::kObjectType);
+	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
+	
+	result.AddMember("apiVersion", "v1alpha3", alloc);
+	rapidjson::Value resultItems(rapidjson::kArrayType);
+	resultItems.Reserve(imported.size(), alloc);
+	for(const ImportedUser& entry : imported){
+		rapidjson::Value userResult(rapidjson::kObjectType);
+		userResult.AddMember("apiVersion", "v1alpha3", alloc);
+		userResult.AddMember("kind", "User", alloc);
+		rapidjson::Value metadata(rapidjson::kObjectType);
+		metadata.AddMember("id", entry.user.id, alloc);
+		metadata.AddMember("globusID", entry.user.globusID, alloc);
+		metadata.AddMember("created", entry.created, alloc);
+		rapidjson::Value addedGroups(rapidjson::kArrayType);
+		for(const auto& groupName : entry.addedGroups)
+			addedGroups.PushBack(rapidjson::Value(groupName, alloc), alloc);
+		metadata.AddMember("addedGroups", addedGroups, alloc);
+		userResult.AddMember("metadata", metadata, alloc);
+		resultItems.PushBack(userResult, alloc);
+	}
+	result.AddMember("items", resultItems, alloc);
+	
+	return crow::response(to_string(result));
+}
+
 crow::response replaceUserToken(PersistentStore& store, const crow::request& req, const std::string uID){
 	//important: user is the user issuing the command, not the user being modified
 	const User user=authenticateUser(store, req.url_params.get("token"));
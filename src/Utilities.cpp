@@ -1,6 +1,7 @@
 #include <Utilities.h>
 
 #include <cerrno>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <stdexcept>
@@ -61,6 +62,19 @@ std::string removeShellEscapeSequences(std::string s){
 	return s;
 }
 
+std::string contentHash(const std::string& data){
+	uint64_t hash=14695981039346656037ULL; //FNV offset basis
+	for(unsigned char c : data){
+		hash^=c;
+		hash*=1099511628211ULL; //FNV prime
+	}
+	const static char hexDigits[]="0123456789abcdef";
+	std::string result(16,'0');
+	for(int i=15; i>=0; i--, hash>>=4)
+		result[i]=hexDigits[hash&0xF];
+	return result;
+}
+
 //Implementation of program_location based on 
 //boost::dll::detail::program_location_impl for POSIX, with changes to avoid 
 //having to link against libboost_system or libboost_filesystem
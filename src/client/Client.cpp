@@ -18,6 +18,7 @@
 
 #include "client_version.h"
 #include "Archive.h"
+#include "FileSystem.h"
 #include "Utilities.h"
 #include "Process.h"
 #include "OSDetection.h"
@@ -293,6 +294,21 @@ void Client::ProgressManager::SetProgress(float value){
   }
 }
 
+void Client::ProgressManager::ShowProgressMessage(std::string message){
+  if (!verbose_)
+    return;
+  if(nestingLevel)
+    return;
+  std::unique_lock<std::mutex> lock(this->mut_);
+  work_.emplace(std::chrono::system_clock::now(),
+		[this, message]()->void{
+		  std::unique_lock<std::mutex> lock(this->mut_);
+		  if(this->showingProgress_)
+		    start_scan_progress(message);
+		});
+  cond_.notify_all();
+}
+
 void Client::ProgressManager::StopShowingProgress(){
   if (!verbose_)
     return;
@@ -688,6 +704,63 @@ std::string Client::formatOutput(const rapidjson::Value& jdata, const rapidjson:
 	throw std::runtime_error("Specified output format is not supported");
 }
 
+void Client::printListing(std::string url, const std::vector<columnSpec>& columns,
+                          const std::string& errMsg,
+                          std::function<void(rapidjson::Document&)> prepare){
+	//Pages can only be printed independently when the output is a table which
+	//is ordered the same way the server orders the pages. Otherwise, all pages
+	//are collected before anything is printed. 
+	const bool streaming=pageSize && orderBy.empty() && 
+	                     (outputFormat.empty() || outputFormat=="no-headers");
+	if(pageSize){
+		url+="&limit="+std::to_string(pageSize);
+		if(streaming)
+			url+="&sort=name";
+	}
+	
+	rapidjson::Document combined;
+	std::string continueToken;
+	bool firstPage=true;
+	do{
+		//only unpaged listings are cached, to avoid accumulating cache entries
+		//for every continuation token
+		auto response=pageSize ? 
+		  httpRequests::httpGet(url+(continueToken.empty()?"":"&continue="+continueToken),
+		                        defaultOptions()) : 
+		  cachedGet(url);
+		if(response.status!=200){
+			std::cerr << errMsg;
+			showError(response.body);
+			throw OperationFailed();
+		}
+		rapidjson::Document json;
+		json.Parse(response.body.c_str());
+		if(prepare)
+			prepare(json);
+		continueToken.clear();
+		if(json.HasMember("continue") && json["continue"].IsString())
+			continueToken=json["continue"].GetString();
+		
+		if(streaming){
+			std::cout << jsonListToTable(json["items"], columns, firstPage && outputFormat.empty());
+			std::cout.flush();
+		}
+		else if(firstPage)
+			combined.Swap(json);
+		else{
+			rapidjson::Document::AllocatorType& alloc=combined.GetAllocator();
+			for(const auto& item : json["items"].GetArray())
+				combined["items"].PushBack(rapidjson::Value(item,alloc),alloc);
+		}
+		firstPage=false;
+	}while(!continueToken.empty());
+	
+	if(!streaming){
+		combined.RemoveMember("continue");
+		std::cout << formatOutput(combined["items"], combined, columns);
+	}
+}
+
 Client::Client(bool useANSICodes, std::size_t outputWidth):
 apiVersion("v1alpha3"),
 useANSICodes(useANSICodes),
@@ -990,7 +1063,7 @@ void Client::deleteGroup(const GroupDeleteOptions& opt){
 				throw std::runtime_error("Group deletion aborted");
 	}
 	
-	auto response=httpRequests::httpDelete(makeURL("groups/"+opt.groupName),defaultOptions());
+	auto response=awaitJob(httpRequests::httpDelete(makeURL("groups/"+opt.groupName)+"&async",defaultOptions()));
 	//TODO: other output formats
 	if(response.status==200)
 		std::cout << "Successfully deleted group " << opt.groupName << std::endl;
@@ -1030,18 +1103,8 @@ void Client::listGroups(const GroupListOptions& opt){
 	auto url = makeURL("groups");
 	if (opt.user)
 		url += "&user=true";
-	auto response=httpRequests::httpGet(url,defaultOptions());
-	//TODO: handle errors, make output nice
-	if(response.status==200){
-		rapidjson::Document json;
-		json.Parse(response.body.c_str());
-		std::cout << formatOutput(json["items"], json, {{"Name", "/metadata/name"},{"ID", "/metadata/id", true}});
-	}
-	else{
-		std::cerr << "Failed to list groups";
-		showError(response.body);
-		throw OperationFailed();
-	}
+	printListing(url, {{"Name", "/metadata/name"},{"ID", "/metadata/id", true}}, 
+	             "Failed to list groups");
 }
 
 rapidjson::Document Client::getClusterList(std::string group){
@@ -1049,7 +1112,7 @@ rapidjson::Document Client::getClusterList(std::string group){
 	if(!group.empty())
 		url+="&group="+group;
 	ProgressToken progress(pman_,"Fetching cluster list...");
-	auto response=httpRequests::httpGet(url,defaultOptions());
+	auto response=cachedGet(url);
 	if(response.status==200){
 		rapidjson::Document json;
 		json.Parse(response.body.c_str());
@@ -1261,10 +1324,10 @@ void Client::deleteCluster(const ClusterDeleteOptions& opt){
 				throw std::runtime_error("Cluster deletion aborted");
 	}
 	
-	auto url=makeURL("clusters/"+opt.clusterName);
+	auto url=makeURL("clusters/"+opt.clusterName)+"&async";
 	if(opt.force)
 		url+="&force";
-	auto response=httpRequests::httpDelete(url,defaultOptions());
+	auto response=awaitJob(httpRequests::httpDelete(url,defaultOptions()));
 	//TODO: other output formats
 	if(response.status==200)
 		std::cout << "Successfully deleted cluster " << opt.clusterName << std::endl;
@@ -1276,11 +1339,14 @@ void Client::deleteCluster(const ClusterDeleteOptions& opt){
 }
 
 void Client::listClusters(const ClusterListOptions& opt){
-	rapidjson::Document json = getClusterList(opt.group);
-	std::cout << formatOutput(json["items"], json,
-			{{"Name","/metadata/name"},
-			{"Admin","/metadata/owningGroup"},
-			{"ID","/metadata/id",true}});
+	std::string url=makeURL("clusters");
+	if(!opt.group.empty())
+		url+="&group="+opt.group;
+	ProgressToken progress(pman_,"Fetching cluster list...");
+	printListing(url, {{"Name","/metadata/name"},
+	                   {"Admin","/metadata/owningGroup"},
+	                   {"ID","/metadata/id",true}},
+	             "Failed to list clusters");
 }
 
 void Client::getClusterInfo(const ClusterInfoOptions& opt){
@@ -1602,7 +1668,7 @@ void Client::listApplications(const ApplicationOptions& opt){
 		url+="&dev";
 	if(opt.testRepo)
 		url+="&test";
-	auto response=httpRequests::httpGet(url,defaultOptions());
+	auto response=cachedGet(url);
 	//TODO: handle errors, make output nice
 	if(response.status==200){
 		rapidjson::Document json;
@@ -1741,12 +1807,13 @@ void Client::installApplication(const ApplicationInstallOptions& opt){
 		url+="&dev";
 	if(opt.testRepo)
 		url+="&test";
+	url+="&async";
 
 	rapidjson::StringBuffer buffer;
 	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
 	request.Accept(writer);
 
-	auto response=httpRequests::httpPost(url,buffer.GetString(),defaultOptions());
+	auto response=awaitJob(httpRequests::httpPost(url,buffer.GetString(),defaultOptions()));
 	
 	//TODO: other output formats
 	if(response.status==200){
@@ -1791,20 +1858,8 @@ void Client::listInstances(const InstanceListOptions& opt){
 		columns = {{"Name","/metadata/name"},
 			   {"ID","/metadata/id",true}};
 	
-	auto response=httpRequests::httpGet(url,defaultOptions());
-	//TODO: handle errors, make output nice
-	if(response.status==200){
-		rapidjson::Document json;
-		json.Parse(response.body.c_str());
-		filterInstanceNames(json, "/items");
-		std::cout << formatOutput(json["items"], json,
-		                             columns);
-	}
-	else{
-		std::cerr << "Failed to list application instances";
-		showError(response.body);
-		throw OperationFailed();
-	}
+	printListing(url, columns, "Failed to list application instances",
+	             [](rapidjson::Document& json){ filterInstanceNames(json, "/items"); });
 }
 
 void Client::getInstanceInfo(const InstanceOptions& opt){
@@ -1813,7 +1868,7 @@ void Client::getInstanceInfo(const InstanceOptions& opt){
 		throw std::runtime_error("The instance info command requires an instance ID, not a name");
 	
 	std::string url=makeURL("instances/"+opt.instanceID)+"&detailed";
-	auto response=httpRequests::httpGet(url,defaultOptions());
+	auto response=cachedGet(url);
 	//TODO: handle errors, make output nice
 	if(response.status==200){
 		rapidjson::Document body;
@@ -2010,8 +2065,8 @@ void Client::restartInstance(const InstanceOptions& opt){
 	if(!verifyInstanceID(opt.instanceID))
 		throw std::runtime_error("The instance restart command requires an instance ID, not a name");
 	
-	auto url=makeURL("instances/"+opt.instanceID+"/restart");
-	auto response=httpRequests::httpPut(url,"",defaultOptions());
+	auto url=makeURL("instances/"+opt.instanceID+"/restart")+"&async";
+	auto response=awaitJob(httpRequests::httpPut(url,"",defaultOptions()));
 	if(response.status==200){
 		std::cout << "Successfully restarted instance " << opt.instanceID << std::endl;
 		
@@ -2085,6 +2140,29 @@ void Client::fetchInstanceLogs(const InstanceLogOptions& opt){
 		url+="&container="+opt.container;
 	if(opt.previousLogs)
 		url+="&previous";
+	if(opt.follow){
+		if(clientShouldPrintOnlyJson())
+			throw std::runtime_error("Following logs is not possible with JSON output");
+		//the stream endpoint sends plain text as it is produced, which can be
+		//written out directly
+		url.insert(url.find('?'),"/stream");
+		url+="&follow";
+		auto options=defaultOptions();
+		options.outputSink=[&progress](const char* data, std::size_t size){
+			progress.end();
+			std::cout.write(data,size);
+			std::cout.flush();
+			return bool(std::cout);
+		};
+		auto response=httpRequests::httpGet(url,options);
+		if(response.status!=200){
+			progress.end();
+			std::cerr << "Failed to get application instance logs";
+			showError(response.body);
+			throw OperationFailed();
+		}
+		return;
+	}
 	auto response=httpRequests::httpGet(url,defaultOptions());
 	if(response.status==200){
 		rapidjson::Document body;
@@ -2181,19 +2259,7 @@ void Client::listSecrets(const SecretListOptions& opt){
 			   {"Created","/metadata/created",true},
 			   {"ID","/metadata/id",true}};
 	}
-	auto response=httpRequests::httpGet(url,defaultOptions());
-	//TODO: handle errors, make output nice
-	if(response.status==200){
-		rapidjson::Document json;
-		json.Parse(response.body.c_str());
-		std::cout << formatOutput(json["items"], json,
-		                             columns);
-	}
-	else{
-		std::cerr << "Failed to list secrets";
-		showError(response.body);
-		throw OperationFailed();
-	}
+	printListing(url, columns, "Failed to list secrets");
 }
 
 void Client::getSecretInfo(const SecretOptions& opt){
@@ -2516,6 +2582,106 @@ httpRequests::Options Client::defaultOptions() const{
 	return opts;
 }
 
+httpRequests::Response Client::cachedGet(const std::string& url){
+	//The URL contains the user's token, so it is only used in hashed form
+	const std::string cacheDir=getHomeDirectory()+".slate/cache/";
+	const std::string cachePath=cacheDir+contentHash(url);
+	//Each cache file holds the ETag on its first line, followed by the body
+	std::string cachedETag, cachedBody;
+	{
+		std::ifstream cacheFile(cachePath);
+		if(cacheFile && std::getline(cacheFile,cachedETag)){
+			std::ostringstream ss;
+			ss << cacheFile.rdbuf();
+			cachedBody=ss.str();
+		}
+	}
+	
+	auto options=defaultOptions();
+	options.ifNoneMatch=cachedETag;
+	auto response=httpRequests::httpGet(url,options);
+	if(response.status==304 && !cachedETag.empty())
+		return httpRequests::Response{200,cachedBody,cachedETag};
+	if(response.status==200 && !response.etag.empty()){
+		//failing to update the cache only costs efficiency later, so is not
+		//treated as an error
+		try{
+			mkdir_p(cacheDir,0700);
+			//mkstemp creates the file with mode 0600 and a unique name, so 
+			//there is no moment at which another user could read it, and 
+			//concurrent clients do not write over each other's files
+			const std::string tempPath=makeTemporaryFile(cachePath+".");
+			{
+				std::ofstream cacheFile(tempPath);
+				cacheFile << response.etag << '\n' << response.body;
+				if(!cacheFile){
+					remove(tempPath.c_str());
+					throw std::runtime_error("Failed to write "+tempPath);
+				}
+			}
+			if(rename(tempPath.c_str(),cachePath.c_str()))
+				remove(tempPath.c_str());
+		}catch(std::exception&){}
+	}
+	return response;
+}
+
+httpRequests::Response Client::awaitJob(httpRequests::Response response){
+	if(response.status!=202)
+		return response;
+	rapidjson::Document job;
+	job.Parse(response.body.c_str());
+	if(job.HasParseError() || !job.IsObject() || !job.HasMember("metadata") 
+	   || !job["metadata"].IsObject() || !job["metadata"].HasMember("id")
+	   || !job["metadata"]["id"].IsString())
+		throw std::runtime_error("Server did not return a valid job ID");
+	const std::string jobID=job["metadata"]["id"].GetString();
+	const std::string url=makeURL("jobs/"+jobID);
+	
+	//poll quickly at first, since many operations finish promptly
+	std::chrono::milliseconds delay(250);
+	const std::chrono::milliseconds maxDelay(2000);
+	//the server fails jobs which it stops running long before this, so a job 
+	//which goes this long without any change is assumed to be stuck
+	const std::chrono::minutes stallLimit(15);
+	std::string lastProgress, lastUpdate;
+	auto lastChange=std::chrono::steady_clock::now();
+	while(true){
+		std::this_thread::sleep_for(delay);
+		delay=std::min(2*delay,maxDelay);
+		auto status=httpRequests::httpGet(url,defaultOptions());
+		if(status.status!=200)
+			return status;
+		job.Parse(status.body.c_str());
+		if(job.HasParseError() || !job.IsObject() || !job.HasMember("metadata") 
+		   || !job["metadata"].IsObject())
+			throw std::runtime_error("Unable to parse job state from server");
+		const rapidjson::Value& metadata=job["metadata"];
+		if(metadata.HasMember("updated") && metadata["updated"].IsString() 
+		   && lastUpdate!=metadata["updated"].GetString()){
+			lastUpdate=metadata["updated"].GetString();
+			lastChange=std::chrono::steady_clock::now();
+		}
+		else if(std::chrono::steady_clock::now()-lastChange>stallLimit)
+			throw std::runtime_error("Job "+jobID+" has not been updated for "
+			                         +std::to_string(stallLimit.count())
+			                         +" minutes; giving up waiting for it");
+		if(metadata.HasMember("progress") && metadata["progress"].IsString() 
+		   && lastProgress!=metadata["progress"].GetString()){
+			lastProgress=metadata["progress"].GetString();
+			if(!lastProgress.empty())
+				pman_.ShowProgressMessage(lastProgress+"...");
+		}
+		if(job.HasMember("resultCode") && job["resultCode"].IsUint() 
+		   && job.HasMember("result") && job["result"].IsString()){
+			httpRequests::Response result;
+			result.status=job["resultCode"].GetUint();
+			result.body=job["result"].GetString();
+			return result;
+		}
+	}
+}
+
 #ifdef USE_CURLOPT_CAINFO
 void Client::detectCABundlePath() const{
 	if(caBundlePath.empty()){
@@ -383,6 +383,7 @@ void registerInstanceFetchLogs(CLI::App& parent, Client& client){
 	info->add_option("--max-lines", instOpt->maxLines, "Maximum number of most recent lines to fetch, 0 to get full logs");
 	info->add_option("--container", instOpt->container, "Name of specific container for which to fetch logs");
 	info->add_flag("--previous", instOpt->previousLogs, "Name of specific container for which to fetch logs");
+	info->add_flag("-f,--follow", instOpt->follow, "Keep showing new log output as it is written, with each line prefixed by its pod and container");
     info->callback([&client,instOpt](){ client.fetchInstanceLogs(*instOpt); });
 }
 
@@ -497,6 +498,9 @@ void registerCommonOptions(CLI::App& parent, Client& client){
 	                         "Do not use ANSI formatting escape sequences in output");
 	parent.add_option("--width",client.outputWidth,
 	                  "The maximum width to use when printing tabular output");
+	parent.add_option("--page-size",client.pageSize,
+	                  "Fetch listings from the server in pages of this many "
+	                  "items, printing each page as it arrives when possible");
 	parent.add_option("--api-endpoint",client.apiEndpoint,
 	                  "The endpoint at which to contact the SLATE API server")
 	                 ->envname("SLATE_API_ENDPOINT")
@@ -1,16 +1,26 @@
+#include <algorithm>
 #include <cerrno>
 #include <iostream>
 #include <cctype>
+#include <future>
+#include <mutex>
 
 #include <sys/stat.h>
 
+#include <aws/core/utils/threading/Executor.h>
+
 #define CROW_ENABLE_SSL
 #include <crow.h>
 
+#include "ClusterProber.h"
 #include "Entities.h"
+#include "JobEngine.h"
 #include "Logging.h"
 #include "PersistentStore.h"
 #include "Process.h"
+#include "RequestMetrics.h"
+#include "RequestTracing.h"
+#include "ResponseCompression.h"
 #include "ServerUtilities.h"
 
 #include "ApplicationCommands.h"
@@ -19,6 +29,7 @@
 #include "SecretCommands.h"
 #include "UserCommands.h"
 #include "GroupCommands.h"
+#include "JobCommands.h"
 #include "VersionCommands.h"
 #include "KubeInterface.h"
 
@@ -101,13 +112,97 @@ void initializeHelm(){
 				log_fatal("Unable to install slate development repository");
 		}
 	}
-	{ //Ensure that repositories are up-to-date
-		int err=runCommand("helm",{"repo","update"}).status;
-		if(err)
-			log_fatal("helm repo update failed");
+}
+
+///Refresh helm's copies of the application catalog, and then the store's 
+///cached listings of the applications it contains. This involves fetching 
+///each repository's index over the network, and is not needed for the service
+///to start, since adding a repository also fetches its index and a previously 
+///fetched catalog remains usable, so it is done in the background. 
+///\param store the store whose cached application listings should be replaced
+void updateHelmRepositories(PersistentStore& store){
+	auto start=std::chrono::steady_clock::now();
+	try{
+		auto helmResult=runCommand("helm",{"repo","update"});
+		if(helmResult.status){
+			log_error("helm repo update failed; the application catalog may be out of date: " 
+			          << helmResult.error);
+			return;
+		}
+		//listings cached before the update, possibly by a previous server 
+		//instance, would otherwise be served until they expire
+		store.fetchApplications("slate");
+		store.fetchApplications("slate-dev");
+	}catch(std::runtime_error& err){
+		log_error("Updating the application catalog failed; it may be out of date: " 
+		          << err.what());
+		return;
 	}
+	log_info("Application catalog updated after " 
+	         << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start).count() 
+	         << " ms");
 }
 
+///Records how long each phase of starting the service takes, so that slow 
+///starts can be diagnosed
+class StartupTimer{
+public:
+	using clock=std::chrono::steady_clock;
+	
+	StartupTimer():start(clock::now()){}
+	
+	///Record the duration of a completed phase. This may be called from any 
+	///thread.
+	///\param phase the name of the phase
+	///\param duration how long the phase took
+	void record(const std::string& phase, clock::duration duration){
+		std::lock_guard<std::mutex> lock(mutex);
+		phases.emplace_back(phase,duration);
+	}
+	
+	///Record the time since startup began as the time taken to become ready, 
+	///and log the duration of each phase
+	void finish(){
+		std::lock_guard<std::mutex> lock(mutex);
+		ready=clock::now()-start;
+		std::ostringstream os;
+		os << "Ready to serve after " << milliseconds(ready) << " ms";
+		bool first=true;
+		for(const auto& phase : phases){
+			os << (first ? "; " : ", ") << phase.first << ' ' 
+			   << milliseconds(phase.second) << " ms";
+			first=false;
+		}
+		log_info(os.str());
+	}
+	
+	void writeMetrics(std::ostream& os) const{
+		std::lock_guard<std::mutex> lock(mutex);
+		metrics::writeHeader(os,"slate_startup_phase_seconds","gauge",
+		                     "Time taken by each phase of starting the service");
+		for(const auto& phase : phases)
+			metrics::writeSample(os,"slate_startup_phase_seconds",{{"phase",phase.first}},
+			                     std::chrono::duration<double>(phase.second).count());
+		metrics::writeHeader(os,"slate_startup_seconds","gauge",
+		                     "Time taken for the service to become ready to serve requests");
+		metrics::writeSample(os,"slate_startup_seconds",{},std::chrono::duration<double>(ready).count());
+	}
+	
+private:
+	static long long milliseconds(clock::duration d){
+		return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+	}
+	
+	const clock::time_point start;
+	mutable std::mutex mutex;
+	std::vector<std::pair<std::string,clock::duration>> phases;
+	clock::duration ready=clock::duration::zero();
+};
+
+//request timing and tracing come first so that they include the time spent on 
+//compression
+using SlateServer=crow::App<RequestMetrics,RequestTracer,ResponseCompressor>;
+
 struct Configuration{
 	struct ParamRef{
 		enum Type{String,Bool} type;
@@ -147,6 +242,16 @@ struct Configuration{
 	std::string awsRegion;
 	std::string awsURLScheme;
 	std::string awsEndpoint;
+	std::string awsMaxConnectionsString;
+	std::string awsAsyncThreadsString;
+	std::string awsConnectTimeoutString;
+	std::string awsRequestTimeoutString;
+	std::string awsMaxRetriesString;
+	std::string awsRetryBaseDelayString;
+	std::string awsRetryMaxDelayString;
+	bool awsTCPKeepAlive;
+	bool dbChangeFeed;
+	std::string awsStreamsEndpoint;
 	std::string geocodeEndpoint;
 	std::string geocodeToken;
 	std::string portString;
@@ -156,6 +261,17 @@ struct Configuration{
 	std::string encryptionKeyFile;
 	std::string appLoggingServerName;
 	std::string appLoggingServerPortString;
+	std::string cacheBudgets;
+	std::string cacheSnapshot;
+	std::string cacheSnapshotIntervalString;
+	std::string clusterProbeIntervalString;
+	std::string clusterProbeConcurrencyString;
+	std::string jobConcurrencyString;
+	std::string jobClusterConcurrencyString;
+	std::string jobQueueLimitString;
+	std::string logLevel;
+	std::string traceDirectory;
+	std::string traceFileLimitString;
 	bool allowAdHocApps;
 	
 	std::map<std::string,ParamRef> options;
@@ -166,11 +282,28 @@ struct Configuration{
 	awsRegion("us-east-1"),
 	awsURLScheme("http"),
 	awsEndpoint("localhost:8000"),
+	awsMaxConnectionsString("64"),
+	awsAsyncThreadsString("16"),
+	awsConnectTimeoutString("1000"),
+	awsRequestTimeoutString("3000"),
+	awsMaxRetriesString("10"),
+	awsRetryBaseDelayString("25"),
+	awsRetryMaxDelayString("2000"),
+	awsTCPKeepAlive(true),
+	dbChangeFeed(false),
 	geocodeEndpoint("https://geocode.xyz"),
 	portString("18080"),
 	bootstrapUserFile("slate_portal_user"),
 	encryptionKeyFile("encryptionKey"),
 	appLoggingServerPortString("9200"),
+	cacheSnapshotIntervalString("600"),
+	clusterProbeIntervalString("60"),
+	clusterProbeConcurrencyString("8"),
+	jobConcurrencyString("16"),
+	jobClusterConcurrencyString("4"),
+	jobQueueLimitString("256"),
+	logLevel("info"),
+	traceFileLimitString("100"),
 	allowAdHocApps(false),
 	options{
 		{"awsAccessKey",awsAccessKey},
@@ -178,6 +311,16 @@ struct Configuration{
 		{"awsRegion",awsRegion},
 		{"awsURLScheme",awsURLScheme},
 		{"awsEndpoint",awsEndpoint},
+		{"awsMaxConnections",awsMaxConnectionsString},
+		{"awsAsyncThreads",awsAsyncThreadsString},
+		{"awsConnectTimeout",awsConnectTimeoutString},
+		{"awsRequestTimeout",awsRequestTimeoutString},
+		{"awsMaxRetries",awsMaxRetriesString},
+		{"awsRetryBaseDelay",awsRetryBaseDelayString},
+		{"awsRetryMaxDelay",awsRetryMaxDelayString},
+		{"awsTCPKeepAlive",awsTCPKeepAlive},
+		{"dbChangeFeed",dbChangeFeed},
+		{"awsStreamsEndpoint",awsStreamsEndpoint},
 		{"geocodeEndpoint",geocodeEndpoint},
 		{"geocodeToken",geocodeToken},
 		{"port",portString},
@@ -188,6 +331,17 @@ struct Configuration{
 		{"appLoggingServerName",appLoggingServerName},
 		{"appLoggingServerPort",appLoggingServerPortString},
 		{"allowAdHocApps",allowAdHocApps},
+		{"cacheBudgets",cacheBudgets},
+		{"cacheSnapshot",cacheSnapshot},
+		{"cacheSnapshotInterval",cacheSnapshotIntervalString},
+		{"clusterProbeInterval",clusterProbeIntervalString},
+		{"clusterProbeConcurrency",clusterProbeConcurrencyString},
+		{"jobConcurrency",jobConcurrencyString},
+		{"jobClusterConcurrency",jobClusterConcurrencyString},
+		{"jobQueueLimit",jobQueueLimitString},
+		{"logLevel",logLevel},
+		{"traceDirectory",traceDirectory},
+		{"traceFileLimit",traceFileLimitString},
 	}
 	{
 		//check for environment variables
@@ -271,7 +425,7 @@ struct Configuration{
 ///Accept a dictionary describing several individual requests, execute them all 
 ///concurrently, and return the results in another dictionary. Currently very
 ///simplistic; a new thread will be spawned for every individual request. 
-crow::response multiplex(crow::SimpleApp& server, PersistentStore& store, const crow::request& req){
+crow::response multiplex(SlateServer& server, PersistentStore& store, const crow::request& req){
 	using namespace std::chrono;
 	high_resolution_clock::time_point t1 = high_resolution_clock::now();
 	const User user=authenticateUser(store, req.url_params.get("token"));
@@ -369,6 +523,12 @@ crow::response multiplex(crow::SimpleApp& server, PersistentStore& store, const
 int main(int argc, char* argv[]){
 	Configuration config(argc, argv);
 	
+	try{
+		logging::setLevel(logging::parseLevel(config.logLevel));
+	}catch(std::runtime_error& err){
+		log_fatal(err.what());
+	}
+	
 	if(config.sslCertificate.empty()!=config.sslKey.empty()){
 		log_fatal("--sslCertificate ($SLATE_sslCertificate) and --sslKey ($SLATE_sslKey)"
 		          " must be specified together");
@@ -393,7 +553,20 @@ int main(int argc, char* argv[]){
 	}
 	
 	startReaper();
-	initializeHelm();
+	setCommandObserver([](const std::string& command, const std::vector<std::string>& args,
+	                      std::chrono::steady_clock::duration duration, int status){
+		metrics::recordCommand(command,args,duration,status);
+		if(tracing::current())
+			tracing::recordCompleted("command",command+" "+metrics::subcommand(args),duration);
+	});
+	//checking helm's setup involves several slow commands, but does not 
+	//depend on the database, so it is done while the tables are checked
+	StartupTimer startup;
+	auto helmSetup=std::async(std::launch::async,[&startup]{
+		auto start=StartupTimer::clock::now();
+		initializeHelm();
+		startup.record("helm setup",StartupTimer::clock::now()-start);
+	});
 	// DB client initialization
 	Aws::SDKOptions awsOptions;
 	Aws::InitAPI(awsOptions);
@@ -412,14 +585,129 @@ int main(int argc, char* argv[]){
 	else
 		log_fatal("Unrecognized URL scheme for AWS: '" << config.awsURLScheme << '\'');
 	clientConfig.endpointOverride=config.awsEndpoint;
+	//The SDK's defaults allow fewer connections than the server has threads, 
+	//and retry throttled requests in lockstep
+	auto parseCount=[](const std::string& option, const std::string& value)->long{
+		long result=-1;
+		std::istringstream is(value);
+		is >> result;
+		if(is.fail() || result<0)
+			log_fatal("Unable to parse \"" << value << "\" as a valid value for " << option);
+		return result;
+	};
+	clientConfig.maxConnections=parseCount("awsMaxConnections",config.awsMaxConnectionsString);
+	if(!clientConfig.maxConnections)
+		log_fatal("awsMaxConnections must be positive");
+	clientConfig.connectTimeoutMs=parseCount("awsConnectTimeout",config.awsConnectTimeoutString);
+	clientConfig.requestTimeoutMs=parseCount("awsRequestTimeout",config.awsRequestTimeoutString);
+	clientConfig.enableTcpKeepAlive=config.awsTCPKeepAlive;
+	//Without an executor the SDK starts a new thread for every asynchronous 
+	//request, which the concurrent lookups in request handlers make often
+	long asyncThreads=parseCount("awsAsyncThreads",config.awsAsyncThreadsString);
+	if(!asyncThreads)
+		log_fatal("awsAsyncThreads must be positive");
+	clientConfig.executor=Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(
+		"slate-service",asyncThreads);
+	clientConfig.retryStrategy=std::make_shared<JitteredRetryStrategy>(
+		parseCount("awsMaxRetries",config.awsMaxRetriesString),
+		parseCount("awsRetryBaseDelay",config.awsRetryBaseDelayString),
+		parseCount("awsRetryMaxDelay",config.awsRetryMaxDelayString));
+	log_info("Database client allows " << clientConfig.maxConnections << " connections, " 
+	         << config.awsMaxRetriesString << " retries");
+	//DynamoDB Local serves streams from the same endpoint as tables, but AWS 
+	//uses a separate one
+	std::string changeFeedEndpoint;
+	if(config.dbChangeFeed)
+		changeFeedEndpoint=config.awsStreamsEndpoint.empty() ? config.awsEndpoint : config.awsStreamsEndpoint;
+	auto storeStart=StartupTimer::clock::now();
 	PersistentStore store(credentials,clientConfig,
 	                      config.bootstrapUserFile,config.encryptionKeyFile,
-	                      config.appLoggingServerName,appLoggingServerPort);
+	                      config.appLoggingServerName,appLoggingServerPort,
+	                      changeFeedEndpoint);
+	startup.record("database",StartupTimer::clock::now()-storeStart);
+	helmSetup.get();
 	if(!config.geocodeEndpoint.empty() && !config.geocodeToken.empty())
 		store.setGeocoder(Geocoder(config.geocodeEndpoint,config.geocodeToken));
+	//apply any adjustments to cache sizes, given as a comma separated list 
+	//of cacheName:maxEntries:maxBytes
+	for(const std::string& item : string_split_columns(config.cacheBudgets,',',false)){
+		auto parts=string_split_columns(item,':');
+		std::size_t maxEntries=0, maxBytes=0;
+		if(parts.size()!=3)
+			log_fatal("Unable to parse \"" << item << "\" as a cache budget; expected cacheName:maxEntries:maxBytes");
+		std::istringstream entriesStream(parts[1]), bytesStream(parts[2]);
+		entriesStream >> maxEntries;
+		bytesStream >> maxBytes;
+		if(entriesStream.fail() || bytesStream.fail())
+			log_fatal("Unable to parse \"" << item << "\" as a cache budget; expected cacheName:maxEntries:maxBytes");
+		if(!store.setCacheBudget(parts[0],maxEntries,maxBytes))
+			log_fatal("Unknown cache name in cache budget: " << parts[0]);
+	}
+	//begin with the records cached by the previous server instance, if any
+	if(!config.cacheSnapshot.empty()){
+		long snapshotInterval=parseCount("cacheSnapshotInterval",config.cacheSnapshotIntervalString);
+		if(!snapshotInterval)
+			log_fatal("cacheSnapshotInterval must be positive");
+		auto snapshotStart=StartupTimer::clock::now();
+		store.startCacheSnapshots(config.cacheSnapshot,std::chrono::seconds(snapshotInterval));
+		startup.record("cache snapshot",StartupTimer::clock::now()-snapshotStart);
+	}
+	//the refreshed catalog must replace any listings loaded from the snapshot,
+	//so this waits until they have been
+	auto catalogUpdate=std::async(std::launch::async,[&store]{ updateHelmRepositories(store); });
+	
+	//keep track of which clusters can be reached, so that requests need not 
+	//wait for unresponsive clusters to time out
+	std::unique_ptr<ClusterProber> prober;
+	if(long probeInterval=parseCount("clusterProbeInterval",config.clusterProbeIntervalString)){
+		ClusterProber::Schedule schedule;
+		schedule.interval=std::chrono::seconds(probeInterval);
+		//the store keeps cached reachability valid for at least twice this, 
+		//so that it is refreshed before it expires
+		schedule.maxBackoff=std::max(schedule.interval,std::chrono::seconds(std::chrono::minutes(15)));
+		schedule.afterChange=std::min(schedule.interval,std::chrono::seconds(5));
+		schedule.maxConcurrent=parseCount("clusterProbeConcurrency",config.clusterProbeConcurrencyString);
+		if(!schedule.maxConcurrent)
+			log_fatal("clusterProbeConcurrency must be positive");
+		prober.reset(new ClusterProber(store,[&store](const Cluster& cluster){
+			return internal::pingCluster(store,cluster);
+		},schedule));
+		store.setClusterProber(prober.get());
+		prober->start();
+		log_info("Probing clusters every " << probeInterval << " seconds");
+	}
+	
+	//run long operations in the background when clients ask for this
+	JobEngine::Limits jobLimits;
+	jobLimits.maxConcurrent=parseCount("jobConcurrency",config.jobConcurrencyString);
+	jobLimits.maxPerCluster=parseCount("jobClusterConcurrency",config.jobClusterConcurrencyString);
+	jobLimits.maxQueued=parseCount("jobQueueLimit",config.jobQueueLimitString);
+	if(!jobLimits.maxConcurrent || !jobLimits.maxPerCluster)
+		log_fatal("jobConcurrency and jobClusterConcurrency must be positive");
+	JobEngine jobs(store,jobLimits);
+	//the cluster on which an installation request acts, if it identifies one
+	auto installCluster=[&store](const crow::request& req)->std::string{
+		rapidjson::Document body;
+		try{
+			body.Parse(req.body.c_str());
+		}catch(std::runtime_error& err){
+			return "";
+		}
+		if(!body.IsObject() || !body.HasMember("cluster") || !body["cluster"].IsString())
+			return "";
+		return store.getCluster(body["cluster"].GetString()).id;
+	};
 	
 	// REST server initialization
-	crow::SimpleApp server;
+	SlateServer server;
+	auto& tracer=server.get_middleware<RequestTracer>();
+	//traces expose the service's internal operations, so only administrators 
+	//may request them
+	tracer.setAuthorizer([&store](const crow::request& req){
+		return authenticateUser(store,req.url_params.get("token")).admin;
+	});
+	tracer.setExportDirectory(config.traceDirectory,
+	                          parseCount("traceFileLimit",config.traceFileLimitString));
 	
 	CROW_ROUTE(server, "/v1alpha3/multiplex").methods("POST"_method)(
 	  [&](const crow::request& req){ return multiplex(server,store,req); });
@@ -445,6 +733,8 @@ int main(int argc, char* argv[]){
 	  [&](const crow::request& req, const std::string& uID){ return replaceUserToken(store,req,uID); });
 	CROW_ROUTE(server, "/v1alpha3/find_user").methods("GET"_method)(
 	  [&](const crow::request& req){ return findUser(store,req); });
+	CROW_ROUTE(server, "/v1alpha3/import_users").methods("POST"_method)(
+	  [&](const crow::request& req){ return importUsers(store,req); });
 	
 	// == Cluster commands ==
 	CROW_ROUTE(server, "/v1alpha3/clusters").methods("GET"_method)(
@@ -454,7 +744,9 @@ int main(int argc, char* argv[]){
 	CROW_ROUTE(server, "/v1alpha3/clusters/<string>").methods("GET"_method)(
 	  [&](const crow::request& req, const std::string& cID){ return getClusterInfo(store,req,cID); });
 	CROW_ROUTE(server, "/v1alpha3/clusters/<string>").methods("DELETE"_method)(
-	  [&](const crow::request& req, const std::string& cID){ return deleteCluster(store,req,cID); });
+	  [&](const crow::request& req, const std::string& cID){
+		  return runAsJob(store,jobs,req,"delete cluster",[&store,&cID]{ return store.getCluster(cID).id; },
+		                  [&store,cID](const crow::request& req){ return deleteCluster(store,req,cID); }); });
 	CROW_ROUTE(server, "/v1alpha3/clusters/<string>").methods("PUT"_method)(
 	  [&](const crow::request& req, const std::string& cID){ return updateCluster(store,req,cID); });
 	CROW_ROUTE(server, "/v1alpha3/clusters/<string>/ping").methods("GET"_method)(
@@ -492,7 +784,9 @@ int main(int argc, char* argv[]){
 	CROW_ROUTE(server, "/v1alpha3/groups/<string>").methods("PUT"_method)(
 	  [&](const crow::request& req, const std::string& groupID){ return updateGroup(store,req,groupID); });
 	CROW_ROUTE(server, "/v1alpha3/groups/<string>").methods("DELETE"_method)(
-	  [&](const crow::request& req, const std::string& groupID){ return deleteGroup(store,req,groupID); });
+	  [&](const crow::request& req, const std::string& groupID){
+		  return runAsJob(store,jobs,req,"delete group",[]{ return std::string(); },
+		                  [&store,groupID](const crow::request& req){ return deleteGroup(store,req,groupID); }); });
 	CROW_ROUTE(server, "/v1alpha3/groups/<string>/members").methods("GET"_method)(
 	  [&](const crow::request& req, const std::string& groupID){ return listGroupMembers(store,req,groupID); });
 	CROW_ROUTE(server, "/v1alpha3/groups/<string>/clusters").methods("GET"_method)(
@@ -507,14 +801,18 @@ int main(int argc, char* argv[]){
 	  [&](const crow::request& req, const std::string& aID){ return fetchApplicationDocumentation(store,req,aID); });
 	if(config.allowAdHocApps){
 		CROW_ROUTE(server, "/v1alpha3/apps/ad-hoc").methods("POST"_method)(
-		  [&](const crow::request& req){ return installAdHocApplication(store,req); });
+		  [&](const crow::request& req){
+			  return runAsJob(store,jobs,req,"install",[&]{ return installCluster(req); },
+			                  [&store](const crow::request& req){ return installAdHocApplication(store,req); }); });
 	}
 	else{
 		CROW_ROUTE(server, "/v1alpha3/apps/ad-hoc").methods("POST"_method)(
 		  [&](const crow::request& req){ return crow::response(400,generateError("Ad-hoc application installation is not permitted")); });
 	}
 	CROW_ROUTE(server, "/v1alpha3/apps/<string>").methods("POST"_method)(
-	  [&](const crow::request& req, const std::string& aID){ return installApplication(store,req,aID); });
+	  [&](const crow::request& req, const std::string& aID){
+		  return runAsJob(store,jobs,req,"install",[&]{ return installCluster(req); },
+		                  [&store,aID](const crow::request& req){ return installApplication(store,req,aID); }); });
 	CROW_ROUTE(server, "/v1alpha3/update_apps").methods("POST"_method)(
 	  [&](const crow::request& req){ return updateCatalog(store,req); });
 	
@@ -526,9 +824,13 @@ int main(int argc, char* argv[]){
 	CROW_ROUTE(server, "/v1alpha3/instances/<string>").methods("DELETE"_method)(
 	  [&](const crow::request& req, const std::string& iID){ return deleteApplicationInstance(store,req,iID); });
 	CROW_ROUTE(server, "/v1alpha3/instances/<string>/restart").methods("PUT"_method)(
-	  [&](const crow::request& req, const std::string& iID){ return restartApplicationInstance(store,req,iID); });
+	  [&](const crow::request& req, const std::string& iID){
+		  return runAsJob(store,jobs,req,"restart",[&store,&iID]{ return store.getApplicationInstance(iID).cluster; },
+		                  [&store,iID](const crow::request& req){ return restartApplicationInstance(store,req,iID); }); });
 	CROW_ROUTE(server, "/v1alpha3/instances/<string>/logs").methods("GET"_method)(
 	  [&](const crow::request& req, const std::string& iID){ return getApplicationInstanceLogs(store,req,iID); });
+	CROW_ROUTE(server, "/v1alpha3/instances/<string>/logs/stream").methods("GET"_method)(
+	  [&](const crow::request& req, const std::string& iID){ return streamApplicationInstanceLogs(store,req,iID); });
 	CROW_ROUTE(server, "/v1alpha3/instances/<string>/scale").methods("GET"_method)(
 	  [&](const crow::request& req, const std::string& iID){ return getApplicationInstanceScale(store,req,iID); });
 	CROW_ROUTE(server, "/v1alpha3/instances/<string>/scale").methods("PUT"_method)(
@@ -544,8 +846,25 @@ int main(int argc, char* argv[]){
 	CROW_ROUTE(server, "/v1alpha3/secrets/<string>").methods("DELETE"_method)(
 	  [&](const crow::request& req, const std::string& id){ return deleteSecret(store,req,id); });
 	
+	// == Job commands ==
+	CROW_ROUTE(server, "/v1alpha3/jobs/<string>").methods("GET"_method)(
+	  [&](const crow::request& req, const std::string& jobID){ return getJob(store,req,jobID); });
+	
 	CROW_ROUTE(server, "/v1alpha3/stats").methods("GET"_method)(
-	  [&](){ return(store.getStatistics()); });
+	  [&](){ return(store.getStatistics()+jobs.getStatistics()+logging::getStatistics()+server.get_middleware<ResponseCompressor>().getStatistics()); });
+	
+	CROW_ROUTE(server, "/v1alpha3/metrics").methods("GET"_method)(
+	  [&](){
+	  	std::ostringstream os;
+	  	server.get_middleware<RequestMetrics>().writeMetrics(os);
+	  	store.writeMetrics(os);
+	  	jobs.writeMetrics(os);
+	  	metrics::writeCommandMetrics(os);
+	  	startup.writeMetrics(os);
+	  	crow::response res(os.str());
+	  	res.set_header("Content-Type","text/plain; version=0.0.4");
+	  	return res;
+	  });
 	
 	CROW_ROUTE(server, "/version").methods("GET"_method)(&serverVersionInfo);
 	
@@ -555,6 +874,7 @@ int main(int argc, char* argv[]){
 	  	return crow::response(400,generateError("Unsupported API version")); });
 	
 	server.loglevel(crow::LogLevel::Warning);
+	startup.finish();
 	if(!config.sslCertificate.empty())
 		server.port(port).ssl_file(config.sslCertificate,config.sslKey).multithreaded().run();
 		//server.port(port).ssl_file(config.sslCertificate,config.sslKey).concurrency(128).run();
@@ -0,0 +1,159 @@
+//Measures the read capacity consumed by listing application instances when
+//instance configs are stored alongside the instance records (the layout used
+//before configs were moved to their own table) and when they are stored
+//separately.
+//
+//Usage: slate-instance-listing-benchmark [endpoint] [instances] [config size]
+//The endpoint should be a DynamoDB (or DynamoDB Local) instance which may be
+//freely written to, e.g. localhost:8000. Temporary tables are created and
+//deleted.
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <aws/core/Aws.h>
+#include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/dynamodb/DynamoDBClient.h>
+#include <aws/dynamodb/model/CreateTableRequest.h>
+#include <aws/dynamodb/model/DeleteTableRequest.h>
+#include <aws/dynamodb/model/DescribeTableRequest.h>
+#include <aws/dynamodb/model/PutItemRequest.h>
+#include <aws/dynamodb/model/ScanRequest.h>
+
+namespace{
+
+using namespace Aws::DynamoDB::Model;
+using AV=AttributeValue;
+
+void createTable(Aws::DynamoDB::DynamoDBClient& client, const std::string& name, bool hasSortKey){
+	auto request=CreateTableRequest().WithTableName(name);
+	request.AddAttributeDefinitions(AttributeDefinition().WithAttributeName("ID").WithAttributeType(ScalarAttributeType::S));
+	request.AddKeySchema(KeySchemaElement().WithAttributeName("ID").WithKeyType(KeyType::HASH));
+	if(hasSortKey){
+		request.AddAttributeDefinitions(AttributeDefinition().WithAttributeName("sortKey").WithAttributeType(ScalarAttributeType::S));
+		request.AddKeySchema(KeySchemaElement().WithAttributeName("sortKey").WithKeyType(KeyType::RANGE));
+	}
+	request.SetProvisionedThroughput(ProvisionedThroughput().WithReadCapacityUnits(1).WithWriteCapacityUnits(1));
+	auto outcome=client.CreateTable(request);
+	if(!outcome.IsSuccess())
+		throw std::runtime_error("Failed to create table "+name+": "+outcome.GetError().GetMessage());
+	while(true){
+		auto desc=client.DescribeTable(DescribeTableRequest().WithTableName(name));
+		if(desc.IsSuccess() && desc.GetResult().GetTable().GetTableStatus()==TableStatus::ACTIVE)
+			break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+}
+
+void put(Aws::DynamoDB::DynamoDBClient& client, const std::string& table,
+         const Aws::Map<Aws::String,AttributeValue>& item){
+	auto outcome=client.PutItem(PutItemRequest().WithTableName(table).WithItem(item));
+	if(!outcome.IsSuccess())
+		throw std::runtime_error("Failed to write to "+table+": "+outcome.GetError().GetMessage());
+}
+
+Aws::Map<Aws::String,AttributeValue> instanceItem(const std::string& id){
+	return {{"ID",AV(id)},{"sortKey",AV(id)},{"name",AV("benchmark-"+id)},
+	        {"application",AV("slate/osg-frontier-squid")},{"owningGroup",AV("Group_benchmark")},
+	        {"cluster",AV("Cluster_benchmark")},{"ctime",AV("2019-Jan-01 00:00:00 UTC")}};
+}
+
+///Scan a table to completion, as listApplicationInstances does
+///\return the total read capacity consumed
+double scan(Aws::DynamoDB::DynamoDBClient& client, ScanRequest request, std::size_t& count){
+	request.SetReturnConsumedCapacity(ReturnConsumedCapacity::TOTAL);
+	double consumed=0;
+	count=0;
+	bool keepGoing=false;
+	do{
+		auto outcome=client.Scan(request);
+		if(!outcome.IsSuccess())
+			throw std::runtime_error("Scan failed: "+outcome.GetError().GetMessage());
+		const auto& result=outcome.GetResult();
+		consumed+=result.GetConsumedCapacity().GetCapacityUnits();
+		count+=result.GetItems().size();
+		keepGoing=!result.GetLastEvaluatedKey().empty();
+		if(keepGoing)
+			request.SetExclusiveStartKey(result.GetLastEvaluatedKey());
+	}while(keepGoing);
+	return consumed;
+}
+
+void report(const std::string& label, Aws::DynamoDB::DynamoDBClient& client, const ScanRequest& request){
+	using namespace std::chrono;
+	std::size_t count;
+	high_resolution_clock::time_point t1 = high_resolution_clock::now();
+	double consumed=scan(client,request,count);
+	high_resolution_clock::time_point t2 = high_resolution_clock::now();
+	std::cout << label << ": " << count << " instances, " << consumed
+	          << " read capacity units, "
+	          << 1000*duration_cast<duration<double>>(t2-t1).count() << " ms" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]){
+	std::string endpoint="localhost:8000";
+	std::size_t instanceCount=200, configSize=16*1024;
+	if(argc>1)
+		endpoint=argv[1];
+	if(argc>2)
+		instanceCount=std::stoul(argv[2]);
+	if(argc>3)
+		configSize=std::stoul(argv[3]);
+
+	Aws::SDKOptions awsOptions;
+	Aws::InitAPI(awsOptions);
+	int result=0;
+	{
+		Aws::Client::ClientConfiguration clientConfig;
+		clientConfig.scheme=Aws::Http::Scheme::HTTP;
+		clientConfig.endpointOverride=endpoint;
+		Aws::DynamoDB::DynamoDBClient client(Aws::Auth::AWSCredentials("foo","bar"),clientConfig);
+
+		const std::string suffix=std::to_string(getpid());
+		const std::string legacyTable="benchmark_instances_legacy_"+suffix;
+		const std::string instanceTable="benchmark_instances_"+suffix;
+		const std::string configTable="benchmark_instance_configs_"+suffix;
+		try{
+			createTable(client,legacyTable,true);
+			createTable(client,instanceTable,true);
+			createTable(client,configTable,false);
+
+			const std::string config(configSize,'x');
+			for(std::size_t i=0; i<instanceCount; i++){
+				std::string id="Instance_"+std::to_string(i);
+				put(client,legacyTable,instanceItem(id));
+				put(client,legacyTable,{{"ID",AV(id)},{"sortKey",AV(id+":config")},{"config",AV(config)}});
+				put(client,instanceTable,instanceItem(id));
+				put(client,configTable,{{"ID",AV(id)},{"config",AV(config)}});
+			}
+			std::cout << "Listing " << instanceCount << " instances with "
+			          << configSize << " byte configs" << std::endl;
+
+			report("Configs in instance table",client,ScanRequest()
+			       .WithTableName(legacyTable)
+			       .WithFilterExpression("attribute_exists(ctime)"));
+			report("Configs in separate table",client,ScanRequest()
+			       .WithTableName(instanceTable)
+			       .WithFilterExpression("attribute_exists(#ctime)")
+			       .WithProjectionExpression("#id, #name, #application, #owningGroup, #cluster, #ctime")
+			       .WithExpressionAttributeNames({{"#id","ID"},{"#name","name"},
+			                                      {"#application","application"},
+			                                      {"#owningGroup","owningGroup"},
+			                                      {"#cluster","cluster"},{"#ctime","ctime"}}));
+		}catch(std::exception& ex){
+			std::cerr << ex.what() << std::endl;
+			result=1;
+		}
+		for(const auto& table : {legacyTable,instanceTable,configTable})
+			client.DeleteTable(DeleteTableRequest().WithTableName(table));
+	}
+	Aws::ShutdownAPI(awsOptions);
+	return result;
+}
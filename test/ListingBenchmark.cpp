@@ -0,0 +1,163 @@
+//Compares the cost of rendering a large listing response by building a
+//rapidjson::Document and serializing it with to_string() against writing the
+//JSON directly into the response body with JSONResponseWriter.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ServerUtilities.h"
+
+namespace{
+	std::atomic<std::size_t> allocationCount(0);
+	std::atomic<std::size_t> allocatedBytes(0);
+}
+
+void* operator new(std::size_t size){
+	allocationCount++;
+	allocatedBytes+=size;
+	if(void* ptr=std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept{
+	std::free(ptr);
+}
+
+namespace{
+
+///Stand-in for a listed entity, with fields similar in size to an instance
+struct Item{
+	std::string id;
+	std::string name;
+	std::string application;
+	std::string group;
+	std::string cluster;
+	std::string created;
+};
+
+std::vector<Item> makeItems(std::size_t count){
+	std::vector<Item> items;
+	items.reserve(count);
+	for(std::size_t i=0; i<count; i++){
+		std::string n=std::to_string(i);
+		items.push_back(Item{"instance_"+std::string(11-n.size(),'0')+n,
+		                     "osg-frontier-squid-"+n,"osg-frontier-squid",
+		                     "some-group","some-cluster","2019-Jan-01 00:00:00 UTC"});
+	}
+	return items;
+}
+
+crow::response renderDocument(const std::vector<Item>& items){
+	rapidjson::Document result(rapidjson::kObjectType);
+	rapidjson::Document::AllocatorType& alloc = result.GetAllocator();
+
+	result.AddMember("apiVersion", "v1alpha3", alloc);
+	rapidjson::Value resultItems(rapidjson::kArrayType);
+	resultItems.Reserve(items.size(), alloc);
+	for(const Item& item : items){
+		rapidjson::Value itemResult(rapidjson::kObjectType);
+		itemResult.AddMember("apiVersion", "v1alpha3", alloc);
+		itemResult.AddMember("kind", "ApplicationInstance", alloc);
+		rapidjson::Value itemData(rapidjson::kObjectType);
+		itemData.AddMember("id", item.id, alloc);
+		itemData.AddMember("name", item.name, alloc);
+		itemData.AddMember("application", item.application, alloc);
+		itemData.AddMember("group", item.group, alloc);
+		itemData.AddMember("cluster", item.cluster, alloc);
+		itemData.AddMember("created", item.created, alloc);
+		itemResult.AddMember("metadata", itemData, alloc);
+		resultItems.PushBack(itemResult, alloc);
+	}
+	result.AddMember("items", resultItems, alloc);
+	return crow::response(to_string(result));
+}
+
+crow::response renderStreaming(const std::vector<Item>& items){
+	JSONResponseWriter out(64+320*items.size());
+	auto& json=out.json();
+	json.StartObject();
+	json.Key("apiVersion");
+	json.String("v1alpha3");
+	json.Key("items");
+	json.StartArray();
+	for(const Item& item : items){
+		json.StartObject();
+		json.Key("apiVersion");
+		json.String("v1alpha3");
+		json.Key("kind");
+		json.String("ApplicationInstance");
+		json.Key("metadata");
+		json.StartObject();
+		json.Key("id");
+		json.String(item.id);
+		json.Key("name");
+		json.String(item.name);
+		json.Key("application");
+		json.String(item.application);
+		json.Key("group");
+		json.String(item.group);
+		json.Key("cluster");
+		json.String(item.cluster);
+		json.Key("created");
+		json.String(item.created);
+		json.EndObject();
+		json.EndObject();
+	}
+	json.EndArray();
+	json.EndObject();
+	return out.response();
+}
+
+template<typename Renderer>
+void measure(const std::string& label, const std::vector<Item>& items,
+             unsigned int iterations, Renderer render){
+	using namespace std::chrono;
+	std::size_t bodySize=0;
+	std::size_t startCount=allocationCount, startBytes=allocatedBytes;
+	high_resolution_clock::time_point t1 = high_resolution_clock::now();
+	for(unsigned int i=0; i<iterations; i++){
+		crow::response res=render(items);
+		bodySize=res.body.size();
+	}
+	high_resolution_clock::time_point t2 = high_resolution_clock::now();
+	double elapsed=duration_cast<duration<double>>(t2-t1).count();
+	std::cout << label << ": " << bodySize << " byte body, "
+	          << (allocationCount-startCount)/iterations << " allocations ("
+	          << (allocatedBytes-startBytes)/iterations << " bytes), "
+	          << 1000*elapsed/iterations << " ms per listing" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]){
+	std::size_t itemCount=10000;
+	unsigned int iterations=20;
+	if(argc>1)
+		itemCount=std::stoul(argv[1]);
+	if(argc>2)
+		iterations=std::stoul(argv[2]);
+	if(!iterations)
+		iterations=1;
+
+	const std::vector<Item> items=makeItems(itemCount);
+	std::cout << "Rendering " << itemCount << " items, " << iterations
+	          << " iterations" << std::endl;
+	//make sure both produce identical output before timing them
+	if(renderDocument(items).body!=renderStreaming(items).body){
+		std::cerr << "Rendered listings differ" << std::endl;
+		return 1;
+	}
+	measure("Document + to_string",items,iterations,renderDocument);
+	measure("JSONResponseWriter  ",items,iterations,renderStreaming);
+	return 0;
+}
@@ -0,0 +1,132 @@
+//Compares the cost of looking up a large category in a concurrent_multimap,
+//which now shares the category's set with the caller, against copying the
+//whole set, as every lookup previously did. Lookups are also timed while
+//other threads are reading and inserting into the same category.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PersistentStore.h"
+
+namespace{
+	std::atomic<std::size_t> allocationCount(0);
+	std::atomic<std::size_t> allocatedBytes(0);
+}
+
+void* operator new(std::size_t size){
+	allocationCount++;
+	allocatedBytes+=size;
+	if(void* ptr=std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept{
+	std::free(ptr);
+}
+
+namespace{
+
+using Multimap=concurrent_multimap<std::string,CacheRecord<ApplicationInstance>>;
+
+ApplicationInstance makeInstance(std::size_t i){
+	std::string n=std::to_string(i);
+	ApplicationInstance instance;
+	instance.valid=true;
+	instance.id="instance_"+std::string(11-std::min<std::size_t>(n.size(),11),'0')+n;
+	instance.name="osg-frontier-squid-"+n;
+	instance.application="osg-frontier-squid";
+	instance.owningGroup="some-group";
+	instance.cluster="some-cluster";
+	instance.ctime="2019-Jan-01 00:00:00 UTC";
+	return instance;
+}
+
+template<typename Lookup>
+void measure(const std::string& label, const Multimap& cache,
+             unsigned int iterations, Lookup lookup){
+	using namespace std::chrono;
+	std::size_t found=0;
+	std::size_t startCount=allocationCount, startBytes=allocatedBytes;
+	high_resolution_clock::time_point t1 = high_resolution_clock::now();
+	for(unsigned int i=0; i<iterations; i++)
+		found=lookup(cache);
+	high_resolution_clock::time_point t2 = high_resolution_clock::now();
+	double elapsed=duration_cast<duration<double>>(t2-t1).count();
+	std::cout << label << ": " << found << " records, "
+	          << (allocationCount-startCount)/iterations << " allocations ("
+	          << (allocatedBytes-startBytes)/iterations << " bytes), "
+	          << 1e6*elapsed/iterations << " us per lookup" << std::endl;
+}
+
+std::size_t sharedLookup(const Multimap& cache){
+	auto category=cache.find(std::string("some-group"));
+	return category.items().size();
+}
+
+std::size_t copyingLookup(const Multimap& cache){
+	auto category=cache.find(std::string("some-group"));
+	Multimap::set_type records=category.items();
+	return records.size();
+}
+
+}
+
+int main(int argc, char* argv[]){
+	std::size_t recordCount=10000;
+	unsigned int iterations=1000;
+	if(argc>1)
+		recordCount=std::stoul(argv[1]);
+	if(argc>2)
+		iterations=std::stoul(argv[2]);
+	if(!iterations)
+		iterations=1;
+
+	Multimap cache;
+	const auto expiration=std::chrono::steady_clock::now()+std::chrono::hours(1);
+	for(std::size_t i=0; i<recordCount; i++)
+		cache.insert(std::string("some-group"),CacheRecord<ApplicationInstance>(makeInstance(i),expiration));
+	cache.update_expiration(std::string("some-group"),expiration);
+	std::cout << "Looking up a category of " << recordCount << " records, "
+	          << iterations << " iterations" << std::endl;
+
+	measure("Shared set ",cache,iterations,sharedLookup);
+	measure("Copied set ",cache,iterations,copyingLookup);
+
+	//repeat with background readers and a writer contending for the category;
+	//each write while readers hold the set forces one copy of it
+	std::atomic<bool> stop(false);
+	std::atomic<std::size_t> writes(0);
+	std::vector<std::thread> background;
+	for(unsigned int i=0; i<3; i++){
+		background.emplace_back([&]{
+			while(!stop)
+				sharedLookup(cache);
+		});
+	}
+	background.emplace_back([&]{
+		std::size_t i=recordCount;
+		while(!stop){
+			cache.insert(std::string("some-group"),CacheRecord<ApplicationInstance>(makeInstance(i++),expiration));
+			writes++;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+	measure("Shared set, contended ",cache,iterations,sharedLookup);
+	measure("Copied set, contended ",cache,iterations,copyingLookup);
+	stop=true;
+	for(auto& thread : background)
+		thread.join();
+	std::cout << writes << " concurrent insertions" << std::endl;
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include "test.h"
+
+#include <sstream>
+
+#include <CacheManager.h>
+#include <PersistentStore.h>
+
+namespace{
+	using steady_clock=std::chrono::steady_clock;
+
+	User makeUser(const std::string& id){
+		User user;
+		user.valid=true;
+		user.id=id;
+		user.name="Name of "+id;
+		return user;
+	}
+}
+
+TEST(SweepExpiredRecords){
+	cache_map<std::string,CacheRecord<User>> cache;
+	cache.insert("a",CacheRecord<User>(makeUser("a"),std::chrono::minutes(5)));
+	cache.insert("b",CacheRecord<User>(makeUser("b"),steady_clock::now()-std::chrono::seconds(1)));
+	cache.insert("c",CacheRecord<User>(makeUser("c"),std::chrono::minutes(5)));
+
+	unsigned int removals=0;
+	CacheManager manager;
+	manager.manage("users",cache,CacheManager::Budget{0,0},[&removals]{ removals++; });
+	manager.sweep();
+
+	ENSURE_EQUAL(cache.size(),2,"Only the expired record should be removed");
+	ENSURE(!cache.contains("b"),"The expired record should be removed");
+	ENSURE_EQUAL(removals,1,"The removal callback should be called once per sweep which removes records");
+
+	manager.sweep();
+	ENSURE_EQUAL(cache.size(),2,"Unexpired records should not be removed");
+	ENSURE_EQUAL(removals,1,"The removal callback should not be called when nothing is removed");
+}
+
+TEST(EvictToEntryBudget){
+	cache_map<std::string,CacheRecord<User>> cache;
+	for(unsigned int i=0; i<10; i++){
+		std::string id="user"+std::to_string(i);
+		cache.insert(id,CacheRecord<User>(makeUser(id),std::chrono::minutes(5)));
+	}
+
+	CacheManager manager;
+	manager.manage("users",cache,CacheManager::Budget{0,0});
+	//with no budget nothing should be evicted, but all reference marks from
+	//insertion are still set
+	manager.sweep();
+	ENSURE_EQUAL(cache.size(),10,"Nothing should be evicted without a budget");
+
+	ENSURE(manager.setBudget("users",CacheManager::Budget{5,0}),"Budget should be changed");
+	ENSURE(!manager.setBudget("nonexistent",CacheManager::Budget{5,0}),"Unknown caches should be reported");
+	//the first eviction pass clears the marks set at insertion; then read some
+	//records so that they are marked again
+	manager.sweep();
+	ENSURE_EQUAL(cache.size(),5,"Cache should be reduced to its budget");
+	std::vector<std::string> remaining;
+	{
+		auto table=cache.lock_table();
+		for(const auto& entry : table)
+			remaining.push_back(entry.first);
+	}
+	CacheRecord<User> record;
+	ENSURE(cache.find(remaining[0],record),"Remaining record should be found");
+	ENSURE(cache.find(remaining[1],record),"Remaining record should be found");
+
+	ENSURE(manager.setBudget("users",CacheManager::Budget{2,0}),"Budget should be changed");
+	manager.sweep();
+	ENSURE_EQUAL(cache.size(),2,"Cache should be reduced to its budget");
+	ENSURE(cache.contains(remaining[0]),"Recently read records should be retained");
+	ENSURE(cache.contains(remaining[1]),"Recently read records should be retained");
+
+	std::string stats=manager.getStatistics();
+	ENSURE(stats.find("users: 2 entries")!=std::string::npos,"Statistics should report cache size");
+	ENSURE(stats.find("8 evicted")!=std::string::npos,"Statistics should report evictions");
+}
+
+TEST(EvictToMemoryBudget){
+	cache_map<std::string,CacheRecord<std::string>> cache;
+	for(unsigned int i=0; i<10; i++)
+		cache.insert(std::to_string(i),CacheRecord<std::string>(std::string(1000,'x'),std::chrono::minutes(5)));
+
+	CacheManager manager;
+	manager.manage("strings",cache,CacheManager::Budget{0,4000});
+	manager.sweep();
+	ENSURE(cache.size()>0 && cache.size()<4,"Cache should be reduced to fit its memory budget");
+}
+
+TEST(CheckListingFitsBudget){
+	cache_map<std::string,CacheRecord<std::string>> cache;
+	for(unsigned int i=0; i<10; i++)
+		cache.insert(std::to_string(i),CacheRecord<std::string>(std::string(1000,'x'),std::chrono::minutes(5)));
+
+	CacheManager manager;
+	manager.manage("strings",cache,CacheManager::Budget{20,8000});
+	manager.sweep();
+	ENSURE(manager.canHold("strings",5),"A small listing should fit");
+	ENSURE(!manager.canHold("strings",10),"A listing exceeding the memory budget should not fit");
+	ENSURE(!manager.canHold("strings",30),"A listing exceeding the entry budget should not fit");
+	ENSURE(!manager.canHold("nonexistent",1),"Unknown caches should hold nothing");
+}
+
+TEST(SweepCategoryCache){
+	concurrent_multimap<std::string,CacheRecord<std::string>> cache;
+	const auto past=steady_clock::now()-std::chrono::seconds(1);
+	const auto future=steady_clock::now()+std::chrono::minutes(5);
+
+	//a complete category must be left intact, even if some records are stale
+	cache.insert("complete",CacheRecord<std::string>("stale",past));
+	cache.insert("complete",CacheRecord<std::string>("fresh",future));
+	cache.update_expiration("complete",future);
+	//an incomplete category should lose its stale records
+	cache.insert("partial",CacheRecord<std::string>("stale",past));
+	cache.insert("partial",CacheRecord<std::string>("fresh",future));
+	//and should be removed entirely when none remain
+	cache.insert("empty",CacheRecord<std::string>("stale",past));
+
+	CacheManager manager;
+	manager.manage("categories",cache,CacheManager::Budget{0,0});
+	manager.sweep();
+
+	ENSURE_EQUAL(cache.count("complete"),2,"Complete categories should not be altered");
+	ENSURE_EQUAL(cache.count("partial"),1,"Stale records should be removed from incomplete categories");
+	ENSURE(cache.contains("partial",CacheRecord<std::string>("fresh")),"Fresh records should be retained");
+	ENSURE(!cache.contains("empty"),"Categories with no remaining records should be removed");
+}
+
+TEST(CountCacheHits){
+	cache_map<std::string,CacheRecord<User>> cache;
+	cache.insert("fresh",CacheRecord<User>(makeUser("fresh"),std::chrono::minutes(5)));
+	cache.insert("stale",CacheRecord<User>(makeUser("stale"),steady_clock::now()-std::chrono::seconds(1)));
+
+	CacheRecord<User> record;
+	cache.find("fresh",record);
+	cache.find("stale",record);
+	cache.find("missing",record);
+	ENSURE_EQUAL(cache.lookups(),3,"Every search should be counted");
+	ENSURE_EQUAL(cache.hits(),1,"Only searches which find unexpired records should be counted as hits");
+
+	concurrent_multimap<std::string,CacheRecord<std::string>> categories;
+	categories.insert("complete",CacheRecord<std::string>("a",std::chrono::minutes(5)));
+	categories.update_expiration("complete",steady_clock::now()+std::chrono::minutes(5));
+	categories.insert("partial",CacheRecord<std::string>("b",std::chrono::minutes(5)));
+	categories.find("complete");
+	categories.find("partial");
+	categories.find("missing");
+	ENSURE_EQUAL(categories.lookups(),3,"Every category search should be counted");
+	ENSURE_EQUAL(categories.hits(),1,"Only searches which find complete categories should be counted as hits");
+
+	CacheManager manager;
+	manager.manage("users",cache,CacheManager::Budget{0,0});
+	std::ostringstream metrics;
+	manager.writeMetrics(metrics);
+	ENSURE(metrics.str().find("slate_cache_hits_total{cache=\"users\"} 1\n")!=std::string::npos,
+	       "Cache hits should be reported in metrics");
+}
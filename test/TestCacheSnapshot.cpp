@@ -0,0 +1,202 @@
+#include "test.h"
+
+#include <fstream>
+#include <iterator>
+
+#include <unistd.h>
+
+#include <CacheSnapshot.h>
+#include <PersistentStore.h>
+#include <ServerUtilities.h>
+
+TEST(SnapshotEncodingRoundTrip){
+	User user;
+	user.valid=true;
+	user.id="User_1234";
+	user.name="Some Person";
+	user.email="person@example.com";
+	user.phone="555-5555";
+	user.institution="Some University";
+	user.token="abcdefghijklmnop";
+	user.globusID="globus-1234";
+	user.admin=true;
+
+	Cluster cluster;
+	cluster.valid=true;
+	cluster.id="Cluster_1234";
+	cluster.name="cluster";
+	cluster.config=std::string(300,'x'); //long enough to need a multi-byte length
+	cluster.systemNamespace="slate-system";
+	cluster.owningGroup="Group_1234";
+	cluster.owningOrganization="Some University";
+
+	Application missing; //the catalog also records applications which do not exist
+
+	SnapshotWriter writer;
+	writer.writeInteger(0);
+	writer.writeInteger(1ULL<<40);
+	writer.beginSection(7);
+	writer.write(user);
+	writer.write(cluster);
+	writer.endSection();
+	writer.beginSection(8);
+	writer.write(missing);
+	writer.write(std::set<std::string>{"Group_1","Group_2"});
+	writer.endSection();
+
+	SnapshotReader reader(writer.data().data(),writer.data().size());
+	ENSURE_EQUAL(reader.readInteger(),0);
+	ENSURE_EQUAL(reader.readInteger(),1ULL<<40);
+	std::size_t length;
+	ENSURE_EQUAL(reader.readSectionHeader(length),7);
+	User readUser;
+	reader.read(readUser);
+	ENSURE(readUser.valid);
+	ENSURE_EQUAL(readUser.id,user.id);
+	ENSURE_EQUAL(readUser.institution,user.institution);
+	ENSURE_EQUAL(readUser.token,user.token);
+	ENSURE(readUser.admin);
+	Cluster readCluster;
+	reader.read(readCluster);
+	ENSURE_EQUAL(readCluster.config,cluster.config);
+	ENSURE_EQUAL(readCluster.owningOrganization,cluster.owningOrganization);
+	//sections which are not understood can be skipped
+	ENSURE_EQUAL(reader.readSectionHeader(length),8);
+	ENSURE(length>0);
+	reader.skip(length);
+	ENSURE(reader.atEnd());
+
+	//data which ends too soon is detected rather than being misread
+	SnapshotReader truncated(writer.data().data(),writer.data().size()-4);
+	truncated.readInteger();
+	truncated.readInteger();
+	truncated.readSectionHeader(length);
+	truncated.read(readUser);
+	truncated.read(readCluster);
+	bool threw=false;
+	try{
+		truncated.readSectionHeader(length);
+	}catch(std::runtime_error&){
+		threw=true;
+	}
+	ENSURE(threw,"Reading a truncated section should fail");
+}
+
+TEST(SnapshotRestoresCaches){
+	auto dbResp=httpRequests::httpGet("http://localhost:52000/dynamo/create");
+	ENSURE_EQUAL(dbResp.status,200);
+	std::string dbPort=dbResp.body;
+
+	const std::string awsAccessKey="foo";
+	const std::string awsSecretKey="bar";
+	Aws::SDKOptions options;
+	Aws::InitAPI(options);
+	using AWSOptionsHandle=std::unique_ptr<Aws::SDKOptions,void(*)(Aws::SDKOptions*)>;
+	AWSOptionsHandle opt_holder(&options,
+								[](Aws::SDKOptions* options){
+									Aws::ShutdownAPI(*options);
+								});
+	Aws::Auth::AWSCredentials credentials(awsAccessKey,awsSecretKey);
+	Aws::Client::ClientConfiguration clientConfig;
+	clientConfig.scheme=Aws::Http::Scheme::HTTP;
+	clientConfig.endpointOverride="localhost:"+dbPort;
+
+	const std::string snapshotPath="cache_snapshot_test";
+	unlink(snapshotPath.c_str());
+
+	User user;
+	user.id=idGenerator.generateUserID();
+	user.token=idGenerator.generateUserToken();
+	user.name="Bob";
+	user.email="bob@place.com";
+	user.phone="555-5555";
+	user.institution="Center of the Earth University";
+	user.globusID="Bob's Globus ID";
+	user.admin=false;
+	user.valid=true;
+
+	Group group;
+	group.id=idGenerator.generateGroupID();
+	group.name="snapshot-group";
+	group.email="abc@def";
+	group.phone="22";
+	group.scienceField="stuff";
+	group.description="original";
+	group.valid=true;
+
+	{
+		PersistentStore store(credentials,clientConfig,
+		                      "slate_portal_user","encryptionKey",
+		                      "",9200);
+		ENSURE(store.addUser(user),"User addition should succeed");
+		ENSURE(store.addGroup(group),"Group addition should succeed");
+		ENSURE(store.addUserToGroup(user.id,group.id),"Group membership addition should succeed");
+		//make sure everything is cached
+		ENSURE(store.findUserByToken(user.token));
+		ENSURE(store.findGroupByID(group.id));
+		ENSURE(store.userInGroup(user.id,group.id));
+		ENSURE(store.saveCacheSnapshot(snapshotPath),"Saving a snapshot should succeed");
+	}
+
+	{
+		std::ifstream file(snapshotPath,std::ios::binary);
+		ENSURE(file,"Snapshot file should exist");
+		std::string contents((std::istreambuf_iterator<char>(file)),std::istreambuf_iterator<char>());
+		ENSURE(contents.find(user.token)==std::string::npos,
+		       "Access tokens should not be stored in the clear");
+		ENSURE(contents.find(user.email)==std::string::npos,
+		       "Snapshot contents should be encrypted");
+	}
+
+	//change the records in the database behind the snapshot's back, so that 
+	//records served from the snapshot can be told apart from fresh ones
+	Group changedGroup=group;
+	changedGroup.description="changed";
+	User changedUser=user;
+	changedUser.institution="Somewhere Else";
+	{
+		PersistentStore store(credentials,clientConfig,
+		                      "slate_portal_user","encryptionKey",
+		                      "",9200);
+		ENSURE(store.updateGroup(changedGroup),"Group update should succeed");
+		ENSURE(store.updateUser(changedUser,user),"User update should succeed");
+	}
+	
+	{
+		PersistentStore store(credentials,clientConfig,
+		                      "slate_portal_user","encryptionKey",
+		                      "",9200);
+		ENSURE(store.loadCacheSnapshot(snapshotPath)>=3,"Records should be loaded from the snapshot");
+		//the loaded records are served without consulting the database
+		User found=store.findUserByToken(user.token);
+		ENSURE(found,"User should be found by token");
+		ENSURE_EQUAL(found.id,user.id);
+		ENSURE_EQUAL(found.institution,user.institution,
+		             "User should be served from the snapshot");
+		ENSURE_EQUAL(store.findGroupByName(group.name).description,"original",
+		             "Group should be served from the snapshot");
+		ENSURE(store.userInGroup(user.id,group.id));
+		
+		ENSURE_EQUAL(store.loadCacheSnapshot("nonexistent_snapshot"),0,
+		             "A missing snapshot should be ignored");
+	}
+	
+	{ //a snapshot written under a different encryption key must be ignored
+		const std::string otherKeyFile="cache_snapshot_test_key";
+		{
+			std::ofstream keyFile(otherKeyFile);
+			keyFile << "some-other-encryption-key";
+		}
+		PersistentStore store(credentials,clientConfig,
+		                      "slate_portal_user",otherKeyFile,
+		                      "",9200);
+		unlink(otherKeyFile.c_str());
+		ENSURE_EQUAL(store.loadCacheSnapshot(snapshotPath),0,
+		             "A snapshot encrypted with a different key should be ignored");
+		ENSURE_EQUAL(store.findUserByToken(user.token).institution,changedUser.institution,
+		             "Records should be read from the database when the snapshot is ignored");
+		ENSURE_EQUAL(store.findGroupByName(group.name).description,"changed",
+		             "Records should be read from the database when the snapshot is ignored");
+	}
+	unlink(snapshotPath.c_str());
+}
@@ -0,0 +1,103 @@
+#include "test.h"
+
+#include <thread>
+
+#include <ServerUtilities.h>
+#include <PersistentStore.h>
+
+namespace{
+	///Repeatedly evaluate a condition until it holds or a time limit passes
+	template<typename Condition>
+	bool eventually(Condition condition){
+		const auto deadline=std::chrono::steady_clock::now()+std::chrono::seconds(30);
+		while(!condition()){
+			if(std::chrono::steady_clock::now()>deadline)
+				return false;
+			std::this_thread::sleep_for(std::chrono::milliseconds(250));
+		}
+		return true;
+	}
+}
+
+TEST(ChangesPropagateBetweenStores){
+	//Two stores sharing a database stand in for two replicas of the service.
+	//Each has cached data which the other then changes.
+	auto dbResp=httpRequests::httpGet("http://localhost:52000/dynamo/create");
+	ENSURE_EQUAL(dbResp.status,200);
+	std::string dbPort=dbResp.body;
+
+	const std::string awsAccessKey="foo";
+	const std::string awsSecretKey="bar";
+	Aws::SDKOptions options;
+	Aws::InitAPI(options);
+	using AWSOptionsHandle=std::unique_ptr<Aws::SDKOptions,void(*)(Aws::SDKOptions*)>;
+	AWSOptionsHandle opt_holder(&options,
+								[](Aws::SDKOptions* options){
+									Aws::ShutdownAPI(*options);
+								});
+	Aws::Auth::AWSCredentials credentials(awsAccessKey,awsSecretKey);
+	Aws::Client::ClientConfiguration clientConfig;
+	clientConfig.scheme=Aws::Http::Scheme::HTTP;
+	clientConfig.endpointOverride="localhost:"+dbPort;
+
+	PersistentStore store1(credentials,clientConfig,
+	                       "slate_portal_user","encryptionKey",
+	                       "",9200,clientConfig.endpointOverride);
+	PersistentStore store2(credentials,clientConfig,
+	                       "slate_portal_user","encryptionKey",
+	                       "",9200,clientConfig.endpointOverride);
+
+	Group group;
+	group.id=idGenerator.generateGroupID();
+	group.name="group1";
+	group.email="abc@def";
+	group.phone="22";
+	group.scienceField="stuff";
+	group.description="original";
+	group.valid=true;
+	ENSURE(store1.addGroup(group),"Group addition should succeed");
+
+	Group guest=group;
+	guest.id=idGenerator.generateGroupID();
+	guest.name="group2";
+	ENSURE(store1.addGroup(guest),"Group addition should succeed");
+
+	Cluster cluster;
+	cluster.id=idGenerator.generateClusterID();
+	cluster.name="cluster";
+	cluster.config="-"; //Dynamo will get upset if this is empty, but it will not be used
+	cluster.systemNamespace="-"; //Dynamo will get upset if this is empty, but it will not be used
+	cluster.owningGroup=group.id;
+	cluster.owningOrganization="Something";
+	cluster.valid=true;
+	ENSURE(store1.addCluster(cluster),"Cluster creation should succeed");
+
+	//load everything into the second store's caches
+	ENSURE_EQUAL(store2.findGroupByID(group.id).description,"original");
+	ENSURE(!store2.groupAllowedOnCluster(guest.id,cluster.id),
+	       "Non-owning Group should not initially have access to cluster");
+
+	Group updated=group;
+	updated.description="modified";
+	ENSURE(store1.updateGroup(updated),"Group update should succeed");
+	ENSURE(eventually([&]{ return store2.findGroupByID(group.id).description=="modified"; }),
+	       "A group updated through one store should be seen updated by the other");
+	ENSURE_EQUAL(store2.findGroupByName(group.name).description,"modified",
+	             "All cached copies of the group should be updated");
+
+	ENSURE(store1.addGroupToCluster(guest.id,cluster.id),
+	       "Granting non-owning Group access to cluster should succeed");
+	ENSURE(eventually([&]{ return store2.groupAllowedOnCluster(guest.id,cluster.id); }),
+	       "Access granted through one store should be seen by the other");
+	ENSURE(store1.removeGroupFromCluster(guest.id,cluster.id),
+	       "Revoking non-owning Group access to cluster should succeed");
+	ENSURE(eventually([&]{ return !store2.groupAllowedOnCluster(guest.id,cluster.id); }),
+	       "Access revoked through one store should be seen by the other");
+
+	ENSURE(store1.removeGroup(group.id),"Group deletion should succeed");
+	ENSURE(eventually([&]{ return !store2.findGroupByID(group.id); }),
+	       "A group deleted through one store should be seen deleted by the other");
+
+	ENSURE(store2.getStatistics().find("Change feed:")!=std::string::npos,
+	       "Statistics should report on the change feed");
+}
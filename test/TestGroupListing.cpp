@@ -1,5 +1,7 @@
 #include "test.h"
 
+#include <algorithm>
+
 #include <ServerUtilities.h>
 
 TEST(UnauthenticatedListgroups){
@@ -194,3 +196,72 @@ TEST(ListgroupsForUser){
 	//should be no groups
 	ENSURE_EQUAL(data["items"].Size(),0,"No Group records should be returned for regular user");
 }
+
+TEST(PagedGroupListing){
+	using namespace httpRequests;
+	TestContext tc;
+
+	std::string adminKey=getPortalToken();
+	std::string groupURL=tc.getAPIServerURL()+"/"+currentAPIVersion+"/groups?token="+adminKey;
+	auto schema=loadSchema(getSchemaDir()+"/GroupListResultSchema.json");
+
+	//add several groups, deliberately not in name order
+	const std::vector<std::string> names={"group-d","group-b","group-e","group-a","group-c"};
+	for(const auto& name : names){
+		rapidjson::Document request(rapidjson::kObjectType);
+		auto& alloc = request.GetAllocator();
+		request.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value metadata(rapidjson::kObjectType);
+		metadata.AddMember("name", name, alloc);
+		metadata.AddMember("scienceField", "Logic", alloc);
+		request.AddMember("metadata", metadata, alloc);
+		auto createResp=httpPost(groupURL,to_string(request));
+		ENSURE_EQUAL(createResp.status,200,"Portal admin user should be able to create a Group");
+	}
+
+	//fetch the groups two at a time, in name order
+	std::vector<std::string> seen;
+	std::string continueToken;
+	unsigned int pages=0;
+	do{
+		std::string url=groupURL+"&limit=2&sort=name";
+		if(!continueToken.empty())
+			url+="&continue="+continueToken;
+		auto listResp=httpGet(url);
+		ENSURE_EQUAL(listResp.status,200,"Portal admin user should be able to list groups by page");
+		rapidjson::Document data;
+		data.Parse(listResp.body.c_str());
+		ENSURE_CONFORMS(data,schema);
+		ENSURE(data["items"].Size()<=2,"Pages should not exceed the requested size");
+		for(const auto& item : data["items"].GetArray())
+			seen.push_back(item["metadata"]["name"].GetString());
+		continueToken.clear();
+		if(data.HasMember("continue"))
+			continueToken=data["continue"].GetString();
+		pages++;
+	}while(!continueToken.empty() && pages<10);
+	ENSURE_EQUAL(pages,3,"Five groups should be returned in three pages of two");
+	std::vector<std::string> expected=names;
+	std::sort(expected.begin(),expected.end());
+	ENSURE_EQUAL(seen.size(),expected.size(),"Paged listing should return all groups");
+	for(std::size_t i=0; i<seen.size() && i<expected.size(); i++)
+		ENSURE_EQUAL(seen[i],expected[i],"Paged listing should return groups in name order");
+
+	//descending order should reverse the listing
+	auto listResp=httpGet(groupURL+"&sort=name&order=desc");
+	ENSURE_EQUAL(listResp.status,200,"Portal admin user should be able to list groups in descending order");
+	rapidjson::Document data;
+	data.Parse(listResp.body.c_str());
+	ENSURE_EQUAL(data["items"].Size(),names.size(),"All groups should be returned when no limit is set");
+	ENSURE(!data.HasMember("continue"),"No continuation token should be returned for a complete listing");
+	ENSURE_EQUAL(data["items"][0]["metadata"]["name"].GetString(),std::string("group-e"),
+	             "Descending listing should start with the last name");
+
+	//invalid paging requests should be rejected
+	listResp=httpGet(groupURL+"&limit=two");
+	ENSURE_EQUAL(listResp.status,400,"Requests with a non-numeric limit should be rejected");
+	listResp=httpGet(groupURL+"&sort=favoriteColor");
+	ENSURE_EQUAL(listResp.status,400,"Requests to sort by an unsupported field should be rejected");
+	listResp=httpGet(groupURL+"&sort=name&continue=not-a-token");
+	ENSURE_EQUAL(listResp.status,400,"Requests with a malformed continuation token should be rejected");
+}
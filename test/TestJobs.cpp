@@ -0,0 +1,156 @@
+#include "test.h"
+
+#include <thread>
+
+#include <JobEngine.h>
+#include <PersistentStore.h>
+#include <ServerUtilities.h>
+
+TEST(UnauthenticatedGetJob){
+	using namespace httpRequests;
+	TestContext tc;
+	
+	//try fetching a job with no authentication
+	auto getResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/jobs/job_1234567890");
+	ENSURE_EQUAL(getResp.status,403,
+				 "Requests to get jobs without authentication should be rejected");
+	
+	//try fetching a job with invalid authentication
+	getResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/jobs/job_1234567890?token=00112233-4455-6677-8899-aabbccddeeff");
+	ENSURE_EQUAL(getResp.status,403,
+				 "Requests to get jobs with invalid authentication should be rejected");
+}
+
+TEST(GetNonexistentJob){
+	using namespace httpRequests;
+	TestContext tc;
+	
+	std::string adminKey=getPortalToken();
+	auto getResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/jobs/job_1234567890?token="+adminKey);
+	ENSURE_EQUAL(getResp.status,404,
+				 "Requests to get a job which does not exist should be rejected");
+}
+
+TEST(AsynchronousGroupDeletion){
+	using namespace httpRequests;
+	TestContext tc;
+	
+	std::string adminKey=getPortalToken();
+	auto baseGroupUrl=tc.getAPIServerURL()+"/"+currentAPIVersion+"/groups";
+	auto token="?token="+adminKey;
+	
+	rapidjson::Document createGroup(rapidjson::kObjectType);
+	{
+		auto& alloc = createGroup.GetAllocator();
+		createGroup.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value metadata(rapidjson::kObjectType);
+		metadata.AddMember("name", "testgroup1", alloc);
+		metadata.AddMember("scienceField", "Logic", alloc);
+		createGroup.AddMember("metadata", metadata, alloc);
+	}
+	auto createResp=httpPost(baseGroupUrl+token,to_string(createGroup));
+	ENSURE_EQUAL(createResp.status,200,"Group creation request should succeed");
+	rapidjson::Document createData;
+	createData.Parse(createResp.body.c_str());
+	std::string groupID=createData["metadata"]["id"].GetString();
+	
+	auto deleteResp=httpDelete(baseGroupUrl+"/"+groupID+token+"&async");
+	ENSURE_EQUAL(deleteResp.status,202,"Asynchronous group deletion should be accepted");
+	rapidjson::Document jobData;
+	jobData.Parse(deleteResp.body.c_str());
+	auto schema=loadSchema(getSchemaDir()+"/JobResultSchema.json");
+	ENSURE_CONFORMS(jobData,schema);
+	std::string jobID=jobData["metadata"]["id"].GetString();
+	
+	//wait for the job to finish
+	auto jobUrl=tc.getAPIServerURL()+"/"+currentAPIVersion+"/jobs/"+jobID+token;
+	const auto deadline=std::chrono::steady_clock::now()+std::chrono::seconds(60);
+	bool finished=false;
+	while(!finished && std::chrono::steady_clock::now()<deadline){
+		auto jobResp=httpGet(jobUrl);
+		ENSURE_EQUAL(jobResp.status,200,"Job owner should be able to fetch the job's state");
+		jobData.Parse(jobResp.body.c_str());
+		ENSURE_CONFORMS(jobData,schema);
+		finished=jobData.HasMember("resultCode");
+		if(!finished)
+			std::this_thread::sleep_for(std::chrono::milliseconds(250));
+	}
+	ENSURE(finished,"Group deletion job should finish");
+	ENSURE_EQUAL(jobData["metadata"]["status"].GetString(),std::string("succeeded"),
+	             "Group deletion job should succeed");
+	ENSURE_EQUAL(jobData["resultCode"].GetUint(),200,
+	             "Group deletion job should record the result of the deletion");
+	
+	auto infoResp=httpGet(baseGroupUrl+"/"+groupID+token);
+	ENSURE_EQUAL(infoResp.status,404,"Group should be deleted once the job has finished");
+}
+
+TEST(AbandonedJobsFailed){
+	auto dbResp=httpRequests::httpGet("http://localhost:52000/dynamo/create");
+	ENSURE_EQUAL(dbResp.status,200);
+	std::string dbPort=dbResp.body;
+	
+	const std::string awsAccessKey="foo";
+	const std::string awsSecretKey="bar";
+	Aws::SDKOptions options;
+	Aws::InitAPI(options);
+	using AWSOptionsHandle=std::unique_ptr<Aws::SDKOptions,void(*)(Aws::SDKOptions*)>;
+	AWSOptionsHandle opt_holder(&options,
+								[](Aws::SDKOptions* options){
+									Aws::ShutdownAPI(*options);
+								});
+	Aws::Auth::AWSCredentials credentials(awsAccessKey,awsSecretKey);
+	Aws::Client::ClientConfiguration clientConfig;
+	clientConfig.scheme=Aws::Http::Scheme::HTTP;
+	clientConfig.endpointOverride="localhost:"+dbPort;
+	PersistentStore store(credentials,clientConfig,
+	                      "slate_portal_user","encryptionKey",
+	                      "",9200);
+	
+	//a job left running by a server instance which has stopped
+	Job stale;
+	stale.valid=true;
+	stale.id=idGenerator.generateJobID();
+	stale.kind="test";
+	stale.owner="User_1234";
+	stale.status="running";
+	stale.ctime=timestamp();
+	stale.mtime=stale.ctime;
+	ENSURE(store.addJob(stale),"Job addition should succeed");
+	const std::chrono::seconds heartbeat(1);
+	//let the record go unrefreshed for longer than an engine allows
+	std::this_thread::sleep_for(4*heartbeat+std::chrono::milliseconds(100));
+	
+	JobEngine::Limits limits;
+	limits.maxConcurrent=1;
+	limits.maxPerCluster=1;
+	limits.maxQueued=1;
+	User owner;
+	owner.valid=true;
+	owner.id="User_1234";
+	JobEngine engine(store,limits,heartbeat);
+	//a job which outlasts several heartbeats, which another engine must not 
+	//take to have been abandoned
+	Job live=engine.submit("test",owner,"",[]{
+		std::this_thread::sleep_for(std::chrono::seconds(8));
+		return crow::response(200);
+	});
+	ENSURE(live,"Job submission should succeed");
+	
+	const auto deadline=std::chrono::steady_clock::now()+std::chrono::seconds(5);
+	Job found=store.getJob(stale.id);
+	while(found.status=="running" && std::chrono::steady_clock::now()<deadline){
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		found=store.getJob(stale.id);
+	}
+	ENSURE_EQUAL(found.status,"failed","An abandoned job should be marked as failed");
+	ENSURE_EQUAL(found.resultCode,503);
+	
+	{
+		JobEngine other(store,limits,heartbeat);
+		std::this_thread::sleep_for(5*heartbeat);
+		ENSURE(other.getStatistics().find(", 0 abandoned")!=std::string::npos,
+		       "A job being run by a live engine should not be taken to be abandoned");
+		ENSURE_EQUAL(store.getJob(live.id).status,"running");
+	}
+}
@@ -0,0 +1,65 @@
+#include "test.h"
+
+#include <sstream>
+
+#include <Metrics.h>
+#include <RequestMetrics.h>
+#include <ServerUtilities.h>
+
+TEST(RouteTemplates){
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/users"),"/v1alpha3/users");
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/users/User_1234/groups/Group_5678"),
+	             "/v1alpha3/users/<string>/groups/<string>");
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/clusters/some-cluster/allowed_groups/*/applications"),
+	             "/v1alpha3/clusters/<string>/allowed_groups/<string>/applications");
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/apps/ad-hoc"),"/v1alpha3/apps/ad-hoc");
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/instances/Instance_1/logs/stream"),
+	             "/v1alpha3/instances/<string>/logs/stream");
+	ENSURE_EQUAL(routeTemplate("/version"),"/version");
+	ENSURE_EQUAL(routeTemplate("/v1alpha1/users"),"other");
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/Users"),"other");
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/a/b/c/d/e/f/g"),"other");
+	//lowercase names which are not part of any route must not each create 
+	//their own metrics
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/nonexistent"),"other");
+	ENSURE_EQUAL(routeTemplate("/v1alpha3/users/User_1234/nonexistent"),"other");
+}
+
+TEST(HistogramFamilyLimit){
+	metrics::HistogramFamily family("test_duration_seconds","Test durations",{"name"},2);
+	family.get({"a"}).record(std::chrono::milliseconds(1));
+	family.get({"b"}).record(std::chrono::milliseconds(1));
+	family.get({"c"}).record(std::chrono::milliseconds(1));
+	family.get({"d"}).record(std::chrono::milliseconds(1));
+	family.get({"a"}).record(std::chrono::milliseconds(1));
+	std::ostringstream os;
+	family.write(os);
+	const std::string output=os.str();
+	ENSURE(output.find("test_duration_seconds_count{name=\"a\"} 2")!=std::string::npos,
+	       "Existing histograms should continue to be used");
+	ENSURE(output.find("test_duration_seconds_count{name=\"other\"} 2")!=std::string::npos,
+	       "Label values beyond the limit should share the overflow histogram");
+	ENSURE(output.find("name=\"c\"")==std::string::npos,
+	       "No histogram should be created beyond the limit");
+}
+
+TEST(MetricsEndpoint){
+	using namespace httpRequests;
+	TestContext tc;
+	
+	std::string adminKey=getPortalToken();
+	auto listResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/users?token="+adminKey);
+	ENSURE_EQUAL(listResp.status,200,"Portal user should be able to list users");
+	
+	auto metricsResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/metrics");
+	ENSURE_EQUAL(metricsResp.status,200,"Metrics should be available without authentication");
+	const std::string& body=metricsResp.body;
+	ENSURE(body.find("# TYPE slate_http_request_duration_seconds histogram")!=std::string::npos,
+	       "Request latencies should be reported");
+	ENSURE(body.find("slate_http_request_duration_seconds_count{method=\"GET\",route=\"/v1alpha3/users\",code=\"2xx\"}")!=std::string::npos,
+	       "Latencies should be reported for the route which was used");
+	ENSURE(body.find("slate_dynamodb_operation_duration_seconds_bucket{operation=")!=std::string::npos,
+	       "Database latencies should be reported");
+	ENSURE(body.find("slate_cache_lookups_total{cache=\"userByTokenCache\"}")!=std::string::npos,
+	       "Cache statistics should be reported");
+}
@@ -0,0 +1,65 @@
+#include "test.h"
+
+#include <thread>
+
+#include <Tracing.h>
+
+TEST(SpansRecordedOnlyWhenTracing){
+	{
+		tracing::Span span("test","untraced");
+	}
+	ENSURE(!tracing::current(),"No trace should be current by default");
+
+	auto trace=std::make_shared<tracing::Trace>(tracing::generateTraceID());
+	{
+		tracing::Scope scope(trace);
+		ENSURE_EQUAL(tracing::current(),trace,"The trace should be current within its scope");
+		{
+			tracing::Span span("test","outer");
+			tracing::recordCompleted("test","inner",std::chrono::milliseconds(1));
+		}
+		//a trace can be carried to another thread
+		std::thread worker([trace]{
+			tracing::Scope scope(trace);
+			tracing::Span span("test","worker");
+		});
+		worker.join();
+	}
+	ENSURE(!tracing::current(),"The previous trace should be restored after the scope ends");
+	{
+		tracing::Span span("test","after");
+	}
+
+	auto spans=trace->spans();
+	ENSURE_EQUAL(spans.size(),3,"Only spans within the trace's scope should be recorded");
+	ENSURE_EQUAL(spans[0].name,"inner");
+	ENSURE_EQUAL(spans[1].name,"outer");
+	ENSURE_EQUAL(spans[2].name,"worker");
+	ENSURE(spans[2].thread!=spans[1].thread,"Spans should record the thread which performed them");
+}
+
+TEST(ServerTimingSummary){
+	tracing::Trace trace("abc");
+	const auto now=tracing::clock::now();
+	trace.record("dynamodb","GetItem",now,std::chrono::milliseconds(2));
+	trace.record("command","helm install",now,std::chrono::milliseconds(30));
+	trace.record("dynamodb","GetItem",now,std::chrono::milliseconds(3));
+	std::string timing=tracing::serverTiming(trace,std::chrono::milliseconds(40));
+	ENSURE_EQUAL(timing,"total;dur=40, dynamodb.GetItem;dur=5;desc=\"dynamodb GetItem x2\", "
+	                    "command.helm_install;dur=30;desc=\"command helm install\"");
+}
+
+TEST(ChromeTraceExport){
+	tracing::Trace trace("abc");
+	trace.record("command","kubectl get",trace.start()+std::chrono::microseconds(5),std::chrono::microseconds(10));
+	rapidjson::Document json;
+	json.Parse(tracing::chromeTrace(trace).c_str());
+	ENSURE(!json.HasParseError(),"The exported trace should be valid JSON");
+	ENSURE(json.HasMember("traceEvents") && json["traceEvents"].IsArray());
+	ENSURE_EQUAL(json["traceEvents"].Size(),1);
+	const auto& event=json["traceEvents"][0];
+	ENSURE_EQUAL(event["name"].GetString(),std::string("kubectl get"));
+	ENSURE_EQUAL(event["ph"].GetString(),std::string("X"));
+	ENSURE_EQUAL(event["ts"].GetInt64(),5);
+	ENSURE_EQUAL(event["dur"].GetInt64(),10);
+}
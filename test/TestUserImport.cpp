@@ -0,0 +1,233 @@
+#include "test.h"
+
+#include <set>
+
+#include <ServerUtilities.h>
+
+namespace{
+	rapidjson::Value importEntry(const std::string& name, const std::string& globusID,
+	                             const std::vector<std::string>& groups,
+	                             rapidjson::Document::AllocatorType& alloc){
+		rapidjson::Value item(rapidjson::kObjectType);
+		rapidjson::Value metadata(rapidjson::kObjectType);
+		metadata.AddMember("name", name, alloc);
+		metadata.AddMember("email", name+"@place.com", alloc);
+		metadata.AddMember("phone", "555-5555", alloc);
+		metadata.AddMember("institution", "Center of the Earth University", alloc);
+		metadata.AddMember("globusID", globusID, alloc);
+		rapidjson::Value groupList(rapidjson::kArrayType);
+		for(const auto& group : groups)
+			groupList.PushBack(rapidjson::Value(group, alloc), alloc);
+		metadata.AddMember("groups", groupList, alloc);
+		item.AddMember("metadata", metadata, alloc);
+		return item;
+	}
+}
+
+TEST(UnauthenticatedImportUsers){
+	using namespace httpRequests;
+	TestContext tc;
+
+	//try importing users with no authentication
+	//doesn't matter whether request body is correct since this should be rejected on other grounds
+	auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users","");
+	ENSURE_EQUAL(importResp.status,403,
+				 "Requests to import users without authentication should be rejected");
+
+	//try importing users with invalid authentication
+	importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token=00112233-4455-6677-8899-aabbccddeeff","");
+	ENSURE_EQUAL(importResp.status,403,
+				 "Requests to import users with invalid authentication should be rejected");
+}
+
+TEST(ImportUsers){
+	using namespace httpRequests;
+	TestContext tc;
+
+	std::string adminKey=getPortalToken();
+	auto schema=loadSchema(getSchemaDir()+"/UserImportResultSchema.json");
+	const std::vector<std::string> groupNames={"some-org","other-org"};
+
+	for(const auto& groupName : groupNames){ //create groups
+		rapidjson::Document request(rapidjson::kObjectType);
+		auto& alloc = request.GetAllocator();
+		request.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value metadata(rapidjson::kObjectType);
+		metadata.AddMember("name", groupName, alloc);
+		metadata.AddMember("scienceField", "Logic", alloc);
+		request.AddMember("metadata", metadata, alloc);
+		auto createResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/groups?token="+adminKey,to_string(request));
+		ENSURE_EQUAL(createResp.status,200,"Group creation request should succeed");
+	}
+
+	//enough users to require more than one batch of writes
+	const unsigned int nUsers=30;
+	std::vector<std::string> uids;
+	{ //import new users
+		rapidjson::Document request(rapidjson::kObjectType);
+		auto& alloc = request.GetAllocator();
+		request.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value items(rapidjson::kArrayType);
+		for(unsigned int i=0; i<nUsers; i++)
+			items.PushBack(importEntry("user"+std::to_string(i),"globus"+std::to_string(i),
+			                           {groupNames[i%2]},alloc),alloc);
+		request.AddMember("items", items, alloc);
+		auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+adminKey,to_string(request));
+		ENSURE_EQUAL(importResp.status,200,"User import request should succeed");
+		rapidjson::Document data;
+		data.Parse(importResp.body);
+		ENSURE_CONFORMS(data,schema);
+		ENSURE_EQUAL(data["items"].Size(),nUsers,"All users should be listed in the result");
+		for(unsigned int i=0; i<nUsers; i++){
+			const auto& metadata=data["items"][i]["metadata"];
+			ENSURE_EQUAL(metadata["globusID"].GetString(),"globus"+std::to_string(i),
+			             "Results should be in the same order as the request");
+			ENSURE(metadata["created"].GetBool(),"New users should be created");
+			ENSURE_EQUAL(metadata["addedGroups"].Size(),1,"New users should be added to their group");
+			uids.push_back(metadata["id"].GetString());
+		}
+	}
+
+	for(unsigned int i=0; i<nUsers; i++){ //check that the users exist and are in the right groups
+		auto infoResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/users/"+uids[i]+"?token="+adminKey);
+		ENSURE_EQUAL(infoResp.status,200,"Getting user's information should succeed");
+		rapidjson::Document data;
+		data.Parse(infoResp.body);
+		ENSURE_EQUAL(data["metadata"]["name"].GetString(),"user"+std::to_string(i),
+		             "User should have the imported name");
+		ENSURE_EQUAL(data["metadata"]["groups"].Size(),1,"User should belong to one Group");
+		ENSURE_EQUAL(data["metadata"]["groups"][0].GetString(),groupNames[i%2],
+		             "User should belong to the correct Group");
+	}
+
+	{ //import the same users again, with both groups
+		rapidjson::Document request(rapidjson::kObjectType);
+		auto& alloc = request.GetAllocator();
+		request.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value items(rapidjson::kArrayType);
+		for(unsigned int i=0; i<nUsers; i++)
+			items.PushBack(importEntry("user"+std::to_string(i),"globus"+std::to_string(i),
+			                           groupNames,alloc),alloc);
+		request.AddMember("items", items, alloc);
+		auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+adminKey,to_string(request));
+		ENSURE_EQUAL(importResp.status,200,"User import request should succeed");
+		rapidjson::Document data;
+		data.Parse(importResp.body);
+		ENSURE_CONFORMS(data,schema);
+		for(unsigned int i=0; i<nUsers; i++){
+			const auto& metadata=data["items"][i]["metadata"];
+			ENSURE_EQUAL(metadata["id"].GetString(),uids[i],"Existing users should be matched by globus ID");
+			ENSURE(!metadata["created"].GetBool(),"Existing users should not be created again");
+			ENSURE_EQUAL(metadata["addedGroups"].Size(),1,"Only missing memberships should be added");
+			ENSURE_EQUAL(metadata["addedGroups"][0].GetString(),groupNames[(i+1)%2],
+			             "The missing membership should be added");
+		}
+	}
+
+	{ //check that group membership is complete
+		auto listResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/groups/"+groupNames[0]+"/members?token="+adminKey);
+		ENSURE_EQUAL(listResp.status,200,"Listing Group members should succeed");
+		rapidjson::Document data;
+		data.Parse(listResp.body);
+		std::set<std::string> members;
+		for(const auto& item : data["items"].GetArray())
+			members.insert(item["metadata"]["id"].GetString());
+		for(const auto& uid : uids)
+			ENSURE(members.count(uid),"Every imported user should be a member of the Group");
+	}
+}
+
+TEST(MalformedImportUsers){
+	using namespace httpRequests;
+	TestContext tc;
+
+	std::string adminKey=getPortalToken();
+
+	{ //invalid JSON
+		auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+adminKey,"{\"items\":[");
+		ENSURE_EQUAL(importResp.status,400,"User import with invalid JSON should be rejected");
+	}
+	{ //missing user list
+		auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+adminKey,"{\"apiVersion\":\"v1alpha3\"}");
+		ENSURE_EQUAL(importResp.status,400,"User import without a user list should be rejected");
+	}
+	{ //user missing required information
+		rapidjson::Document request(rapidjson::kObjectType);
+		auto& alloc = request.GetAllocator();
+		request.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value items(rapidjson::kArrayType);
+		rapidjson::Value item=importEntry("Bob","Bob's Globus ID",{},alloc);
+		item["metadata"].RemoveMember("email");
+		items.PushBack(item,alloc);
+		request.AddMember("items", items, alloc);
+		auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+adminKey,to_string(request));
+		ENSURE_EQUAL(importResp.status,400,"User import with a user missing an email address should be rejected");
+	}
+	{ //duplicate user
+		rapidjson::Document request(rapidjson::kObjectType);
+		auto& alloc = request.GetAllocator();
+		request.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value items(rapidjson::kArrayType);
+		items.PushBack(importEntry("Bob","Bob's Globus ID",{},alloc),alloc);
+		items.PushBack(importEntry("Bob","Bob's Globus ID",{},alloc),alloc);
+		request.AddMember("items", items, alloc);
+		auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+adminKey,to_string(request));
+		ENSURE_EQUAL(importResp.status,400,"User import listing the same user twice should be rejected");
+	}
+}
+
+TEST(ImportUsersToNonexistentGroup){
+	using namespace httpRequests;
+	TestContext tc;
+
+	std::string adminKey=getPortalToken();
+
+	rapidjson::Document request(rapidjson::kObjectType);
+	auto& alloc = request.GetAllocator();
+	request.AddMember("apiVersion", currentAPIVersion, alloc);
+	rapidjson::Value items(rapidjson::kArrayType);
+	items.PushBack(importEntry("Bob","bobs_globus_id",{"no-such-group"},alloc),alloc);
+	request.AddMember("items", items, alloc);
+	auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+adminKey,to_string(request));
+	ENSURE_EQUAL(importResp.status,404,"User import to a nonexistent Group should be rejected");
+
+	//nothing should have been changed
+	auto findResp=httpGet(tc.getAPIServerURL()+"/"+currentAPIVersion+"/find_user?globus_id=bobs_globus_id&token="+adminKey);
+	ENSURE_EQUAL(findResp.status,404,"No user should have been created by a rejected import");
+}
+
+TEST(NonAdminImportUsers){
+	using namespace httpRequests;
+	TestContext tc;
+
+	std::string adminKey=getPortalToken();
+
+	std::string tok;
+	{ //create a non-admin user
+		rapidjson::Document request(rapidjson::kObjectType);
+		auto& alloc = request.GetAllocator();
+		request.AddMember("apiVersion", currentAPIVersion, alloc);
+		rapidjson::Value metadata(rapidjson::kObjectType);
+		metadata.AddMember("name", "Bob", alloc);
+		metadata.AddMember("email", "bob@place.com", alloc);
+		metadata.AddMember("phone", "555-5555", alloc);
+		metadata.AddMember("institution", "Center of the Earth University", alloc);
+		metadata.AddMember("admin", false, alloc);
+		metadata.AddMember("globusID", "Bob's Globus ID", alloc);
+		request.AddMember("metadata", metadata, alloc);
+		auto createResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/users?token="+adminKey,to_string(request));
+		ENSURE_EQUAL(createResp.status,200,"User creation request should succeed");
+		rapidjson::Document createData;
+		createData.Parse(createResp.body);
+		tok=createData["metadata"]["access_token"].GetString();
+	}
+
+	rapidjson::Document request(rapidjson::kObjectType);
+	auto& alloc = request.GetAllocator();
+	request.AddMember("apiVersion", currentAPIVersion, alloc);
+	rapidjson::Value items(rapidjson::kArrayType);
+	items.PushBack(importEntry("Fred","Fred's Globus ID",{},alloc),alloc);
+	request.AddMember("items", items, alloc);
+	auto importResp=httpPost(tc.getAPIServerURL()+"/"+currentAPIVersion+"/import_users?token="+tok,to_string(request));
+	ENSURE_EQUAL(importResp.status,403,"Non-admin users should not be able to import users");
+}